@@ -25,7 +25,9 @@
 
 #define GLM_FORCE_RADIANS
 
+#include <algorithm>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 #include <wx/datetime.h>
@@ -35,6 +37,7 @@
 
 #include "3d_cache.h"
 #include "3d_info.h"
+#include "3d_model_lod.h"
 #include "3d_plugin_manager.h"
 #include "sg/scenegraph.h"
 #include "plugins/3dapi/ifsg_api.h"
@@ -48,12 +51,14 @@
 #include <project.h>
 #include <settings/common_settings.h>
 #include <settings/settings_manager.h>
+#include <thread_pool.h>
 #include <wx_filename.h>
 
 
 #define MASK_3D_CACHE "3D_CACHE"
 
-static std::mutex mutex3D_cache;
+// Writing a cache file names the scene graph nodes from global counters
+static std::mutex mutex3D_cacheFile;
 
 
 static bool checkTag( const char* aTag, void* aPluginMgrPtr )
@@ -76,11 +81,21 @@ public:
     void SetHash( const HASH_128& aHash );
     const wxString GetCacheBaseName();
 
+    /// Release the render data and its simplified versions.
+    void FreeRenderData();
+
     wxDateTime    modTime;      // file modification time
     HASH_128      m_hash;
     std::string   pluginInfo;   // PluginName:Version string
     SCENEGRAPH*   sceneData;
-    S3DMODEL*     renderData;
+
+    // the render data is shared with the results of S3D_CACHE::GetModelAsync(), which may
+    // outlive the entry
+    std::shared_ptr<S3DMODEL>              renderData;
+    std::vector<std::shared_ptr<S3DMODEL>> lodData; // simplified versions of renderData
+    bool          lodsBuilt;    // true once lodData has been built or read
+    bool          loaded;       // true once the first load of the model has been attempted
+    std::mutex    mutex;        // held while the data of the entry is loaded or translated
 
 private:
     // prohibit assignment and default copy constructor
@@ -94,7 +109,8 @@ private:
 S3D_CACHE_ENTRY::S3D_CACHE_ENTRY()
 {
     sceneData = nullptr;
-    renderData = nullptr;
+    lodsBuilt = false;
+    loaded = false;
     m_hash.Clear();
 }
 
@@ -103,14 +119,38 @@ S3D_CACHE_ENTRY::~S3D_CACHE_ENTRY()
 {
     delete sceneData;
 
-    if( nullptr != renderData )
-        S3D::Destroy3DModel( &renderData );
+    FreeRenderData();
 }
 
 
 void S3D_CACHE_ENTRY::SetHash( const HASH_128& aHash )
 {
     m_hash = aHash;
+    m_CacheBaseName.clear();
+}
+
+
+void S3D_CACHE_ENTRY::FreeRenderData()
+{
+    renderData.reset();
+    lodData.clear();
+    lodsBuilt = false;
+}
+
+
+/**
+ * @return \a aModel owned by a shared pointer, or nullptr.
+ */
+static std::shared_ptr<S3DMODEL> shareModel( S3DMODEL* aModel )
+{
+    if( !aModel )
+        return nullptr;
+
+    return std::shared_ptr<S3DMODEL>( aModel,
+                                      []( S3DMODEL* aModelToFree )
+                                      {
+                                          S3D::Destroy3DModel( &aModelToFree );
+                                      } );
 }
 
 
@@ -128,11 +168,16 @@ S3D_CACHE::S3D_CACHE()
     m_FNResolver = new FILENAME_RESOLVER;
     m_project = nullptr;
     m_Plugins = new S3D_PLUGIN_MANAGER;
+    m_cancelLoads = false;
 }
 
 
 S3D_CACHE::~S3D_CACHE()
 {
+    // The queued loads are skipped; only the ones already running are waited for
+    m_cancelLoads = true;
+    m_loaderPool.reset();
+
     FlushCache();
 
     delete m_FNResolver;
@@ -141,11 +186,11 @@ S3D_CACHE::~S3D_CACHE()
 
 
 SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, const wxString& aBasePath,
-                             S3D_CACHE_ENTRY** aCachePtr,
+                             std::shared_ptr<S3D_CACHE_ENTRY>* aCachePtr,
                              std::vector<const EMBEDDED_FILES*> aEmbeddedFilesStack )
 {
     if( aCachePtr )
-        *aCachePtr = nullptr;
+        aCachePtr->reset();
 
     wxString full3Dpath = m_FNResolver->ResolvePath( aModelFile, aBasePath, std::move( aEmbeddedFilesStack ) );
 
@@ -157,58 +202,75 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, const wxString& aBasePa
         return nullptr;
     }
 
-    // check cache if file is already loaded
-    std::lock_guard<std::mutex> lock( mutex3D_cache );
+    std::shared_ptr<S3D_CACHE_ENTRY> ep;
 
-    std::map< wxString, S3D_CACHE_ENTRY*, rsort_wxString >::iterator mi;
-    mi = m_CacheMap.find( full3Dpath );
-
-    if( mi != m_CacheMap.end() )
+    // find the cache entry or create an empty one; the model is loaded without holding the
+    // cache lock so different models can be loaded in parallel, and the entry is kept alive by
+    // the loading thread if the cache is flushed meanwhile
     {
-        wxFileName fname( full3Dpath );
+        std::lock_guard<std::mutex> lock( m_mutex );
 
-        if( fname.FileExists() )    // Only check if file exists. If not, it will
-        {                           // use the same model in cache.
-            bool       reload = ADVANCED_CFG::GetCfg().m_Skip3DModelMemoryCache;
-            wxDateTime fmdate = fname.GetModificationTime();
+        auto mi = m_CacheMap.find( full3Dpath );
 
-            if( fmdate != mi->second->modTime )
-            {
-                HASH_128 hashSum;
-                getHash( full3Dpath, hashSum );
-                mi->second->modTime = fmdate;
+        if( mi != m_CacheMap.end() )
+        {
+            ep = mi->second;
+        }
+        else
+        {
+            ep = std::make_shared<S3D_CACHE_ENTRY>();
+            m_CacheList.push_back( ep );
+            m_CacheMap.emplace( full3Dpath, ep );
+        }
+    }
 
-                if( hashSum != mi->second->m_hash )
-                {
-                    mi->second->SetHash( hashSum );
-                    reload = true;
-                }
-            }
+    // threads asking for a model which is being loaded wait here for it
+    std::lock_guard<std::mutex> entryLock( ep->mutex );
 
-            if( reload )
-            {
-                if( nullptr != mi->second->sceneData )
-                {
-                    S3D::DestroyNode( mi->second->sceneData );
-                    mi->second->sceneData = nullptr;
-                }
+    if( nullptr != aCachePtr )
+        *aCachePtr = ep;
+
+    if( !ep->loaded )
+    {
+        // a cache item does not exist; search the Filename->Cachename map
+        ep->loaded = true;
+        return checkCache( full3Dpath, ep.get() );
+    }
 
-                if( nullptr != mi->second->renderData )
-                    S3D::Destroy3DModel( &mi->second->renderData );
+    wxFileName fname( full3Dpath );
 
-                mi->second->sceneData = m_Plugins->Load3DModel( full3Dpath,
-                                                                mi->second->pluginInfo );
+    if( fname.FileExists() )    // Only check if file exists. If not, it will
+    {                           // use the same model in cache.
+        bool       reload = ADVANCED_CFG::GetCfg().m_Skip3DModelMemoryCache;
+        wxDateTime fmdate = fname.GetModificationTime();
+
+        if( fmdate != ep->modTime )
+        {
+            HASH_128 hashSum;
+            getHash( full3Dpath, hashSum );
+            ep->modTime = fmdate;
+
+            if( hashSum != ep->m_hash )
+            {
+                ep->SetHash( hashSum );
+                reload = true;
             }
         }
 
-        if( nullptr != aCachePtr )
-            *aCachePtr = mi->second;
+        if( reload )
+        {
+            if( nullptr != ep->sceneData )
+            {
+                S3D::DestroyNode( ep->sceneData );
+                ep->sceneData = nullptr;
+            }
 
-        return mi->second->sceneData;
+            ep->FreeRenderData();
+            ep->sceneData = m_Plugins->Load3DModel( full3Dpath, ep->pluginInfo );
+        }
     }
 
-    // a cache item does not exist; search the Filename->Cachename map
-    return checkCache( full3Dpath, aCachePtr );
+    return ep->sceneData;
 }
 
 
@@ -219,70 +281,38 @@ SCENEGRAPH* S3D_CACHE::Load( const wxString& aModelFile, const wxString& aBasePa
 }
 
 
-SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem )
 {
-    if( aCachePtr )
-        *aCachePtr = nullptr;
-
-    HASH_128    hashSum;
-    S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
-    m_CacheList.push_back( ep );
+    HASH_128   hashSum;
     wxFileName fname( aFileName );
-    ep->modTime = fname.GetModificationTime();
+    aCacheItem->modTime = fname.GetModificationTime();
 
     if( !getHash( aFileName, hashSum ) || m_CacheDir.empty() )
     {
         // just in case we can't get a hash digest (for example, on access issues)
-        // or we do not have a configured cache file directory, we create an
+        // or we do not have a configured cache file directory, we keep an empty
         // entry to prevent further attempts at loading the file
-
-        if( m_CacheMap.emplace( aFileName, ep ).second == false )
-        {
-            wxLogTrace( MASK_3D_CACHE,
-                        wxT( "%s:%s:%d\n * [BUG] duplicate entry in map file; key = '%s'" ),
-                        __FILE__, __FUNCTION__, __LINE__, aFileName );
-
-            m_CacheList.pop_back();
-            delete ep;
-        }
-        else
-        {
-            if( aCachePtr )
-                *aCachePtr = ep;
-        }
-
-        return nullptr;
-    }
-
-    if( m_CacheMap.emplace( aFileName, ep ).second == false )
-    {
-        wxLogTrace( MASK_3D_CACHE,
-                    wxT( "%s:%s:%d\n * [BUG] duplicate entry in map file; key = '%s'" ),
-                    __FILE__, __FUNCTION__, __LINE__, aFileName );
-
-        m_CacheList.pop_back();
-        delete ep;
         return nullptr;
     }
 
-    if( aCachePtr )
-        *aCachePtr = ep;
-
-    ep->SetHash( hashSum );
+    aCacheItem->SetHash( hashSum );
 
-    wxString bname = ep->GetCacheBaseName();
+    wxString bname = aCacheItem->GetCacheBaseName();
     wxString cachename = m_CacheDir + bname + wxT( ".3dc" );
 
     if( !ADVANCED_CFG::GetCfg().m_Skip3DModelFileCache && wxFileName::FileExists( cachename )
-        && loadCacheData( ep ) )
-        return ep->sceneData;
+        && loadCacheData( aCacheItem ) )
+        return aCacheItem->sceneData;
 
-    ep->sceneData = m_Plugins->Load3DModel( aFileName, ep->pluginInfo );
+    aCacheItem->sceneData = m_Plugins->Load3DModel( aFileName, aCacheItem->pluginInfo );
 
-    if( !ADVANCED_CFG::GetCfg().m_Skip3DModelFileCache && nullptr != ep->sceneData )
-        saveCacheData( ep );
+    if( !ADVANCED_CFG::GetCfg().m_Skip3DModelFileCache && nullptr != aCacheItem->sceneData )
+    {
+        std::lock_guard<std::mutex> lock( mutex3D_cacheFile );
+        saveCacheData( aCacheItem );
+    }
 
-    return ep->sceneData;
+    return aCacheItem->sceneData;
 }
 
 
@@ -484,18 +514,13 @@ bool S3D_CACHE::SetProject( PROJECT* aProject )
 
     if( m_FNResolver->SetProject( aProject, &hasChanged ) && hasChanged )
     {
-        m_CacheMap.clear();
-
-        std::list< S3D_CACHE_ENTRY* >::iterator sL = m_CacheList.begin();
-        std::list< S3D_CACHE_ENTRY* >::iterator eL = m_CacheList.end();
-
-        while( sL != eL )
-        {
-            delete *sL;
-            ++sL;
-        }
+        // The loads still running keep their entries and results alive, so there is no need
+        // to wait for them
+        std::lock_guard<std::mutex> lock( m_mutex );
 
+        m_CacheMap.clear();
         m_CacheList.clear();
+        m_pendingLoads.clear();
 
         return true;
     }
@@ -524,17 +549,15 @@ std::list< wxString > const* S3D_CACHE::GetFileFilters() const
 
 void S3D_CACHE::FlushCache( bool closePlugins )
 {
-    std::list< S3D_CACHE_ENTRY* >::iterator sCL = m_CacheList.begin();
-    std::list< S3D_CACHE_ENTRY* >::iterator eCL = m_CacheList.end();
-
-    while( sCL != eCL )
     {
-        delete *sCL;
-        ++sCL;
-    }
+        // The loads still running keep their entries and results alive, so there is no need
+        // to wait for them
+        std::lock_guard<std::mutex> lock( m_mutex );
 
-    m_CacheList.clear();
-    m_CacheMap.clear();
+        m_CacheList.clear();
+        m_CacheMap.clear();
+        m_pendingLoads.clear();
+    }
 
     if( closePlugins )
         ClosePlugins();
@@ -551,8 +574,8 @@ void S3D_CACHE::ClosePlugins()
 S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName, const wxString& aBasePath,
                                std::vector<const EMBEDDED_FILES*> aEmbeddedFilesStack )
 {
-    S3D_CACHE_ENTRY* cp = nullptr;
-    SCENEGRAPH*      sp = load( aModelFileName, aBasePath, &cp, std::move( aEmbeddedFilesStack ) );
+    std::shared_ptr<S3D_CACHE_ENTRY> cp;
+    SCENEGRAPH* sp = load( aModelFileName, aBasePath, &cp, std::move( aEmbeddedFilesStack ) );
 
     if( !sp )
         return nullptr;
@@ -566,20 +589,132 @@ S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName, const wxString& a
         return nullptr;
     }
 
-    if( cp->renderData )
-        return cp->renderData;
+    std::lock_guard<std::mutex> entryLock( cp->mutex );
 
-    S3DMODEL* mp = S3D::GetModel( sp );
-    cp->renderData = mp;
+    if( !cp->renderData && cp->sceneData )
+        cp->renderData = shareModel( S3D::GetModel( cp->sceneData ) );
 
-    return mp;
+    return cp->renderData.get();
 }
 
+
+std::shared_future<std::vector<std::shared_ptr<S3DMODEL>>>
+S3D_CACHE::GetModelAsync( const wxString& aModelFileName, const wxString& aBasePath,
+                          std::vector<const EMBEDDED_FILES*> aEmbeddedFilesStack, bool aWithLods )
+{
+    wxString full3Dpath = m_FNResolver->ResolvePath( aModelFileName, aBasePath,
+                                                     std::move( aEmbeddedFilesStack ) );
+
+    if( full3Dpath.empty() )
+    {
+        wxLogTrace( MASK_3D_CACHE, wxT( "%s:%s:%d\n * [3D model] could not find model '%s'\n" ),
+                    __FILE__, __FUNCTION__, __LINE__, aModelFileName );
+
+        std::promise<std::vector<std::shared_ptr<S3DMODEL>>> missing;
+        missing.set_value( {} );
+        return missing.get_future().share();
+    }
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    auto it = m_pendingLoads.find( { full3Dpath, aWithLods } );
+
+    if( it != m_pendingLoads.end()
+            && it->second.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+    {
+        return it->second;
+    }
+
+    // The plugins are not reentrant and load one model at a time, so the loads get a few
+    // threads of their own rather than filling the queue of the KiCad thread pool, which the
+    // renderers use for their own work while the models load.
+    if( !m_loaderPool )
+    {
+        unsigned threads = std::clamp( std::thread::hardware_concurrency() / 2, 1u, 4u );
+        m_loaderPool = std::make_unique<thread_pool>( threads );
+    }
+
+    // a finished load is started again so the model is checked for changes as GetModel() does
+    std::shared_future<std::vector<std::shared_ptr<S3DMODEL>>> result =
+            m_loaderPool->submit_task(
+                    [this, full3Dpath, aWithLods]() -> std::vector<std::shared_ptr<S3DMODEL>>
+                    {
+                        if( m_cancelLoads )
+                            return {};
+
+                        return getModelLods( full3Dpath, aWithLods );
+                    } ).share();
+
+    m_pendingLoads[{ full3Dpath, aWithLods }] = result;
+
+    return result;
+}
+
+
+std::vector<std::shared_ptr<S3DMODEL>> S3D_CACHE::getModelLods( const wxString& aFullPath,
+                                                                bool aWithLods )
+{
+    std::shared_ptr<S3D_CACHE_ENTRY> cp;
+
+    if( !load( aFullPath, wxEmptyString, &cp ) || !cp )
+        return {};
+
+    std::lock_guard<std::mutex> entryLock( cp->mutex );
+
+    if( !cp->renderData && cp->sceneData )
+        cp->renderData = shareModel( S3D::GetModel( cp->sceneData ) );
+
+    if( !cp->renderData )
+        return {};
+
+    std::vector<std::shared_ptr<S3DMODEL>> models = { cp->renderData };
+
+    if( aWithLods )
+    {
+        if( !cp->lodsBuilt )
+            buildLods( cp.get() );
+
+        models.insert( models.end(), cp->lodData.begin(), cp->lodData.end() );
+    }
+
+    return models;
+}
+
+
+void S3D_CACHE::buildLods( S3D_CACHE_ENTRY* aCacheItem )
+{
+    aCacheItem->lodsBuilt = true;
+
+    wxString bname = aCacheItem->GetCacheBaseName();
+    bool     useFileCache = !ADVANCED_CFG::GetCfg().m_Skip3DModelFileCache && !bname.empty()
+                            && !m_CacheDir.empty();
+    wxString lodname = m_CacheDir + bname + wxT( ".lod" );
+
+    std::vector<S3DMODEL*> lods;
+
+    if( !useFileCache || !wxFileName::FileExists( lodname )
+            || !S3D::ReadLodCache( lodname, *aCacheItem->renderData, lods ) )
+    {
+        S3D::BuildLods( *aCacheItem->renderData, lods );
+
+        // an empty file is kept for the models which cannot be simplified, so they are not
+        // tried again the next time
+        if( useFileCache )
+        {
+            std::lock_guard<std::mutex> lock( mutex3D_cacheFile );
+            S3D::WriteLodCache( lodname, *aCacheItem->renderData, lods );
+        }
+    }
+
+    for( S3DMODEL* lod : lods )
+        aCacheItem->lodData.push_back( shareModel( lod ) );
+}
+
+
 void S3D_CACHE::CleanCacheDir( int aNumDaysOld )
 {
     wxDir         dir;
-    wxString      fileSpec = wxT( "*.3dc" );
-    wxArrayString fileList; // Holds list of ".3dc" files found in cache directory
+    wxArrayString fileList; // Holds list of ".3dc" and ".lod" files found in cache directory
     size_t        numFilesFound = 0;
 
     wxFileName thisFile;
@@ -595,8 +730,9 @@ void S3D_CACHE::CleanCacheDir( int aNumDaysOld )
     {
         thisFile.SetPath( m_CacheDir ); // Set the base path to the cache folder
 
-        // Get a list of all the ".3dc" files in the cache directory
-        numFilesFound = dir.GetAllFiles( m_CacheDir, &fileList, fileSpec );
+        // Get a list of all the model and level of detail files in the cache directory
+        for( const wxString& fileSpec : { wxT( "*.3dc" ), wxT( "*.lod" ) } )
+            numFilesFound += dir.GetAllFiles( m_CacheDir, &fileList, fileSpec );
 
         for( unsigned int i = 0; i < numFilesFound; i++ )
         {
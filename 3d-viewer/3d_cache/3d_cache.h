@@ -33,8 +33,15 @@
 #include <core/typeinfo.h>
 #include "string_utils.h"
 #include <hash_128.h>
+#include <thread_pool.h>
+#include <atomic>
+#include <future>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include "plugins/3dapi/c3dmodel.h"
 #include <project.h>
 #include <wx/string.h>
@@ -136,27 +143,48 @@ public:
     S3DMODEL* GetModel( const wxString& aModelFileName, const wxString& aBasePath,
                         std::vector<const EMBEDDED_FILES*> aEmbeddedFilesStack );
 
+    /**
+     * Start loading a model in the background and translating it into an S3DMODEL structure.
+     *
+     * The model file name is resolved on the calling thread, so the embedded files only have to
+     * live until this function returns.  Asking for a model which is still being loaded returns
+     * the same future.  Flushing the cache does not wait for the loads in progress.
+     *
+     * @param aModelFileName is the full path to the model to be loaded.
+     * @param aBasePath is the path to search for any relative files.
+     * @param aEmbeddedFilesStack is a stack of pointers to the embedded files lists.
+     * @param aWithLods set to true to also get the simplified versions of the model, see
+     *                  S3D::BuildLods().  They are read from or saved to the cache directory.
+     * @return a future holding the render data followed by its simplified versions, or an
+     *         empty list if not available.  The models are shared with the cache and stay valid
+     *         as long as the future does, even if the cache is flushed.
+     */
+    std::shared_future<std::vector<std::shared_ptr<S3DMODEL>>>
+    GetModelAsync( const wxString& aModelFileName, const wxString& aBasePath,
+                   std::vector<const EMBEDDED_FILES*> aEmbeddedFilesStack, bool aWithLods = false );
+
     /**
      * Delete up old cache files in cache directory.
      *
-     * Deletes ".3dc" files in the cache directory that are older than \a aNumDaysOld.
+     * Deletes ".3dc" and ".lod" files in the cache directory that are older than
+     * \a aNumDaysOld.
      *
-     * @param aNumDaysOld is age threshold to delete ".3dc" cache files.
+     * @param aNumDaysOld is age threshold to delete cache files.
      */
     void CleanCacheDir( int aNumDaysOld );
 
 private:
     /**
-     * Find or create cache entry for file name
+     * Load the scene data of a new cache entry.
      *
-     * Searches the cache list for the given filename and retrieves the cache data; a cache
-     * entry is created if one does not already exist.
+     * The data is read from the cache file if there is one for the hash of the model file,
+     * otherwise the model is loaded through the plugins and a cache file is written.
      *
-     * @param aFileName  is the file name (full or partial path).
-     * @param aCachePtr is an optional return address for cache entry pointer.
+     * @param aFileName is the full path of the model file.
+     * @param aCacheItem is the new cache entry, locked by the caller.
      * @return SCENEGRAPH object associated with file name or NULL on error.
      */
-    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = nullptr );
+    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem );
 
     /**
      * Calculate the SHA1 hash of the given file.
@@ -173,16 +201,43 @@ private:
     // save scene data to a cache file
     bool saveCacheData( S3D_CACHE_ENTRY* aCacheItem );
 
+    /**
+     * Load a model and translate it into render data.
+     *
+     * @param aFullPath is the resolved path of the model file.
+     * @param aWithLods set to true to also get the simplified versions of the model.
+     * @return the render data followed by its simplified versions, or an empty list.
+     */
+    std::vector<std::shared_ptr<S3DMODEL>> getModelLods( const wxString& aFullPath,
+                                                         bool aWithLods );
+
+    // build the simplified versions of the render data of an entry locked by the caller,
+    // or read them from the cache directory
+    void buildLods( S3D_CACHE_ENTRY* aCacheItem );
+
     // the real load function (can supply a cache entry pointer to member functions)
     SCENEGRAPH* load( const wxString& aModelFile, const wxString& aBasePath,
-                      S3D_CACHE_ENTRY** aCachePtr = nullptr,
+                      std::shared_ptr<S3D_CACHE_ENTRY>* aCachePtr = nullptr,
                       std::vector<const EMBEDDED_FILES*> aEmbeddedFilesStack = {} );
 
-    /// Cache entries.
-    std::list< S3D_CACHE_ENTRY* > m_CacheList;
+    /// Protects the cache list and map; each entry has its own lock for loading its data.
+    std::mutex m_mutex;
+
+    /// Loads started by GetModelAsync(), by full file name and LOD request.
+    std::map<std::pair<wxString, bool>,
+             std::shared_future<std::vector<std::shared_ptr<S3DMODEL>>>> m_pendingLoads;
+
+    /// Threads running the loads started by GetModelAsync(), created on first use.
+    std::unique_ptr<thread_pool> m_loaderPool;
+
+    /// Set on destruction so the queued loads are skipped.
+    std::atomic<bool> m_cancelLoads;
+
+    /// Cache entries, shared with the loads in progress.
+    std::list<std::shared_ptr<S3D_CACHE_ENTRY>> m_CacheList;
 
     /// Mapping of file names to cache names and data.
-    std::map< wxString, S3D_CACHE_ENTRY*, rsort_wxString > m_CacheMap;
+    std::map<wxString, std::shared_ptr<S3D_CACHE_ENTRY>, rsort_wxString> m_CacheMap;
 
     FILENAME_RESOLVER*  m_FNResolver;
 
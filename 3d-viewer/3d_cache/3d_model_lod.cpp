@@ -0,0 +1,594 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/log.h>
+
+#include "3d_model_lod.h"
+#include "plugins/3dapi/ifsg_api.h"
+
+
+#define MASK_3D_LOD "3D_LOD"
+
+static const char   LOD_FILE_TAG[8] = { 'K', 'I', 'C', 'A', 'D', 'L', 'O', 'D' };
+static const uint32_t LOD_FILE_VERSION = 1;
+
+// A level must have less than this fraction of the triangles of the previous one to be kept
+static const double LOD_MIN_REDUCTION = 0.6;
+
+
+static bool isValidMesh( const S3DMODEL& aModel, const SMESH& aMesh )
+{
+    // same checks as MODEL_3D, which ignores the other meshes
+    return aMesh.m_MaterialIdx < aModel.m_MaterialsSize
+           && aMesh.m_Positions != nullptr
+           && aMesh.m_Normals != nullptr
+           && aMesh.m_FaceIdx != nullptr
+           && aMesh.m_FaceIdxSize >= 3
+           && aMesh.m_VertexSize > 0;
+}
+
+
+/**
+ * Return the main direction of a normal, so vertices of opposite faces of a thin part or of
+ * both sides of a sharp edge are not merged.
+ */
+static int normalDirection( const SFVEC3F& aNormal )
+{
+    const SFVEC3F n = glm::abs( aNormal );
+
+    if( n.x >= n.y && n.x >= n.z )
+        return aNormal.x >= 0.0f ? 0 : 1;
+    else if( n.y >= n.z )
+        return aNormal.y >= 0.0f ? 2 : 3;
+    else
+        return aNormal.z >= 0.0f ? 4 : 5;
+}
+
+
+unsigned int S3D::GetTriangleCount( const S3DMODEL& aModel )
+{
+    unsigned int count = 0;
+
+    for( unsigned int ii = 0; ii < aModel.m_MeshesSize; ++ii )
+    {
+        if( isValidMesh( aModel, aModel.m_Meshes[ii] ) )
+            count += aModel.m_Meshes[ii].m_FaceIdxSize / 3;
+    }
+
+    return count;
+}
+
+
+static SMATERIAL* copyMaterials( const S3DMODEL& aModel )
+{
+    SMATERIAL* materials = new SMATERIAL[aModel.m_MaterialsSize];
+
+    std::copy( aModel.m_Materials, aModel.m_Materials + aModel.m_MaterialsSize, materials );
+
+    return materials;
+}
+
+
+static S3DMODEL* newModel( const S3DMODEL& aSource, std::vector<SMESH>& aMeshes )
+{
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = aSource.m_MaterialsSize;
+    model->m_Materials = copyMaterials( aSource );
+
+    model->m_MeshesSize = aMeshes.size();
+    model->m_Meshes = new SMESH[aMeshes.size()];
+    std::copy( aMeshes.begin(), aMeshes.end(), model->m_Meshes );
+
+    return model;
+}
+
+
+S3DMODEL* S3D::SimplifyModel( const S3DMODEL& aModel, int aGridSize )
+{
+    if( aModel.m_Meshes == nullptr || aModel.m_Materials == nullptr || aGridSize < 1 )
+        return nullptr;
+
+    SFVEC3F bboxMin( FLT_MAX );
+    SFVEC3F bboxMax( -FLT_MAX );
+
+    for( unsigned int mesh_i = 0; mesh_i < aModel.m_MeshesSize; ++mesh_i )
+    {
+        const SMESH& mesh = aModel.m_Meshes[mesh_i];
+
+        if( !isValidMesh( aModel, mesh ) )
+            continue;
+
+        for( unsigned int vtx_i = 0; vtx_i < mesh.m_VertexSize; ++vtx_i )
+        {
+            bboxMin = glm::min( bboxMin, mesh.m_Positions[vtx_i] );
+            bboxMax = glm::max( bboxMax, mesh.m_Positions[vtx_i] );
+        }
+    }
+
+    const SFVEC3F extent = bboxMax - bboxMin;
+    const float   maxExtent = std::max( { extent.x, extent.y, extent.z } );
+
+    if( !( maxExtent > 0.0f ) || !std::isfinite( maxExtent ) )
+        return nullptr;
+
+    const float    cellSize = maxExtent / aGridSize;
+    const uint64_t cells = aGridSize + 1;
+
+    struct CLUSTER
+    {
+        glm::dvec3   m_pos = glm::dvec3( 0.0 );
+        SFVEC3F      m_normal = SFVEC3F( 0.0f );
+        SFVEC3F      m_color = SFVEC3F( 0.0f );
+        SFVEC2F      m_uv = SFVEC2F( 0.0f );
+        unsigned int m_count = 0;
+    };
+
+    struct TRIANGLE_HASH
+    {
+        size_t operator()( const std::array<unsigned int, 3>& aTri ) const
+        {
+            return ( (size_t) aTri[0] * 73856093 ) ^ ( (size_t) aTri[1] * 19349663 )
+                   ^ ( (size_t) aTri[2] * 83492791 );
+        }
+    };
+
+    std::vector<SMESH> meshes;
+    unsigned int       triangleCount = 0;
+
+    for( unsigned int mesh_i = 0; mesh_i < aModel.m_MeshesSize; ++mesh_i )
+    {
+        const SMESH& mesh = aModel.m_Meshes[mesh_i];
+
+        if( !isValidMesh( aModel, mesh ) )
+            continue;
+
+        // Clusters are numbered in the order of the vertices, so the result doesn't depend
+        // on the order of the hash map
+        std::unordered_map<uint64_t, unsigned int> clusterIds;
+        std::vector<CLUSTER>                       clusters;
+        std::vector<unsigned int>                  vertexCluster( mesh.m_VertexSize );
+
+        for( unsigned int vtx_i = 0; vtx_i < mesh.m_VertexSize; ++vtx_i )
+        {
+            const SFVEC3F& pos = mesh.m_Positions[vtx_i];
+            const SFVEC3F  cell = glm::clamp( glm::floor( ( pos - bboxMin ) / cellSize ),
+                                              SFVEC3F( 0.0f ), SFVEC3F( (float) aGridSize ) );
+
+            const uint64_t key = ( ( ( (uint64_t) cell.x * cells ) + (uint64_t) cell.y ) * cells
+                                   + (uint64_t) cell.z ) * 6
+                                 + normalDirection( mesh.m_Normals[vtx_i] );
+
+            auto [it, inserted] = clusterIds.emplace( key, (unsigned int) clusters.size() );
+
+            if( inserted )
+                clusters.emplace_back();
+
+            CLUSTER& cluster = clusters[it->second];
+
+            cluster.m_pos += glm::dvec3( pos );
+            cluster.m_normal += mesh.m_Normals[vtx_i];
+
+            if( mesh.m_Color )
+                cluster.m_color += mesh.m_Color[vtx_i];
+
+            if( mesh.m_Texcoords )
+                cluster.m_uv += mesh.m_Texcoords[vtx_i];
+
+            cluster.m_count++;
+            vertexCluster[vtx_i] = it->second;
+        }
+
+        // Collapse the triangles, dropping the degenerate and the duplicated ones
+        std::unordered_set<std::array<unsigned int, 3>, TRIANGLE_HASH> seen;
+        std::vector<unsigned int> indices;
+        std::vector<int>          newIndex( clusters.size(), -1 );
+        std::vector<unsigned int> usedClusters;
+
+        const unsigned int faceIdxSize = ( mesh.m_FaceIdxSize / 3 ) * 3;
+
+        for( unsigned int idx_i = 0; idx_i < faceIdxSize; idx_i += 3 )
+        {
+            std::array<unsigned int, 3> tri;
+            bool                        valid = true;
+
+            for( int ii = 0; ii < 3; ++ii )
+            {
+                unsigned int vtx = mesh.m_FaceIdx[idx_i + ii];
+
+                if( vtx >= mesh.m_VertexSize )
+                {
+                    valid = false;
+                    break;
+                }
+
+                tri[ii] = vertexCluster[vtx];
+            }
+
+            if( !valid || tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2] )
+                continue;
+
+            // Same triangle with the same winding, whatever its first vertex
+            std::array<unsigned int, 3> key = tri;
+            std::rotate( key.begin(), std::min_element( key.begin(), key.end() ), key.end() );
+
+            if( !seen.insert( key ).second )
+                continue;
+
+            for( unsigned int cluster : tri )
+            {
+                if( newIndex[cluster] < 0 )
+                {
+                    newIndex[cluster] = (int) usedClusters.size();
+                    usedClusters.push_back( cluster );
+                }
+
+                indices.push_back( newIndex[cluster] );
+            }
+        }
+
+        if( indices.empty() )
+            continue;
+
+        SMESH out;
+        S3D::Init3DMesh( out );
+
+        out.m_MaterialIdx = mesh.m_MaterialIdx;
+        out.m_VertexSize = usedClusters.size();
+        out.m_Positions = new SFVEC3F[out.m_VertexSize];
+        out.m_Normals = new SFVEC3F[out.m_VertexSize];
+
+        if( mesh.m_Color )
+            out.m_Color = new SFVEC3F[out.m_VertexSize];
+
+        if( mesh.m_Texcoords )
+            out.m_Texcoords = new SFVEC2F[out.m_VertexSize];
+
+        for( unsigned int ii = 0; ii < usedClusters.size(); ++ii )
+        {
+            const CLUSTER& cluster = clusters[usedClusters[ii]];
+            const float    scale = 1.0f / cluster.m_count;
+
+            out.m_Positions[ii] = SFVEC3F( cluster.m_pos / (double) cluster.m_count );
+
+            if( glm::length( cluster.m_normal ) > FLT_EPSILON )
+                out.m_Normals[ii] = glm::normalize( cluster.m_normal );
+            else
+                out.m_Normals[ii] = SFVEC3F( 0.0f, 0.0f, 1.0f );
+
+            if( out.m_Color )
+                out.m_Color[ii] = cluster.m_color * scale;
+
+            if( out.m_Texcoords )
+                out.m_Texcoords[ii] = cluster.m_uv * scale;
+        }
+
+        out.m_FaceIdxSize = indices.size();
+        out.m_FaceIdx = new unsigned int[indices.size()];
+        std::copy( indices.begin(), indices.end(), out.m_FaceIdx );
+
+        triangleCount += indices.size() / 3;
+        meshes.push_back( out );
+    }
+
+    if( meshes.empty() || triangleCount > GetTriangleCount( aModel ) * LOD_MIN_REDUCTION )
+    {
+        for( SMESH& mesh : meshes )
+            S3D::Free3DMesh( mesh );
+
+        return nullptr;
+    }
+
+    return newModel( aModel, meshes );
+}
+
+
+void S3D::BuildLods( const S3DMODEL& aModel, std::vector<S3DMODEL*>& aLods )
+{
+    const S3DMODEL* previous = &aModel;
+
+    for( int gridSize : LOD_GRID_SIZES )
+    {
+        S3DMODEL* lod = SimplifyModel( aModel, gridSize );
+
+        if( !lod )
+            break;
+
+        if( GetTriangleCount( *lod ) > GetTriangleCount( *previous ) * LOD_MIN_REDUCTION )
+        {
+            S3D::Destroy3DModel( &lod );
+            break;
+        }
+
+        aLods.push_back( lod );
+        previous = lod;
+    }
+}
+
+
+size_t S3D::SelectLod( float aScreenSize, size_t aLevelCount )
+{
+    size_t level = 0;
+
+    while( level < std::min( aLevelCount, LOD_LEVELS )
+           && aScreenSize < LOD_GRID_SIZES[level] * 2.0f )
+    {
+        level++;
+    }
+
+    return level;
+}
+
+
+namespace
+{
+
+/// Identifies the full model the levels of a file were built from
+struct LOD_FILE_HEADER
+{
+    char     m_tag[8];
+    uint32_t m_version;
+    uint32_t m_gridSizes[S3D::LOD_LEVELS];
+    uint32_t m_meshCount;
+    uint32_t m_vertexCount;
+    uint32_t m_indexCount;
+    uint32_t m_levelCount;
+};
+
+
+LOD_FILE_HEADER makeHeader( const S3DMODEL& aModel, size_t aLevelCount )
+{
+    LOD_FILE_HEADER header;
+    memset( &header, 0, sizeof( header ) );
+
+    memcpy( header.m_tag, LOD_FILE_TAG, sizeof( header.m_tag ) );
+    header.m_version = LOD_FILE_VERSION;
+
+    for( size_t ii = 0; ii < S3D::LOD_LEVELS; ++ii )
+        header.m_gridSizes[ii] = S3D::LOD_GRID_SIZES[ii];
+
+    header.m_meshCount = aModel.m_MeshesSize;
+
+    for( unsigned int ii = 0; ii < aModel.m_MeshesSize; ++ii )
+    {
+        header.m_vertexCount += aModel.m_Meshes[ii].m_VertexSize;
+        header.m_indexCount += aModel.m_Meshes[ii].m_FaceIdxSize;
+    }
+
+    header.m_levelCount = aLevelCount;
+
+    return header;
+}
+
+
+enum MESH_FLAGS
+{
+    HAS_COLORS = 1,
+    HAS_TEXCOORDS = 2
+};
+
+} // namespace
+
+
+bool S3D::WriteLodCache( const wxString& aFileName, const S3DMODEL& aModel,
+                         const std::vector<S3DMODEL*>& aLods )
+{
+    // Write to a temporary file first so a partial file is never read
+    wxString tmpName = aFileName + wxT( ".tmp" );
+    wxFFile  file( tmpName, wxT( "wb" ) );
+
+    if( !file.IsOpened() )
+    {
+        wxLogTrace( MASK_3D_LOD, wxT( " * [3D model] cannot create LOD file '%s'" ), tmpName );
+        return false;
+    }
+
+    LOD_FILE_HEADER header = makeHeader( aModel, aLods.size() );
+    bool            ok = file.Write( &header, sizeof( header ) ) == sizeof( header );
+
+    auto write =
+            [&]( const void* aData, size_t aSize )
+            {
+                if( ok && aSize )
+                    ok = file.Write( aData, aSize ) == aSize;
+            };
+
+    for( const S3DMODEL* lod : aLods )
+    {
+        uint32_t meshCount = lod->m_MeshesSize;
+        write( &meshCount, sizeof( meshCount ) );
+
+        for( unsigned int ii = 0; ii < lod->m_MeshesSize; ++ii )
+        {
+            const SMESH& mesh = lod->m_Meshes[ii];
+
+            uint32_t desc[4] = { mesh.m_MaterialIdx, mesh.m_VertexSize, mesh.m_FaceIdxSize,
+                                 ( mesh.m_Color ? HAS_COLORS : 0u )
+                                         | ( mesh.m_Texcoords ? HAS_TEXCOORDS : 0u ) };
+
+            write( desc, sizeof( desc ) );
+            write( mesh.m_Positions, sizeof( SFVEC3F ) * mesh.m_VertexSize );
+            write( mesh.m_Normals, sizeof( SFVEC3F ) * mesh.m_VertexSize );
+
+            if( mesh.m_Color )
+                write( mesh.m_Color, sizeof( SFVEC3F ) * mesh.m_VertexSize );
+
+            if( mesh.m_Texcoords )
+                write( mesh.m_Texcoords, sizeof( SFVEC2F ) * mesh.m_VertexSize );
+
+            write( mesh.m_FaceIdx, sizeof( unsigned int ) * mesh.m_FaceIdxSize );
+        }
+    }
+
+    ok = file.Close() && ok;
+
+    if( !ok || !wxRenameFile( tmpName, aFileName, true ) )
+    {
+        wxLogTrace( MASK_3D_LOD, wxT( " * [3D model] cannot write LOD file '%s'" ), aFileName );
+        wxRemoveFile( tmpName );
+        return false;
+    }
+
+    return true;
+}
+
+
+bool S3D::ReadLodCache( const wxString& aFileName, const S3DMODEL& aModel,
+                        std::vector<S3DMODEL*>& aLods )
+{
+    wxFFile file( aFileName, wxT( "rb" ) );
+
+    if( !file.IsOpened() )
+        return false;
+
+    const wxFileOffset length = file.Length();
+
+    LOD_FILE_HEADER expected = makeHeader( aModel, 0 );
+    LOD_FILE_HEADER header;
+
+    if( file.Read( &header, sizeof( header ) ) != sizeof( header ) )
+        return false;
+
+    expected.m_levelCount = header.m_levelCount;
+
+    if( memcmp( &header, &expected, sizeof( header ) ) != 0
+            || header.m_levelCount > LOD_LEVELS )
+    {
+        wxLogTrace( MASK_3D_LOD, wxT( " * [3D model] LOD file '%s' doesn't match the model" ),
+                    aFileName );
+        return false;
+    }
+
+    bool ok = true;
+
+    // Never trust a size read from the file for more than what is left of it
+    auto read =
+            [&]( void* aData, size_t aSize )
+            {
+                if( ok && aSize )
+                {
+                    ok = (wxFileOffset) aSize <= length - file.Tell()
+                         && file.Read( aData, aSize ) == aSize;
+                }
+
+                return ok;
+            };
+
+    std::vector<S3DMODEL*> lods;
+
+    for( uint32_t level = 0; ok && level < header.m_levelCount; ++level )
+    {
+        uint32_t           meshCount = 0;
+        std::vector<SMESH> meshes;
+
+        if( !read( &meshCount, sizeof( meshCount ) ) || meshCount > aModel.m_MeshesSize )
+        {
+            ok = false;
+            break;
+        }
+
+        for( uint32_t ii = 0; ii < meshCount; ++ii )
+        {
+            uint32_t desc[4];
+
+            if( !read( desc, sizeof( desc ) ) )
+                break;
+
+            const uint32_t vertexSize = desc[1];
+            const uint32_t faceIdxSize = desc[2];
+
+            if( desc[0] >= aModel.m_MaterialsSize || vertexSize == 0 || faceIdxSize == 0
+                    || (wxFileOffset) vertexSize * sizeof( SFVEC3F ) > length
+                    || (wxFileOffset) faceIdxSize * sizeof( unsigned int ) > length )
+            {
+                ok = false;
+                break;
+            }
+
+            SMESH mesh;
+            S3D::Init3DMesh( mesh );
+
+            mesh.m_MaterialIdx = desc[0];
+            mesh.m_VertexSize = vertexSize;
+            mesh.m_FaceIdxSize = faceIdxSize;
+            mesh.m_Positions = new SFVEC3F[vertexSize];
+            mesh.m_Normals = new SFVEC3F[vertexSize];
+            mesh.m_FaceIdx = new unsigned int[faceIdxSize];
+
+            read( mesh.m_Positions, sizeof( SFVEC3F ) * vertexSize );
+            read( mesh.m_Normals, sizeof( SFVEC3F ) * vertexSize );
+
+            if( desc[3] & HAS_COLORS )
+            {
+                mesh.m_Color = new SFVEC3F[vertexSize];
+                read( mesh.m_Color, sizeof( SFVEC3F ) * vertexSize );
+            }
+
+            if( desc[3] & HAS_TEXCOORDS )
+            {
+                mesh.m_Texcoords = new SFVEC2F[vertexSize];
+                read( mesh.m_Texcoords, sizeof( SFVEC2F ) * vertexSize );
+            }
+
+            read( mesh.m_FaceIdx, sizeof( unsigned int ) * faceIdxSize );
+
+            for( uint32_t idx = 0; ok && idx < faceIdxSize; ++idx )
+                ok = mesh.m_FaceIdx[idx] < vertexSize;
+
+            meshes.push_back( mesh );
+
+            if( !ok )
+                break;
+        }
+
+        if( ok )
+            lods.push_back( newModel( aModel, meshes ) );
+        else
+            for( SMESH& mesh : meshes )
+                S3D::Free3DMesh( mesh );
+    }
+
+    if( !ok )
+    {
+        wxLogTrace( MASK_3D_LOD, wxT( " * [3D model] corrupt LOD file '%s'" ), aFileName );
+
+        for( S3DMODEL*& lod : lods )
+            S3D::Destroy3DModel( &lod );
+
+        return false;
+    }
+
+    aLods.insert( aLods.end(), lods.begin(), lods.end() );
+    return true;
+}
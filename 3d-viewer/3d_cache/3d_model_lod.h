@@ -0,0 +1,110 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_model_lod.h
+ * Simplified versions of the 3D models, used to draw models which are small on screen.
+ */
+
+#ifndef MODEL_LOD_3D_H
+#define MODEL_LOD_3D_H
+
+#include <vector>
+#include <plugins/3dapi/c3dmodel.h>
+#include <wx/string.h>
+
+namespace S3D
+{
+
+/// Number of simplified levels of detail built for a model
+constexpr size_t LOD_LEVELS = 2;
+
+/// Size of the clustering grid of each level, in cells along the largest side of the model
+constexpr int LOD_GRID_SIZES[LOD_LEVELS] = { 48, 12 };
+
+/**
+ * Simplify a model by merging its vertices falling in the same cell of a regular grid.
+ *
+ * The vertices of each mesh are clustered separately and only with vertices facing the same
+ * way, so the materials and the sharp edges of the model are kept.  The result only depends on
+ * the input model: the same model always gives the same simplified model.
+ *
+ * @param aModel is the model to simplify.
+ * @param aGridSize is the number of cells along the largest side of the model bounding box.
+ * @return the simplified model, to be freed with S3D::Destroy3DModel(), or nullptr if it would
+ *         not be significantly smaller than \a aModel.
+ */
+S3DMODEL* SimplifyModel( const S3DMODEL& aModel, int aGridSize );
+
+/**
+ * Build the simplified versions of a model for each grid of #LOD_GRID_SIZES.
+ *
+ * The levels stop at the first one which doesn't make the model significantly smaller than
+ * the previous level.
+ *
+ * @param aLods receives the simplified models, from the most to the least detailed.
+ */
+void BuildLods( const S3DMODEL& aModel, std::vector<S3DMODEL*>& aLods );
+
+/**
+ * Select the level of detail to draw a model with.
+ *
+ * A level is used while its grid cells are smaller than two pixels on screen.
+ *
+ * @param aScreenSize is the size of the model on screen, in pixels.
+ * @param aLevelCount is the number of simplified levels available.
+ * @return 0 for the full model, otherwise the index of the simplified level plus one.
+ */
+size_t SelectLod( float aScreenSize, size_t aLevelCount );
+
+/**
+ * Return the number of triangles of the meshes of a model.
+ */
+unsigned int GetTriangleCount( const S3DMODEL& aModel );
+
+/**
+ * Save the simplified versions of a model.
+ *
+ * @param aFileName is the file to write.
+ * @param aModel is the full model the levels were built from.
+ * @param aLods are the simplified levels.
+ * @return true on success.
+ */
+bool WriteLodCache( const wxString& aFileName, const S3DMODEL& aModel,
+                    const std::vector<S3DMODEL*>& aLods );
+
+/**
+ * Load the simplified versions of a model saved by WriteLodCache().
+ *
+ * The file is rejected if it was built with other grid sizes or from a different model.
+ *
+ * @param aModel is the full model; the levels use its materials.
+ * @param aLods receives the simplified levels.
+ * @return true on success.
+ */
+bool ReadLodCache( const wxString& aFileName, const S3DMODEL& aModel,
+                   std::vector<S3DMODEL*>& aLods );
+
+} // namespace S3D
+
+#endif // MODEL_LOD_3D_H
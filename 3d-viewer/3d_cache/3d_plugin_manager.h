@@ -32,6 +32,7 @@
 
 #include <map>
 #include <list>
+#include <mutex>
 #include <string>
 #include <wx/string.h>
 
@@ -53,6 +54,11 @@ public:
      */
     std::list< wxString > const* GetFileFilters( void ) const noexcept;
 
+    /**
+     * Load a model through the first plugin able to read it.
+     *
+     * This may be called from any thread; the plugins are called one at a time.
+     */
     SCENEGRAPH* Load3DModel( const wxString& aFileName, std::string& aPluginInfo );
 
     /**
@@ -96,6 +102,10 @@ private:
 
     /// list of file filters
     std::list< wxString > m_FileFilters;
+
+    /// plugins are not reentrant (they keep state and may switch the locale), so models are
+    /// loaded through them one at a time
+    std::mutex m_mutex;
 };
 
 #endif  // PLUGIN_MANAGER_3D_H
@@ -222,6 +222,7 @@ BOARD_ADAPTER::BOARD_ADAPTER() :
 BOARD_ADAPTER::~BOARD_ADAPTER()
 {
     destroyLayers();
+    clearLayerCache();
 }
 
 
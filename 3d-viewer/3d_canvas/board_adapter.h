@@ -363,6 +363,27 @@ private:
     bool createBoardPolygon( wxString* aErrorMsg );
     void createLayers( REPORTER* aStatusReporter );
     void destroyLayers();
+    void clearLayerCache();
+
+    /**
+     * Hash the items and settings each layer is built from.
+     */
+    std::array<size_t, PCB_LAYER_ID_COUNT>
+    hashLayers( const std::bitset<LAYER_3D_END>& aVisibilityFlags ) const;
+
+    // Build the 2D objects and contours of a layer.  They may run in parallel for different
+    // layers.  aPoly is null when the contours aren't needed.
+    void buildCopperLayer( PCB_LAYER_ID aLayer, const std::vector<const PCB_TRACK*>& aTrackList,
+                           const std::bitset<LAYER_3D_END>& aVisibilityFlags,
+                           BVH_CONTAINER_2D* aContainer, SHAPE_POLY_SET* aPoly );
+
+    void buildTechLayer( PCB_LAYER_ID aLayer, const std::bitset<LAYER_3D_END>& aVisibilityFlags,
+                         BVH_CONTAINER_2D* aContainer, SHAPE_POLY_SET* aPoly );
+
+    void buildPlatedCopperPolys( PCB_LAYER_ID aLayer, bool aLayerEnabled,
+                                 const std::vector<const PCB_TRACK*>& aTrackList,
+                                 const std::bitset<LAYER_3D_END>& aVisibilityFlags,
+                                 SHAPE_POLY_SET& aPolys );
 
     // Helper functions to create the board
     void createTrackWithMargin( const PCB_TRACK* aTrack, CONTAINER_2D_BASE* aDstContainer,
@@ -475,6 +496,17 @@ private:
 
     SHAPE_POLY_SET    m_board_poly;           ///< Board outline polygon.
 
+    /// The 2D elements and contours of a layer, kept between two builds of the layers.
+    struct LAYER_CACHE_ENTRY
+    {
+        size_t            m_hash = 0;            ///< Of the items and settings of the layer.
+        BVH_CONTAINER_2D* m_container = nullptr;
+        SHAPE_POLY_SET*   m_poly = nullptr;      ///< Null if the contours weren't needed.
+    };
+
+    /// Owns the 2D elements and contours of m_layerMap and m_layers_poly.
+    std::map<PCB_LAYER_ID, LAYER_CACHE_ENTRY> m_layerCache;
+
     MAP_CONTAINER_2D_BASE  m_layerMap;        ///< 2D elements for each layer.
     MAP_CONTAINER_2D_BASE  m_layerHoleMap;    ///< Holes for each layer.
 
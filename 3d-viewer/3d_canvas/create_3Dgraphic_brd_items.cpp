@@ -134,7 +134,7 @@ void BOARD_ADAPTER::addText( const EDA_TEXT* aText, CONTAINER_2D_BASE* aContaine
 
         attrs.m_Angle = aText->GetDrawRotation();
 
-        if( auto* cache = aText->GetRenderCache( font, shownText ) )
+        if( auto cache = aText->GetRenderCache( font, shownText ) )
         {
             callback_gal.DrawGlyphs( *cache );
         }
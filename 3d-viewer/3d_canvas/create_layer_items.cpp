@@ -32,10 +32,13 @@
 #include <lset.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <trigo.h>
+#include <core/kicad_algo.h>
+#include <hash.h>
+#include <hash_eda.h>
+#include <thread_pool.h>
 #include <vector>
-#include <thread>
 #include <algorithm>
-#include <atomic>
+#include <mutex>
 #include <wx/log.h>
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -142,6 +145,181 @@ void transformFPTextToPolySet( const FOOTPRINT* aFootprint, PCB_LAYER_ID aLayer,
 }
 
 
+/**
+ * Hash what the 3D objects and contours of a board item are built from.
+ *
+ * The address of the item is part of it, as the 2D objects keep a reference to their item.
+ */
+static size_t hashLayerItem( const BOARD_ITEM* aItem )
+{
+    const int flags = HASH_POS | HASH_ROT | HASH_LAYER | HASH_REF | HASH_VALUE;
+    size_t    ret = hash_val( aItem, aItem->Type(), aItem->IsKnockout() );
+
+    if( const EDA_TEXT* text = dynamic_cast<const EDA_TEXT*>( aItem ) )
+    {
+        hash_combine( ret, text->GetShownText( true ).ToStdString(), text->IsVisible(),
+                      text->GetTextThickness(), text->GetFont() );
+    }
+
+    if( BaseType( aItem->Type() ) == PCB_DIMENSION_T )
+    {
+        const PCB_DIMENSION_BASE* dimension = static_cast<const PCB_DIMENSION_BASE*>( aItem );
+
+        hash_combine( ret, dimension->GetLineThickness() );
+
+        for( const std::shared_ptr<SHAPE>& shape : dimension->GetShapes() )
+        {
+            BOX2I bbox = shape->BBox();
+            hash_combine( ret, shape->Type(), bbox.GetX(), bbox.GetY(), bbox.GetWidth(),
+                          bbox.GetHeight() );
+        }
+
+        return ret;
+    }
+
+    switch( aItem->Type() )
+    {
+    case PCB_TRACE_T:
+    case PCB_ARC_T:
+    {
+        const PCB_TRACK* track = static_cast<const PCB_TRACK*>( aItem );
+
+        hash_combine( ret, track->GetStart().x, track->GetStart().y, track->GetEnd().x,
+                      track->GetEnd().y, track->GetWidth(), track->GetLayer(),
+                      track->HasSolderMask(), track->GetSolderMaskExpansion() );
+
+        if( aItem->Type() == PCB_ARC_T )
+        {
+            const VECTOR2I& mid = static_cast<const PCB_ARC*>( track )->GetMid();
+            hash_combine( ret, mid.x, mid.y );
+        }
+
+        break;
+    }
+
+    case PCB_VIA_T:
+    {
+        const PCB_VIA* via = static_cast<const PCB_VIA*>( aItem );
+
+        hash_combine( ret, hash_fp_item( via, flags ), via->GetStart().x, via->GetStart().y,
+                      via->GetSolderMaskExpansion(), via->IsTented( F_Mask ),
+                      via->IsTented( B_Mask ) );
+        break;
+    }
+
+    case PCB_PAD_T:
+    {
+        const PAD* pad = static_cast<const PAD*>( aItem );
+
+        hash_combine( ret, hash_fp_item( pad, flags ), pad->GetSolderMaskExpansion( F_Mask ),
+                      pad->GetSolderMaskExpansion( B_Mask ), pad->GetSolderPasteMargin( F_Paste ).x,
+                      pad->GetSolderPasteMargin( F_Paste ).y, pad->GetSolderPasteMargin( B_Paste ).x,
+                      pad->GetSolderPasteMargin( B_Paste ).y );
+        break;
+    }
+
+    case PCB_FIELD_T:
+    case PCB_TEXT_T:
+    case PCB_TEXTBOX_T:
+    case PCB_TABLECELL_T:
+    case PCB_SHAPE_T:
+        hash_combine( ret, hash_fp_item( aItem, flags ) );
+        break;
+
+    case PCB_TABLE_T:
+        hash_combine( ret, hash_fp_item( aItem, flags ) );
+
+        for( PCB_TABLECELL* cell : static_cast<const PCB_TABLE*>( aItem )->GetCells() )
+            hash_combine( ret, hashLayerItem( cell ) );
+
+        break;
+
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+
+std::array<size_t, PCB_LAYER_ID_COUNT>
+BOARD_ADAPTER::hashLayers( const std::bitset<LAYER_3D_END>& aVisibilityFlags ) const
+{
+    EDA_3D_VIEWER_SETTINGS::RENDER_SETTINGS& cfg = m_Cfg->m_Render;
+    const BOARD_DESIGN_SETTINGS&             bds = m_board->GetDesignSettings();
+
+    // What every layer depends on
+    size_t common = hash_val( m_board, m_biuTo3Dunits, m_copperLayersCount, bds.m_MaxError,
+                              bds.m_SolderMaskExpansion, bds.m_LineThickness[ LAYER_CLASS_SILK ],
+                              cfg.engine, cfg.opengl_copper_thickness,
+                              cfg.DifferentiatePlatedCopper(), cfg.show_zones,
+                              aVisibilityFlags.test( LAYER_FP_TEXT ),
+                              aVisibilityFlags.test( LAYER_FP_REFERENCES ),
+                              aVisibilityFlags.test( LAYER_FP_VALUES ) );
+
+    std::array<size_t, PCB_LAYER_ID_COUNT> hashes;
+    hashes.fill( common );
+
+    auto addItem =
+            [&]( const BOARD_ITEM* aItem, const LSET& aLayers )
+            {
+                size_t itemHash = hashLayerItem( aItem );
+
+                aLayers.RunOnLayers(
+                        [&]( PCB_LAYER_ID layer )
+                        {
+                            hash_combine( hashes[layer], itemHash );
+                        } );
+            };
+
+    // The contours of the mask layers are built from all the tracks with a solder mask
+    for( PCB_TRACK* track : m_board->Tracks() )
+        addItem( track, track->GetLayerSet() | LSET( { F_Mask, B_Mask } ) );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+            addItem( pad, pad->GetLayerSet() );
+
+        for( BOARD_ITEM* item : footprint->GraphicalItems() )
+            addItem( item, item->GetLayerSet() );
+
+        for( PCB_FIELD* field : footprint->GetFields() )
+            addItem( field, field->GetLayerSet() );
+    }
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        addItem( item, item->GetLayerSet() );
+
+    for( ZONE* zone : m_board->Zones() )
+    {
+        zone->GetLayerSet().RunOnLayers(
+                [&]( PCB_LAYER_ID layer )
+                {
+                    hash_combine( hashes[layer], zone );
+
+                    if( zone->HasFilledPolysForLayer( layer ) )
+                    {
+                        HASH_128 fillHash = zone->GetFilledPolysList( layer )->GetHash();
+                        hash_combine( hashes[layer], fillHash.Value64[0], fillHash.Value64[1] );
+                    }
+                } );
+    }
+
+    for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        hash_combine( hashes[layer], Is3dLayerEnabled( ToLAYER_ID( layer ), aVisibilityFlags ) );
+
+    // The plated copper is trimmed to the solder mask and removed from the outer copper layers
+    if( cfg.DifferentiatePlatedCopper() )
+    {
+        hash_combine( hashes[F_Cu], hashes[F_Mask] );
+        hash_combine( hashes[B_Cu], hashes[B_Mask] );
+    }
+
+    return hashes;
+}
+
+
 void BOARD_ADAPTER::destroyLayers()
 {
 #define DELETE_AND_FREE( ptr ) \
@@ -158,7 +336,8 @@ void BOARD_ADAPTER::destroyLayers()
         map.clear();                       \
     }
 
-    DELETE_AND_FREE_MAP( m_layers_poly );
+    // Owned by m_layerCache
+    m_layers_poly.clear();
 
     DELETE_AND_FREE( m_frontPlatedCopperPolys )
     DELETE_AND_FREE( m_backPlatedCopperPolys )
@@ -171,7 +350,7 @@ void BOARD_ADAPTER::destroyLayers()
     m_viaTH_ODPolys.RemoveAllContours();
     m_viaAnnuliPolys.RemoveAllContours();
 
-    DELETE_AND_FREE_MAP( m_layerMap )
+    m_layerMap.clear();
     DELETE_AND_FREE_MAP( m_layerHoleMap )
 
     DELETE_AND_FREE( m_platedPadsFront )
@@ -186,453 +365,262 @@ void BOARD_ADAPTER::destroyLayers()
 }
 
 
-void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
+void BOARD_ADAPTER::clearLayerCache()
 {
-    destroyLayers();
-
-    // Build Copper layers
-    // Based on:
-    //    https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L692
-
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    int64_t stats_startCopperLayersTime = GetRunningMicroSecs();
-
-    int64_t start_Time = stats_startCopperLayersTime;
-#endif
-
-    EDA_3D_VIEWER_SETTINGS::RENDER_SETTINGS& cfg = m_Cfg->m_Render;
-
-    std::bitset<LAYER_3D_END> visibilityFlags = GetVisibleLayers();
-
-    m_trackCount               = 0;
-    m_averageTrackWidth        = 0;
-    m_viaCount                 = 0;
-    m_averageViaHoleDiameter   = 0;
-    m_holeCount                = 0;
-    m_averageHoleDiameter      = 0;
-
-    if( !m_board )
-        return;
-
-    // Prepare track list, convert in a vector. Calc statistic for the holes
-    std::vector<const PCB_TRACK*> trackList;
-    trackList.clear();
-    trackList.reserve( m_board->Tracks().size() );
-
-    for( PCB_TRACK* track : m_board->Tracks() )
+    for( auto& [ layer, entry ] : m_layerCache )
     {
-         // Skip tracks (not vias theyt are on more than one layer ) on disabled layers
-        if( track->Type() != PCB_VIA_T && !Is3dLayerEnabled( track->GetLayer(), visibilityFlags ) )
-        {
-            continue;
-        }
-
-        // Note: a PCB_TRACK holds normal segment tracks and also vias circles (that have also
-        // drill values)
-        trackList.push_back( track );
-
-        if( track->Type() == PCB_VIA_T )
-        {
-            const PCB_VIA *via = static_cast< const PCB_VIA*>( track );
-            m_viaCount++;
-            m_averageViaHoleDiameter += static_cast<float>( via->GetDrillValue() * m_biuTo3Dunits );
-        }
-        else
-        {
-            m_trackCount++;
-            m_averageTrackWidth += static_cast<float>( track->GetWidth() * m_biuTo3Dunits );
-        }
+        delete entry.m_container;
+        delete entry.m_poly;
     }
 
-    if( m_trackCount )
-        m_averageTrackWidth /= (float)m_trackCount;
-
-    if( m_viaCount )
-        m_averageViaHoleDiameter /= (float)m_viaCount;
+    m_layerCache.clear();
+}
 
-    // Prepare copper layers index and containers
-    std::vector<PCB_LAYER_ID> layer_ids;
-    layer_ids.clear();
-    layer_ids.reserve( m_copperLayersCount );
 
-    for( PCB_LAYER_ID layer : LAYER_RANGE( F_Cu,B_Cu, m_copperLayersCount) )
+void BOARD_ADAPTER::buildCopperLayer( PCB_LAYER_ID aLayer,
+                                      const std::vector<const PCB_TRACK*>& aTrackList,
+                                      const std::bitset<LAYER_3D_END>& aVisibilityFlags,
+                                      BVH_CONTAINER_2D* aContainer, SHAPE_POLY_SET* aPoly )
+{
+    // Create tracks as objects and add it to container
+    for( const PCB_TRACK* track : aTrackList )
     {
-        if( !Is3dLayerEnabled( layer, visibilityFlags ) ) // Skip non enabled layers
+        // NOTE: Vias can be on multiple layers
+        if( !track->IsOnLayer( aLayer ) )
             continue;
 
-        layer_ids.push_back( layer );
-
-        BVH_CONTAINER_2D *layerContainer = new BVH_CONTAINER_2D;
-        m_layerMap[layer] = layerContainer;
-
-        if( cfg.opengl_copper_thickness && cfg.engine == RENDER_ENGINE::OPENGL )
-        {
-            SHAPE_POLY_SET* layerPoly = new SHAPE_POLY_SET;
-            m_layers_poly[layer] = layerPoly;
-        }
-    }
-
-    if( cfg.DifferentiatePlatedCopper() )
-    {
-        m_frontPlatedCopperPolys = new SHAPE_POLY_SET;
-        m_backPlatedCopperPolys = new SHAPE_POLY_SET;
+        // Skip vias annulus when not flashed on this layer
+        if( track->Type() == PCB_VIA_T && !static_cast<const PCB_VIA*>( track )->FlashLayer( aLayer ) )
+            continue;
 
-        m_platedPadsFront = new BVH_CONTAINER_2D;
-        m_platedPadsBack = new BVH_CONTAINER_2D;
-    }
+        // Add object item to layer container
+        createTrackWithMargin( track, aContainer, aLayer );
 
-    if( cfg.show_off_board_silk )
-    {
-        m_offboardPadsFront = new BVH_CONTAINER_2D;
-        m_offboardPadsBack = new BVH_CONTAINER_2D;
+        // Add the track/via contour (vertical outlines) if required
+        if( aPoly )
+            track->TransformShapeToPolygon( *aPoly, aLayer, 0, track->GetMaxError(), ERROR_INSIDE );
     }
 
-    if( aStatusReporter )
-        aStatusReporter->Report( _( "Create tracks and vias" ) );
-
-    // Create tracks as objects and add it to container
-    for( PCB_LAYER_ID layer : layer_ids )
+    // Add footprints copper items (pads, shapes and text) to containers
+    for( FOOTPRINT* fp : m_board->Footprints() )
     {
-        wxASSERT( m_layerMap.contains( layer ) );
-
-        BVH_CONTAINER_2D *layerContainer = m_layerMap[layer];
+        addPads( fp, aContainer, aLayer );
+        addFootprintShapes( fp, aContainer, aLayer, aVisibilityFlags );
 
-        for( const PCB_TRACK* track : trackList )
+        // Add copper item to poly contours (vertical outlines) if required
+        if( aPoly )
         {
-            // NOTE: Vias can be on multiple layers
-            if( !track->IsOnLayer( layer ) )
-                continue;
-
-            // Skip vias annulus when not flashed on this layer
-            if( track->Type() == PCB_VIA_T && !static_cast<const PCB_VIA*>( track )->FlashLayer( layer ) )
-                continue;
-
-            // Add object item to layer container
-            createTrackWithMargin( track, layerContainer, layer );
+            fp->TransformPadsToPolySet( *aPoly, aLayer, 0, fp->GetMaxError(), ERROR_INSIDE );
+            transformFPTextToPolySet( fp, aLayer, aVisibilityFlags, *aPoly, fp->GetMaxError(), ERROR_INSIDE );
+            transformFPShapesToPolySet( fp, aLayer, *aPoly, fp->GetMaxError(), ERROR_INSIDE );
         }
     }
 
-    // Create VIAS and THTs objects and add it to holes containers
-    for( PCB_LAYER_ID layer : layer_ids )
+    // Add graphic items on copper layers (texts and other graphics)
+    for( BOARD_ITEM* item : m_board->Drawings() )
     {
-        // ADD TRACKS
-        unsigned int nTracks = trackList.size();
+        if( !item->IsOnLayer( aLayer ) )
+            continue;
 
-        for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
+        switch( item->Type() )
         {
-            const PCB_TRACK *track = trackList[trackIdx];
+        case PCB_SHAPE_T:
+            addShape( static_cast<PCB_SHAPE*>( item ), aContainer, item, aLayer );
+            break;
+
+        case PCB_TEXT_T:
+            addText( static_cast<PCB_TEXT*>( item ), aContainer, item );
+            break;
+
+        case PCB_TEXTBOX_T:
+            addShape( static_cast<PCB_TEXTBOX*>( item ), aContainer, item );
+            break;
+
+        case PCB_TABLE_T:
+            addTable( static_cast<PCB_TABLE*>( item ), aContainer, item );
+            break;
+
+        case PCB_DIM_ALIGNED_T:
+        case PCB_DIM_CENTER_T:
+        case PCB_DIM_RADIAL_T:
+        case PCB_DIM_ORTHOGONAL_T:
+        case PCB_DIM_LEADER_T:
+            addShape( static_cast<PCB_DIMENSION_BASE*>( item ), aContainer, item );
+            break;
+
+        case PCB_REFERENCE_IMAGE_T:     // ignore
+            break;
+
+        default:
+            wxLogTrace( m_logTrace, wxT( "createLayers: item type: %d not implemented" ), item->Type() );
+            break;
+        }
 
-            if( !track->IsOnLayer( layer ) )
-                continue;
+        // Add copper item to poly contours (vertical outlines) if required
+        if( aPoly )
+        {
+            switch( item->Type() )
+            {
+            case PCB_SHAPE_T:
+                item->TransformShapeToPolySet( *aPoly, aLayer, 0, item->GetMaxError(), ERROR_INSIDE );
+                break;
 
-            // ADD VIAS and THT
-            if( track->Type() == PCB_VIA_T )
+            case PCB_TEXT_T:
             {
-                const PCB_VIA* via               = static_cast<const PCB_VIA*>( track );
-                const VIATYPE  viatype           = via->GetViaType();
-                const double   holediameter      = via->GetDrillValue() * BiuTo3dUnits();
-                const double   viasize           = via->GetWidth( layer ) * BiuTo3dUnits();
-                const double   plating           = GetHolePlatingThickness() * BiuTo3dUnits();
+                PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
 
-                // holes and layer copper extend half info cylinder wall to hide transition
-                const float    thickness         = static_cast<float>( plating / 2.0f );
-                const float    hole_inner_radius = static_cast<float>( holediameter / 2.0f );
-                const float    ring_radius       = static_cast<float>( viasize / 2.0f );
+                text->TransformTextToPolySet( *aPoly, 0, text->GetMaxError(), ERROR_INSIDE );
+                break;
+            }
 
-                const SFVEC2F via_center( via->GetStart().x * m_biuTo3Dunits,
-                                          -via->GetStart().y * m_biuTo3Dunits );
+            case PCB_TEXTBOX_T:
+            {
+                PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
 
-                if( viatype != VIATYPE::THROUGH )
+                if( textbox->IsBorderEnabled() )
                 {
-                    // Add hole objects
-                    BVH_CONTAINER_2D *layerHoleContainer = nullptr;
-
-                    // Check if the layer is already created
-                    if( !m_layerHoleMap.contains( layer ) )
-                    {
-                        // not found, create a new container
-                        layerHoleContainer = new BVH_CONTAINER_2D;
-                        m_layerHoleMap[layer] = layerHoleContainer;
-                    }
-                    else
-                    {
-                        // found
-                        layerHoleContainer = m_layerHoleMap[layer];
-                    }
-
-                    // Add a hole for this layer
-                    layerHoleContainer->Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius + thickness,
-                                                                   *track ) );
+                    textbox->PCB_SHAPE::TransformShapeToPolygon( *aPoly, aLayer, 0, textbox->GetMaxError(),
+                                                                 ERROR_INSIDE );
                 }
-                else if( layer == layer_ids[0] ) // it only adds once the THT holes
-                {
-                    // Add through hole object
-                    m_TH_ODs.Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius + thickness, *track ) );
-                    m_viaTH_ODs.Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius + thickness, *track ) );
-
-                    if( cfg.clip_silk_on_via_annuli && ring_radius > 0.0 )
-                        m_viaAnnuli.Add( new FILLED_CIRCLE_2D( via_center, ring_radius, *track ) );
 
-                    if( hole_inner_radius > 0.0 )
-                        m_TH_IDs.Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius, *track ) );
-                }
+                textbox->TransformTextToPolySet( *aPoly, 0, textbox->GetMaxError(), ERROR_INSIDE );
+                break;
             }
 
-            if( cfg.DifferentiatePlatedCopper() && layer == F_Cu )
-            {
-                track->TransformShapeToPolygon( *m_frontPlatedCopperPolys, F_Cu, 0, track->GetMaxError(),
-                                                ERROR_INSIDE );
-            }
-            else if( cfg.DifferentiatePlatedCopper() && layer == B_Cu )
+            case PCB_TABLE_T:
             {
-                track->TransformShapeToPolygon( *m_backPlatedCopperPolys, B_Cu, 0, track->GetMaxError(),
-                                                ERROR_INSIDE );
-            }
-        }
-    }
-
-    // Create VIAS and THTs objects and add it to holes containers
-    for( PCB_LAYER_ID layer : layer_ids )
-    {
-        // ADD TRACKS
-        const unsigned int nTracks = trackList.size();
+                PCB_TABLE* table = static_cast<PCB_TABLE*>( item );
 
-        for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
-        {
-            const PCB_TRACK *track = trackList[trackIdx];
+                for( PCB_TABLECELL* cell : table->GetCells() )
+                    cell->TransformTextToPolySet( *aPoly, 0, cell->GetMaxError(), ERROR_INSIDE );
 
-            if( !track->IsOnLayer( layer ) )
-                continue;
+                table->DrawBorders(
+                        [&]( const VECTOR2I& ptA, const VECTOR2I& ptB,
+                             const STROKE_PARAMS& stroke )
+                        {
+                            SHAPE_SEGMENT seg( ptA, ptB, stroke.GetWidth()  );
+                            seg.TransformToPolygon( *aPoly, table->GetMaxError(), ERROR_INSIDE );
+                        } );
+                break;
+            }
 
-            // ADD VIAS and THT
-            if( track->Type() == PCB_VIA_T )
+            case PCB_DIM_ALIGNED_T:
+            case PCB_DIM_CENTER_T:
+            case PCB_DIM_RADIAL_T:
+            case PCB_DIM_ORTHOGONAL_T:
+            case PCB_DIM_LEADER_T:
             {
-                const PCB_VIA* via = static_cast<const PCB_VIA*>( track );
-                const VIATYPE  viatype = via->GetViaType();
-
-                if( viatype != VIATYPE::THROUGH )
-                {
-                    // Add PCB_VIA hole contours
-
-                    // Add outer holes of VIAs
-                    SHAPE_POLY_SET *layerOuterHolesPoly = nullptr;
-                    SHAPE_POLY_SET *layerInnerHolesPoly = nullptr;
-
-                    // Check if the layer is already created
-                    if( !m_layerHoleOdPolys.contains( layer ) )
-                    {
-                        // not found, create a new container
-                        layerOuterHolesPoly = new SHAPE_POLY_SET;
-                        m_layerHoleOdPolys[layer] = layerOuterHolesPoly;
-
-                        wxASSERT( !m_layerHoleIdPolys.contains( layer ) );
-
-                        layerInnerHolesPoly = new SHAPE_POLY_SET;
-                        m_layerHoleIdPolys[layer] = layerInnerHolesPoly;
-                    }
-                    else
-                    {
-                        // found
-                        layerOuterHolesPoly = m_layerHoleOdPolys[layer];
-
-                        wxASSERT( m_layerHoleIdPolys.contains( layer ) );
-
-                        layerInnerHolesPoly = m_layerHoleIdPolys[layer];
-                    }
-
-                    const int holediameter = via->GetDrillValue();
-                    const int hole_outer_radius = (holediameter / 2) + GetHolePlatingThickness();
+                PCB_DIMENSION_BASE* dimension = static_cast<PCB_DIMENSION_BASE*>( item );
 
-                    TransformCircleToPolygon( *layerOuterHolesPoly, via->GetStart(), hole_outer_radius,
-                                              via->GetMaxError(), ERROR_INSIDE );
+                dimension->TransformTextToPolySet( *aPoly, 0, dimension->GetMaxError(), ERROR_INSIDE );
 
-                    TransformCircleToPolygon( *layerInnerHolesPoly, via->GetStart(), holediameter / 2,
-                                              via->GetMaxError(), ERROR_INSIDE );
-                }
-                else if( layer == layer_ids[0] ) // it only adds once the THT holes
-                {
-                    const int holediameter = via->GetDrillValue();
-                    const int hole_outer_radius = (holediameter / 2) + GetHolePlatingThickness();
-                    const int hole_outer_ring_radius = KiROUND( via->GetWidth( layer ) / 2.0 );
+                for( const std::shared_ptr<SHAPE>& shape : dimension->GetShapes() )
+                    shape->TransformToPolygon( *aPoly, dimension->GetMaxError(), ERROR_INSIDE );
 
-                    // Add through hole contours
-                    TransformCircleToPolygon( m_TH_ODPolys, via->GetStart(), hole_outer_radius,
-                                              via->GetMaxError(), ERROR_INSIDE );
+                break;
+            }
 
-                    // Add same thing for vias only
-                    TransformCircleToPolygon( m_viaTH_ODPolys, via->GetStart(), hole_outer_radius,
-                                              via->GetMaxError(), ERROR_INSIDE );
+            case PCB_REFERENCE_IMAGE_T:     // ignore
+                break;
 
-                    if( cfg.clip_silk_on_via_annuli )
-                    {
-                        TransformCircleToPolygon( m_viaAnnuliPolys, via->GetStart(), hole_outer_ring_radius,
-                                                  via->GetMaxError(), ERROR_INSIDE );
-                    }
-                }
+            default:
+                wxLogTrace( m_logTrace, wxT( "createLayers: item type: %d not implemented" ), item->Type() );
+                break;
             }
         }
     }
+}
+
 
-    // Creates vertical outline contours of the tracks and add it to the poly of the layer
-    if( cfg.opengl_copper_thickness && cfg.engine == RENDER_ENGINE::OPENGL )
+void BOARD_ADAPTER::buildPlatedCopperPolys( PCB_LAYER_ID aLayer, bool aLayerEnabled,
+                                            const std::vector<const PCB_TRACK*>& aTrackList,
+                                            const std::bitset<LAYER_3D_END>& aVisibilityFlags,
+                                            SHAPE_POLY_SET& aPolys )
+{
+    if( aLayerEnabled )
     {
-        for( PCB_LAYER_ID layer : layer_ids )
+        for( const PCB_TRACK* track : aTrackList )
         {
-            wxASSERT( m_layers_poly.contains( layer ) );
-
-            SHAPE_POLY_SET *layerPoly = m_layers_poly[layer];
-
-            // ADD TRACKS
-            unsigned int nTracks = trackList.size();
-
-            for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
-            {
-                const PCB_TRACK *track = trackList[trackIdx];
-
-                if( !track->IsOnLayer( layer ) )
-                    continue;
-
-                // Skip vias annulus when not flashed on this layer
-                if( track->Type() == PCB_VIA_T && !static_cast<const PCB_VIA*>( track )->FlashLayer( layer ) )
-                    continue;
-
-                // Add the track/via contour
-                track->TransformShapeToPolygon( *layerPoly, layer, 0, track->GetMaxError(), ERROR_INSIDE );
-            }
+            if( track->IsOnLayer( aLayer ) )
+                track->TransformShapeToPolygon( aPolys, aLayer, 0, track->GetMaxError(), ERROR_INSIDE );
         }
-    }
 
-    // Add holes of footprints
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-    {
-        for( PAD* pad : footprint->Pads() )
+        for( FOOTPRINT* fp : m_board->Footprints() )
         {
-            // Note: holes of NPTH are already built by GetBoardPolygonOutlines
-            if( !pad->HasHole() )
-                continue;
-
-            m_holeCount++;
-            double holeDiameter = ( pad->GetDrillSize().x + pad->GetDrillSize().y ) / 2.0;
-            m_averageHoleDiameter += static_cast<float>( holeDiameter * m_biuTo3Dunits );
-
-            if( pad->GetAttribute() == PAD_ATTRIB::NPTH )
-            {
-                // Ensure the silk drawings are clipped to the NPTH hole, like other pad/via holes
-                // even if the clip to board body is not activated (remember NPTH holes are part of
-                // the board body)
-                createPadHoleShape( pad, &m_TH_ODs, 0 );
-                continue;
-            }
-
-            // The hole in the body is inflated by copper thickness
-            int inflate = KiROUND( GetHolePlatingThickness() / 2.0 );
-
-            createPadHoleShape( pad, &m_TH_ODs, inflate );
-
-            if( cfg.clip_silk_on_via_annuli )
-                createPadHoleShape( pad, &m_viaAnnuli, inflate );
-
-            createPadHoleShape( pad, &m_TH_IDs, 0 );
+            fp->TransformPadsToPolySet( aPolys, aLayer, 0, fp->GetMaxError(), ERROR_INSIDE );
+            transformFPTextToPolySet( fp, aLayer, aVisibilityFlags, aPolys, fp->GetMaxError(), ERROR_INSIDE );
+            transformFPShapesToPolySet( fp, aLayer, aPolys, fp->GetMaxError(), ERROR_INSIDE );
         }
-    }
-
-    if( m_holeCount )
-        m_averageHoleDiameter /= (float)m_holeCount;
 
-    // Add contours of the pad holes (pads can be Circle or Segment holes)
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-    {
-        for( PAD* pad : footprint->Pads() )
+        for( BOARD_ITEM* item : m_board->Drawings() )
         {
-            if( !pad->HasHole() )
+            if( !item->IsOnLayer( aLayer ) )
                 continue;
 
-            // The hole in the body is inflated by copper thickness.
-            const int inflate = GetHolePlatingThickness();
-
-            if( pad->GetAttribute() != PAD_ATTRIB::NPTH )
+            // Note: for TEXT and TEXTBOX, TransformShapeToPolygon returns the bounding
+            // box shape, not the exact text shape. So it is not used for these items
+            if( item->Type() == PCB_TEXTBOX_T )
             {
-                if( cfg.clip_silk_on_via_annuli )
-                    pad->TransformHoleToPolygon( m_viaAnnuliPolys, inflate, pad->GetMaxError(), ERROR_INSIDE );
+                PCB_TEXTBOX* text_box = static_cast<PCB_TEXTBOX*>( item );
+                text_box->TransformTextToPolySet( aPolys, 0, text_box->GetMaxError(), ERROR_INSIDE );
 
-                pad->TransformHoleToPolygon( m_TH_ODPolys, inflate, pad->GetMaxError(), ERROR_INSIDE );
+                // Add box outlines
+                text_box->PCB_SHAPE::TransformShapeToPolygon( aPolys, aLayer, 0, text_box->GetMaxError(),
+                                                              ERROR_INSIDE );
             }
-            else
+            else if( item->Type() == PCB_TEXT_T )
             {
-                // If not plated, no copper.
-                if( cfg.clip_silk_on_via_annuli )
-                    pad->TransformHoleToPolygon( m_viaAnnuliPolys, 0, pad->GetMaxError(), ERROR_INSIDE );
-
-                pad->TransformHoleToPolygon( m_NPTH_ODPolys, 0, pad->GetMaxError(), ERROR_INSIDE );
+                PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
+                text->TransformTextToPolySet( aPolys, 0, text->GetMaxError(), ERROR_INSIDE );
+            }
+            else if( item->Type() != PCB_REFERENCE_IMAGE_T )
+            {
+                item->TransformShapeToPolySet( aPolys, aLayer, 0, item->GetMaxError(), ERROR_INSIDE );
             }
         }
     }
 
-    // Add footprints copper items (pads, shapes and text) to containers
-    for( PCB_LAYER_ID layer : layer_ids )
+    if( m_Cfg->m_Render.show_zones )
     {
-        wxASSERT( m_layerMap.contains( layer ) );
-
-        BVH_CONTAINER_2D *layerContainer = m_layerMap[layer];
-
-        for( FOOTPRINT* fp : m_board->Footprints() )
-        {
-            addPads( fp, layerContainer, layer );
-            addFootprintShapes( fp, layerContainer, layer, visibilityFlags );
-
-            // Add copper item to the plated copper polygon list if required
-            if( cfg.DifferentiatePlatedCopper() && IsExternalCopperLayer( layer ) )
-            {
-                SHAPE_POLY_SET* layerPoly = layer == F_Cu ? m_frontPlatedCopperPolys : m_backPlatedCopperPolys;
-
-                fp->TransformPadsToPolySet( *layerPoly, layer, 0, fp->GetMaxError(), ERROR_INSIDE );
-                transformFPTextToPolySet( fp, layer, visibilityFlags, *layerPoly, fp->GetMaxError(), ERROR_INSIDE );
-                transformFPShapesToPolySet( fp, layer, *layerPoly, fp->GetMaxError(), ERROR_INSIDE );
-            }
-
-            // Add copper item to poly contours (vertical outlines) if required
-            if( cfg.opengl_copper_thickness && cfg.engine == RENDER_ENGINE::OPENGL )
-            {
-                wxASSERT( m_layers_poly.contains( layer ) );
-
-                SHAPE_POLY_SET* layerPoly = m_layers_poly[layer];
-
-                fp->TransformPadsToPolySet( *layerPoly, layer, 0, fp->GetMaxError(), ERROR_INSIDE );
-                transformFPTextToPolySet( fp, layer, visibilityFlags, *layerPoly, fp->GetMaxError(), ERROR_INSIDE );
-                transformFPShapesToPolySet( fp, layer, *layerPoly, fp->GetMaxError(), ERROR_INSIDE );
-            }
+        for( ZONE* zone : m_board->Zones() )
+        {
+            if( zone->IsOnLayer( aLayer ) )
+                zone->TransformShapeToPolygon( aPolys, aLayer, 0, zone->GetMaxError(), ERROR_INSIDE );
         }
     }
+}
 
-    // Add graphic item on copper layers to object containers
-    for( PCB_LAYER_ID layer : layer_ids )
-    {
-        wxASSERT( m_layerMap.contains( layer ) );
 
-        BVH_CONTAINER_2D *layerContainer = m_layerMap[layer];
+void BOARD_ADAPTER::buildTechLayer( PCB_LAYER_ID aLayer,
+                                    const std::bitset<LAYER_3D_END>& aVisibilityFlags,
+                                    BVH_CONTAINER_2D* aContainer, SHAPE_POLY_SET* aPoly )
+{
+    EDA_3D_VIEWER_SETTINGS::RENDER_SETTINGS& cfg = m_Cfg->m_Render;
 
-        // Add graphic items on copper layers (texts and other graphics)
+    if( Is3dLayerEnabled( aLayer, aVisibilityFlags ) )
+    {
+        // Add drawing objects
         for( BOARD_ITEM* item : m_board->Drawings() )
         {
-            if( !item->IsOnLayer( layer ) )
+            if( !item->IsOnLayer( aLayer ) )
                 continue;
 
             switch( item->Type() )
             {
             case PCB_SHAPE_T:
-                addShape( static_cast<PCB_SHAPE*>( item ), layerContainer, item, layer );
+                addShape( static_cast<PCB_SHAPE*>( item ), aContainer, item, aLayer );
                 break;
 
             case PCB_TEXT_T:
-                addText( static_cast<PCB_TEXT*>( item ), layerContainer, item );
+                addText( static_cast<PCB_TEXT*>( item ), aContainer, item );
                 break;
 
             case PCB_TEXTBOX_T:
-                addShape( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
+                addShape( static_cast<PCB_TEXTBOX*>( item ), aContainer, item );
                 break;
 
             case PCB_TABLE_T:
-                addTable( static_cast<PCB_TABLE*>( item ), layerContainer, item );
+                addTable( static_cast<PCB_TABLE*>( item ), aContainer, item );
                 break;
 
             case PCB_DIM_ALIGNED_T:
@@ -640,210 +628,285 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
             case PCB_DIM_RADIAL_T:
             case PCB_DIM_ORTHOGONAL_T:
             case PCB_DIM_LEADER_T:
-                addShape( static_cast<PCB_DIMENSION_BASE*>( item ), layerContainer, item );
-                break;
-
-            case PCB_REFERENCE_IMAGE_T:     // ignore
+                addShape( static_cast<PCB_DIMENSION_BASE*>( item ), aContainer, item );
                 break;
 
             default:
-                wxLogTrace( m_logTrace, wxT( "createLayers: item type: %d not implemented" ), item->Type() );
                 break;
             }
+        }
 
-            // Add copper item to the plated copper polygon list if required
-            if( cfg.DifferentiatePlatedCopper() && IsExternalCopperLayer( layer ) )
+        // Add track, via and arc tech layers
+        if( IsSolderMaskLayer( aLayer ) )
+        {
+            for( PCB_TRACK* track : m_board->Tracks() )
             {
-                SHAPE_POLY_SET* copperPolys = layer == F_Cu ? m_frontPlatedCopperPolys : m_backPlatedCopperPolys;
+                if( !track->IsOnLayer( aLayer ) )
+                    continue;
 
-                // Note: for TEXT and TEXTBOX, TransformShapeToPolygon returns the bounding
-                // box shape, not the exact text shape. So it is not used for these items
-                if( item->Type() == PCB_TEXTBOX_T )
-                {
-                    PCB_TEXTBOX* text_box = static_cast<PCB_TEXTBOX*>( item );
-                    text_box->TransformTextToPolySet( *copperPolys, 0, text_box->GetMaxError(), ERROR_INSIDE );
+                // Only vias on a external copper layer can have a solder mask
+                PCB_LAYER_ID copper_layer = ( aLayer == F_Mask ) ? F_Cu : B_Cu;
 
-                    // Add box outlines
-                    text_box->PCB_SHAPE::TransformShapeToPolygon( *copperPolys, layer, 0, text_box->GetMaxError(),
-                                                                  ERROR_INSIDE );
-                }
-                else if( item->Type() == PCB_TEXT_T )
+                if( track->Type() == PCB_VIA_T )
                 {
-                    PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
-                    text->TransformTextToPolySet( *copperPolys, 0, text->GetMaxError(), ERROR_INSIDE );
-                }
-                else if( item->Type() != PCB_REFERENCE_IMAGE_T )
-                {
-                    item->TransformShapeToPolySet( *copperPolys, layer, 0, item->GetMaxError(), ERROR_INSIDE );
+                    const PCB_VIA* via = static_cast<const PCB_VIA*>( track );
+
+                    if( !via->FlashLayer( copper_layer ) )
+                        continue;
                 }
+
+                int maskExpansion = track->GetSolderMaskExpansion();
+                createTrackWithMargin( track, aContainer, aLayer, maskExpansion );
             }
+        }
 
-            // Add copper item to poly contours (vertical outlines) if required
-            if( cfg.opengl_copper_thickness && cfg.engine == RENDER_ENGINE::OPENGL )
+        // Add footprints tech layers - objects
+        for( FOOTPRINT* footprint : m_board->Footprints() )
+        {
+            if( aLayer == F_SilkS || aLayer == B_SilkS )
             {
-                wxASSERT( m_layers_poly.contains( layer ) );
+                int linewidth = m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
 
-                SHAPE_POLY_SET *layerPoly = m_layers_poly[layer];
-
-                switch( item->Type() )
-                {
-                case PCB_SHAPE_T:
-                    item->TransformShapeToPolySet( *layerPoly, layer, 0, item->GetMaxError(), ERROR_INSIDE );
-                    break;
-
-                case PCB_TEXT_T:
+                for( PAD* pad : footprint->Pads() )
                 {
-                    PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
+                    if( !pad->IsOnLayer( aLayer ) )
+                        continue;
 
-                    text->TransformTextToPolySet( *layerPoly, 0, text->GetMaxError(), ERROR_INSIDE );
-                    break;
+                    buildPadOutlineAsSegments( pad, aLayer, aContainer, linewidth );
                 }
+            }
+            else
+            {
+                addPads( footprint, aContainer, aLayer );
+            }
 
-                case PCB_TEXTBOX_T:
-                {
-                    PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
+            addFootprintShapes( footprint, aContainer, aLayer, aVisibilityFlags );
+        }
 
-                    if( textbox->IsBorderEnabled() )
-                    {
-                        textbox->PCB_SHAPE::TransformShapeToPolygon( *layerPoly, layer, 0, textbox->GetMaxError(),
-                                                                     ERROR_INSIDE );
-                    }
+        // Draw non copper zones
+        if( cfg.show_zones )
+        {
+            for( ZONE* zone : m_board->Zones() )
+            {
+                if( zone->IsOnLayer( aLayer ) )
+                    addSolidAreasShapes( zone, aContainer, aLayer );
+            }
+        }
+    }
 
-                    textbox->TransformTextToPolySet( *layerPoly, 0, textbox->GetMaxError(), ERROR_INSIDE );
-                    break;
-                }
+    // Add item contours.  We need these if we're building vertical walls or if this is a
+    // mask layer and we're differentiating copper from plated copper.
+    if( ( cfg.engine == RENDER_ENGINE::OPENGL && cfg.opengl_copper_thickness )
+            || ( cfg.DifferentiatePlatedCopper() && ( aLayer == F_Mask || aLayer == B_Mask ) ) )
+    {
+        // DRAWINGS
+        for( BOARD_ITEM* item : m_board->Drawings() )
+        {
+            if( !item->IsOnLayer( aLayer ) )
+                continue;
 
-                case PCB_TABLE_T:
-                {
-                    PCB_TABLE* table = static_cast<PCB_TABLE*>( item );
+            switch( item->Type() )
+            {
+            case PCB_SHAPE_T:
+                item->TransformShapeToPolySet( *aPoly, aLayer, 0, item->GetMaxError(), ERROR_INSIDE );
+                break;
 
-                    for( PCB_TABLECELL* cell : table->GetCells() )
-                        cell->TransformTextToPolySet( *layerPoly, 0, cell->GetMaxError(), ERROR_INSIDE );
+            case PCB_TEXT_T:
+            {
+                PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
 
-                    table->DrawBorders(
-                            [&]( const VECTOR2I& ptA, const VECTOR2I& ptB,
-                                 const STROKE_PARAMS& stroke )
-                            {
-                                SHAPE_SEGMENT seg( ptA, ptB, stroke.GetWidth()  );
-                                seg.TransformToPolygon( *layerPoly, table->GetMaxError(), ERROR_INSIDE );
-                            } );
-                    break;
-                }
+                text->TransformTextToPolySet( *aPoly, 0, text->GetMaxError(), ERROR_INSIDE );
+                break;
+            }
+
+            case PCB_TEXTBOX_T:
+            {
+                PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
 
-                case PCB_DIM_ALIGNED_T:
-                case PCB_DIM_CENTER_T:
-                case PCB_DIM_RADIAL_T:
-                case PCB_DIM_ORTHOGONAL_T:
-                case PCB_DIM_LEADER_T:
+                if( textbox->IsBorderEnabled() )
                 {
-                    PCB_DIMENSION_BASE* dimension = static_cast<PCB_DIMENSION_BASE*>( item );
+                    textbox->PCB_SHAPE::TransformShapeToPolygon( *aPoly, aLayer, 0, textbox->GetMaxError(),
+                                                                 ERROR_INSIDE );
+                }
+
+                textbox->TransformTextToPolySet( *aPoly, 0, textbox->GetMaxError(), ERROR_INSIDE );
+                break;
+            }
 
-                    dimension->TransformTextToPolySet( *layerPoly, 0, dimension->GetMaxError(), ERROR_INSIDE );
+            case PCB_TABLE_T:
+            {
+                PCB_TABLE* table = static_cast<PCB_TABLE*>( item );
 
-                    for( const std::shared_ptr<SHAPE>& shape : dimension->GetShapes() )
-                        shape->TransformToPolygon( *layerPoly, dimension->GetMaxError(), ERROR_INSIDE );
+                for( PCB_TABLECELL* cell : table->GetCells() )
+                    cell->TransformTextToPolySet( *aPoly, 0, cell->GetMaxError(), ERROR_INSIDE );
 
-                    break;
-                }
+                table->DrawBorders(
+                        [&]( const VECTOR2I& ptA, const VECTOR2I& ptB,
+                             const STROKE_PARAMS& stroke )
+                        {
+                            SHAPE_SEGMENT seg( ptA, ptB, stroke.GetWidth()  );
+                            seg.TransformToPolygon( *aPoly, table->GetMaxError(), ERROR_INSIDE );
+                        } );
 
-                case PCB_REFERENCE_IMAGE_T:     // ignore
-                    break;
+                break;
+            }
 
-                default:
-                    wxLogTrace( m_logTrace, wxT( "createLayers: item type: %d not implemented" ), item->Type() );
-                    break;
-                }
+            default:
+                break;
             }
         }
-    }
-
-    if( cfg.show_zones )
-    {
-        if( aStatusReporter )
-            aStatusReporter->Report( _( "Create zones" ) );
 
-        std::vector<std::pair<ZONE*, PCB_LAYER_ID>> zones;
-        std::unordered_map<PCB_LAYER_ID, std::unique_ptr<std::mutex>> layer_lock;
-
-        for( ZONE* zone : m_board->Zones() )
+        // NON-TENTED VIAS
+        if( ( aLayer == F_Mask || aLayer == B_Mask ) )
         {
-            for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
-            {
-                zones.emplace_back( std::make_pair( zone, layer ) );
-                layer_lock.emplace( layer, std::make_unique<std::mutex>() );
+            int maskExpansion = GetBoard()->GetDesignSettings().m_SolderMaskExpansion;
 
-                if( cfg.DifferentiatePlatedCopper() && IsExternalCopperLayer( layer ) )
+            for( PCB_TRACK* track : m_board->Tracks() )
+            {
+                if( track->Type() == PCB_VIA_T )
                 {
-                    SHAPE_POLY_SET* copperPolys = layer == F_Cu ? m_frontPlatedCopperPolys : m_backPlatedCopperPolys;
+                    const PCB_VIA* via = static_cast<const PCB_VIA*>( track );
 
-                    zone->TransformShapeToPolygon( *copperPolys, layer, 0, zone->GetMaxError(), ERROR_INSIDE );
+                    if( via->FlashLayer( aLayer ) && !via->IsTented( aLayer ) )
+                    {
+                        track->TransformShapeToPolygon( *aPoly, aLayer, maskExpansion, track->GetMaxError(),
+                                                        ERROR_INSIDE );
+                    }
+                }
+                else
+                {
+                    if( track->HasSolderMask() )
+                    {
+                        track->TransformShapeToPolySet( *aPoly, aLayer, maskExpansion, track->GetMaxError(),
+                                                        ERROR_INSIDE );
+                    }
                 }
             }
         }
 
-        // Add zones objects
-        std::atomic<size_t> nextZone( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        // FOOTPRINT CHILDREN
+        for( FOOTPRINT* footprint : m_board->Footprints() )
+        {
+            if( aLayer == F_SilkS || aLayer == B_SilkS )
+            {
+                int linewidth = m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
+
+                for( PAD* pad : footprint->Pads() )
+                {
+                    if( pad->IsOnLayer( aLayer ) )
+                    {
+                        buildPadOutlineAsPolygon( pad, aLayer, *aPoly, linewidth, pad->GetMaxError(),
+                                                  ERROR_INSIDE );
+                    }
+                }
+            }
+            else
+            {
+                footprint->TransformPadsToPolySet( *aPoly, aLayer, 0, footprint->GetMaxError(), ERROR_INSIDE );
+            }
 
-        size_t parallelThreadCount = std::min<size_t>( zones.size(),
-                std::max<size_t>( std::thread::hardware_concurrency(), 2 ) );
+            transformFPTextToPolySet( footprint, aLayer, aVisibilityFlags, *aPoly, footprint->GetMaxError(),
+                                      ERROR_INSIDE );
+            transformFPShapesToPolySet( footprint, aLayer, *aPoly, footprint->GetMaxError(), ERROR_INSIDE );
+        }
 
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        if( cfg.show_zones || aLayer == F_Mask || aLayer == B_Mask )
         {
-            std::thread t = std::thread( [&]()
+            for( ZONE* zone : m_board->Zones() )
             {
-                for( size_t areaId = nextZone.fetch_add( 1 );
-                            areaId < zones.size();
-                            areaId = nextZone.fetch_add( 1 ) )
-                {
-                    ZONE* zone = zones[areaId].first;
+                if( zone->IsOnLayer( aLayer ) )
+                    zone->TransformSolidAreasShapesToPolygon( aLayer, *aPoly );
+            }
+        }
 
-                    if( zone == nullptr )
-                        break;
+        // This will make a union of all added contours
+        aPoly->Simplify();
+    }
 
-                    PCB_LAYER_ID layer = zones[areaId].second;
+    // The solder mask is the only tech layer the renderers need a BVH for
+    if( aLayer == F_Mask || aLayer == B_Mask )
+        aContainer->BuildBVH();
+}
 
-                    if( m_layerMap.contains( layer ) )
-                        addSolidAreasShapes( zone, m_layerMap[layer], layer );
 
-                    if( cfg.opengl_copper_thickness && cfg.engine == RENDER_ENGINE::OPENGL
-                            && m_layers_poly.contains( layer ) )
-                    {
-                        auto mut_it = layer_lock.find( layer );
+void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
+{
+    destroyLayers();
 
-                        if( mut_it != layer_lock.end() )
-                        {
-                            std::lock_guard< std::mutex > lock( *( mut_it->second ) );
-                            zone->TransformSolidAreasShapesToPolygon( layer, *m_layers_poly[layer] );
-                        }
-                    }
-                }
+    // Build Copper layers
+    // Based on:
+    //    https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L692
+
+#ifdef PRINT_STATISTICS_3D_VIEWER
+    int64_t stats_startCopperLayersTime = GetRunningMicroSecs();
+
+    int64_t start_Time = stats_startCopperLayersTime;
+#endif
+
+    EDA_3D_VIEWER_SETTINGS::RENDER_SETTINGS& cfg = m_Cfg->m_Render;
 
-                threadsFinished++;
-            } );
+    std::bitset<LAYER_3D_END> visibilityFlags = GetVisibleLayers();
+
+    m_trackCount               = 0;
+    m_averageTrackWidth        = 0;
+    m_viaCount                 = 0;
+    m_averageViaHoleDiameter   = 0;
+    m_holeCount                = 0;
+    m_averageHoleDiameter      = 0;
+
+    if( !m_board )
+        return;
+
+    // Prepare track list, convert in a vector. Calc statistic for the holes
+    std::vector<const PCB_TRACK*> trackList;
+    trackList.clear();
+    trackList.reserve( m_board->Tracks().size() );
 
-            t.detach();
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+         // Skip tracks (not vias theyt are on more than one layer ) on disabled layers
+        if( track->Type() != PCB_VIA_T && !Is3dLayerEnabled( track->GetLayer(), visibilityFlags ) )
+        {
+            continue;
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        // Note: a PCB_TRACK holds normal segment tracks and also vias circles (that have also
+        // drill values)
+        trackList.push_back( track );
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            const PCB_VIA *via = static_cast< const PCB_VIA*>( track );
+            m_viaCount++;
+            m_averageViaHoleDiameter += static_cast<float>( via->GetDrillValue() * m_biuTo3Dunits );
+        }
+        else
+        {
+            m_trackCount++;
+            m_averageTrackWidth += static_cast<float>( track->GetWidth() * m_biuTo3Dunits );
+        }
     }
-    // End Build Copper layers
 
-    // This will make a union of all added contours
-    m_TH_ODPolys.Simplify();
-    m_NPTH_ODPolys.Simplify();
-    m_viaTH_ODPolys.Simplify();
-    m_viaAnnuliPolys.Simplify();
+    if( m_trackCount )
+        m_averageTrackWidth /= (float)m_trackCount;
 
-    // Build Tech layers
-    // Based on:
-    //    https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L1059
-    if( aStatusReporter )
-        aStatusReporter->Report( _( "Build Tech layers" ) );
+    if( m_viaCount )
+        m_averageViaHoleDiameter /= (float)m_viaCount;
+
+    // Prepare copper layers index
+    std::vector<PCB_LAYER_ID> layer_ids;
+    layer_ids.clear();
+    layer_ids.reserve( m_copperLayersCount );
+
+    for( PCB_LAYER_ID layer : LAYER_RANGE( F_Cu,B_Cu, m_copperLayersCount) )
+    {
+        if( !Is3dLayerEnabled( layer, visibilityFlags ) ) // Skip non enabled layers
+            continue;
 
-    // draw graphic items, on technical layers
+        layer_ids.push_back( layer );
+    }
 
+    // Prepare tech layers index
     LSEQ techLayerList = LSET::AllNonCuMask().Seq( {
             B_Adhes,
             F_Adhes,
@@ -914,247 +977,385 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         enabledFlags.set( LAYER_3D_SOLDERMASK_BOTTOM );
     }
 
+    std::vector<PCB_LAYER_ID> tech_ids;
+
     for( PCB_LAYER_ID layer : techLayerList )
     {
-        if( aStatusReporter )
-            aStatusReporter->Report( wxString::Format( _( "Build Tech layer %d" ), (int) layer ) );
+        if( Is3dLayerEnabled( layer, enabledFlags ) )
+            tech_ids.push_back( layer );
+    }
 
-        if( !Is3dLayerEnabled( layer, enabledFlags ) )
-            continue;
+    // Reuse the layers built from the same items and settings as last time.  The others are
+    // rebuilt, and the layers which are not shown anymore are dropped.
+    const bool copperPolys = cfg.opengl_copper_thickness && cfg.engine == RENDER_ENGINE::OPENGL;
 
-        BVH_CONTAINER_2D *layerContainer = new BVH_CONTAINER_2D;
-        m_layerMap[layer] = layerContainer;
+    std::array<size_t, PCB_LAYER_ID_COUNT>        layerHashes = hashLayers( visibilityFlags );
+    std::map<PCB_LAYER_ID, LAYER_CACHE_ENTRY>     layerCache;
+    std::vector<PCB_LAYER_ID>                     dirtyCopperLayers;
+    std::vector<PCB_LAYER_ID>                     dirtyTechLayers;
 
-        SHAPE_POLY_SET *layerPoly = new SHAPE_POLY_SET;
-        m_layers_poly[layer] = layerPoly;
+    auto useLayer =
+            [&]( PCB_LAYER_ID aLayer, bool aHasPoly, std::vector<PCB_LAYER_ID>& aDirtyLayers )
+            {
+                auto it = m_layerCache.find( aLayer );
+
+                if( it != m_layerCache.end() && it->second.m_hash == layerHashes[aLayer] )
+                {
+                    layerCache[aLayer] = it->second;
+                    m_layerCache.erase( it );
+                }
+                else
+                {
+                    LAYER_CACHE_ENTRY& entry = layerCache[aLayer];
+
+                    entry.m_hash = layerHashes[aLayer];
+                    entry.m_container = new BVH_CONTAINER_2D;
+                    entry.m_poly = aHasPoly ? new SHAPE_POLY_SET : nullptr;
+                    aDirtyLayers.push_back( aLayer );
+                }
+
+                m_layerMap[aLayer] = layerCache[aLayer].m_container;
+
+                if( layerCache[aLayer].m_poly )
+                    m_layers_poly[aLayer] = layerCache[aLayer].m_poly;
+            };
+
+    for( PCB_LAYER_ID layer : layer_ids )
+        useLayer( layer, copperPolys, dirtyCopperLayers );
+
+    for( PCB_LAYER_ID layer : tech_ids )
+        useLayer( layer, true, dirtyTechLayers );
+
+    clearLayerCache();
+    m_layerCache = std::move( layerCache );
+
+    wxLogTrace( m_logTrace, wxT( "createLayers: rebuilding %zu of %zu layers" ),
+                dirtyCopperLayers.size() + dirtyTechLayers.size(), m_layerCache.size() );
+
+    if( cfg.DifferentiatePlatedCopper() )
+    {
+        m_frontPlatedCopperPolys = new SHAPE_POLY_SET;
+        m_backPlatedCopperPolys = new SHAPE_POLY_SET;
+
+        m_platedPadsFront = new BVH_CONTAINER_2D;
+        m_platedPadsBack = new BVH_CONTAINER_2D;
+    }
+
+    if( cfg.show_off_board_silk )
+    {
+        m_offboardPadsFront = new BVH_CONTAINER_2D;
+        m_offboardPadsBack = new BVH_CONTAINER_2D;
+    }
+
+    if( aStatusReporter )
+        aStatusReporter->Report( _( "Create tracks and vias" ) );
+
+    // Build the layers on the thread pool, while the holes are built below
+    thread_pool&           tp = GetKiCadThreadPool();
+    BS::multi_future<void> tasks;
+
+    // Copper zones are the slowest to build, so each one is a task of its own.  The contours
+    // of a copper layer are shared by its tasks.
+    std::map<PCB_LAYER_ID, std::mutex> layerLocks;
+
+    for( PCB_LAYER_ID layer : dirtyCopperLayers )
+    {
+        layerLocks.try_emplace( layer );
+
+        tasks.push_back( tp.submit_task(
+                [&, layer]()
+                {
+                    const LAYER_CACHE_ENTRY& entry = m_layerCache.at( layer );
+                    SHAPE_POLY_SET           poly;
+
+                    buildCopperLayer( layer, trackList, visibilityFlags, entry.m_container,
+                                      entry.m_poly ? &poly : nullptr );
 
-        if( Is3dLayerEnabled( layer, visibilityFlags ) )
+                    if( entry.m_poly )
+                    {
+                        std::lock_guard<std::mutex> lock( layerLocks.at( layer ) );
+                        entry.m_poly->Append( poly );
+                    }
+                } ) );
+    }
+
+    if( cfg.show_zones )
+    {
+        for( ZONE* zone : m_board->Zones() )
         {
-            // Add drawing objects
-            for( BOARD_ITEM* item : m_board->Drawings() )
+            for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
             {
-                if( !item->IsOnLayer( layer ) )
+                if( !layerLocks.contains( layer ) )
                     continue;
 
-                switch( item->Type() )
-                {
-                case PCB_SHAPE_T:
-                    addShape( static_cast<PCB_SHAPE*>( item ), layerContainer, item, layer );
-                    break;
-
-                case PCB_TEXT_T:
-                    addText( static_cast<PCB_TEXT*>( item ), layerContainer, item );
-                    break;
-
-                case PCB_TEXTBOX_T:
-                    addShape( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
-                    break;
-
-                case PCB_TABLE_T:
-                    addTable( static_cast<PCB_TABLE*>( item ), layerContainer, item );
-                    break;
-
-                case PCB_DIM_ALIGNED_T:
-                case PCB_DIM_CENTER_T:
-                case PCB_DIM_RADIAL_T:
-                case PCB_DIM_ORTHOGONAL_T:
-                case PCB_DIM_LEADER_T:
-                    addShape( static_cast<PCB_DIMENSION_BASE*>( item ), layerContainer, item );
-                    break;
-
-                default:
-                    break;
-                }
+                tasks.push_back( tp.submit_task(
+                        [&, zone, layer]()
+                        {
+                            const LAYER_CACHE_ENTRY& entry = m_layerCache.at( layer );
+
+                            addSolidAreasShapes( zone, entry.m_container, layer );
+
+                            if( entry.m_poly )
+                            {
+                                std::lock_guard<std::mutex> lock( layerLocks.at( layer ) );
+                                zone->TransformSolidAreasShapesToPolygon( layer, *entry.m_poly );
+                            }
+                        } ) );
             }
+        }
+    }
+
+    for( PCB_LAYER_ID layer : dirtyTechLayers )
+    {
+        tasks.push_back( tp.submit_task(
+                [&, layer]()
+                {
+                    const LAYER_CACHE_ENTRY& entry = m_layerCache.at( layer );
+                    buildTechLayer( layer, visibilityFlags, entry.m_container, entry.m_poly );
+                } ) );
+    }
+
+    if( cfg.DifferentiatePlatedCopper() )
+    {
+        bool frontEnabled = alg::contains( layer_ids, F_Cu );
+        bool backEnabled = alg::contains( layer_ids, B_Cu );
 
-            // Add track, via and arc tech layers
-            if( IsSolderMaskLayer( layer ) )
-            {
-                for( PCB_TRACK* track : m_board->Tracks() )
+        tasks.push_back( tp.submit_task(
+                [&, frontEnabled]()
                 {
-                    if( !track->IsOnLayer( layer ) )
-                        continue;
+                    buildPlatedCopperPolys( F_Cu, frontEnabled, trackList, visibilityFlags,
+                                            *m_frontPlatedCopperPolys );
+                } ) );
 
-                    // Only vias on a external copper layer can have a solder mask
-                    PCB_LAYER_ID copper_layer = ( layer == F_Mask ) ? F_Cu : B_Cu;
+        tasks.push_back( tp.submit_task(
+                [&, backEnabled]()
+                {
+                    buildPlatedCopperPolys( B_Cu, backEnabled, trackList, visibilityFlags,
+                                            *m_backPlatedCopperPolys );
+                } ) );
+    }
 
-                    if( track->Type() == PCB_VIA_T )
-                    {
-                        const PCB_VIA* via = static_cast<const PCB_VIA*>( track );
+    // Create VIAS and THTs objects and add it to holes containers
+    for( PCB_LAYER_ID layer : layer_ids )
+    {
+        // ADD TRACKS
+        unsigned int nTracks = trackList.size();
 
-                        if( !via->FlashLayer( copper_layer ) )
-                            continue;
-                    }
+        for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
+        {
+            const PCB_TRACK *track = trackList[trackIdx];
 
-                    int maskExpansion = track->GetSolderMaskExpansion();
-                    createTrackWithMargin( track, layerContainer, layer, maskExpansion );
-                }
-            }
+            if( !track->IsOnLayer( layer ) )
+                continue;
 
-            // Add footprints tech layers - objects
-            for( FOOTPRINT* footprint : m_board->Footprints() )
+            // ADD VIAS and THT
+            if( track->Type() == PCB_VIA_T )
             {
-                if( layer == F_SilkS || layer == B_SilkS )
+                const PCB_VIA* via               = static_cast<const PCB_VIA*>( track );
+                const VIATYPE  viatype           = via->GetViaType();
+                const double   holediameter      = via->GetDrillValue() * BiuTo3dUnits();
+                const double   viasize           = via->GetWidth( layer ) * BiuTo3dUnits();
+                const double   plating           = GetHolePlatingThickness() * BiuTo3dUnits();
+
+                // holes and layer copper extend half info cylinder wall to hide transition
+                const float    thickness         = static_cast<float>( plating / 2.0f );
+                const float    hole_inner_radius = static_cast<float>( holediameter / 2.0f );
+                const float    ring_radius       = static_cast<float>( viasize / 2.0f );
+
+                const SFVEC2F via_center( via->GetStart().x * m_biuTo3Dunits,
+                                          -via->GetStart().y * m_biuTo3Dunits );
+
+                if( viatype != VIATYPE::THROUGH )
                 {
-                    int linewidth = m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
+                    // Add hole objects
+                    BVH_CONTAINER_2D *layerHoleContainer = nullptr;
 
-                    for( PAD* pad : footprint->Pads() )
+                    // Check if the layer is already created
+                    if( !m_layerHoleMap.contains( layer ) )
                     {
-                        if( !pad->IsOnLayer( layer ) )
-                            continue;
-
-                        buildPadOutlineAsSegments( pad, layer, layerContainer, linewidth );
+                        // not found, create a new container
+                        layerHoleContainer = new BVH_CONTAINER_2D;
+                        m_layerHoleMap[layer] = layerHoleContainer;
+                    }
+                    else
+                    {
+                        // found
+                        layerHoleContainer = m_layerHoleMap[layer];
                     }
+
+                    // Add a hole for this layer
+                    layerHoleContainer->Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius + thickness,
+                                                                   *track ) );
                 }
-                else
+                else if( layer == layer_ids[0] ) // it only adds once the THT holes
                 {
-                    addPads( footprint, layerContainer, layer );
-                }
+                    // Add through hole object
+                    m_TH_ODs.Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius + thickness, *track ) );
+                    m_viaTH_ODs.Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius + thickness, *track ) );
 
-                addFootprintShapes( footprint, layerContainer, layer, visibilityFlags );
-            }
+                    if( cfg.clip_silk_on_via_annuli && ring_radius > 0.0 )
+                        m_viaAnnuli.Add( new FILLED_CIRCLE_2D( via_center, ring_radius, *track ) );
 
-            // Draw non copper zones
-            if( cfg.show_zones )
-            {
-                for( ZONE* zone : m_board->Zones() )
-                {
-                    if( zone->IsOnLayer( layer ) )
-                        addSolidAreasShapes( zone, layerContainer, layer );
+                    if( hole_inner_radius > 0.0 )
+                        m_TH_IDs.Add( new FILLED_CIRCLE_2D( via_center, hole_inner_radius, *track ) );
                 }
             }
         }
+    }
+
+    // Create VIAS and THTs objects and add it to holes containers
+    for( PCB_LAYER_ID layer : layer_ids )
+    {
+        // ADD TRACKS
+        const unsigned int nTracks = trackList.size();
 
-        // Add item contours.  We need these if we're building vertical walls or if this is a
-        // mask layer and we're differentiating copper from plated copper.
-        if( ( cfg.engine == RENDER_ENGINE::OPENGL && cfg.opengl_copper_thickness )
-                || ( cfg.DifferentiatePlatedCopper() && ( layer == F_Mask || layer == B_Mask ) ) )
+        for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
         {
-            // DRAWINGS
-            for( BOARD_ITEM* item : m_board->Drawings() )
+            const PCB_TRACK *track = trackList[trackIdx];
+
+            if( !track->IsOnLayer( layer ) )
+                continue;
+
+            // ADD VIAS and THT
+            if( track->Type() == PCB_VIA_T )
             {
-                if( !item->IsOnLayer( layer ) )
-                    continue;
+                const PCB_VIA* via = static_cast<const PCB_VIA*>( track );
+                const VIATYPE  viatype = via->GetViaType();
 
-                switch( item->Type() )
+                if( viatype != VIATYPE::THROUGH )
                 {
-                case PCB_SHAPE_T:
-                    item->TransformShapeToPolySet( *layerPoly, layer, 0, item->GetMaxError(), ERROR_INSIDE );
-                    break;
+                    // Add PCB_VIA hole contours
 
-                case PCB_TEXT_T:
-                {
-                    PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
+                    // Add outer holes of VIAs
+                    SHAPE_POLY_SET *layerOuterHolesPoly = nullptr;
+                    SHAPE_POLY_SET *layerInnerHolesPoly = nullptr;
 
-                    text->TransformTextToPolySet( *layerPoly, 0, text->GetMaxError(), ERROR_INSIDE );
-                    break;
-                }
+                    // Check if the layer is already created
+                    if( !m_layerHoleOdPolys.contains( layer ) )
+                    {
+                        // not found, create a new container
+                        layerOuterHolesPoly = new SHAPE_POLY_SET;
+                        m_layerHoleOdPolys[layer] = layerOuterHolesPoly;
 
-                case PCB_TEXTBOX_T:
-                {
-                    PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
+                        wxASSERT( !m_layerHoleIdPolys.contains( layer ) );
 
-                    if( textbox->IsBorderEnabled() )
-                    {
-                        textbox->PCB_SHAPE::TransformShapeToPolygon( *layerPoly, layer, 0, textbox->GetMaxError(),
-                                                                     ERROR_INSIDE );
+                        layerInnerHolesPoly = new SHAPE_POLY_SET;
+                        m_layerHoleIdPolys[layer] = layerInnerHolesPoly;
                     }
+                    else
+                    {
+                        // found
+                        layerOuterHolesPoly = m_layerHoleOdPolys[layer];
 
-                    textbox->TransformTextToPolySet( *layerPoly, 0, textbox->GetMaxError(), ERROR_INSIDE );
-                    break;
-                }
-
-                case PCB_TABLE_T:
-                {
-                    PCB_TABLE* table = static_cast<PCB_TABLE*>( item );
+                        wxASSERT( m_layerHoleIdPolys.contains( layer ) );
 
-                    for( PCB_TABLECELL* cell : table->GetCells() )
-                        cell->TransformTextToPolySet( *layerPoly, 0, cell->GetMaxError(), ERROR_INSIDE );
+                        layerInnerHolesPoly = m_layerHoleIdPolys[layer];
+                    }
 
-                    table->DrawBorders(
-                            [&]( const VECTOR2I& ptA, const VECTOR2I& ptB,
-                                 const STROKE_PARAMS& stroke )
-                            {
-                                SHAPE_SEGMENT seg( ptA, ptB, stroke.GetWidth()  );
-                                seg.TransformToPolygon( *layerPoly, table->GetMaxError(), ERROR_INSIDE );
-                            } );
+                    const int holediameter = via->GetDrillValue();
+                    const int hole_outer_radius = (holediameter / 2) + GetHolePlatingThickness();
 
-                    break;
-                }
+                    TransformCircleToPolygon( *layerOuterHolesPoly, via->GetStart(), hole_outer_radius,
+                                              via->GetMaxError(), ERROR_INSIDE );
 
-                default:
-                    break;
+                    TransformCircleToPolygon( *layerInnerHolesPoly, via->GetStart(), holediameter / 2,
+                                              via->GetMaxError(), ERROR_INSIDE );
                 }
-            }
+                else if( layer == layer_ids[0] ) // it only adds once the THT holes
+                {
+                    const int holediameter = via->GetDrillValue();
+                    const int hole_outer_radius = (holediameter / 2) + GetHolePlatingThickness();
+                    const int hole_outer_ring_radius = KiROUND( via->GetWidth( layer ) / 2.0 );
 
-            // NON-TENTED VIAS
-            if( ( layer == F_Mask || layer == B_Mask ) )
-            {
-                int maskExpansion = GetBoard()->GetDesignSettings().m_SolderMaskExpansion;
+                    // Add through hole contours
+                    TransformCircleToPolygon( m_TH_ODPolys, via->GetStart(), hole_outer_radius,
+                                              via->GetMaxError(), ERROR_INSIDE );
 
-                for( PCB_TRACK* track : m_board->Tracks() )
-                {
-                    if( track->Type() == PCB_VIA_T )
-                    {
-                        const PCB_VIA* via = static_cast<const PCB_VIA*>( track );
+                    // Add same thing for vias only
+                    TransformCircleToPolygon( m_viaTH_ODPolys, via->GetStart(), hole_outer_radius,
+                                              via->GetMaxError(), ERROR_INSIDE );
 
-                        if( via->FlashLayer( layer ) && !via->IsTented( layer ) )
-                        {
-                            track->TransformShapeToPolygon( *layerPoly, layer, maskExpansion, track->GetMaxError(),
-                                                            ERROR_INSIDE );
-                        }
-                    }
-                    else
+                    if( cfg.clip_silk_on_via_annuli )
                     {
-                        if( track->HasSolderMask() )
-                        {
-                            track->TransformShapeToPolySet( *layerPoly, layer, maskExpansion, track->GetMaxError(),
-                                                            ERROR_INSIDE );
-                        }
+                        TransformCircleToPolygon( m_viaAnnuliPolys, via->GetStart(), hole_outer_ring_radius,
+                                                  via->GetMaxError(), ERROR_INSIDE );
                     }
                 }
             }
+        }
+    }
 
-            // FOOTPRINT CHILDREN
-            for( FOOTPRINT* footprint : m_board->Footprints() )
-            {
-                if( layer == F_SilkS || layer == B_SilkS )
-                {
-                    int linewidth = m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
+    // Add holes of footprints
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+        {
+            // Note: holes of NPTH are already built by GetBoardPolygonOutlines
+            if( !pad->HasHole() )
+                continue;
 
-                    for( PAD* pad : footprint->Pads() )
-                    {
-                        if( pad->IsOnLayer( layer ) )
-                        {
-                            buildPadOutlineAsPolygon( pad, layer, *layerPoly, linewidth, pad->GetMaxError(),
-                                                      ERROR_INSIDE );
-                        }
-                    }
-                }
-                else
-                {
-                    footprint->TransformPadsToPolySet( *layerPoly, layer, 0, footprint->GetMaxError(), ERROR_INSIDE );
-                }
+            m_holeCount++;
+            double holeDiameter = ( pad->GetDrillSize().x + pad->GetDrillSize().y ) / 2.0;
+            m_averageHoleDiameter += static_cast<float>( holeDiameter * m_biuTo3Dunits );
 
-                transformFPTextToPolySet( footprint, layer, visibilityFlags, *layerPoly, footprint->GetMaxError(),
-                                          ERROR_INSIDE );
-                transformFPShapesToPolySet( footprint, layer, *layerPoly, footprint->GetMaxError(), ERROR_INSIDE );
+            if( pad->GetAttribute() == PAD_ATTRIB::NPTH )
+            {
+                // Ensure the silk drawings are clipped to the NPTH hole, like other pad/via holes
+                // even if the clip to board body is not activated (remember NPTH holes are part of
+                // the board body)
+                createPadHoleShape( pad, &m_TH_ODs, 0 );
+                continue;
             }
 
-            if( cfg.show_zones || layer == F_Mask || layer == B_Mask )
+            // The hole in the body is inflated by copper thickness
+            int inflate = KiROUND( GetHolePlatingThickness() / 2.0 );
+
+            createPadHoleShape( pad, &m_TH_ODs, inflate );
+
+            if( cfg.clip_silk_on_via_annuli )
+                createPadHoleShape( pad, &m_viaAnnuli, inflate );
+
+            createPadHoleShape( pad, &m_TH_IDs, 0 );
+        }
+    }
+
+    if( m_holeCount )
+        m_averageHoleDiameter /= (float)m_holeCount;
+
+    // Add contours of the pad holes (pads can be Circle or Segment holes)
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+        {
+            if( !pad->HasHole() )
+                continue;
+
+            // The hole in the body is inflated by copper thickness.
+            const int inflate = GetHolePlatingThickness();
+
+            if( pad->GetAttribute() != PAD_ATTRIB::NPTH )
             {
-                for( ZONE* zone : m_board->Zones() )
-                {
-                    if( zone->IsOnLayer( layer ) )
-                        zone->TransformSolidAreasShapesToPolygon( layer, *layerPoly );
-                }
+                if( cfg.clip_silk_on_via_annuli )
+                    pad->TransformHoleToPolygon( m_viaAnnuliPolys, inflate, pad->GetMaxError(), ERROR_INSIDE );
+
+                pad->TransformHoleToPolygon( m_TH_ODPolys, inflate, pad->GetMaxError(), ERROR_INSIDE );
             }
+            else
+            {
+                // If not plated, no copper.
+                if( cfg.clip_silk_on_via_annuli )
+                    pad->TransformHoleToPolygon( m_viaAnnuliPolys, 0, pad->GetMaxError(), ERROR_INSIDE );
 
-            // This will make a union of all added contours
-            layerPoly->Simplify();
+                pad->TransformHoleToPolygon( m_NPTH_ODPolys, 0, pad->GetMaxError(), ERROR_INSIDE );
+            }
         }
     }
-    // End Build Tech layers
+
+    // This will make a union of all added contours
+    m_TH_ODPolys.Simplify();
+    m_NPTH_ODPolys.Simplify();
+    m_viaTH_ODPolys.Simplify();
+    m_viaAnnuliPolys.Simplify();
 
     // If we're rendering off-board silk, also render pads of footprints which are entirely
     // outside the board outline.  This makes off-board footprints more visually recognizable.
@@ -1177,100 +1378,70 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         m_offboardPadsBack->BuildBVH();
     }
 
+    if( aStatusReporter )
+        aStatusReporter->Report( _( "Build Tech layers" ) );
+
+    tasks.wait();
+    tasks.clear();
+
     // Simplify layer polygons
 
     if( aStatusReporter )
         aStatusReporter->Report( _( "Simplifying copper layer polygons" ) );
 
-    if( cfg.DifferentiatePlatedCopper() )
-    {
-        if( aStatusReporter )
-            aStatusReporter->Report( _( "Calculating plated copper" ) );
-
-        // TRIM PLATED COPPER TO SOLDERMASK
-        if( m_layers_poly.contains( F_Mask ) )
-            m_frontPlatedCopperPolys->BooleanIntersection( *m_layers_poly.at( F_Mask ) );
+    auto buildPlatedPads =
+            [&]( PCB_LAYER_ID aLayer, PCB_LAYER_ID aMaskLayer, SHAPE_POLY_SET* aPlatedPolys,
+                 BVH_CONTAINER_2D* aPlatedPads )
+            {
+                // TRIM PLATED COPPER TO SOLDERMASK
+                if( m_layers_poly.contains( aMaskLayer ) )
+                    aPlatedPolys->BooleanIntersection( *m_layers_poly.at( aMaskLayer ) );
 
-        if( m_layers_poly.contains( B_Mask ))
-            m_backPlatedCopperPolys->BooleanIntersection( *m_layers_poly.at( B_Mask ) );
+                // Subtract plated copper from unplated copper (already done for a layer
+                // reused from the cache)
+                if( m_layers_poly.contains( aLayer ) && alg::contains( dirtyCopperLayers, aLayer ) )
+                    m_layers_poly.at( aLayer )->BooleanSubtract( *aPlatedPolys );
 
-        // Subtract plated copper from unplated copper
-        if( m_layers_poly.contains( F_Cu ) )
-            m_layers_poly[F_Cu]->BooleanSubtract( *m_frontPlatedCopperPolys );
+                // ADD PLATED COPPER
+                ConvertPolygonToTriangles( *aPlatedPolys, *aPlatedPads, m_biuTo3Dunits,
+                                           *DELETED_BOARD_ITEM::GetInstance() );
 
-        if( m_layers_poly.contains( B_Cu ) )
-            m_layers_poly[B_Cu]->BooleanSubtract( *m_backPlatedCopperPolys );
+                aPlatedPads->BuildBVH();
+            };
 
-        // ADD PLATED COPPER
-        ConvertPolygonToTriangles( *m_frontPlatedCopperPolys, *m_platedPadsFront, m_biuTo3Dunits,
-                                   *DELETED_BOARD_ITEM::GetInstance() );
+    if( cfg.DifferentiatePlatedCopper() )
+    {
+        if( aStatusReporter )
+            aStatusReporter->Report( _( "Calculating plated copper" ) );
 
-        ConvertPolygonToTriangles( *m_backPlatedCopperPolys, *m_platedPadsBack, m_biuTo3Dunits,
-                                   *DELETED_BOARD_ITEM::GetInstance() );
+        tasks.push_back( tp.submit_task(
+                [&]()
+                {
+                    buildPlatedPads( F_Cu, F_Mask, m_frontPlatedCopperPolys, m_platedPadsFront );
+                } ) );
 
-        m_platedPadsFront->BuildBVH();
-        m_platedPadsBack->BuildBVH();
+        tasks.push_back( tp.submit_task(
+                [&]()
+                {
+                    buildPlatedPads( B_Cu, B_Mask, m_backPlatedCopperPolys, m_platedPadsBack );
+                } ) );
     }
 
-    if( cfg.opengl_copper_thickness && cfg.engine == RENDER_ENGINE::OPENGL )
+    if( copperPolys )
     {
-        std::vector<PCB_LAYER_ID> &selected_layer_id = layer_ids;
-        std::vector<PCB_LAYER_ID> layer_id_without_F_and_B;
-
-        if( cfg.DifferentiatePlatedCopper() )
-        {
-            layer_id_without_F_and_B.clear();
-            layer_id_without_F_and_B.reserve( layer_ids.size() );
-
-            for( PCB_LAYER_ID layer: layer_ids )
-            {
-                if( layer != F_Cu && layer != B_Cu )
-                    layer_id_without_F_and_B.push_back( layer );
-            }
-
-            selected_layer_id = layer_id_without_F_and_B;
-        }
-
-        if( selected_layer_id.size() > 0 )
+        for( PCB_LAYER_ID layer : dirtyCopperLayers )
         {
-            if( aStatusReporter )
-            {
-                aStatusReporter->Report( wxString::Format( _( "Simplifying %d copper layers" ),
-                                                           (int) selected_layer_id.size() ) );
-            }
-
-            std::atomic<size_t> nextItem( 0 );
-            std::atomic<size_t> threadsFinished( 0 );
-
-            size_t parallelThreadCount = std::min<size_t>(
-                    std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-                    selected_layer_id.size() );
-
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            {
-                std::thread t = std::thread(
-                        [&nextItem, &threadsFinished, &selected_layer_id, this]()
-                        {
-                            for( size_t i = nextItem.fetch_add( 1 );
-                                        i < selected_layer_id.size();
-                                        i = nextItem.fetch_add( 1 ) )
-                            {
-                                if( m_layers_poly.contains( selected_layer_id[i] ) )
-                                {
-                                    // This will make a union of all added contours
-                                    m_layers_poly[ selected_layer_id[i] ]->ClearArcs();
-                                    m_layers_poly[ selected_layer_id[i] ]->Simplify();
-                                }
-                            }
-
-                            threadsFinished++;
-                        } );
-
-                t.detach();
-            }
+            // The outer layers are simplified by the plated copper subtraction
+            if( cfg.DifferentiatePlatedCopper() && ( layer == F_Cu || layer == B_Cu ) )
+                continue;
 
-            while( threadsFinished < parallelThreadCount )
-                std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            tasks.push_back( tp.submit_task(
+                    [&, layer]()
+                    {
+                        // This will make a union of all added contours
+                        m_layers_poly.at( layer )->ClearArcs();
+                        m_layers_poly.at( layer )->Simplify();
+                    } ) );
         }
     }
 
@@ -1308,11 +1479,5 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
             hole.second->BuildBVH();
     }
 
-    // We only need the Solder mask to initialize the BVH
-    // because..?
-    if( m_layerMap[B_Mask] )
-        m_layerMap[B_Mask]->BuildBVH();
-
-    if( m_layerMap[F_Mask] )
-        m_layerMap[F_Mask]->BuildBVH();
+    tasks.wait();
 }
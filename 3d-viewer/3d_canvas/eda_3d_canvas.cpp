@@ -772,8 +772,13 @@ void EDA_3D_CANVAS::RenderToFrameBuffer( unsigned char* buffer, int width, int h
                 reloadRaytracingForCalculations = true;
             }
 
+            // A single frame is rendered, it must show all the models
+            m_3d_render_opengl->SetLoadModelsInBackground( false );
+
             requested_redraw = m_3d_render->Redraw( false, nullptr, nullptr );
 
+            m_3d_render_opengl->SetLoadModelsInBackground( true );
+
             if( reloadRaytracingForCalculations )
                 m_3d_render_raytracing->Reload( nullptr, nullptr, true );
         }
@@ -33,6 +33,7 @@
 #include "3d_model.h"
 #include "../common_ogl/ogl_utils.h"
 #include "../3d_math.h"
+#include "../../3d_cache/3d_model_lod.h"
 #include <utility>
 #include <wx/debug.h>
 #include <wx/log.h>
@@ -568,6 +569,14 @@ MODEL_3D::~MODEL_3D()
 }
 
 
+const MODEL_3D& MODEL_3D::GetLod( float aScreenSize ) const
+{
+    size_t level = S3D::SelectLod( aScreenSize, m_lods.size() );
+
+    return level == 0 ? *this : *m_lods[level - 1];
+}
+
+
 void MODEL_3D::DrawBbox() const
 {
     if( !glBindBuffer )
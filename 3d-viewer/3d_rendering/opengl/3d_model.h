@@ -26,6 +26,7 @@
 #ifndef _MODEL_3D_H_
 #define _MODEL_3D_H_
 
+#include <memory>
 #include <vector>
 #include <plugins/3dapi/c3dmodel.h>
 #include "../../common_ogl/openGL_includes.h"
@@ -102,6 +103,21 @@ public:
      */
     const BBOX_3D& GetBBox() const { return m_model_bbox; }
 
+    /**
+     * Add a simplified version of the model, see S3D::BuildLods().
+     *
+     * The levels must be added from the most to the least detailed.
+     */
+    void AddLod( std::unique_ptr<MODEL_3D> aLod ) { m_lods.push_back( std::move( aLod ) ); }
+
+    /**
+     * Get the version of the model to draw at a given size.
+     *
+     * @param aScreenSize is the size of the model on screen, in pixels.
+     * @return this model or one of its simplified versions.
+     */
+    const MODEL_3D& GetLod( float aScreenSize ) const;
+
     /**
      * Set some basic render states before drawing multiple models.
      */
@@ -123,6 +139,8 @@ private:
     BBOX_3D   m_model_bbox;               ///< global bounding box for this model
     std::vector<BBOX_3D> m_meshes_bbox;   ///< individual bbox for each mesh
 
+    std::vector<std::unique_ptr<MODEL_3D>> m_lods; ///< simplified versions of the model
+
     // unified vertex format for mesh rendering.
     struct VERTEX
     {
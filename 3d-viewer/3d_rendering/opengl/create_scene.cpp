@@ -36,6 +36,7 @@
 #include <fp_lib_table.h>
 #include <eda_3d_viewer_frame.h>
 #include <project_pcb.h>
+#include <memory>
 
 
 void RENDER_3D_OPENGL::addObjectTriangles( const FILLED_CIRCLE_2D* aCircle,
@@ -993,7 +994,7 @@ void RENDER_3D_OPENGL::generateViasAndPads()
 
 void RENDER_3D_OPENGL::Load3dModelsIfNeeded()
 {
-    if( m_3dModelMap.size() > 0 )
+    if( !m_3dModelMap.empty() || !m_pending3dModels.empty() )
         return;
 
     if( wxFrame* frame = dynamic_cast<wxFrame*>( m_canvas->GetParent() ) )
@@ -1055,38 +1056,83 @@ void RENDER_3D_OPENGL::load3dModels( REPORTER* aStatusReporter )
         {
             if( fp_model.m_Show && !fp_model.m_Filename.empty() )
             {
-                if( aStatusReporter )
-                {
-                    // Display the short filename of the 3D fp_model loaded:
-                    // (the full name is usually too long to be displayed)
-                    wxFileName fn( fp_model.m_Filename );
-                    aStatusReporter->Report( wxString::Format( _( "Loading %s..." ),
-                                                               fn.GetFullName() ) );
-                }
-
                 // Check if the fp_model is not present in our cache map
-                // (Not already loaded in memory)
-                if( !m_3dModelMap.contains( fp_model.m_Filename ) )
+                // (Not already loaded in memory or being loaded)
+                if( !m_3dModelMap.contains( fp_model.m_Filename )
+                        && !m_pending3dModels.contains( fp_model.m_Filename ) )
                 {
-                    // It is not present, try get it from cache
+                    // It is not present, get it from cache in the background
                     std::vector<const EMBEDDED_FILES*> embeddedFilesStack;
                     embeddedFilesStack.push_back( footprint->GetEmbeddedFiles() );
                     embeddedFilesStack.push_back( m_boardAdapter.GetBoard()->GetEmbeddedFiles() );
 
-                    const S3DMODEL* modelPtr = m_boardAdapter.Get3dCacheManager()->GetModel( fp_model.m_Filename,
-                                                                                             footprintBasePath,
-                                                                                             embeddedFilesStack );
+                    m_pending3dModels[ fp_model.m_Filename ] =
+                            m_boardAdapter.Get3dCacheManager()->GetModelAsync( fp_model.m_Filename,
+                                                                               footprintBasePath,
+                                                                               embeddedFilesStack,
+                                                                               true );
+                }
+            }
+        }
+    }
 
-                    // only add it if the return is not NULL
-                    if( modelPtr )
-                    {
-                        MATERIAL_MODE materialMode = m_boardAdapter.m_Cfg->m_Render.material_mode;
-                        MODEL_3D*     model        = new MODEL_3D( *modelPtr, materialMode );
+    if( !m_loadModelsInBackground )
+        createLoaded3dModels( aStatusReporter, true );
+}
 
-                        m_3dModelMap[ fp_model.m_Filename ] = model;
-                    }
-                }
+
+bool RENDER_3D_OPENGL::createLoaded3dModels( REPORTER* aStatusReporter, bool aWait )
+{
+    // Maximum time spent creating the models of a frame, to keep the view responsive when a
+    // lot of them become ready at the same time
+    const int64_t maxTime = 50000;  // microseconds
+    const int64_t startTime = GetRunningMicroSecs();
+
+    MATERIAL_MODE materialMode = m_boardAdapter.m_Cfg->m_Render.material_mode;
+    bool          hadPending = !m_pending3dModels.empty();
+
+    for( auto it = m_pending3dModels.begin(); it != m_pending3dModels.end(); )
+    {
+        if( !aWait )
+        {
+            if( GetRunningMicroSecs() - startTime > maxTime )
+                break;
+
+            if( it->second.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+            {
+                ++it;
+                continue;
             }
         }
+
+        // only add it if the model is available, with its simplified versions
+        const std::vector<std::shared_ptr<S3DMODEL>>& models = it->second.get();
+
+        if( !models.empty() )
+        {
+            MODEL_3D* model = new MODEL_3D( *models[0], materialMode );
+
+            for( size_t ii = 1; ii < models.size(); ++ii )
+                model->AddLod( std::make_unique<MODEL_3D>( *models[ii], materialMode ) );
+
+            m_3dModelMap[ it->first ] = model;
+        }
+
+        it = m_pending3dModels.erase( it );
+    }
+
+    if( aStatusReporter )
+    {
+        if( !m_pending3dModels.empty() )
+        {
+            aStatusReporter->Report( wxString::Format( _( "Loading 3D models (%zu remaining)..." ),
+                                                       m_pending3dModels.size() ) );
+        }
+        else if( hadPending )
+        {
+            aStatusReporter->Report( wxEmptyString );
+        }
     }
+
+    return !m_pending3dModels.empty();
 }
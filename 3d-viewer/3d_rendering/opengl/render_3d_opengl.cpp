@@ -23,6 +23,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <cfloat>
 #include <cstdint>
 #include <gal/opengl/kiglew.h>    // Must be included first
 
@@ -38,6 +39,7 @@
 #include <lset.h>
 #include <pgm_base.h>
 #include <math/util.h>      // for KiROUND
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <wx/log.h>
@@ -82,6 +84,7 @@ RENDER_3D_OPENGL::RENDER_3D_OPENGL( EDA_3D_CANVAS* aCanvas, BOARD_ADAPTER& aAdap
     m_boardWithHoles = nullptr;
 
     m_3dModelMap.clear();
+    m_loadModelsInBackground = true;
 
     m_spheres_gizmo = new SPHERES_GIZMO( 4, 4 );
 }
@@ -533,6 +536,11 @@ bool RENDER_3D_OPENGL::Redraw( bool aIsMoving, REPORTER* aStatusReporter,
         }
     }
 
+    // Pick up the footprint models loaded in the background since the last frame
+    bool modelsPending = !m_pending3dModels.empty()
+                                && createLoaded3dModels( aStatusReporter,
+                                                         !m_loadModelsInBackground );
+
     setupMaterials();
 
     // Initial setup
@@ -732,6 +740,9 @@ bool RENDER_3D_OPENGL::Redraw( bool aIsMoving, REPORTER* aStatusReporter,
     // Render 3D Models (Non-transparent)
     renderOpaqueModels( cameraViewMatrix );
 
+    if( modelsPending )
+        renderModelPlaceholders();
+
     // Display board body
     if( layerFlags.test( LAYER_3D_BOARD ) )
         renderBoardBody( skipRenderHoles );
@@ -833,7 +844,8 @@ bool RENDER_3D_OPENGL::Redraw( bool aIsMoving, REPORTER* aStatusReporter,
     // to take a screenshot after the render)
     glViewport( 0, 0, m_windowSize.x, m_windowSize.y );
 
-    return false;
+    // Draw again until all the models are there
+    return modelsPending;
 }
 
 
@@ -937,6 +949,8 @@ void RENDER_3D_OPENGL::freeAllLists()
 
     DELETE_AND_FREE_MAP( m_3dModelMap )
 
+    // The loads themselves are owned by the 3D cache manager
+    m_pending3dModels.clear();
     m_3dModelMatrixMap.clear();
 
     DELETE_AND_FREE( m_board )
@@ -1111,7 +1125,11 @@ void RENDER_3D_OPENGL::get3dModelsFromFootprint( std::list<MODELTORENDER> &aDstR
                         modelworldMatrix *= mtx;
                     }
 
-                    aDstRenderList.emplace_back( modelworldMatrix, modelPtr,
+                    // Small models on screen are drawn with their simplified versions
+                    const MODEL_3D& lod = modelPtr->GetLod(
+                            getScreenSize( modelPtr->GetBBox(), modelworldMatrix ) );
+
+                    aDstRenderList.emplace_back( modelworldMatrix, &lod,
                                                  aRenderTransparentOnly ? sM.m_Opacity : 1.0f,
                                                  aRenderTransparentOnly,
                                                  aFootprint->IsSelected() || aIsSelected );
@@ -1122,6 +1140,25 @@ void RENDER_3D_OPENGL::get3dModelsFromFootprint( std::list<MODELTORENDER> &aDstR
 }
 
 
+float RENDER_3D_OPENGL::getScreenSize( const BBOX_3D& aBBox, const glm::mat4& aWorldMatrix ) const
+{
+    const glm::mat4& projection = m_camera.GetProjectionMatrix();
+
+    const glm::vec4 min = aWorldMatrix * glm::vec4( aBBox.Min(), 1.0f );
+    const glm::vec4 max = aWorldMatrix * glm::vec4( aBBox.Max(), 1.0f );
+    const glm::vec4 center = projection * m_camera.GetViewMatrix() * ( ( min + max ) * 0.5f );
+
+    // The model is at or behind the eye of a perspective camera (w is 1 for an orthographic
+    // camera)
+    if( center.w <= FLT_EPSILON )
+        return FLT_MAX;
+
+    const float size = glm::length( SFVEC3F( max - min ) );
+
+    return size * projection[1][1] / center.w * m_windowSize.y * 0.5f;
+}
+
+
 void RENDER_3D_OPENGL::renderOpaqueModels( const glm::mat4 &aCameraViewMatrix )
 {
     EDA_3D_VIEWER_SETTINGS::RENDER_SETTINGS& cfg = m_boardAdapter.m_Cfg->m_Render;
@@ -1166,6 +1203,75 @@ void RENDER_3D_OPENGL::renderOpaqueModels( const glm::mat4 &aCameraViewMatrix )
 }
 
 
+void RENDER_3D_OPENGL::renderModelPlaceholders()
+{
+    if( !m_boardAdapter.GetBoard() )
+        return;
+
+    const float biuTo3d = m_boardAdapter.BiuTo3dUnits();
+    const float height = pcbIUScale.mmToIU( 1.0 ) * biuTo3d;
+
+    glDisable( GL_LIGHTING );
+    glLineWidth( 1 );
+    glColor4f( 0.6f, 0.6f, 0.6f, 1.0f );
+
+    glBegin( GL_LINES );
+
+    for( const FOOTPRINT* fp : m_boardAdapter.GetBoard()->Footprints() )
+    {
+        if( !m_boardAdapter.IsFootprintShown( (FOOTPRINT_ATTR_T) fp->GetAttributes() ) )
+            continue;
+
+        bool loading = false;
+
+        for( const FP_3DMODEL& model : fp->Models() )
+        {
+            if( model.m_Show && m_pending3dModels.contains( model.m_Filename ) )
+            {
+                loading = true;
+                break;
+            }
+        }
+
+        if( !loading )
+            continue;
+
+        // The footprint outline, raised from the board side of the footprint
+        const BOX2I bbox = fp->GetBoundingBox( false );
+        const float zpos = m_boardAdapter.GetFootprintZPos( fp->IsFlipped() );
+        const float zend = fp->IsFlipped() ? zpos - height : zpos + height;
+
+        const SFVEC3F min( bbox.GetLeft() * biuTo3d, -bbox.GetBottom() * biuTo3d,
+                           std::min( zpos, zend ) );
+        const SFVEC3F max( bbox.GetRight() * biuTo3d, -bbox.GetTop() * biuTo3d,
+                           std::max( zpos, zend ) );
+
+        const SFVEC3F corners[8] = { { min.x, min.y, min.z }, { max.x, min.y, min.z },
+                                     { max.x, max.y, min.z }, { min.x, max.y, min.z },
+                                     { min.x, min.y, max.z }, { max.x, min.y, max.z },
+                                     { max.x, max.y, max.z }, { min.x, max.y, max.z } };
+
+        for( int ii = 0; ii < 4; ++ii )
+        {
+            const int next = ( ii + 1 ) % 4;
+
+            glVertex3fv( &corners[ii].x );
+            glVertex3fv( &corners[next].x );
+
+            glVertex3fv( &corners[ii + 4].x );
+            glVertex3fv( &corners[next + 4].x );
+
+            glVertex3fv( &corners[ii].x );
+            glVertex3fv( &corners[ii + 4].x );
+        }
+    }
+
+    glEnd();
+
+    glEnable( GL_LIGHTING );
+}
+
+
 void RENDER_3D_OPENGL::renderTransparentModels( const glm::mat4 &aCameraViewMatrix )
 {
     EDA_3D_VIEWER_SETTINGS::RENDER_SETTINGS& cfg = m_boardAdapter.m_Cfg->m_Render;
@@ -40,7 +40,9 @@
 
 #include "3d_cache/3d_info.h"
 
+#include <future>
 #include <map>
+#include <memory>
 
 typedef std::map< PCB_LAYER_ID, OPENGL_RENDER_LIST* > MAP_OGL_DISP_LISTS;
 typedef std::list<TRIANGLE_DISPLAY_LIST* > LIST_TRIANGLES;
@@ -71,6 +73,13 @@ public:
      * Load footprint models if they are not already loaded, i.e. if m_3dModelMap is empty
      */
     void Load3dModelsIfNeeded();
+
+    /**
+     * Set if the footprint models are loaded in the background, drawing a placeholder box
+     * for the footprints until their models are ready (the default), or if a reload waits
+     * for all of them, e.g. to render a single image.
+     */
+    void SetLoadModelsInBackground( bool aBackground ) { m_loadModelsInBackground = aBackground; }
     void                                handleGizmoMouseInput( int mouseX, int mouseY );
     void                                setGizmoViewport( int x, int y, int width, int height );
     std::tuple<int, int, int, int>      getGizmoViewport() const;
@@ -142,6 +151,20 @@ private:
      */
     void load3dModels( REPORTER* aStatusReporter );
 
+    /**
+     * Create the #MODEL_3D objects of the models loaded in the background.
+     *
+     * @param aWait is true to wait for all the models, false to only create the ones which are
+     *              ready, within a time budget.
+     * @return true if some models are still being loaded.
+     */
+    bool createLoaded3dModels( REPORTER* aStatusReporter, bool aWait );
+
+    /**
+     * Draw a box in place of the models of the footprints whose models are still loading.
+     */
+    void renderModelPlaceholders();
+
     struct MODELTORENDER
     {
         glm::mat4 m_modelWorldMat;
@@ -178,6 +201,14 @@ private:
                                    const FOOTPRINT* aFootprint, bool aRenderTransparentOnly,
                                    bool aIsSelected );
 
+    /**
+     * Return the size on screen of a model, in pixels, to select its level of detail.
+     *
+     * @param aBBox is the bounding box of the model.
+     * @param aWorldMatrix is the transform of the model.
+     */
+    float getScreenSize( const BBOX_3D& aBBox, const glm::mat4& aWorldMatrix ) const;
+
     void setLightFront( bool enabled );
     void setLightTop( bool enabled );
     void setLightBottom( bool enabled );
@@ -251,6 +282,11 @@ private:
     std::map<wxString, MODEL_3D*>           m_3dModelMap;
     std::map<std::vector<float>, glm::mat4> m_3dModelMatrixMap;
 
+    /// Models being loaded by the 3D cache manager, by file name
+    std::map<wxString, std::shared_future<std::vector<std::shared_ptr<S3DMODEL>>>>
+                        m_pending3dModels;
+    bool                m_loadModelsInBackground;
+
     BOARD_ITEM*         m_currentRollOverItem;
 
     SHAPE_POLY_SET m_antiBoardPolys; ///< The negative polygon representation of the board
@@ -28,9 +28,11 @@
  */
 
 #include "bvh_pbrt.h"
+#include <wx/debug.h>
 
 
-#define BVH_RANGED_TRAVERSAL
+#define BVH_WIDE_RANGED_TRAVERSAL
+//#define BVH_RANGED_TRAVERSAL
 //#define BVH_PARTITION_TRAVERSAL
 
 
@@ -44,6 +46,165 @@ struct StackNode
 };
 
 
+#ifdef BVH_WIDE_RANGED_TRAVERSAL
+
+/// Each wide node pushes up to three children more than it pops
+#define MAX_WIDE_TODOS ( 3 * MAX_TODOS + 1 )
+
+
+// Ranged traversal over the 4-wide BVH: the rays of the packet are tested against the four
+// children of a node at once, and each child gets the range of rays that hit it.
+bool BVH_PBRT::Intersect( const RAYPACKET& aRayPacket, HITINFO_PACKET* aHitInfoPacket ) const
+{
+    if( m_wideNodes.empty() )
+        return false;
+
+    bool anyHit = false;
+    int todoOffset = 0;
+    StackNode todo[MAX_WIDE_TODOS];
+
+    todo[todoOffset++] = { 0, 0 };
+
+    while( todoOffset > 0 )
+    {
+        const StackNode    current = todo[--todoOffset];
+        const WideBVHNode& node = m_wideNodes[current.cell];
+
+        float        entry[WideBVHNode::WIDTH];
+        unsigned int first[WideBVHNode::WIDTH];
+        unsigned int last[WideBVHNode::WIDTH];
+        unsigned int pending = ( 1 << WideBVHNode::WIDTH ) - 1;
+        unsigned int found = 0;
+
+        // First ray hitting each child.  The frustum culls the children missed by the whole
+        // packet once the first alive ray missed them.
+        unsigned int ia = current.ia;
+
+        found = intersectWideNode( node, aRayPacket.m_ray[ia],
+                                   aHitInfoPacket[ia].m_HitInfo.m_tHit, entry );
+
+        for( int c = 0; c < WideBVHNode::WIDTH; ++c )
+        {
+            if( found & ( 1 << c ) )
+            {
+                first[c] = ia;
+            }
+            else
+            {
+                BBOX_3D bbox( SFVEC3F( node.bounds[0][c], node.bounds[1][c], node.bounds[2][c] ),
+                              SFVEC3F( node.bounds[3][c], node.bounds[4][c], node.bounds[5][c] ) );
+
+                if( node.bounds[0][c] > node.bounds[3][c]
+                  || !aRayPacket.m_Frustum.Intersect( bbox ) )
+                {
+                    pending &= ~( 1 << c );
+                }
+            }
+        }
+
+        pending &= ~found;
+
+        for( unsigned int i = ia + 1; pending && i < RAYPACKET_RAYS_PER_PACKET; ++i )
+        {
+            unsigned int hits = pending & intersectWideNode( node, aRayPacket.m_ray[i],
+                                                             aHitInfoPacket[i].m_HitInfo.m_tHit,
+                                                             entry );
+
+            for( int c = 0; c < WideBVHNode::WIDTH; ++c )
+            {
+                if( hits & ( 1 << c ) )
+                    first[c] = i;
+            }
+
+            found |= hits;
+            pending &= ~hits;
+        }
+
+        // Last ray hitting each leaf, for the range of rays to test against its primitives
+        unsigned int leaves = 0;
+
+        for( int c = 0; c < WideBVHNode::WIDTH; ++c )
+        {
+            if( ( found & ( 1 << c ) ) && node.children[c] < 0 )
+            {
+                leaves |= 1 << c;
+                last[c] = first[c] + 1;
+            }
+        }
+
+        pending = leaves;
+
+        for( unsigned int ie = RAYPACKET_RAYS_PER_PACKET - 1; pending && ie > ia; --ie )
+        {
+            for( int c = 0; c < WideBVHNode::WIDTH; ++c )
+            {
+                if( ( pending & ( 1 << c ) ) && ie <= first[c] )
+                    pending &= ~( 1 << c );
+            }
+
+            unsigned int hits = pending & intersectWideNode( node, aRayPacket.m_ray[ie],
+                                                             aHitInfoPacket[ie].m_HitInfo.m_tHit,
+                                                             entry );
+
+            for( int c = 0; c < WideBVHNode::WIDTH; ++c )
+            {
+                if( hits & ( 1 << c ) )
+                    last[c] = ie + 1;
+            }
+
+            pending &= ~hits;
+        }
+
+        for( int c = 0; c < WideBVHNode::WIDTH; ++c )
+        {
+            if( !( leaves & ( 1 << c ) ) )
+                continue;
+
+            const int            leafNum = ~node.children[c];
+            const LinearBVHNode& leaf = m_nodes[leafNum];
+
+            for( int j = 0; j < leaf.nPrimitives; ++j )
+            {
+                const OBJECT_3D* obj = m_primitives[leaf.primitivesOffset + j];
+
+                if( aRayPacket.m_Frustum.Intersect( obj->GetBBox() ) )
+                {
+                    for( unsigned int i = first[c]; i < last[c]; ++i )
+                    {
+                        const bool hit = obj->Intersect( aRayPacket.m_ray[i],
+                                                         aHitInfoPacket[i].m_HitInfo );
+
+                        if( hit )
+                        {
+                            anyHit |= hit;
+                            aHitInfoPacket[i].m_hitresult |= hit;
+                            aHitInfoPacket[i].m_HitInfo.m_acc_node_info = leafNum;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Visit the interior children in order
+        for( int c = WideBVHNode::WIDTH - 1; c >= 0; --c )
+        {
+            if( ( found & ( 1 << c ) ) && node.children[c] >= 0 )
+            {
+                wxASSERT( todoOffset < MAX_WIDE_TODOS );
+
+                StackNode& stackNode = todo[todoOffset++];
+                stackNode.cell = node.children[c];
+                stackNode.ia = first[c];
+            }
+        }
+    }
+
+    return anyHit;
+}
+
+#endif
+
+
 static inline unsigned int getFirstHit( const RAYPACKET& aRayPacket, const BBOX_3D& aBBox,
                                         unsigned int ia, HITINFO_PACKET* aHitInfoPacket )
 {
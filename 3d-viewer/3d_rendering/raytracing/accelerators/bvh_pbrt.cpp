@@ -75,9 +75,16 @@
 #include <cstdlib>
 #include <vector>
 
+#include <cmath>
+#include <limits>
 #include <stack>
 #include <wx/debug.h>
 
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define BVH_WIDE_USE_SSE2
+#endif
+
 #ifdef PRINT_STATISTICS_3D_VIEWER
 #include <stdio.h>
 #endif
@@ -300,6 +307,9 @@ BVH_PBRT::BVH_PBRT( const CONTAINER_3D_BASE& aObjectContainer, int aMaxPrimsInNo
     flattenBVHTree( root, &offset );
 
     wxASSERT( offset == (unsigned int)totalNodes );
+
+    m_wideNodes.reserve( totalNodes / 2 + 1 );
+    buildWideNode( 0 );
 }
 
 
@@ -1060,67 +1070,241 @@ int BVH_PBRT::flattenBVHTree( BVHBuildNode* node, uint32_t* offset )
 }
 
 
+int BVH_PBRT::buildWideNode( int aNode )
+{
+    int children[WideBVHNode::WIDTH];
+    int count = 0;
+
+    if( m_nodes[aNode].nPrimitives > 0 )
+    {
+        children[count++] = aNode;
+    }
+    else
+    {
+        children[count++] = aNode + 1;
+        children[count++] = m_nodes[aNode].secondChildOffset;
+    }
+
+    // Open the interior child with the largest surface until the node is full
+    while( count < WideBVHNode::WIDTH )
+    {
+        int   best = -1;
+        float bestArea = -1.0f;
+
+        for( int i = 0; i < count; ++i )
+        {
+            const LinearBVHNode& child = m_nodes[children[i]];
+
+            if( child.nPrimitives == 0 && child.bounds.SurfaceArea() > bestArea )
+            {
+                best = i;
+                bestArea = child.bounds.SurfaceArea();
+            }
+        }
+
+        if( best < 0 )
+            break;
+
+        const int opened = children[best];
+
+        children[best] = opened + 1;
+        children[count++] = m_nodes[opened].secondChildOffset;
+    }
+
+    const int index = (int) m_wideNodes.size();
+
+    m_wideNodes.emplace_back();
+
+    for( int i = 0; i < WideBVHNode::WIDTH; ++i )
+    {
+        int child = ~0;
+
+        if( i < count )
+        {
+            if( m_nodes[children[i]].nPrimitives > 0 )
+                child = ~children[i];
+            else
+                child = buildWideNode( children[i] );
+        }
+
+        // The vector may have grown in the recursion
+        WideBVHNode& node = m_wideNodes[index];
+
+        node.children[i] = child;
+
+        for( int axis = 0; axis < 3; ++axis )
+        {
+            if( i < count )
+            {
+                node.bounds[axis][i] = m_nodes[children[i]].bounds.Min()[axis];
+                node.bounds[axis + 3][i] = m_nodes[children[i]].bounds.Max()[axis];
+            }
+            else
+            {
+                node.bounds[axis][i] = std::numeric_limits<float>::infinity();
+                node.bounds[axis + 3][i] = -std::numeric_limits<float>::infinity();
+            }
+        }
+    }
+
+    return index;
+}
+
+
+unsigned int BVH_PBRT::intersectWideNode( const WideBVHNode& aNode, const RAY& aRay,
+                                          float aMaxT, float* aEntry )
+{
+    // Slab test against the near and far planes of each axis.  The planes are chosen from the
+    // sign of the inverse direction so that empty slots never hit.  A ray lying on a plane gives
+    // NaN distances, which the min/max below ignore.
+    //
+    // The far distances are scaled up a little, as in pbrt, so that rounding errors don't cull
+    // the boxes a ray just grazes.
+    const float farScale = 1.0f + 4.0f * std::numeric_limits<float>::epsilon();
+
+#ifdef BVH_WIDE_USE_SSE2
+    __m128 tEntry = _mm_setzero_ps();
+    __m128 tExit = _mm_set1_ps( aMaxT );
+    const __m128 scale = _mm_set1_ps( farScale );
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+        const bool   isNeg = std::signbit( aRay.m_InvDir[axis] );
+        const __m128 origin = _mm_set1_ps( aRay.m_Origin[axis] );
+        const __m128 invDir = _mm_set1_ps( aRay.m_InvDir[axis] );
+
+        const __m128 tNear = _mm_mul_ps(
+                _mm_sub_ps( _mm_loadu_ps( aNode.bounds[isNeg ? axis + 3 : axis] ), origin ),
+                invDir );
+
+        const __m128 tFar = _mm_mul_ps(
+                _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( aNode.bounds[isNeg ? axis : axis + 3] ),
+                                        origin ),
+                            invDir ),
+                scale );
+
+        // Returns the second operand if the first one is NaN
+        tEntry = _mm_max_ps( tNear, tEntry );
+        tExit = _mm_min_ps( tFar, tExit );
+    }
+
+    _mm_storeu_ps( aEntry, tEntry );
+
+    return (unsigned int) _mm_movemask_ps( _mm_cmple_ps( tEntry, tExit ) );
+#else
+    float tExit[WideBVHNode::WIDTH];
+
+    for( int i = 0; i < WideBVHNode::WIDTH; ++i )
+    {
+        aEntry[i] = 0.0f;
+        tExit[i] = aMaxT;
+    }
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+        const bool   isNeg = std::signbit( aRay.m_InvDir[axis] );
+        const float* nearPlanes = aNode.bounds[isNeg ? axis + 3 : axis];
+        const float* farPlanes = aNode.bounds[isNeg ? axis : axis + 3];
+
+        for( int i = 0; i < WideBVHNode::WIDTH; ++i )
+        {
+            const float tNear = ( nearPlanes[i] - aRay.m_Origin[axis] ) * aRay.m_InvDir[axis];
+            const float tFar = ( farPlanes[i] - aRay.m_Origin[axis] ) * aRay.m_InvDir[axis]
+                               * farScale;
+
+            aEntry[i] = tNear > aEntry[i] ? tNear : aEntry[i];
+            tExit[i] = tFar < tExit[i] ? tFar : tExit[i];
+        }
+    }
+
+    unsigned int mask = 0;
+
+    for( int i = 0; i < WideBVHNode::WIDTH; ++i )
+    {
+        if( aEntry[i] <= tExit[i] )
+            mask |= 1 << i;
+    }
+
+    return mask;
+#endif
+}
+
+
 #define MAX_TODOS 64
 
+/// Each wide node pushes up to three children more than it pops
+#define MAX_WIDE_TODOS ( 3 * MAX_TODOS + 1 )
+
 
 bool BVH_PBRT::Intersect( const RAY& aRay, HITINFO& aHitInfo ) const
 {
-    if( !m_nodes )
+    if( m_wideNodes.empty() )
         return false;
 
     bool hit = false;
 
     // Follow ray through BVH nodes to find primitive intersections
-    int todoOffset = 0, nodeNum = 0;
-    int todo[MAX_TODOS];
+    int todoOffset = 0;
+    int todo[MAX_WIDE_TODOS];
 
-    while( true )
+    todo[todoOffset++] = 0;
+
+    while( todoOffset > 0 )
     {
-        const LinearBVHNode *node = &m_nodes[nodeNum];
+        const WideBVHNode& node = m_wideNodes[todo[--todoOffset]];
 
-        wxASSERT( todoOffset < MAX_TODOS );
+        float        entry[WideBVHNode::WIDTH];
+        unsigned int mask = intersectWideNode( node, aRay, aHitInfo.m_tHit, entry );
 
-        // Check ray against BVH node
-        float hitBox = 0.0f;
+        // Sort the children hit from the farthest to the nearest
+        int order[WideBVHNode::WIDTH];
+        int count = 0;
 
-        const bool hitted = node->bounds.Intersect( aRay, &hitBox );
+        for( int i = 0; i < WideBVHNode::WIDTH; ++i )
+        {
+            if( !( mask & ( 1 << i ) ) )
+                continue;
 
-        if( hitted && ( hitBox < aHitInfo.m_tHit ) )
+            int j = count++;
+
+            for( ; j > 0 && entry[order[j - 1]] < entry[i]; --j )
+                order[j] = order[j - 1];
+
+            order[j] = i;
+        }
+
+        // Intersect the leaves from the nearest, so the farther ones may be culled by a hit
+        for( int k = count - 1; k >= 0; --k )
         {
-            if( node->nPrimitives > 0 )
-            {
-                // Intersect ray with primitives in leaf BVH node
-                for( int i = 0; i < node->nPrimitives; ++i )
-                {
-                    if( m_primitives[node->primitivesOffset + i]->Intersect( aRay, aHitInfo ) )
-                    {
-                        aHitInfo.m_acc_node_info = nodeNum;
-                        hit = true;
-                    }
-                }
-            }
-            else
+            const int child = node.children[order[k]];
+
+            if( child >= 0 || entry[order[k]] > aHitInfo.m_tHit )
+                continue;
+
+            const LinearBVHNode& leaf = m_nodes[~child];
+
+            // Intersect ray with primitives in leaf BVH node
+            for( int i = 0; i < leaf.nPrimitives; ++i )
             {
-                // Put far BVH node on _todo_ stack, advance to near node
-                if( aRay.m_dirIsNeg[node->axis] )
-                {
-                    todo[todoOffset++] = nodeNum + 1;
-                    nodeNum = node->secondChildOffset;
-                }
-                else
+                if( m_primitives[leaf.primitivesOffset + i]->Intersect( aRay, aHitInfo ) )
                 {
-                    todo[todoOffset++] = node->secondChildOffset;
-                    nodeNum = nodeNum + 1;
+                    aHitInfo.m_acc_node_info = ~child;
+                    hit = true;
                 }
-
-                continue;
             }
         }
 
-        if( todoOffset == 0 )
-            break;
+        // Put the interior nodes on the _todo_ stack, so the nearest is visited first
+        for( int k = 0; k < count; ++k )
+        {
+            const int child = node.children[order[k]];
 
-        nodeNum = todo[--todoOffset];
+            if( child >= 0 && entry[order[k]] <= aHitInfo.m_tHit )
+            {
+                wxASSERT( todoOffset < MAX_WIDE_TODOS );
+                todo[todoOffset++] = child;
+            }
+        }
     }
 
     return hit;
@@ -1194,60 +1378,48 @@ bool BVH_PBRT::Intersect( const RAY& aRay, HITINFO& aHitInfo, unsigned int aAccN
 
 bool BVH_PBRT::IntersectP( const RAY& aRay, float aMaxDistance ) const
 {
-    if( !m_nodes )
+    if( m_wideNodes.empty() )
         return false;
 
     // Follow ray through BVH nodes to find primitive intersections
-    int todoOffset = 0, nodeNum = 0;
-    int todo[MAX_TODOS];
+    int todoOffset = 0;
+    int todo[MAX_WIDE_TODOS];
 
-    while( true )
+    todo[todoOffset++] = 0;
+
+    while( todoOffset > 0 )
     {
-        const LinearBVHNode* node = &m_nodes[nodeNum];
+        const WideBVHNode& node = m_wideNodes[todo[--todoOffset]];
 
-        wxASSERT( todoOffset < MAX_TODOS );
+        float        entry[WideBVHNode::WIDTH];
+        unsigned int mask = intersectWideNode( node, aRay, aMaxDistance, entry );
 
-        // Check ray against BVH node
-        float hitBox = 0.0f;
+        for( int k = 0; k < WideBVHNode::WIDTH; ++k )
+        {
+            if( !( mask & ( 1 << k ) ) )
+                continue;
 
-        const bool hitted = node->bounds.Intersect( aRay, &hitBox );
+            const int child = node.children[k];
 
-        if( hitted && ( hitBox < aMaxDistance ) )
-        {
-            if( node->nPrimitives > 0 )
+            if( child >= 0 )
             {
-                // Intersect ray with primitives in leaf BVH node
-                for( int i = 0; i < node->nPrimitives; ++i )
-                {
-                    const OBJECT_3D* obj = m_primitives[node->primitivesOffset + i];
-
-                    if( obj->GetMaterial()->GetCastShadows()
-                      && obj->IntersectP( aRay, aMaxDistance ) )
-                        return true;
-                }
+                wxASSERT( todoOffset < MAX_WIDE_TODOS );
+                todo[todoOffset++] = child;
+                continue;
             }
-            else
+
+            const LinearBVHNode& leaf = m_nodes[~child];
+
+            // Intersect ray with primitives in leaf BVH node
+            for( int i = 0; i < leaf.nPrimitives; ++i )
             {
-                // Put far BVH node on _todo_ stack, advance to near node
-                if( aRay.m_dirIsNeg[node->axis] )
-                {
-                    todo[todoOffset++] = nodeNum + 1;
-                    nodeNum = node->secondChildOffset;
-                }
-                else
-                {
-                    todo[todoOffset++] = node->secondChildOffset;
-                    nodeNum = nodeNum + 1;
-                }
+                const OBJECT_3D* obj = m_primitives[leaf.primitivesOffset + i];
 
-                continue;
+                if( obj->GetMaterial()->GetCastShadows()
+                  && obj->IntersectP( aRay, aMaxDistance ) )
+                    return true;
             }
         }
-
-        if( todoOffset == 0 )
-            break;
-
-        nodeNum = todo[--todoOffset];
     }
 
     return false;
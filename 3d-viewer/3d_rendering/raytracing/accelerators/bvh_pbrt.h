@@ -73,6 +73,7 @@
 #include "accelerator_3d.h"
 #include <cstdint>
 #include <list>
+#include <vector>
 
 // Forward Declarations
 struct BVHBuildNode;
@@ -98,6 +99,25 @@ struct LinearBVHNode
 };
 
 
+/**
+ * A node of the 4-wide BVH collapsed from the binary one.
+ *
+ * The bounds of the (up to) four children are stored as structure of arrays so that a ray can
+ * be tested against all of them at once.  Leaves are the leaves of the binary BVH, so the node
+ * numbers reported in HITINFO::m_acc_node_info are the same for both.
+ */
+struct WideBVHNode
+{
+    static constexpr int WIDTH = 4;
+
+    /// Min x, y, z then max x, y, z of each child.  Unused slots have empty (inverted) bounds.
+    float bounds[6][WIDTH];
+
+    /// Index of a child wide node, or ~index of a LinearBVHNode leaf.
+    int   children[WIDTH];
+};
+
+
 enum class SPLITMETHOD
 {
     MIDDLE,
@@ -143,11 +163,29 @@ private:
 
     int flattenBVHTree( BVHBuildNode* node, uint32_t* offset );
 
+    /**
+     * Collapse the binary subtree at \a aNode into wide nodes.
+     *
+     * @return the index of the wide node.
+     */
+    int buildWideNode( int aNode );
+
+    /**
+     * Test a ray against the four children of a wide node.
+     *
+     * @param aMaxT is the distance beyond which boxes are ignored.
+     * @param aEntry receives the distances at which the ray enters the children's boxes.
+     * @return a mask of the children hit by the ray.
+     */
+    static unsigned int intersectWideNode( const WideBVHNode& aNode, const RAY& aRay,
+                                           float aMaxT, float* aEntry );
+
     // BVH Private Data
     const int           m_maxPrimsInNode;
     SPLITMETHOD         m_splitMethod;
     CONST_VECTOR_OBJECT m_primitives;
     LinearBVHNode*      m_nodes;
+    std::vector<WideBVHNode> m_wideNodes;
 
     std::list<void*>    m_nodesToFree;
 
@@ -1223,11 +1223,64 @@ void RENDER_3D_RAYTRACE_BASE::load3DModels( CONTAINER_3D& aDstContainer,
         return;
     }
 
+    S3D_CACHE* cacheMgr = m_boardAdapter.Get3dCacheManager();
+
+    auto getBasePath =
+            [&]( const FOOTPRINT* aFootprint ) -> wxString
+            {
+                wxString libraryName = aFootprint->GetFPID().GetLibNickname();
+
+                if( m_boardAdapter.GetBoard()->GetProject() )
+                {
+                    try
+                    {
+                        // FindRow() can throw an exception
+                        const FP_LIB_TABLE_ROW* fpRow =
+                            PROJECT_PCB::PcbFootprintLibs( m_boardAdapter.GetBoard()->GetProject() )
+                                    ->FindRow( libraryName, false );
+
+                        if( fpRow )
+                            return fpRow->GetFullURI( true );
+                    }
+                    catch( ... )
+                    {
+                        // Do nothing if the libraryName is not found in lib table
+                    }
+                }
+
+                return wxEmptyString;
+            };
+
+    auto isShown =
+            [&]( const FOOTPRINT* aFootprint )
+            {
+                return !aFootprint->Models().empty()
+                       && m_boardAdapter.IsFootprintShown( (FOOTPRINT_ATTR_T) aFootprint->GetAttributes() );
+            };
+
+    // Load the models in parallel first, they are then taken from the cache
+    for( FOOTPRINT* fp : m_boardAdapter.GetBoard()->Footprints() )
+    {
+        if( !isShown( fp ) )
+            continue;
+
+        wxString footprintBasePath = getBasePath( fp );
+
+        for( const FP_3DMODEL& model : fp->Models() )
+        {
+            if( model.m_Show && !model.m_Filename.empty() )
+            {
+                cacheMgr->GetModelAsync( model.m_Filename, footprintBasePath,
+                                         { fp->GetEmbeddedFiles(),
+                                           m_boardAdapter.GetBoard()->GetEmbeddedFiles() } );
+            }
+        }
+    }
+
     // Go for all footprints
     for( FOOTPRINT* fp : m_boardAdapter.GetBoard()->Footprints() )
     {
-        if( !fp->Models().empty()
-          && m_boardAdapter.IsFootprintShown( (FOOTPRINT_ATTR_T) fp->GetAttributes() ) )
+        if( isShown( fp ) )
         {
             double zpos = m_boardAdapter.GetFootprintZPos( fp->IsFlipped() );
 
@@ -1261,29 +1314,7 @@ void RENDER_3D_RAYTRACE_BASE::load3DModels( CONTAINER_3D& aDstContainer,
                                        modelunit_to_3d_units_factor ) );
 
             // Get the list of model files for this model
-            S3D_CACHE* cacheMgr = m_boardAdapter.Get3dCacheManager();
-
-            wxString                libraryName = fp->GetFPID().GetLibNickname();
-
-            wxString                footprintBasePath = wxEmptyString;
-
-            if( m_boardAdapter.GetBoard()->GetProject() )
-            {
-                try
-                {
-                    // FindRow() can throw an exception
-                    const FP_LIB_TABLE_ROW* fpRow =
-                        PROJECT_PCB::PcbFootprintLibs( m_boardAdapter.GetBoard()->GetProject() )
-                                ->FindRow( libraryName, false );
-
-                    if( fpRow )
-                        footprintBasePath = fpRow->GetFullURI( true );
-                }
-                catch( ... )
-                {
-                    // Do nothing if the libraryName is not found in lib table
-                }
-            }
+            wxString footprintBasePath = getBasePath( fp );
 
             for( FP_3DMODEL& model : fp->Models() )
             {
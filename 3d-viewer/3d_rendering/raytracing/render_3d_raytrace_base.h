@@ -80,6 +80,10 @@ protected:
     void renderTracing( uint8_t* ptrPBO, REPORTER* aStatusReporter );
     void postProcessShading( uint8_t* ptrPBO, REPORTER* aStatusReporter );
     void postProcessBlurFinish( uint8_t* ptrPBO, REPORTER* aStatusReporter );
+
+    /// Number of thread pool tasks the rows of the post processing stages are split into.
+    size_t rowBlockCount() const;
+
     void renderBlockTracing( uint8_t* ptrPBO , signed int iBlock );
     void renderFinalColor( uint8_t* ptrPBO, const SFVEC4F& rgbColor,
                            bool applyColorSpaceConversion );
@@ -156,6 +160,10 @@ protected:
     /// Save the number of blocks progress of the render
     size_t m_blockRenderProgressCount;
 
+    /// Render a frame over several calls of render(), each one limited in time, so the caller
+    /// can show the progress.  Otherwise the frame is rendered in a single call.
+    bool m_timeSlicedRender;
+
     POST_SHADER_SSAO m_postShaderSsao;
 
     std::list<LIGHT*> m_lights;
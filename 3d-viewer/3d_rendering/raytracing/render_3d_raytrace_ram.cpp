@@ -32,6 +32,8 @@ RENDER_3D_RAYTRACE_RAM::RENDER_3D_RAYTRACE_RAM( BOARD_ADAPTER& aAdapter, CAMERA&
     m_outputBuffer( nullptr ),
     m_pboDataSize( 0 )
 {
+    // Nothing is displayed while rendering off screen, so render whole frames
+    m_timeSlicedRender = false;
 }
 
 
@@ -120,17 +122,10 @@ bool RENDER_3D_RAYTRACE_RAM::Redraw( bool aIsMoving, REPORTER* aStatusReporter,
         m_renderState = RT_RENDER_STATE_MAX; // Set to an invalid state,
                                              // so it will restart again latter
 
-    // This will only render if need, otherwise it will redraw the PBO on the screen again
+    // There is nobody to show a preview to, so skip it and render the frame on the next call
     if( aIsMoving || was_camera_changed )
     {
-        // Set head light (camera view light) with the opposite direction of the camera
-        if( m_cameraLight )
-            m_cameraLight->SetDirection( -m_camera.GetDir() );
-
-        if( m_outputBuffer )
-        {
-            renderPreview( m_outputBuffer );
-        }
+        requestRedraw = true;
     }
     else
     {
@@ -62,6 +62,7 @@ namespace AC_KEYS
 {
 
 static const wxChar IncrementalConnectivity[] = wxT( "IncrementalConnectivity" );
+static const wxChar IncrementalConnectivityVerify[] = wxT( "IncrementalConnectivityVerify" );
 static const wxChar Use3DConnexionDriver[] = wxT( "3DConnexionDriver" );
 static const wxChar ExtraFillMargin[] = wxT( "ExtraFillMargin" );
 static const wxChar EnableCreepageSlot[] = wxT( "EnableCreepageSlot" );
@@ -131,8 +132,11 @@ static const wxChar GitIconRefreshInterval[] = wxT( "GitIconRefreshInterval" );
 static const wxChar ConfigurableToolbars[] = wxT( "ConfigurableToolbars" );
 static const wxChar MaxPastedTextLength[] = wxT( "MaxPastedTextLength" );
 static const wxChar PNSProcessClusterTimeout[] = wxT( "PNSProcessClusterTimeout" );
+static const wxChar PNSParallelCandidates[] = wxT( "PNSParallelCandidateEvaluation" );
 static const wxChar ImportSkipComponentBodies[] = wxT( "ImportSkipComponentBodies" );
 static const wxChar ScreenDPI[] = wxT( "ScreenDPI" );
+static const wxChar ParallelViewRecache[] = wxT( "ParallelViewRecache" );
+static const wxChar TextCacheSize[] = wxT( "TextCacheSize" );
 
 } // namespace KEYS
 
@@ -275,6 +279,7 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_Use3DConnexionDriver      = true;
 
     m_IncrementalConnectivity   = true;
+    m_IncrementalConnectivityVerify = false;
 
     m_DisambiguationMenuDelay   = 500;
 
@@ -320,11 +325,16 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_MaxPastedTextLength = 100;
 
     m_PNSProcessClusterTimeout = 100; // Default: 100 ms
+    m_PNSParallelCandidates = false;
 
     m_ImportSkipComponentBodies = false;
 
     m_ScreenDPI = 91;
 
+    m_ParallelViewRecache = true;
+
+    m_TextCacheSize = 64;
+
     loadFromConfigFile();
 }
 
@@ -517,6 +527,11 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
                                                 &m_IncrementalConnectivity,
                                                 m_IncrementalConnectivity ) );
 
+    m_entries.push_back( std::make_unique<PARAM_CFG_BOOL>( true,
+                                                AC_KEYS::IncrementalConnectivityVerify,
+                                                &m_IncrementalConnectivityVerify,
+                                                m_IncrementalConnectivityVerify ) );
+
     m_entries.push_back( std::make_unique<PARAM_CFG_INT>( true, AC_KEYS::DisambiguationTime,
                                                &m_DisambiguationMenuDelay,
                                                m_DisambiguationMenuDelay,
@@ -639,6 +654,10 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     m_entries.push_back( std::make_unique<PARAM_CFG_INT>( true, AC_KEYS::PNSProcessClusterTimeout,
                                                &m_PNSProcessClusterTimeout, 100, 10, 10000 ) );
 
+    m_entries.push_back( std::make_unique<PARAM_CFG_BOOL>( true, AC_KEYS::PNSParallelCandidates,
+                                                &m_PNSParallelCandidates,
+                                                m_PNSParallelCandidates ) );
+
     m_entries.push_back( std::make_unique<PARAM_CFG_BOOL>( true, AC_KEYS::ImportSkipComponentBodies,
                                                 &m_ImportSkipComponentBodies,
                                                 m_ImportSkipComponentBodies ) );
@@ -647,6 +666,14 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
                                                &m_ScreenDPI, m_ScreenDPI,
                                                50, 500 ) );
 
+    m_entries.push_back( std::make_unique<PARAM_CFG_BOOL>( true, AC_KEYS::ParallelViewRecache,
+                                                &m_ParallelViewRecache,
+                                                m_ParallelViewRecache ) );
+
+    m_entries.push_back( std::make_unique<PARAM_CFG_INT>( true, AC_KEYS::TextCacheSize,
+                                               &m_TextCacheSize, m_TextCacheSize,
+                                               1, 4096 ) );
+
     // Special case for trace mask setting...we just grab them and set them immediately
     // Because we even use wxLogTrace inside of advanced config
     m_entries.push_back( std::make_unique<PARAM_CFG_WXSTRING>( true, AC_KEYS::TraceMasks, &m_traceMasks,
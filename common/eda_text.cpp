@@ -115,6 +115,29 @@ EDA_TEXT::EDA_TEXT( const EDA_IU_SCALE& aIuScale, const wxString& aText ) :
 }
 
 
+/**
+ * @return a copy of \a aGlyphs which does not share the glyphs, or nullptr.
+ */
+static std::shared_ptr<std::vector<std::unique_ptr<KIFONT::GLYPH>>>
+copyGlyphs( const std::shared_ptr<std::vector<std::unique_ptr<KIFONT::GLYPH>>>& aGlyphs )
+{
+    if( !aGlyphs )
+        return nullptr;
+
+    auto copy = std::make_shared<std::vector<std::unique_ptr<KIFONT::GLYPH>>>();
+
+    for( const std::unique_ptr<KIFONT::GLYPH>& glyph : *aGlyphs )
+    {
+        if( KIFONT::OUTLINE_GLYPH* outline = dynamic_cast<KIFONT::OUTLINE_GLYPH*>( glyph.get() ) )
+            copy->emplace_back( std::make_unique<KIFONT::OUTLINE_GLYPH>( *outline ) );
+        else if( KIFONT::STROKE_GLYPH* stroke = dynamic_cast<KIFONT::STROKE_GLYPH*>( glyph.get() ) )
+            copy->emplace_back( std::make_unique<KIFONT::STROKE_GLYPH>( *stroke ) );
+    }
+
+    return copy;
+}
+
+
 EDA_TEXT::EDA_TEXT( const EDA_TEXT& aText ) :
     m_IuScale( aText.m_IuScale )
 {
@@ -131,15 +154,7 @@ EDA_TEXT::EDA_TEXT( const EDA_TEXT& aText ) :
     m_render_cache_angle = aText.m_render_cache_angle;
     m_render_cache_offset = aText.m_render_cache_offset;
 
-    m_render_cache.clear();
-
-    for( const std::unique_ptr<KIFONT::GLYPH>& glyph : aText.m_render_cache )
-    {
-        if( KIFONT::OUTLINE_GLYPH* outline = dynamic_cast<KIFONT::OUTLINE_GLYPH*>( glyph.get() ) )
-            m_render_cache.emplace_back( std::make_unique<KIFONT::OUTLINE_GLYPH>( *outline ) );
-        else if( KIFONT::STROKE_GLYPH* stroke = dynamic_cast<KIFONT::STROKE_GLYPH*>( glyph.get() ) )
-            m_render_cache.emplace_back( std::make_unique<KIFONT::STROKE_GLYPH>( *stroke ) );
-    }
+    m_render_cache = copyGlyphs( aText.m_render_cache );
 
     m_bbox_cache = aText.m_bbox_cache;
 
@@ -167,15 +182,7 @@ EDA_TEXT& EDA_TEXT::operator=( const EDA_TEXT& aText )
     m_render_cache_angle = aText.m_render_cache_angle;
     m_render_cache_offset = aText.m_render_cache_offset;
 
-    m_render_cache.clear();
-
-    for( const std::unique_ptr<KIFONT::GLYPH>& glyph : aText.m_render_cache )
-    {
-        if( KIFONT::OUTLINE_GLYPH* outline = dynamic_cast<KIFONT::OUTLINE_GLYPH*>( glyph.get() ) )
-            m_render_cache.emplace_back( std::make_unique<KIFONT::OUTLINE_GLYPH>( *outline ) );
-        else if( KIFONT::STROKE_GLYPH* stroke = dynamic_cast<KIFONT::STROKE_GLYPH*>( glyph.get() ) )
-            m_render_cache.emplace_back( std::make_unique<KIFONT::STROKE_GLYPH>( *stroke ) );
-    }
+    m_render_cache = copyGlyphs( aText.m_render_cache );
 
     m_bbox_cache = aText.m_bbox_cache;
 
@@ -512,7 +519,7 @@ bool EDA_TEXT::ResolveFont( const std::vector<wxString>* aEmbeddedFonts )
         m_attributes.m_Font = KIFONT::FONT::GetFont( m_unresolvedFontName, IsBold(), IsItalic(),
                                                      aEmbeddedFonts );
 
-        if( !m_render_cache.empty() )
+        if( m_render_cache && !m_render_cache->empty() )
             m_render_cache_font = m_attributes.m_Font;
 
         m_unresolvedFontName = wxEmptyString;
@@ -601,12 +608,22 @@ void EDA_TEXT::Offset( const VECTOR2I& aOffset )
 
     m_pos += aOffset;
 
-    for( std::unique_ptr<KIFONT::GLYPH>& glyph : m_render_cache )
     {
-        if( KIFONT::OUTLINE_GLYPH* outline = dynamic_cast<KIFONT::OUTLINE_GLYPH*>( glyph.get() ) )
-            outline->Move( aOffset );
-        else if( KIFONT::STROKE_GLYPH* stroke = dynamic_cast<KIFONT::STROKE_GLYPH*>( glyph.get() ) )
-            glyph = stroke->Transform( { 1.0, 1.0 }, aOffset, 0, ANGLE_0, false, { 0, 0 } );
+        std::lock_guard<std::mutex> lock( m_cache_mutex );
+
+        // Move a copy of the glyphs: the callers of GetRenderCache() may still hold the list
+        m_render_cache = copyGlyphs( m_render_cache );
+
+        if( m_render_cache )
+        {
+            for( std::unique_ptr<KIFONT::GLYPH>& glyph : *m_render_cache )
+            {
+                if( auto* outline = dynamic_cast<KIFONT::OUTLINE_GLYPH*>( glyph.get() ) )
+                    outline->Move( aOffset );
+                else if( auto* stroke = dynamic_cast<KIFONT::STROKE_GLYPH*>( glyph.get() ) )
+                    glyph = stroke->Transform( { 1.0, 1.0 }, aOffset, 0, ANGLE_0, false, { 0, 0 } );
+            }
+        }
     }
 
     ClearBoundingBoxCache();
@@ -671,46 +688,54 @@ const KIFONT::METRICS& EDA_TEXT::getFontMetrics() const
 
 void EDA_TEXT::ClearRenderCache()
 {
-    m_render_cache.clear();
+    std::lock_guard<std::mutex> lock( m_cache_mutex );
+
+    m_render_cache.reset();
 }
 
 
 void EDA_TEXT::ClearBoundingBoxCache()
 {
+    std::lock_guard<std::mutex> lock( m_cache_mutex );
+
     m_bbox_cache.clear();
 }
 
 
-std::vector<std::unique_ptr<KIFONT::GLYPH>>*
+std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>>
 EDA_TEXT::GetRenderCache( const KIFONT::FONT* aFont, const wxString& forResolvedText,
                           const VECTOR2I& aOffset ) const
 {
     if( aFont->IsOutline() )
     {
-        EDA_ANGLE resolvedAngle = GetDrawRotation();
+        EDA_ANGLE                   resolvedAngle = GetDrawRotation();
+        std::lock_guard<std::mutex> lock( m_cache_mutex );
 
-        if( m_render_cache.empty()
+        if( !m_render_cache
+                || m_render_cache->empty()
                 || m_render_cache_font != aFont
                 || m_render_cache_text != forResolvedText
                 || m_render_cache_angle != resolvedAngle
                 || m_render_cache_offset != aOffset )
         {
-            m_render_cache.clear();
+            // Never refill the current list: other threads may be drawing it
+            auto glyphs = std::make_shared<std::vector<std::unique_ptr<KIFONT::GLYPH>>>();
 
             const KIFONT::OUTLINE_FONT* font = static_cast<const KIFONT::OUTLINE_FONT*>( aFont );
             TEXT_ATTRIBUTES             attrs = GetAttributes();
 
             attrs.m_Angle = resolvedAngle;
 
-            font->GetLinesAsGlyphs( &m_render_cache, forResolvedText, GetDrawPos() + aOffset,
+            font->GetLinesAsGlyphs( glyphs.get(), forResolvedText, GetDrawPos() + aOffset,
                                     attrs, getFontMetrics() );
+            m_render_cache = std::move( glyphs );
             m_render_cache_font = aFont;
             m_render_cache_angle = resolvedAngle;
             m_render_cache_text = forResolvedText;
             m_render_cache_offset = aOffset;
         }
 
-        return &m_render_cache;
+        return m_render_cache;
     }
 
     return nullptr;
@@ -724,14 +749,17 @@ void EDA_TEXT::SetupRenderCache( const wxString& aResolvedText, const KIFONT::FO
     m_render_cache_font = aFont;
     m_render_cache_angle = aAngle;
     m_render_cache_offset = aOffset;
-    m_render_cache.clear();
+    m_render_cache = std::make_shared<std::vector<std::unique_ptr<KIFONT::GLYPH>>>();
 }
 
 
 void EDA_TEXT::AddRenderCacheGlyph( const SHAPE_POLY_SET& aPoly )
 {
-    m_render_cache.emplace_back( std::make_unique<KIFONT::OUTLINE_GLYPH>( aPoly ) );
-    static_cast<KIFONT::OUTLINE_GLYPH*>( m_render_cache.back().get() )->CacheTriangulation();
+    if( !m_render_cache )
+        m_render_cache = std::make_shared<std::vector<std::unique_ptr<KIFONT::GLYPH>>>();
+
+    m_render_cache->emplace_back( std::make_unique<KIFONT::OUTLINE_GLYPH>( aPoly ) );
+    static_cast<KIFONT::OUTLINE_GLYPH*>( m_render_cache->back().get() )->CacheTriangulation();
 }
 
 
@@ -745,10 +773,14 @@ BOX2I EDA_TEXT::GetTextBox( const RENDER_SETTINGS* aSettings, int aLine ) const
 {
     VECTOR2I drawPos = GetDrawPos();
 
-    auto cache_it = m_bbox_cache.find( aLine );
+    {
+        std::lock_guard<std::mutex> lock( m_cache_mutex );
+
+        auto cache_it = m_bbox_cache.find( aLine );
 
-    if( cache_it != m_bbox_cache.end() && cache_it->second.m_pos == drawPos )
-        return cache_it->second.m_bbox;
+        if( cache_it != m_bbox_cache.end() && cache_it->second.m_pos == drawPos )
+            return cache_it->second.m_bbox;
+    }
 
     BOX2I          bbox;
     wxArrayString  strings;
@@ -862,6 +894,7 @@ BOX2I EDA_TEXT::GetTextBox( const RENDER_SETTINGS* aSettings, int aLine ) const
 
     bbox.Normalize();       // Make h and v sizes always >= 0
 
+    std::lock_guard<std::mutex> lock( m_cache_mutex );
     m_bbox_cache[ aLine ] = { drawPos, bbox };
 
     return bbox;
@@ -1126,7 +1159,7 @@ std::shared_ptr<SHAPE_COMPOUND> EDA_TEXT::GetEffectiveTextShape( bool aTriangula
     VECTOR2I                        drawPos = GetDrawPos();
     TEXT_ATTRIBUTES                 attrs = GetAttributes();
 
-    std::vector<std::unique_ptr<KIFONT::GLYPH>>* cache = nullptr;
+    std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>> cache;
 
     if( aBBox.GetWidth() )
     {
@@ -24,10 +24,13 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
 #include <list>
 #include <mutex>
 #include <unordered_map>
 
+#include <advanced_config.h>
+#include <hash.h>
 #include <macros.h>
 #include <string_utils.h>
 #include <gal/graphics_abstraction_layer.h>
@@ -73,7 +76,7 @@ public:
     {
     }
 
-    ENTRY& Put( const wxString& aQuery, ENTRY&& aResult )
+    void Put( const wxString& aQuery, std::shared_ptr<ENTRY> aResult )
     {
         auto it = m_cache.find( aQuery );
 
@@ -94,11 +97,9 @@ public:
             m_cache.erase( last->first );
             m_cacheMru.pop_back();
         }
-
-        return m_cacheMru.begin()->second;
     }
 
-    ENTRY* Get( const wxString& aQuery )
+    std::shared_ptr<ENTRY> Get( const wxString& aQuery )
     {
         auto it = m_cache.find( aQuery );
 
@@ -107,7 +108,7 @@ public:
 
         m_cacheMru.splice( m_cacheMru.begin(), m_cacheMru, it->second );
 
-        return &m_cacheMru.begin()->second;
+        return m_cacheMru.begin()->second;
     }
 
     void Clear()
@@ -117,22 +118,200 @@ public:
     }
 
 private:
-    size_t                                                                        m_maxSize;
-    std::list<std::pair<wxString, ENTRY>>                                         m_cacheMru;
-    std::unordered_map<wxString, std::list<std::pair<wxString, ENTRY>>::iterator> m_cache;
+    using ENTRY_LIST = std::list<std::pair<wxString, std::shared_ptr<ENTRY>>>;
+
+    size_t                                             m_maxSize;
+    ENTRY_LIST                                         m_cacheMru;
+    std::unordered_map<wxString, ENTRY_LIST::iterator> m_cache;
 };
 
 
 static MARKUP_CACHE s_markupCache( 1024 );
 static std::mutex s_markupCacheMutex;
 static std::mutex s_defaultFontMutex;;
+static std::mutex s_fontMapMutex;
+
+static std::atomic<uint64_t> s_nextFontCacheId( 0 );
+
+
+/**
+ * A run of text laid out by FONT::layoutText().  The glyphs are only kept if they were asked
+ * for: bounding box and word break computations only need the extents.
+ */
+struct TEXT_RUN
+{
+    VECTOR2I                            m_Cursor;
+    BOX2I                               m_BBox;
+    bool                                m_HasGlyphs = false;
+    std::vector<std::unique_ptr<GLYPH>> m_Glyphs;
+};
+
+
+struct TEXT_RUN_KEY
+{
+    uint64_t         fontId;
+    wxString         text;
+    VECTOR2I         size;
+    VECTOR2I         position;
+    EDA_ANGLE        angle;
+    bool             mirror;
+    VECTOR2I         origin;
+    TEXT_STYLE_FLAGS style;
+
+    bool operator==( const TEXT_RUN_KEY& rhs ) const
+    {
+        return fontId == rhs.fontId
+                && text == rhs.text
+                && size == rhs.size
+                && position == rhs.position
+                && angle == rhs.angle
+                && mirror == rhs.mirror
+                && origin == rhs.origin
+                && style == rhs.style;
+    }
+};
+
+
+namespace std
+{
+    template <>
+    struct hash<TEXT_RUN_KEY>
+    {
+        std::size_t operator()( const TEXT_RUN_KEY& k ) const
+        {
+            return hash_val( k.fontId, k.text, k.size.x, k.size.y, k.position.x, k.position.y,
+                             k.angle.AsDegrees(), k.mirror, k.origin.x, k.origin.y, k.style );
+        }
+    };
+}
+
+
+/**
+ * Laid out runs of all the fonts, shared by the painters, the plotters and the bounding box
+ * computations.  Half of the text cache budget, the other half is for the outline font
+ * shaping caches.
+ */
+static TEXT_CACHE<TEXT_RUN_KEY, TEXT_RUN>& textRunCache()
+{
+    static TEXT_CACHE<TEXT_RUN_KEY, TEXT_RUN> s_cache(
+            (size_t) ADVANCED_CFG::GetCfg().m_TextCacheSize * 1024 * 1024 / 2 );
+
+    return s_cache;
+}
+
+
+static size_t textRunSize( const TEXT_RUN_KEY& aKey, const TEXT_RUN& aRun )
+{
+    size_t bytes = sizeof( TEXT_RUN_KEY ) + sizeof( TEXT_RUN )
+                   + aKey.text.length() * sizeof( wxUniChar );
+
+    for( const std::unique_ptr<GLYPH>& glyph : aRun.m_Glyphs )
+    {
+        if( glyph->IsOutline() )
+        {
+            const OUTLINE_GLYPH* outline = static_cast<const OUTLINE_GLYPH*>( glyph.get() );
+
+            bytes += sizeof( OUTLINE_GLYPH ) + outline->FullPointCount() * sizeof( VECTOR2I );
+
+            for( unsigned ii = 0; ii < outline->TriangulatedPolyCount(); ++ii )
+            {
+                const SHAPE_POLY_SET::TRIANGULATED_POLYGON* poly =
+                        outline->TriangulatedPolygon( ii );
+
+                bytes += poly->GetVertexCount() * sizeof( VECTOR2I )
+                         + poly->GetTriangleCount()
+                                   * sizeof( SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI );
+            }
+        }
+        else if( glyph->IsStroke() )
+        {
+            const STROKE_GLYPH* stroke = static_cast<const STROKE_GLYPH*>( glyph.get() );
+
+            bytes += sizeof( STROKE_GLYPH );
+
+            for( const std::vector<VECTOR2D>& pointList : *stroke )
+                bytes += pointList.size() * sizeof( VECTOR2D );
+        }
+    }
+
+    return bytes;
+}
+
+
+static std::unique_ptr<GLYPH> copyGlyph( const GLYPH& aGlyph )
+{
+    if( aGlyph.IsOutline() )
+        return std::make_unique<OUTLINE_GLYPH>( static_cast<const OUTLINE_GLYPH&>( aGlyph ) );
+    else if( aGlyph.IsStroke() )
+        return std::make_unique<STROKE_GLYPH>( static_cast<const STROKE_GLYPH&>( aGlyph ) );
+
+    return nullptr;
+}
 
 
-FONT::FONT()
+FONT::FONT() :
+        m_cacheId( s_nextFontCacheId++ )
 {
 }
 
 
+VECTOR2I FONT::GetTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                                const wxString& aText, const VECTOR2I& aSize,
+                                const VECTOR2I& aPosition, const EDA_ANGLE& aAngle, bool aMirror,
+                                const VECTOR2I& aOrigin, TEXT_STYLE_FLAGS aTextStyle ) const
+{
+    TEXT_RUN_KEY key = { m_cacheId, aText, aSize, aPosition, aAngle, aMirror, aOrigin,
+                         aTextStyle };
+
+    std::shared_ptr<const TEXT_RUN> run = textRunCache().Get( key );
+
+    // Runs stored for a bounding box only are laid out again when the glyphs are needed
+    if( !run || ( aGlyphs && !run->m_HasGlyphs ) )
+    {
+        std::shared_ptr<TEXT_RUN> newRun = std::make_shared<TEXT_RUN>();
+
+        newRun->m_HasGlyphs = aGlyphs != nullptr;
+        newRun->m_Cursor = layoutText( &newRun->m_BBox, aGlyphs ? &newRun->m_Glyphs : nullptr,
+                                       aText, aSize, aPosition, aAngle, aMirror, aOrigin,
+                                       aTextStyle );
+
+        textRunCache().Put( key, newRun, textRunSize( key, *newRun ) );
+        run = newRun;
+    }
+
+    if( aBBox )
+        *aBBox = run->m_BBox;
+
+    if( aGlyphs )
+    {
+        aGlyphs->reserve( aGlyphs->size() + run->m_Glyphs.size() );
+
+        for( const std::unique_ptr<GLYPH>& glyph : run->m_Glyphs )
+            aGlyphs->push_back( copyGlyph( *glyph ) );
+    }
+
+    return run->m_Cursor;
+}
+
+
+FONT::CACHE_STATS FONT::GetCacheStats()
+{
+    CACHE_STATS stats;
+
+    stats.m_TextRuns = textRunCache().GetStats();
+    OUTLINE_FONT::GetShapingCacheStats( stats.m_ShapedRuns, stats.m_Glyphs );
+
+    return stats;
+}
+
+
+void FONT::ClearCaches()
+{
+    textRunCache().Clear();
+    OUTLINE_FONT::ClearShapingCaches();
+}
+
+
 FONT* FONT::getDefaultFont()
 {
     std::lock_guard lock( s_defaultFontMutex );
@@ -152,6 +331,8 @@ FONT* FONT::GetFont( const wxString& aFontName, bool aBold, bool aItalic,
 
     std::tuple<wxString, bool, bool, bool> key = { aFontName, aBold, aItalic, aForDrawingSheet };
 
+    std::lock_guard lock( s_fontMapMutex );
+
     FONT* font = nullptr;
 
     if( s_fontMap.find( key ) != s_fontMap.end() )
@@ -378,18 +559,25 @@ VECTOR2I FONT::drawMarkup( BOX2I* aBoundingBox, std::vector<std::unique_ptr<GLYP
                            const EDA_ANGLE& aAngle, bool aMirror, const VECTOR2I& aOrigin,
                            TEXT_STYLE_FLAGS aTextStyle, const METRICS& aFontMetrics ) const
 {
-    std::lock_guard<std::mutex> lock( s_markupCacheMutex );
+    std::shared_ptr<MARKUP_CACHE::ENTRY> markup;
 
-    MARKUP_CACHE::ENTRY* markup = s_markupCache.Get( aText );
+    {
+        std::lock_guard<std::mutex> lock( s_markupCacheMutex );
+        markup = s_markupCache.Get( aText );
+    }
 
+    // The lock is not held while laying out the text, so other threads can draw at the same
+    // time.  The parsed tree is never modified and the entry outlives its eviction.
     if( !markup || !markup->root )
     {
-        MARKUP_CACHE::ENTRY& cached = s_markupCache.Put( aText, {} );
+        markup = std::make_shared<MARKUP_CACHE::ENTRY>();
+        markup->source = TO_UTF8( aText );
+
+        MARKUP::MARKUP_PARSER markupParser( &markup->source );
+        markup->root = markupParser.Parse();
 
-        cached.source = TO_UTF8( aText );
-        MARKUP::MARKUP_PARSER markupParser( &cached.source );
-        cached.root = markupParser.Parse();
-        markup = &cached;
+        std::lock_guard<std::mutex> lock( s_markupCacheMutex );
+        s_markupCache.Put( aText, markup );
     }
 
     wxASSERT( markup && markup->root );
@@ -175,7 +175,7 @@ OUTLINE_GLYPH::GetTriangulationData() const
 
 
 void OUTLINE_GLYPH::CacheTriangulation(
-        std::vector<std::unique_ptr<SHAPE_POLY_SET::TRIANGULATED_POLYGON>>& aHintData )
+        const std::vector<std::unique_ptr<SHAPE_POLY_SET::TRIANGULATED_POLYGON>>& aHintData )
 {
     cacheTriangulation( false, false, &aHintData );
 }
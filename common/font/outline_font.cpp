@@ -37,6 +37,7 @@
 #include FT_BBOX_H
 #include <trigo.h>
 #include <core/utf8.h>
+#include <advanced_config.h>
 
 using namespace KIFONT;
 
@@ -226,11 +227,11 @@ void OUTLINE_FONT::GetLinesAsGlyphs( std::vector<std::unique_ptr<GLYPH>>* aGlyph
 }
 
 
-VECTOR2I OUTLINE_FONT::GetTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                                        const wxString& aText, const VECTOR2I& aSize,
-                                        const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
-                                        bool aMirror, const VECTOR2I& aOrigin,
-                                        TEXT_STYLE_FLAGS aTextStyle ) const
+VECTOR2I OUTLINE_FONT::layoutText( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                                   const wxString& aText, const VECTOR2I& aSize,
+                                   const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
+                                   bool aMirror, const VECTOR2I& aOrigin,
+                                   TEXT_STYLE_FLAGS aTextStyle ) const
 {
     // HarfBuzz needs further processing to split tab-delimited text into text runs.
 
@@ -278,17 +279,41 @@ VECTOR2I OUTLINE_FONT::GetTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_pt
 }
 
 
-VECTOR2I OUTLINE_FONT::getTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                                        const wxString& aText, const VECTOR2I& aSize,
-                                        const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
-                                        bool aMirror, const VECTOR2I& aOrigin,
-                                        TEXT_STYLE_FLAGS aTextStyle ) const
+namespace KIFONT
 {
-    std::lock_guard<std::mutex> guard( m_freeTypeMutex );
 
-    return getTextAsGlyphsUnlocked( aBBox, aGlyphs, aText, aSize, aPosition, aAngle, aMirror,
-                                    aOrigin, aTextStyle );
-}
+/**
+ * A run of text shaped by HarfBuzz at the face size used for decomposing the glyphs.  Only the
+ * first glyph of each cluster is kept.
+ */
+struct SHAPED_RUN
+{
+    struct SHAPED_GLYPH
+    {
+        hb_codepoint_t m_Codepoint;
+        hb_position_t  m_XAdvance;
+        hb_position_t  m_YAdvance;
+    };
+
+    std::vector<SHAPED_GLYPH> m_Glyphs;
+    FT_Pos                    m_Ascender;
+    FT_Pos                    m_Descender;
+};
+
+} // namespace KIFONT
+
+
+struct SHAPED_RUN_KEY
+{
+    FT_Face  face;
+    bool     supersub;
+    wxString text;
+
+    bool operator==( const SHAPED_RUN_KEY& rhs ) const
+    {
+        return face == rhs.face && supersub == rhs.supersub && text == rhs.text;
+    }
+};
 
 
 struct GLYPH_CACHE_KEY {
@@ -319,6 +344,15 @@ struct GLYPH_CACHE_KEY {
 
 namespace std
 {
+    template <>
+    struct hash<SHAPED_RUN_KEY>
+    {
+        std::size_t operator()( const SHAPED_RUN_KEY& k ) const
+        {
+            return hash_val( k.face, k.supersub, k.text );
+        }
+    };
+
     template <>
     struct hash<GLYPH_CACHE_KEY>
     {
@@ -331,36 +365,208 @@ namespace std
 }
 
 
-VECTOR2I OUTLINE_FONT::getTextAsGlyphsUnlocked( BOX2I* aBBox,
-                                                std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                                                const wxString& aText, const VECTOR2I& aSize,
-                                                const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
-                                                bool aMirror, const VECTOR2I& aOrigin,
-                                                TEXT_STYLE_FLAGS aTextStyle ) const
+/**
+ * Shaped runs of all the outline fonts.  They are small, a quarter of the text cache budget is
+ * plenty.
+ */
+static TEXT_CACHE<SHAPED_RUN_KEY, SHAPED_RUN>& shapedRunCache()
+{
+    static TEXT_CACHE<SHAPED_RUN_KEY, SHAPED_RUN> s_cache(
+            (size_t) ADVANCED_CFG::GetCfg().m_TextCacheSize * 1024 * 1024 / 4 );
+
+    return s_cache;
+}
+
+
+/**
+ * Glyphs of all the outline fonts.  GLYPH_DATA is a collection of all outlines in the glyph;
+ * for example the 'o' glyph generally contains 2 contours, one for the glyph outline and one
+ * for the hole.
+ */
+static TEXT_CACHE<GLYPH_CACHE_KEY, GLYPH_DATA>& glyphCache()
+{
+    static TEXT_CACHE<GLYPH_CACHE_KEY, GLYPH_DATA> s_cache(
+            (size_t) ADVANCED_CFG::GetCfg().m_TextCacheSize * 1024 * 1024 / 4 );
+
+    return s_cache;
+}
+
+
+static size_t glyphDataSize( const GLYPH_DATA& aData )
+{
+    size_t bytes = sizeof( GLYPH_CACHE_KEY ) + sizeof( GLYPH_DATA );
+
+    for( const CONTOUR& contour : aData.m_Contours )
+        bytes += sizeof( CONTOUR ) + contour.m_Points.size() * sizeof( VECTOR2D );
+
+    for( const std::unique_ptr<SHAPE_POLY_SET::TRIANGULATED_POLYGON>& poly :
+         aData.m_TriangulationData )
+    {
+        bytes += sizeof( SHAPE_POLY_SET::TRIANGULATED_POLYGON )
+                 + poly->GetVertexCount() * sizeof( VECTOR2I )
+                 + poly->GetTriangleCount() * sizeof( SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI );
+    }
+
+    return bytes;
+}
+
+
+void OUTLINE_FONT::GetShapingCacheStats( TEXT_CACHE_STATS& aShapedRuns,
+                                         TEXT_CACHE_STATS& aGlyphs )
+{
+    aShapedRuns = shapedRunCache().GetStats();
+    aGlyphs = glyphCache().GetStats();
+}
+
+
+void OUTLINE_FONT::ClearShapingCaches()
+{
+    shapedRunCache().Clear();
+    glyphCache().Clear();
+}
+
+
+std::shared_ptr<const SHAPED_RUN> OUTLINE_FONT::shapeText( const wxString& aText,
+                                                           bool aSuperSub ) const
+{
+    SHAPED_RUN_KEY key = { m_face, aSuperSub, aText };
+
+    if( std::shared_ptr<const SHAPED_RUN> cached = shapedRunCache().Get( key ) )
+        return cached;
+
+    std::shared_ptr<SHAPED_RUN> run = std::make_shared<SHAPED_RUN>();
+
+    {
+        std::lock_guard<std::mutex> guard( m_freeTypeMutex );
+
+        // set glyph resolution so that FT_Load_Glyph() results are good enough for decomposing
+        FT_Set_Char_Size( m_face, 0, aSuperSub ? subscriptSize() : faceSize(), GLYPH_RESOLUTION,
+                          0 );
+
+        hb_buffer_t* buf = hb_buffer_create();
+        hb_buffer_add_utf8( buf, UTF8( aText ).c_str(), -1, 0, -1 );
+        hb_buffer_guess_segment_properties( buf );  // guess direction, script, and language based
+                                                    // on contents
+
+        hb_font_t* referencedFont = hb_ft_font_create_referenced( m_face );
+        hb_ft_font_set_funcs( referencedFont );
+        hb_shape( referencedFont, buf, nullptr, 0 );
+
+        unsigned int         glyphCount;
+        hb_glyph_info_t*     glyphInfo = hb_buffer_get_glyph_infos( buf, &glyphCount );
+        hb_glyph_position_t* glyphPos = hb_buffer_get_glyph_positions( buf, &glyphCount );
+
+        run->m_Glyphs.reserve( glyphCount );
+
+        for( unsigned int i = 0; i < glyphCount; i++ )
+        {
+            // Don't process glyphs that were already included in a previous cluster
+            if( i > 0 && glyphInfo[i].cluster == glyphInfo[i-1].cluster )
+                continue;
+
+            run->m_Glyphs.push_back( { glyphInfo[i].codepoint, glyphPos[i].x_advance,
+                                       glyphPos[i].y_advance } );
+        }
+
+        run->m_Ascender = m_face->size->metrics.ascender;
+        run->m_Descender = m_face->size->metrics.descender;
+
+        hb_buffer_destroy( buf );
+        hb_font_destroy( referencedFont );
+    }
+
+    size_t bytes = sizeof( SHAPED_RUN_KEY ) + sizeof( SHAPED_RUN )
+                   + aText.length() * sizeof( wxUniChar )
+                   + run->m_Glyphs.size() * sizeof( SHAPED_RUN::SHAPED_GLYPH );
+
+    shapedRunCache().Put( key, run, bytes );
+
+    return run;
+}
+
+
+void OUTLINE_FONT::loadGlyph( std::vector<CONTOUR>& aContours, unsigned int aCodepoint,
+                              int aAdvance, bool aSuperSub ) const
+{
+    double scaler = aSuperSub ? subscriptSize() : faceSize();
+    bool   decomposed;
+
+    {
+        std::lock_guard<std::mutex> guard( m_freeTypeMutex );
+
+        // Another run may have changed the size since this one was shaped
+        FT_Set_Char_Size( m_face, 0, scaler, GLYPH_RESOLUTION, 0 );
+
+        if( m_fakeItal )
+        {
+            FT_Matrix matrix;
+            // Create a 12 degree slant
+            const float angle = (float)( -M_PI * 12.0f ) / 180.0f;
+            matrix.xx = (FT_Fixed) ( cos( angle ) * 0x10000L );
+            matrix.xy = (FT_Fixed) ( -sin( angle ) * 0x10000L );
+            matrix.yx = (FT_Fixed) ( 0 * 0x10000L );  // Don't rotate in the y direction
+            matrix.yy = (FT_Fixed) ( 1 * 0x10000L );
+
+            FT_Set_Transform( m_face, &matrix, nullptr );
+        }
+
+        FT_Load_Glyph( m_face, aCodepoint, FT_LOAD_NO_BITMAP );
+
+        if( m_fakeBold )
+            FT_Outline_Embolden( &m_face->glyph->outline, 1 << 6 );
+
+        OUTLINE_DECOMPOSER decomposer( m_face->glyph->outline );
+
+        decomposed = decomposer.OutlineToSegments( &aContours );
+    }
+
+    if( decomposed )
+        return;
+
+    double  hb_advance = aAdvance * GLYPH_SIZE_SCALER;
+    BOX2D   tofuBox( { scaler * 0.03, 0.0 },
+                     { hb_advance - scaler * 0.02, scaler * 0.72 } );
+
+    aContours.clear();
+
+    CONTOUR outline;
+    outline.m_Winding = 1;
+    outline.m_Orientation = FT_ORIENTATION_TRUETYPE;
+    outline.m_Points.push_back( tofuBox.GetPosition() );
+    outline.m_Points.push_back( { tofuBox.GetSize().x, tofuBox.GetPosition().y } );
+    outline.m_Points.push_back( tofuBox.GetSize() );
+    outline.m_Points.push_back( { tofuBox.GetPosition().x, tofuBox.GetSize().y } );
+    aContours.push_back( std::move( outline ) );
+
+    CONTOUR hole;
+    tofuBox.Move( { scaler * 0.06, scaler * 0.06 } );
+    tofuBox.SetSize( { tofuBox.GetWidth() - scaler * 0.06,
+                       tofuBox.GetHeight() - scaler * 0.06 } );
+    hole.m_Winding = 1;
+    hole.m_Orientation = FT_ORIENTATION_NONE;
+    hole.m_Points.push_back( tofuBox.GetPosition() );
+    hole.m_Points.push_back( { tofuBox.GetSize().x, tofuBox.GetPosition().y } );
+    hole.m_Points.push_back( tofuBox.GetSize() );
+    hole.m_Points.push_back( { tofuBox.GetPosition().x, tofuBox.GetSize().y } );
+    aContours.push_back( std::move( hole ) );
+}
+
+
+VECTOR2I OUTLINE_FONT::getTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                                        const wxString& aText, const VECTOR2I& aSize,
+                                        const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
+                                        bool aMirror, const VECTOR2I& aOrigin,
+                                        TEXT_STYLE_FLAGS aTextStyle ) const
 {
     VECTOR2D glyphSize = aSize;
-    FT_Face  face = m_face;
     double   scaler = faceSize();
     bool     supersub = IsSuperscript( aTextStyle ) || IsSubscript( aTextStyle );
 
     if( supersub )
         scaler = subscriptSize();
 
-    // set glyph resolution so that FT_Load_Glyph() results are good enough for decomposing
-    FT_Set_Char_Size( face, 0, scaler, GLYPH_RESOLUTION, 0 );
-
-    hb_buffer_t* buf = hb_buffer_create();
-    hb_buffer_add_utf8( buf, UTF8( aText ).c_str(), -1, 0, -1 );
-    hb_buffer_guess_segment_properties( buf );  // guess direction, script, and language based on
-                                                // contents
-
-    hb_font_t* referencedFont = hb_ft_font_create_referenced( face );
-    hb_ft_font_set_funcs( referencedFont );
-    hb_shape( referencedFont, buf, nullptr, 0 );
-
-    unsigned int         glyphCount;
-    hb_glyph_info_t*     glyphInfo = hb_buffer_get_glyph_infos( buf, &glyphCount );
-    hb_glyph_position_t* glyphPos = hb_buffer_get_glyph_positions( buf, &glyphCount );
+    // The FreeType lock is only taken for the runs and glyphs missing from the caches
+    std::shared_ptr<const SHAPED_RUN> run = shapeText( aText, supersub );
 
     VECTOR2D scaleFactor( glyphSize.x / faceSize(), -glyphSize.y / faceSize() );
     scaleFactor = scaleFactor * m_outlineFontSizeCompensation;
@@ -368,88 +574,38 @@ VECTOR2I OUTLINE_FONT::getTextAsGlyphsUnlocked( BOX2I* aBBox,
     VECTOR2I cursor( 0, 0 );
 
     if( aGlyphs )
-        aGlyphs->reserve( glyphCount );
+        aGlyphs->reserve( aGlyphs->size() + run->m_Glyphs.size() );
 
-    // GLYPH_DATA is a collection of all outlines in the glyph; for example the 'o' glyph
-    // generally contains 2 contours, one for the glyph outline and one for the hole
-    static std::unordered_map<GLYPH_CACHE_KEY, GLYPH_DATA> s_glyphCache;
-
-    for( unsigned int i = 0; i < glyphCount; i++ )
+    for( const SHAPED_RUN::SHAPED_GLYPH& shaped : run->m_Glyphs )
     {
-        // Don't process glyphs that were already included in a previous cluster
-        if( i > 0 && glyphInfo[i].cluster == glyphInfo[i-1].cluster )
-            continue;
-
         if( aGlyphs )
         {
-            GLYPH_CACHE_KEY key = { face, glyphInfo[i].codepoint, scaleFactor, m_forDrawingSheet,
+            GLYPH_CACHE_KEY key = { m_face, shaped.m_Codepoint, scaleFactor, m_forDrawingSheet,
                                     m_fakeItal, m_fakeBold, aMirror, supersub, aAngle };
-            GLYPH_DATA&     glyphData = s_glyphCache[ key ];
-
-            if( glyphData.m_Contours.empty() )
-            {
-                if( m_fakeItal )
-                {
-                    FT_Matrix matrix;
-                    // Create a 12 degree slant
-                    const float angle = (float)( -M_PI * 12.0f ) / 180.0f;
-                    matrix.xx = (FT_Fixed) ( cos( angle ) * 0x10000L );
-                    matrix.xy = (FT_Fixed) ( -sin( angle ) * 0x10000L );
-                    matrix.yx = (FT_Fixed) ( 0 * 0x10000L );  // Don't rotate in the y direction
-                    matrix.yy = (FT_Fixed) ( 1 * 0x10000L );
-
-                    FT_Set_Transform( face, &matrix, nullptr );
-                }
-
-                FT_Load_Glyph( face, glyphInfo[i].codepoint, FT_LOAD_NO_BITMAP );
 
-                if( m_fakeBold )
-                    FT_Outline_Embolden( &face->glyph->outline, 1 << 6 );
+            std::shared_ptr<const GLYPH_DATA> glyphData = glyphCache().Get( key );
+            std::shared_ptr<GLYPH_DATA>       newGlyphData;
 
-                OUTLINE_DECOMPOSER decomposer( face->glyph->outline );
-
-                if( !decomposer.OutlineToSegments( &glyphData.m_Contours ) )
-                {
-                    double  hb_advance = glyphPos[i].x_advance * GLYPH_SIZE_SCALER;
-                    BOX2D   tofuBox( { scaler * 0.03, 0.0 },
-                                     { hb_advance - scaler * 0.02, scaler * 0.72 } );
-
-                    glyphData.m_Contours.clear();
-
-                    CONTOUR outline;
-                    outline.m_Winding = 1;
-                    outline.m_Orientation = FT_ORIENTATION_TRUETYPE;
-                    outline.m_Points.push_back( tofuBox.GetPosition() );
-                    outline.m_Points.push_back( { tofuBox.GetSize().x, tofuBox.GetPosition().y } );
-                    outline.m_Points.push_back( tofuBox.GetSize() );
-                    outline.m_Points.push_back( { tofuBox.GetPosition().x, tofuBox.GetSize().y } );
-                    glyphData.m_Contours.push_back( std::move( outline ) );
-
-                    CONTOUR hole;
-                    tofuBox.Move( { scaler * 0.06, scaler * 0.06 } );
-                    tofuBox.SetSize( { tofuBox.GetWidth() - scaler * 0.06,
-                                       tofuBox.GetHeight() - scaler * 0.06 } );
-                    hole.m_Winding = 1;
-                    hole.m_Orientation = FT_ORIENTATION_NONE;
-                    hole.m_Points.push_back( tofuBox.GetPosition() );
-                    hole.m_Points.push_back( { tofuBox.GetSize().x, tofuBox.GetPosition().y } );
-                    hole.m_Points.push_back( tofuBox.GetSize() );
-                    hole.m_Points.push_back( { tofuBox.GetPosition().x, tofuBox.GetSize().y } );
-                    glyphData.m_Contours.push_back( std::move( hole ) );
-                }
+            if( !glyphData )
+            {
+                newGlyphData = std::make_shared<GLYPH_DATA>();
+                loadGlyph( newGlyphData->m_Contours, shaped.m_Codepoint, shaped.m_XAdvance,
+                           supersub );
             }
 
+            const std::vector<CONTOUR>& contours = glyphData ? glyphData->m_Contours
+                                                             : newGlyphData->m_Contours;
+
             std::unique_ptr<OUTLINE_GLYPH> glyph = std::make_unique<OUTLINE_GLYPH>();
             std::vector<SHAPE_LINE_CHAIN>  holes;
 
-            for( CONTOUR& c : glyphData.m_Contours )
+            for( const CONTOUR& c : contours )
             {
-                std::vector<VECTOR2D> points = c.m_Points;
-                SHAPE_LINE_CHAIN      shape;
+                SHAPE_LINE_CHAIN shape;
 
-                shape.ReservePoints( points.size() );
+                shape.ReservePoints( c.m_Points.size() );
 
-                for( const VECTOR2D& v : points )
+                for( const VECTOR2D& v : c.m_Points )
                 {
                     VECTOR2D pt( v + cursor );
 
@@ -502,31 +658,28 @@ VECTOR2I OUTLINE_FONT::getTextAsGlyphsUnlocked( BOX2I* aBBox,
                 }
             }
 
-            if( glyphData.m_TriangulationData.empty() )
+            if( newGlyphData )
             {
                 glyph->CacheTriangulation( false, false );
-                glyphData.m_TriangulationData = glyph->GetTriangulationData();
+                newGlyphData->m_TriangulationData = glyph->GetTriangulationData();
+                glyphCache().Put( key, newGlyphData, glyphDataSize( *newGlyphData ) );
             }
             else
             {
-                glyph->CacheTriangulation( glyphData.m_TriangulationData );
+                glyph->CacheTriangulation( glyphData->m_TriangulationData );
             }
 
             aGlyphs->push_back( std::move( glyph ) );
         }
 
-        hb_glyph_position_t& pos = glyphPos[i];
-        cursor.x += ( pos.x_advance * GLYPH_SIZE_SCALER );
-        cursor.y += ( pos.y_advance * GLYPH_SIZE_SCALER );
+        cursor.x += ( shaped.m_XAdvance * GLYPH_SIZE_SCALER );
+        cursor.y += ( shaped.m_YAdvance * GLYPH_SIZE_SCALER );
     }
 
-    int      ascender = abs( face->size->metrics.ascender * GLYPH_SIZE_SCALER );
-    int      descender = abs( face->size->metrics.descender * GLYPH_SIZE_SCALER );
+    int      ascender = abs( run->m_Ascender * GLYPH_SIZE_SCALER );
+    int      descender = abs( run->m_Descender * GLYPH_SIZE_SCALER );
     VECTOR2I extents( cursor.x * scaleFactor.x, ( ascender + descender ) * abs( scaleFactor.y ) );
 
-    hb_buffer_destroy( buf );
-    hb_font_destroy( referencedFont );
-
     VECTOR2I cursorDisplacement( cursor.x * scaleFactor.x, -cursor.y * scaleFactor.y );
 
     if( aBBox )
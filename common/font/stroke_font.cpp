@@ -199,11 +199,11 @@ double STROKE_FONT::GetInterline( double aGlyphHeight, const METRICS& aFontMetri
 }
 
 
-VECTOR2I STROKE_FONT::GetTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                                       const wxString& aText, const VECTOR2I& aSize,
-                                       const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
-                                       bool aMirror, const VECTOR2I& aOrigin,
-                                       TEXT_STYLE_FLAGS aTextStyle ) const
+VECTOR2I STROKE_FONT::layoutText( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                                  const wxString& aText, const VECTOR2I& aSize,
+                                  const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
+                                  bool aMirror, const VECTOR2I& aOrigin,
+                                  TEXT_STYLE_FLAGS aTextStyle ) const
 {
     constexpr int    TAB_WIDTH = 4;
     constexpr double INTER_CHAR = 0.2;
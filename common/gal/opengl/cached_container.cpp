@@ -53,13 +53,15 @@ using namespace KIGFX;
 
 CACHED_CONTAINER::CACHED_CONTAINER( unsigned int aSize ) :
         VERTEX_CONTAINER( aSize ),
+        m_compacting( false ),
         m_item( nullptr ),
         m_chunkSize( 0 ),
         m_chunkOffset( 0 ),
         m_maxIndex( 0 )
 {
     // In the beginning there is only free space
-    m_freeChunks.insert( std::make_pair( aSize, 0 ) );
+    m_freeChunks.emplace( aSize, 0 );
+    m_freeChunksByOffset.emplace( 0, aSize );
 }
 
 
@@ -73,6 +75,13 @@ void CACHED_CONTAINER::SetItem( VERTEX_ITEM* aItem )
 
     // Get the previously set offset if the item was stored previously
     m_chunkOffset = itemSize > 0 ? aItem->GetOffset() : -1;
+
+    // An item edited again is stored as the current item until FinishItem()
+    if( itemSize > 0 )
+    {
+        m_items.erase( aItem );
+        m_itemsByOffset.erase( m_chunkOffset );
+    }
 }
 
 
@@ -90,14 +99,14 @@ void CACHED_CONTAINER::FinishItem()
 
         // Add the not used memory back to the pool
         addFreeChunk( itemOffset + itemSize, m_chunkSize - itemSize );
-
-        // mergeFreeChunks();   // veery slow and buggy
-
-        m_maxIndex = std::max( itemOffset + itemSize, m_maxIndex );
     }
 
     if( itemSize > 0 )
+    {
         m_items.insert( m_item );
+        m_itemsByOffset[m_item->GetOffset()] = m_item;
+        m_maxIndex = std::max( m_item->GetOffset() + itemSize, m_maxIndex );
+    }
 
     m_item = nullptr;
     m_chunkSize = 0;
@@ -136,7 +145,7 @@ VERTEX* CACHED_CONTAINER::Allocate( unsigned int aSize )
     m_item->setSize( newSize );
 
     // The content has to be updated
-    m_dirty = true;
+    SetDirty( m_chunkOffset + itemSize, aSize );
 
 #if CACHED_CONTAINER_TEST > 0
     test();
@@ -170,6 +179,11 @@ void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
 
     m_items.erase( aItem );
 
+    auto indexed = m_itemsByOffset.find( offset );
+
+    if( indexed != m_itemsByOffset.end() && indexed->second == aItem )
+        m_itemsByOffset.erase( indexed );
+
 #if CACHED_CONTAINER_TEST > 0
     test();
 #endif
@@ -196,6 +210,7 @@ void CACHED_CONTAINER::Clear()
     m_freeSpace = m_currentSize;
     m_maxIndex = 0;
     m_failed = false;
+    m_compacting = false;
 
     // Set the size of all the stored VERTEX_ITEMs to 0, so it is clear that they are not held
     // in the container anymore
@@ -203,10 +218,31 @@ void CACHED_CONTAINER::Clear()
         ( *it )->setSize( 0 );
 
     m_items.clear();
+    m_itemsByOffset.clear();
 
     // Now there is only free space left
     m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, 0 ) );
+    m_freeChunksByOffset.clear();
+    m_freeChunks.emplace( m_freeSpace, 0 );
+    m_freeChunksByOffset.emplace( 0, m_freeSpace );
+}
+
+
+CACHED_CONTAINER::STATS CACHED_CONTAINER::GetStats() const
+{
+    STATS stats = m_stats;
+
+    stats.m_size = m_currentSize;
+    stats.m_used = usedSpace();
+    stats.m_freeChunks = m_freeChunks.size();
+
+    if( !m_freeChunks.empty() )
+        stats.m_largestFreeChunk = getChunkSize( *m_freeChunks.rbegin() );
+
+    if( m_freeSpace > 0 )
+        stats.m_fragmentation = 1.0 - (double) stats.m_largestFreeChunk / m_freeSpace;
+
+    return stats;
 }
 
 
@@ -217,17 +253,40 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
 
     unsigned int itemSize = m_item->GetSize();
 
-    // Find a free space chunk >= aSize
-    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( aSize );
+    // Grow the chunk in place if it is followed by enough free space, so the data of the item
+    // doesn't have to be copied
+    if( itemSize > 0 )
+    {
+        auto next = m_freeChunksByOffset.find( m_chunkOffset + m_chunkSize );
+
+        if( next != m_freeChunksByOffset.end() && m_chunkSize + next->second >= aSize )
+        {
+            unsigned int nextSize = next->second;
+
+            removeFreeChunk( m_chunkOffset + m_chunkSize, nextSize );
+            m_chunkSize += nextSize;
+
+            return true;
+        }
+    }
+
+    // Find the smallest free space chunk >= aSize
+    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( CHUNK( aSize, 0 ) );
 
     // Is there enough space to store vertices?
     if( newChunk == m_freeChunks.end() )
     {
         bool result;
 
-        // Would it be enough to double the current space?
-        if( aSize < m_freeSpace + m_currentSize )
+        if( usedSpace() + aSize <= m_currentSize / 2 )
         {
+            // There is plenty of free space, it is only fragmented: pack the data without
+            // growing the container
+            result = defragmentResize( m_currentSize );
+        }
+        else if( aSize < m_freeSpace + m_currentSize )
+        {
+            // Would it be enough to double the current space?
             // Yes: exponential growing
             result = defragmentResize( m_currentSize * 2 );
         }
@@ -240,7 +299,9 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
         if( !result )
             return false;
 
-        newChunk = m_freeChunks.lower_bound( aSize );
+        m_stats.m_resizes++;
+
+        newChunk = m_freeChunks.lower_bound( CHUNK( aSize, 0 ) );
         assert( newChunk != m_freeChunks.end() );
     }
 
@@ -251,19 +312,21 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     assert( newChunkSize >= aSize );
     assert( newChunkOffset < m_currentSize );
 
+    // Remove the new allocated chunk from the free space pool
+    removeFreeChunk( newChunkOffset, newChunkSize );
+
     // Check if the item was previously stored in the container
     if( itemSize > 0 )
     {
         // The item was reallocated, so we have to copy all the old data to the new place
         memcpy( &m_vertices[newChunkOffset], &m_vertices[m_chunkOffset], itemSize * VERTEX_SIZE );
+        SetDirty( newChunkOffset, itemSize );
 
         // Free the space used by the previous chunk
         addFreeChunk( m_chunkOffset, m_chunkSize );
-    }
 
-    // Remove the new allocated chunk from the free space pool
-    m_freeChunks.erase( newChunk );
-    m_freeSpace -= newChunkSize;
+        m_stats.m_reallocations++;
+    }
 
     m_chunkSize = newChunkSize;
     m_chunkOffset = newChunkOffset;
@@ -335,54 +398,97 @@ void CACHED_CONTAINER::defragment( VERTEX* aTarget )
 }
 
 
-void CACHED_CONTAINER::mergeFreeChunks()
+void CACHED_CONTAINER::resetFreeChunks()
+{
+    // Now there is only one big chunk of free memory
+    m_freeChunks.clear();
+    m_freeChunksByOffset.clear();
+
+    if( m_freeSpace > 0 )
+    {
+        m_freeChunks.emplace( m_freeSpace, m_currentSize - m_freeSpace );
+        m_freeChunksByOffset.emplace( m_currentSize - m_freeSpace, m_freeSpace );
+    }
+
+    m_itemsByOffset.clear();
+
+    for( VERTEX_ITEM* item : m_items )
+        m_itemsByOffset.emplace( item->GetOffset(), item );
+
+    m_maxIndex = usedSpace();
+    m_compacting = false;
+
+    // All the data has moved
+    SetDirty();
+}
+
+
+void CACHED_CONTAINER::compact( unsigned int aMaxVertices )
 {
-    if( m_freeChunks.size() <= 1 ) // There are no chunks that can be merged
+    // Items can only be moved between updates
+    if( m_item || !IsMapped() )
+        return;
+
+    m_maxIndex = m_itemsByOffset.empty() ? 0 : m_itemsByOffset.rbegin()->first
+                                                       + m_itemsByOffset.rbegin()->second->GetSize();
+
+    // Free space between the stored items
+    unsigned int holes = m_maxIndex > usedSpace() ? m_maxIndex - usedSpace() : 0;
+
+    // Start when a significant part of the used range is lost and go on until most of it is
+    // recovered, so the container is not compacted for every deleted item
+    if( !m_compacting && holes > std::max( aMaxVertices, m_maxIndex / 4 ) )
+        m_compacting = true;
+    else if( m_compacting && holes <= m_maxIndex / 16 )
+        m_compacting = false;
+
+    if( !m_compacting )
         return;
 
 #ifdef KICAD_GAL_PROFILE
     PROF_TIMER totalTime;
 #endif /* KICAD_GAL_PROFILE */
 
-    // Reversed free chunks map - this one stores chunk size with its offset as the key
-    std::list<CHUNK> freeChunks;
+    unsigned int moved = 0;
 
-    FREE_CHUNK_MAP::const_iterator it, it_end;
-
-    for( it = m_freeChunks.begin(), it_end = m_freeChunks.end(); it != it_end; ++it )
+    // Move the last items to the smallest free chunks able to store them
+    while( moved < aMaxVertices && !m_itemsByOffset.empty() )
     {
-        freeChunks.emplace_back( it->second, it->first );
-    }
+        auto         last = std::prev( m_itemsByOffset.end() );
+        VERTEX_ITEM* item = last->second;
+        unsigned int itemSize = item->GetSize();
 
-    m_freeChunks.clear();
-    freeChunks.sort();
+        FREE_CHUNK_MAP::iterator chunk = m_freeChunks.lower_bound( CHUNK( itemSize, 0 ) );
 
-    std::list<CHUNK>::const_iterator itf, itf_end;
-    unsigned int                     offset = freeChunks.front().first;
-    unsigned int                     size = freeChunks.front().second;
-    freeChunks.pop_front();
+        // Only the free chunk at the end of the container can be after the last item
+        if( chunk != m_freeChunks.end() && getChunkOffset( *chunk ) > last->first )
+            ++chunk;
 
-    for( itf = freeChunks.begin(), itf_end = freeChunks.end(); itf != itf_end; ++itf )
-    {
-        if( itf->first == offset + size )
+        if( chunk == m_freeChunks.end() || getChunkOffset( *chunk ) > last->first )
         {
-            // These chunks can be merged, so just increase the current chunk size and go on
-            size += itf->second;
+            // The item doesn't fit anywhere; it will be done by the next defragmentation
+            m_compacting = false;
+            break;
         }
-        else
-        {
-            // These chunks cannot be merged
-            // So store the previous one
-            m_freeChunks.insert( std::make_pair( size, offset ) );
 
-            // and let's check the next chunk
-            offset = itf->first;
-            size = itf->second;
-        }
+        unsigned int newOffset = getChunkOffset( *chunk );
+
+        removeFreeChunk( newOffset, itemSize );
+        moveItem( item, newOffset );
+        moved += itemSize;
     }
 
-    // Add the last one
-    m_freeChunks.insert( std::make_pair( size, offset ) );
+    m_stats.m_compactedVertices += moved;
+
+    m_maxIndex = m_itemsByOffset.empty() ? 0 : m_itemsByOffset.rbegin()->first
+                                                       + m_itemsByOffset.rbegin()->second->GetSize();
+
+#ifdef KICAD_GAL_PROFILE
+    totalTime.Stop();
+
+    wxLogTrace( wxT( "KICAD_GAL_CACHED_CONTAINER" ), "Compacted %u vertices / %.1f ms", moved,
+                totalTime.msecs() );
+#endif /* KICAD_GAL_PROFILE */
 
 #if CACHED_CONTAINER_TEST > 0
     test();
@@ -390,13 +496,101 @@ void CACHED_CONTAINER::mergeFreeChunks()
 }
 
 
+std::pair<unsigned int, unsigned int> CACHED_CONTAINER::takeDirtyRange()
+{
+    unsigned int start = 0;
+    unsigned int size = 0;
+
+    if( m_dirty )
+    {
+        // Nothing is stored after m_maxIndex
+        unsigned int end = std::min( m_dirtyEnd, m_maxIndex );
+
+        start = std::min( m_dirtyStart, end );
+        size = end - start;
+    }
+
+    m_stats.m_uploadedBytes = (uint64_t) size * VERTEX_SIZE;
+    m_stats.m_totalUploadedBytes += m_stats.m_uploadedBytes;
+
+    ClearDirty();
+
+    return std::make_pair( start, size );
+}
+
+
 void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
 {
     assert( aOffset + aSize <= m_currentSize );
     assert( aSize > 0 );
 
-    m_freeChunks.insert( std::make_pair( aSize, aOffset ) );
     m_freeSpace += aSize;
+
+    // Merge with the free chunk following the new one
+    auto next = m_freeChunksByOffset.lower_bound( aOffset );
+
+    if( next != m_freeChunksByOffset.end() && next->first == aOffset + aSize )
+    {
+        aSize += next->second;
+        m_freeChunks.erase( CHUNK( next->second, next->first ) );
+        next = m_freeChunksByOffset.erase( next );
+    }
+
+    // Merge with the free chunk preceding the new one
+    if( next != m_freeChunksByOffset.begin() )
+    {
+        auto prev = std::prev( next );
+
+        if( prev->first + prev->second == aOffset )
+        {
+            aOffset = prev->first;
+            aSize += prev->second;
+            m_freeChunks.erase( CHUNK( prev->second, prev->first ) );
+            m_freeChunksByOffset.erase( prev );
+        }
+    }
+
+    m_freeChunks.emplace( aSize, aOffset );
+    m_freeChunksByOffset.emplace( aOffset, aSize );
+}
+
+
+void CACHED_CONTAINER::removeFreeChunk( unsigned int aOffset, unsigned int aSize )
+{
+    auto chunk = m_freeChunksByOffset.find( aOffset );
+
+    assert( chunk != m_freeChunksByOffset.end() );
+    assert( chunk->second >= aSize );
+
+    unsigned int chunkSize = chunk->second;
+
+    m_freeChunks.erase( CHUNK( chunkSize, aOffset ) );
+    m_freeChunksByOffset.erase( chunk );
+    m_freeSpace -= aSize;
+
+    // Keep the end of the chunk as free space
+    if( chunkSize > aSize )
+    {
+        m_freeChunks.emplace( chunkSize - aSize, aOffset + aSize );
+        m_freeChunksByOffset.emplace( aOffset + aSize, chunkSize - aSize );
+    }
+}
+
+
+void CACHED_CONTAINER::moveItem( VERTEX_ITEM* aItem, unsigned int aNewOffset )
+{
+    unsigned int offset = aItem->GetOffset();
+    unsigned int size = aItem->GetSize();
+
+    // The target was free space, so the ranges don't overlap
+    memcpy( &m_vertices[aNewOffset], &m_vertices[offset], size * VERTEX_SIZE );
+    SetDirty( aNewOffset, size );
+
+    m_itemsByOffset.erase( offset );
+    m_itemsByOffset.emplace( aNewOffset, aItem );
+    aItem->setOffset( aNewOffset );
+
+    addFreeChunk( offset, size );
 }
 
 
@@ -79,6 +79,9 @@ CACHED_CONTAINER_GPU::CACHED_CONTAINER_GPU( unsigned int aSize ) :
 
 CACHED_CONTAINER_GPU::~CACHED_CONTAINER_GPU()
 {
+    // The stored items may already be gone, so they must not be moved while unmapping
+    m_itemsByOffset.clear();
+
     if( m_isMapped )
         Unmap();
 
@@ -107,6 +110,10 @@ void CACHED_CONTAINER_GPU::Unmap()
 {
     wxCHECK( IsMapped(), /*void*/ );
 
+    // Items can only be moved while the buffer is mapped
+    compact( COMPACTION_STEP );
+    takeDirtyRange();
+
     // This gets called from ~CACHED_CONTAINER_GPU.  To avoid throwing an exception from
     // the dtor, catch it here instead.
     try
@@ -222,9 +229,7 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
 
     KI_TRACE( traceGalProfile, "VBO size %d used %d\n", m_currentSize, AllItemsSize() );
 
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    resetFreeChunks();
 
     return true;
 }
@@ -290,9 +295,7 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
 
     KI_TRACE( traceGalProfile, "VBO size %d used: %d \n", m_currentSize, AllItemsSize() );
 
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    resetFreeChunks();
 
     return true;
 }
@@ -54,10 +54,14 @@ static const wxChar* const traceGalCachedContainer = wxT( "KICAD_GAL_CACHED_CONT
 
 CACHED_CONTAINER_RAM::CACHED_CONTAINER_RAM( unsigned int aSize ) :
         CACHED_CONTAINER( aSize ),
-        m_verticesBuffer( 0 )
+        m_verticesBuffer( 0 ),
+        m_bufferSize( 0 )
 {
-    glGenBuffers( 1, &m_verticesBuffer );
-    checkGlError( "generating vertices buffer", __FILE__, __LINE__ );
+    if( glGenBuffers )
+    {
+        glGenBuffers( 1, &m_verticesBuffer );
+        checkGlError( "generating vertices buffer", __FILE__, __LINE__ );
+    }
 
     m_vertices = static_cast<VERTEX*>( malloc( aSize * VERTEX_SIZE ) );
 
@@ -77,14 +81,43 @@ CACHED_CONTAINER_RAM::~CACHED_CONTAINER_RAM()
 
 void CACHED_CONTAINER_RAM::Unmap()
 {
+    compact( COMPACTION_STEP );
+
+    bool resized = m_bufferSize != m_currentSize;
+
+    // A new buffer has to be filled entirely
+    if( resized )
+        SetDirty();
+
     if( !m_dirty )
+    {
+        m_stats.m_uploadedBytes = 0;
         return;
+    }
 
-    // Upload vertices coordinates and shader types to GPU memory
+    std::pair<unsigned int, unsigned int> range = takeDirtyRange();
+    m_bufferSize = m_currentSize;
+
+    if( !m_verticesBuffer )
+        return;
+
+    // Upload only the modified vertices to GPU memory; the buffer is kept between updates
     glBindBuffer( GL_ARRAY_BUFFER, m_verticesBuffer );
     checkGlError( "binding vertices buffer", __FILE__, __LINE__ );
-    glBufferData( GL_ARRAY_BUFFER, m_maxIndex * VERTEX_SIZE, m_vertices, GL_STREAM_DRAW );
-    checkGlError( "transferring vertices", __FILE__, __LINE__ );
+
+    if( resized )
+    {
+        glBufferData( GL_ARRAY_BUFFER, m_currentSize * VERTEX_SIZE, nullptr, GL_DYNAMIC_DRAW );
+        checkGlError( "resizing vertices buffer", __FILE__, __LINE__ );
+    }
+
+    if( range.second > 0 )
+    {
+        glBufferSubData( GL_ARRAY_BUFFER, range.first * VERTEX_SIZE, range.second * VERTEX_SIZE,
+                         &m_vertices[range.first] );
+        checkGlError( "transferring vertices", __FILE__, __LINE__ );
+    }
+
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
     checkGlError( "unbinding vertices buffer", __FILE__, __LINE__ );
 }
@@ -125,10 +158,7 @@ bool CACHED_CONTAINER_RAM::defragmentResize( unsigned int aNewSize )
     m_freeSpace += ( aNewSize - m_currentSize );
     m_currentSize = aNewSize;
 
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
-    m_dirty = true;
+    resetFreeChunks();
 
     return true;
 }
@@ -228,6 +228,15 @@ void GPU_CACHED_MANAGER::EndDrawing()
               cached->AllItemsSize(), m_vranges.size(), m_indexBufMaxSize, drawCalls );
     KI_TRACE( traceGalProfile, "Timing: %s\n", cntDraw.to_string() );
 
+    CACHED_CONTAINER::STATS stats = cached->GetStats();
+
+    KI_TRACE( traceGalProfile,
+              "Cached container: size %u used %u free chunks %u fragmentation %.2f "
+              "uploaded %llu bytes compacted %llu vertices resizes %u\n",
+              stats.m_size, stats.m_used, stats.m_freeChunks, stats.m_fragmentation,
+              (unsigned long long) stats.m_uploadedBytes,
+              (unsigned long long) stats.m_compactedVertices, stats.m_resizes );
+
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
     cached->ClearDirty();
 
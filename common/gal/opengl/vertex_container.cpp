@@ -63,7 +63,9 @@ VERTEX_CONTAINER::VERTEX_CONTAINER( unsigned int aSize ) :
         m_initialSize( aSize ),
         m_vertices( nullptr ),
         m_failed( false ),
-        m_dirty( true )
+        m_dirty( true ),
+        m_dirtyStart( 0 ),
+        m_dirtyEnd( std::numeric_limits<unsigned int>::max() )
 {
 }
 
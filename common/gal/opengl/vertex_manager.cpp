@@ -50,12 +50,18 @@ static const wxChar traceVertexManager[] = wxT( "KICAD_VERTEX_MANAGER" );
 using namespace KIGFX;
 
 VERTEX_MANAGER::VERTEX_MANAGER( bool aCached ) :
+        VERTEX_MANAGER( VERTEX_CONTAINER::MakeContainer( aCached ) )
+{
+}
+
+
+VERTEX_MANAGER::VERTEX_MANAGER( VERTEX_CONTAINER* aContainer ) :
         m_noTransform( true ),
         m_transform( 1.0f ),
         m_reserved( nullptr ),
         m_reservedSpace( 0 )
 {
-    m_container.reset( VERTEX_CONTAINER::MakeContainer( aCached ) );
+    m_container.reset( aContainer );
     m_gpu.reset( GPU_MANAGER::MakeManager( m_container.get() ) );
 
     // There is no shader used by default
@@ -217,7 +223,7 @@ void VERTEX_MANAGER::ChangeItemColor( const VERTEX_ITEM& aItem, const COLOR4D& a
         vertex++;
     }
 
-    m_container->SetDirty();
+    m_container->SetDirty( offset, size );
 }
 
 
@@ -234,7 +240,7 @@ void VERTEX_MANAGER::ChangeItemDepth( const VERTEX_ITEM& aItem, GLfloat aDepth )
         vertex++;
     }
 
-    m_container->SetDirty();
+    m_container->SetDirty( offset, size );
 }
 
 
@@ -0,0 +1,486 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <gal/recording_gal.h>
+
+#include <font/glyph.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+#include <memory>
+
+using namespace KIGFX;
+
+
+static std::unique_ptr<KIFONT::GLYPH> copyGlyph( const KIFONT::GLYPH& aGlyph )
+{
+    if( aGlyph.IsOutline() )
+    {
+        return std::make_unique<KIFONT::OUTLINE_GLYPH>(
+                static_cast<const KIFONT::OUTLINE_GLYPH&>( aGlyph ) );
+    }
+    else if( aGlyph.IsStroke() )
+    {
+        return std::make_unique<KIFONT::STROKE_GLYPH>(
+                static_cast<const KIFONT::STROKE_GLYPH&>( aGlyph ) );
+    }
+
+    return nullptr;
+}
+
+
+void GAL_DISPLAY_LIST::Replay( GAL& aGal ) const
+{
+    for( const std::function<void( GAL& )>& command : m_commands )
+        command( aGal );
+}
+
+
+RECORDING_GAL::RECORDING_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, GAL& aTarget ) :
+        GAL( aDisplayOptions ),
+        m_isCairoEngine( aTarget.IsCairoEngine() ),
+        m_isOpenGlEngine( aTarget.IsOpenGlEngine() ),
+        m_stateValid( false ),
+        m_recordedIsFill( false ),
+        m_recordedIsStroke( false ),
+        m_recordedLineWidth( 0.0f ),
+        m_recordedMinLineWidth( 0.0f ),
+        m_recordedLayerDepth( 0.0 )
+{
+    // Painters query the view parameters to size some features (e.g. net names, markers)
+    SetScreenSize( aTarget.GetScreenPixelSize() );
+    SetScreenDPI( aTarget.GetScreenDPI() );
+    SetLookAtPoint( aTarget.GetLookAtPoint() );
+    SetZoomFactor( aTarget.GetZoomFactor() );
+    SetRotation( aTarget.GetRotation() );
+    SetFlip( aTarget.IsFlippedX(), aTarget.IsFlippedY() );
+    SetDepthRange( VECTOR2D( aTarget.GetMinDepth(), aTarget.GetMaxDepth() ) );
+    SetWorldScreenMatrix( aTarget.GetWorldScreenMatrix() );
+
+    m_screenWorldMatrix = aTarget.GetScreenWorldMatrix();
+    m_worldScale = aTarget.GetWorldScale();
+}
+
+
+void RECORDING_GAL::BeginRecording( double aLayerDepth )
+{
+    m_list.m_commands.clear();
+    m_stateValid = false;
+
+    SetLayerDepth( aLayerDepth );
+}
+
+
+GAL_DISPLAY_LIST RECORDING_GAL::EndRecording()
+{
+    GAL_DISPLAY_LIST list = std::move( m_list );
+
+    m_list.m_commands.clear();
+    m_stateValid = false;
+
+    return list;
+}
+
+
+void RECORDING_GAL::record( std::function<void( GAL& )>&& aCommand )
+{
+    std::vector<std::function<void( GAL& )>>& commands = m_list.m_commands;
+
+    // The first command of a list sets all the attributes, so the playback does not depend on
+    // the state left by whatever was drawn before on the target
+    if( !m_stateValid || m_recordedIsFill != m_isFillEnabled )
+    {
+        commands.emplace_back( [isFill = m_isFillEnabled]( GAL& aGal )
+                               {
+                                   aGal.SetIsFill( isFill );
+                               } );
+        m_recordedIsFill = m_isFillEnabled;
+    }
+
+    if( !m_stateValid || m_recordedIsStroke != m_isStrokeEnabled )
+    {
+        commands.emplace_back( [isStroke = m_isStrokeEnabled]( GAL& aGal )
+                               {
+                                   aGal.SetIsStroke( isStroke );
+                               } );
+        m_recordedIsStroke = m_isStrokeEnabled;
+    }
+
+    if( !m_stateValid || m_recordedFillColor != m_fillColor )
+    {
+        commands.emplace_back( [color = m_fillColor]( GAL& aGal )
+                               {
+                                   aGal.SetFillColor( color );
+                               } );
+        m_recordedFillColor = m_fillColor;
+    }
+
+    if( !m_stateValid || m_recordedStrokeColor != m_strokeColor )
+    {
+        commands.emplace_back( [color = m_strokeColor]( GAL& aGal )
+                               {
+                                   aGal.SetStrokeColor( color );
+                               } );
+        m_recordedStrokeColor = m_strokeColor;
+    }
+
+    if( !m_stateValid || m_recordedLineWidth != m_lineWidth )
+    {
+        commands.emplace_back( [width = m_lineWidth]( GAL& aGal )
+                               {
+                                   aGal.SetLineWidth( width );
+                               } );
+        m_recordedLineWidth = m_lineWidth;
+    }
+
+    if( !m_stateValid || m_recordedMinLineWidth != m_minLineWidth )
+    {
+        commands.emplace_back( [width = m_minLineWidth]( GAL& aGal )
+                               {
+                                   aGal.SetMinLineWidth( width );
+                               } );
+        m_recordedMinLineWidth = m_minLineWidth;
+    }
+
+    if( !m_stateValid || m_recordedLayerDepth != m_layerDepth )
+    {
+        commands.emplace_back( [depth = m_layerDepth]( GAL& aGal )
+                               {
+                                   aGal.SetLayerDepth( depth );
+                               } );
+        m_recordedLayerDepth = m_layerDepth;
+    }
+
+    m_stateValid = true;
+    commands.push_back( std::move( aCommand ) );
+}
+
+
+void RECORDING_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawLine( aStartPoint, aEndPoint );
+            } );
+}
+
+
+void RECORDING_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                                 double aWidth )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawSegment( aStartPoint, aEndPoint, aWidth );
+            } );
+}
+
+
+void RECORDING_GAL::DrawSegmentChain( const std::vector<VECTOR2D>& aPointList, double aWidth )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawSegmentChain( aPointList, aWidth );
+            } );
+}
+
+
+void RECORDING_GAL::DrawSegmentChain( const SHAPE_LINE_CHAIN& aLineChain, double aWidth )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawSegmentChain( aLineChain, aWidth );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawPolyline( aPointList );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolyline( const std::vector<VECTOR2D>& aPointList )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawPolyline( aPointList );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
+{
+    std::vector<VECTOR2D> points( aPointList, aPointList + aListSize );
+
+    record( [points = std::move( points )]( GAL& aGal )
+            {
+                aGal.DrawPolyline( points.data(), (int) points.size() );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawPolyline( aLineChain );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawPolylines( aPointLists );
+            } );
+}
+
+
+void RECORDING_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawCircle( aCenterPoint, aRadius );
+            } );
+}
+
+
+void RECORDING_GAL::DrawHoleWall( const VECTOR2D& aCenterPoint, double aHoleRadius,
+                                  double aWallWidth )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawHoleWall( aCenterPoint, aHoleRadius, aWallWidth );
+            } );
+}
+
+
+void RECORDING_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius,
+                             const EDA_ANGLE& aStartAngle, const EDA_ANGLE& aAngle )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawArc( aCenterPoint, aRadius, aStartAngle, aAngle );
+            } );
+}
+
+
+void RECORDING_GAL::DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadius,
+                                    const EDA_ANGLE& aStartAngle, const EDA_ANGLE& aAngle,
+                                    double aWidth, double aMaxError )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawArcSegment( aCenterPoint, aRadius, aStartAngle, aAngle, aWidth,
+                                     aMaxError );
+            } );
+}
+
+
+void RECORDING_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawRectangle( aStartPoint, aEndPoint );
+            } );
+}
+
+
+void RECORDING_GAL::DrawGlyph( const KIFONT::GLYPH& aGlyph, int aNth, int aTotal )
+{
+    std::shared_ptr<KIFONT::GLYPH> glyph = copyGlyph( aGlyph );
+
+    if( !glyph )
+        return;
+
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawGlyph( *glyph, aNth, aTotal );
+            } );
+}
+
+
+void RECORDING_GAL::DrawGlyphs( const std::vector<std::unique_ptr<KIFONT::GLYPH>>& aGlyphs )
+{
+    // Recorded as a whole: some GALs draw a run of glyphs faster than the glyphs one by one
+    auto glyphs = std::make_shared<std::vector<std::unique_ptr<KIFONT::GLYPH>>>();
+
+    glyphs->reserve( aGlyphs.size() );
+
+    for( const std::unique_ptr<KIFONT::GLYPH>& glyph : aGlyphs )
+    {
+        if( std::unique_ptr<KIFONT::GLYPH> copy = copyGlyph( *glyph ) )
+            glyphs->push_back( std::move( copy ) );
+    }
+
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawGlyphs( *glyphs );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawPolygon( aPointList );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolygon( const VECTOR2D aPointList[], int aListSize )
+{
+    std::vector<VECTOR2D> points( aPointList, aPointList + aListSize );
+
+    record( [points = std::move( points )]( GAL& aGal )
+            {
+                aGal.DrawPolygon( points.data(), (int) points.size() );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolygon( const SHAPE_POLY_SET& aPolySet, bool aStrokeTriangulation )
+{
+    // Zone fills can be large, share the copy between the copies of the command
+    auto polySet = std::make_shared<SHAPE_POLY_SET>( aPolySet );
+
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawPolygon( *polySet, aStrokeTriangulation );
+            } );
+}
+
+
+void RECORDING_GAL::DrawPolygon( const SHAPE_LINE_CHAIN& aPolySet )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawPolygon( aPolySet );
+            } );
+}
+
+
+void RECORDING_GAL::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
+                               const VECTOR2D& aControlPointB, const VECTOR2D& aEndPoint,
+                               double aFilterValue )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawCurve( aStartPoint, aControlPointA, aControlPointB, aEndPoint,
+                                aFilterValue );
+            } );
+}
+
+
+void RECORDING_GAL::DrawBitmap( const BITMAP_BASE& aBitmap, double alphaBlend )
+{
+    const BITMAP_BASE* bitmap = &aBitmap;
+
+    record( [=]( GAL& aGal )
+            {
+                aGal.DrawBitmap( *bitmap, alphaBlend );
+            } );
+}
+
+
+void RECORDING_GAL::BitmapText( const wxString& aText, const VECTOR2I& aPosition,
+                                const EDA_ANGLE& aAngle )
+{
+    VECTOR2I          size = GetGlyphSize();
+    bool              bold = IsFontBold();
+    bool              italic = IsFontItalic();
+    bool              underlined = IsFontUnderlined();
+    bool              mirrored = IsTextMirrored();
+    GR_TEXT_H_ALIGN_T hAlign = GetHorizontalJustify();
+    GR_TEXT_V_ALIGN_T vAlign = GetVerticalJustify();
+
+    record( [=]( GAL& aGal )
+            {
+                aGal.SetGlyphSize( size );
+                aGal.SetFontBold( bold );
+                aGal.SetFontItalic( italic );
+                aGal.SetFontUnderlined( underlined );
+                aGal.SetTextMirrored( mirrored );
+                aGal.SetHorizontalJustify( hAlign );
+                aGal.SetVerticalJustify( vAlign );
+                aGal.BitmapText( aText, aPosition, aAngle );
+            } );
+}
+
+
+void RECORDING_GAL::Transform( const MATRIX3x3D& aTransformation )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.Transform( aTransformation );
+            } );
+}
+
+
+void RECORDING_GAL::Rotate( double aAngle )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.Rotate( aAngle );
+            } );
+}
+
+
+void RECORDING_GAL::Translate( const VECTOR2D& aTranslation )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.Translate( aTranslation );
+            } );
+}
+
+
+void RECORDING_GAL::Scale( const VECTOR2D& aScale )
+{
+    record( [=]( GAL& aGal )
+            {
+                aGal.Scale( aScale );
+            } );
+}
+
+
+void RECORDING_GAL::Save()
+{
+    record( []( GAL& aGal )
+            {
+                aGal.Save();
+            } );
+}
+
+
+void RECORDING_GAL::Restore()
+{
+    record( []( GAL& aGal )
+            {
+                aGal.Restore();
+            } );
+}
@@ -29,6 +29,7 @@
 #include <macros.h>
 #include <math/util.h>      // for KiROUND
 #include <trigo.h>
+#include <hash.h>
 #include <wx/log.h>
 #include <cstdio>
 #include <fmt/format.h>
@@ -91,6 +92,45 @@ static bool polyCompare( const std::vector<VECTOR2I>& aPolygon,
 }
 
 
+// Polygons are compared with a tolerance (see polyCompare()), so they cannot be looked up by
+// a hash of their coordinates.  They are indexed by the grid cell of their first corner
+// instead: as the cells are larger than the tolerance, a similar polygon has its first corner
+// in the same cell or in one of the 8 neighbouring cells.
+static const int POLY_LOOKUP_CELL_SIZE = 16;
+
+
+static VECTOR2I polyLookupCell( const std::vector<VECTOR2I>& aPolygon )
+{
+    if( aPolygon.empty() )
+        return VECTOR2I( 0, 0 );
+
+    auto floorDiv =
+            []( int aValue )
+            {
+                return aValue >= 0 ? aValue / POLY_LOOKUP_CELL_SIZE
+                                   : ( aValue + 1 ) / POLY_LOOKUP_CELL_SIZE - 1;
+            };
+
+    return VECTOR2I( floorDiv( aPolygon[0].x ), floorDiv( aPolygon[0].y ) );
+}
+
+
+/**
+ * Call aFunc with the lookup cell of aPolygon and its neighbours.
+ */
+template <typename Func>
+static void forEachPolyLookupCell( const std::vector<VECTOR2I>& aPolygon, Func&& aFunc )
+{
+    VECTOR2I cell = polyLookupCell( aPolygon );
+
+    for( int dx = -1; dx <= 1; ++dx )
+    {
+        for( int dy = -1; dy <= 1; ++dy )
+            aFunc( VECTOR2I( cell.x + dx, cell.y + dy ) );
+    }
+}
+
+
 GERBER_PLOTTER::GERBER_PLOTTER()
 {
     workFile  = nullptr;
@@ -261,6 +301,13 @@ bool GERBER_PLOTTER::StartPlot( const wxString& aPageNumber )
     if( m_outputFile == nullptr )
         return false;
 
+    // Gerber files are written one short command at a time: use large buffers to keep the
+    // number of actual writes low
+    m_workFileBuffer.resize( FILE_BUFFER_SIZE );
+    m_finalFileBuffer.resize( FILE_BUFFER_SIZE );
+    setvbuf( workFile, m_workFileBuffer.data(), _IOFBF, m_workFileBuffer.size() );
+    setvbuf( finalFile, m_finalFileBuffer.data(), _IOFBF, m_finalFileBuffer.size() );
+
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
         if( ! m_headerExtraLines[ii].IsEmpty() )
@@ -330,10 +377,13 @@ bool GERBER_PLOTTER::EndPlot()
     fclose( workFile );
     workFile   = wxFopen( m_workFilename, wxT( "rt" ));
     wxASSERT( workFile );
+    setvbuf( workFile, m_workFileBuffer.data(), _IOFBF, m_workFileBuffer.size() );
     m_outputFile = finalFile;
 
+    bool apertureListDone = false;
+
     // Placement of apertures in RS274X
-    while( fgets( line, 1024, workFile ) )
+    while( !apertureListDone && fgets( line, 1024, workFile ) )
     {
         fmt::print( m_outputFile, "{}", line );
 
@@ -385,9 +435,16 @@ bool GERBER_PLOTTER::EndPlot()
 
             writeApertureList();
             fmt::println( m_outputFile, "G04 APERTURE END LIST*" );
+            apertureListDone = true;
         }
     }
 
+    // The remaining lines are copied as is
+    size_t count;
+
+    while( ( count = fread( line, 1, sizeof( line ), workFile ) ) > 0 )
+        fwrite( line, 1, count, m_outputFile );
+
     fclose( workFile );
     fclose( finalFile );
     ::wxRemoveFile( m_workFilename );
@@ -426,23 +483,32 @@ int GERBER_PLOTTER::GetOrCreateAperture( const VECTOR2I& aSize, int aRadius,
                                          int                aApertureAttribute,
                                          const std::string& aCustomAttribute )
 {
-    int last_D_code = 9;
+    int    last_D_code = m_apertures.empty() ? 9 : m_apertures.back().m_DCode;
+    size_t key = hash_val( static_cast<int>( aType ), aSize.x, aSize.y, aRadius,
+                           aRotation.AsDegrees() + 0.0 /* no -0.0 */, aApertureAttribute,
+                           aCustomAttribute );
 
     // Search an existing aperture
-    for( int idx = 0; idx < (int)m_apertures.size(); ++idx )
+    auto [first, last] = m_apertureLookup.equal_range( key );
+    int  found = -1;
+
+    for( auto it = first; it != last; ++it )
     {
-        APERTURE* tool = &m_apertures[idx];
-        last_D_code = tool->m_DCode;
+        APERTURE* tool = &m_apertures[it->second];
 
         if( ( tool->m_Type == aType ) && ( tool->m_Size == aSize ) && ( tool->m_Radius == aRadius )
             && ( tool->m_Rotation == aRotation )
             && ( tool->m_ApertureAttribute == aApertureAttribute )
             && ( tool->m_CustomAttribute == aCustomAttribute ) )
         {
-            return idx;
+            if( found < 0 || it->second < found )
+                found = it->second;
         }
     }
 
+    if( found >= 0 )
+        return found;
+
     // Allocate a new aperture
     APERTURE new_tool;
     new_tool.m_Size     = aSize;
@@ -454,6 +520,7 @@ int GERBER_PLOTTER::GetOrCreateAperture( const VECTOR2I& aSize, int aRadius,
     new_tool.m_CustomAttribute = aCustomAttribute;
 
     m_apertures.push_back( std::move( new_tool ) );
+    m_apertureLookup.emplace( key, (int) m_apertures.size() - 1 );
 
     return m_apertures.size() - 1;
 }
@@ -464,7 +531,7 @@ int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<VECTOR2I>& aCorners,
                                          int                aApertureAttribute,
                                          const std::string& aCustomAttribute )
 {
-    int last_D_code = 9;
+    int last_D_code = m_apertures.empty() ? 9 : m_apertures.back().m_DCode;
 
     // For APERTURE::AM_FREE_POLYGON aperture macros, we need to create the macro
     // on the fly, because due to the fact the vertex count is not a constant we
@@ -477,25 +544,41 @@ int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<VECTOR2I>& aCorners,
             m_am_freepoly_list.Append( aCorners );
     }
 
+    auto cornersKey =
+            [&]( const VECTOR2I& aCell )
+            {
+                return hash_val( static_cast<int>( aType ), aCorners.size(), aCell.x, aCell.y,
+                                 aRotation.AsDegrees() + 0.0 /* no -0.0 */, aApertureAttribute,
+                                 aCustomAttribute );
+            };
+
     // Search an existing aperture
-    for( int idx = 0; idx < (int)m_apertures.size(); ++idx )
-    {
-        APERTURE* tool = &m_apertures[idx];
+    int found = -1;
 
-        last_D_code = tool->m_DCode;
+    forEachPolyLookupCell( aCorners,
+            [&]( const VECTOR2I& aCell )
+            {
+                auto [first, last] = m_apertureLookup.equal_range( cornersKey( aCell ) );
 
-        if( ( tool->m_Type == aType ) && ( tool->m_Corners.size() == aCorners.size() )
-            && ( tool->m_Rotation == aRotation )
-            && ( tool->m_ApertureAttribute == aApertureAttribute )
-            && ( tool->m_CustomAttribute == aCustomAttribute ) )
-        {
-            // A candidate is found. the corner lists must be similar
-            bool is_same = polyCompare( tool->m_Corners, aCorners );
+                for( auto it = first; it != last; ++it )
+                {
+                    APERTURE* tool = &m_apertures[it->second];
+
+                    if( ( tool->m_Type == aType ) && ( tool->m_Corners.size() == aCorners.size() )
+                        && ( tool->m_Rotation == aRotation )
+                        && ( tool->m_ApertureAttribute == aApertureAttribute )
+                        && ( tool->m_CustomAttribute == aCustomAttribute )
+                        && ( found < 0 || it->second < found ) )
+                    {
+                        // A candidate is found. the corner lists must be similar
+                        if( polyCompare( tool->m_Corners, aCorners ) )
+                            found = it->second;
+                    }
+                }
+            } );
 
-            if( is_same )
-                return idx;
-        }
-    }
+    if( found >= 0 )
+        return found;
 
     // Allocate a new aperture
     APERTURE new_tool;
@@ -510,6 +593,8 @@ int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<VECTOR2I>& aCorners,
     new_tool.m_CustomAttribute = aCustomAttribute;
 
     m_apertures.push_back( std::move( new_tool ) );
+    m_apertureLookup.emplace( cornersKey( polyLookupCell( aCorners ) ),
+                              (int) m_apertures.size() - 1 );
 
     return m_apertures.size() - 1;
 }
@@ -1013,6 +1098,88 @@ void GERBER_PLOTTER::PlotGerberRegion( const SHAPE_LINE_CHAIN& aPoly, GBR_METADA
 }
 
 
+void GERBER_PLOTTER::PlotGerberRegion( const SHAPE_POLY_SET& aPolys, GBR_METADATA* aGbrMetadata )
+{
+    bool hasContour = false;
+
+    for( int idx = 0; idx < aPolys.OutlineCount() && !hasContour; ++idx )
+        hasContour = aPolys.COutline( idx ).PointCount() > 2;
+
+    if( !hasContour )
+        return;
+
+    bool clearTA_AperFunction = false;     // true if a TA.AperFunction is used
+
+    if( aGbrMetadata )
+    {
+        std::string attrib = aGbrMetadata->m_ApertureMetadata.FormatAttribute( !m_useX2format );
+
+        if( !attrib.empty() )
+        {
+            fmt::print( m_outputFile, "{}", attrib );
+            clearTA_AperFunction = true;
+        }
+
+        formatNetAttribute( &aGbrMetadata->m_NetlistMetadata );
+    }
+
+    // A region can hold any number of contours, each one starting with a D02 move
+    fmt::println( m_outputFile, "G36*" );
+
+    for( int idx = 0; idx < aPolys.OutlineCount(); ++idx )
+    {
+        const SHAPE_LINE_CHAIN& outline = aPolys.COutline( idx );
+
+        if( outline.PointCount() > 2 )
+            writeRegionContour( outline );
+    }
+
+    fmt::println( m_outputFile, "G37*" );
+
+    // Clear the TA attribute, to avoid the next item to inherit it:
+    if( clearTA_AperFunction )
+    {
+        if( m_useX2format )
+            fmt::println( m_outputFile, "%TD.AperFunction*%" );
+        else
+            fmt::println( m_outputFile, "G04 #@! TD.AperFunction*" );
+    }
+}
+
+
+void GERBER_PLOTTER::writeRegionContour( const SHAPE_LINE_CHAIN& aPoly )
+{
+    MoveTo( VECTOR2I( aPoly.CPoint( 0 ) ) );
+
+    fmt::println( m_outputFile, "G01*" ); // Set linear interpolation.
+
+    for( int ii = 1; ii < aPoly.PointCount(); ii++ )
+    {
+        int arcindex = aPoly.ArcIndex( ii );
+
+        if( arcindex < 0 )
+        {
+            /// Plain point
+            LineTo( VECTOR2I( aPoly.CPoint( ii ) ) );
+        }
+        else
+        {
+            const SHAPE_ARC& arc = aPoly.Arc( arcindex );
+
+            plotArc( arc, true );
+
+            // skip points on arcs, since we plot the arc itself
+            while( ii+1 < aPoly.PointCount() && arcindex == aPoly.ArcIndex( ii+1 ) )
+                ii++;
+        }
+    }
+
+    // If the polygon is not closed, close it:
+    if( aPoly.CPoint( 0 ) != aPoly.CLastPoint() )
+        FinishTo( VECTOR2I( aPoly.CPoint( 0 ) ) );
+}
+
+
 void GERBER_PLOTTER::PlotGerberRegion( const std::vector<VECTOR2I>& aCornerList,
                                        GBR_METADATA* aGbrMetadata )
 {
@@ -1075,36 +1242,7 @@ void GERBER_PLOTTER::PlotPoly( const SHAPE_LINE_CHAIN& aPoly, FILL_T aFill, int
     if( aFill != FILL_T::NO_FILL )
     {
         fmt::println( m_outputFile, "G36*" );
-
-        MoveTo( VECTOR2I( aPoly.CPoint( 0 ) ) );
-
-        fmt::println( m_outputFile, "G01*" ); // Set linear interpolation.
-
-        for( int ii = 1; ii < aPoly.PointCount(); ii++ )
-        {
-            int arcindex = aPoly.ArcIndex( ii );
-
-            if( arcindex < 0 )
-            {
-                /// Plain point
-                LineTo( VECTOR2I( aPoly.CPoint( ii ) ) );
-            }
-            else
-            {
-                const SHAPE_ARC& arc = aPoly.Arc( arcindex );
-
-                plotArc( arc, true );
-
-                // skip points on arcs, since we plot the arc itself
-                while( ii+1 < aPoly.PointCount() && arcindex == aPoly.ArcIndex( ii+1 ) )
-                    ii++;
-            }
-        }
-
-        // If the polygon is not closed, close it:
-        if( aPoly.CPoint( 0 ) != aPoly.CLastPoint() )
-            FinishTo( VECTOR2I( aPoly.CPoint( 0 ) ) );
-
+        writeRegionContour( aPoly );
         fmt::println( m_outputFile, "G37*" );
     }
     else if( aWidth != 0 )    // Draw the polyline/polygon outline
@@ -1899,17 +2037,32 @@ void APER_MACRO_FREEPOLY_LIST::Format( FILE * aOutput, double aIu2GbrMacroUnit )
 
 void APER_MACRO_FREEPOLY_LIST::Append( const std::vector<VECTOR2I>& aPolygon )
 {
+    VECTOR2I cell = polyLookupCell( aPolygon );
+
+    m_lookup.emplace( hash_val( aPolygon.size(), cell.x, cell.y ), AmCount() );
     m_AMList.emplace_back( aPolygon, AmCount() );
 }
 
 
 int APER_MACRO_FREEPOLY_LIST::FindAm( const std::vector<VECTOR2I>& aPolygon ) const
 {
-    for( int idx = 0; idx < AmCount(); idx++ )
-    {
-        if( m_AMList[idx].IsSamePoly( aPolygon ) )
-            return idx;
-    }
+    int found = -1;
+
+    forEachPolyLookupCell( aPolygon,
+            [&]( const VECTOR2I& aCell )
+            {
+                auto [first, last] = m_lookup.equal_range( hash_val( aPolygon.size(), aCell.x,
+                                                                     aCell.y ) );
+
+                for( auto it = first; it != last; ++it )
+                {
+                    if( ( found < 0 || it->second < found )
+                            && m_AMList[it->second].IsSamePoly( aPolygon ) )
+                    {
+                        found = it->second;
+                    }
+                }
+            } );
 
-    return -1;
+    return found;
 }
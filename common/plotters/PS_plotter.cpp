@@ -203,8 +203,8 @@ void PSLIKE_PLOTTER::FlashPadCustom( const VECTOR2I& aPadPos, const VECTOR2I& aS
 void PSLIKE_PLOTTER::FlashPadTrapez( const VECTOR2I& aPadPos, const VECTOR2I* aCorners,
                                      const EDA_ANGLE& aPadOrient, void* aData )
 {
-    static std::vector<VECTOR2I> cornerList;
-    cornerList.clear();
+    std::vector<VECTOR2I> cornerList;
+    cornerList.reserve( 5 );
 
     for( int ii = 0; ii < 4; ii++ )
         cornerList.push_back( aCorners[ii] );
@@ -38,7 +38,12 @@
 #include <gal/definitions.h>
 #include <gal/graphics_abstraction_layer.h>
 #include <gal/painter.h>
+#include <gal/recording_gal.h>
+#include <advanced_config.h>
+#include <thread_pool.h>
 #include <algorithm>
+#include <atomic>
+#include <future>
 
 #include <core/profile.h>
 
@@ -1235,7 +1240,16 @@ void VIEW::clearGroupCache()
 }
 
 
-void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
+struct VIEW::RECORDED_LAYER
+{
+    int              layer;
+    bool             drawn;      ///< False if the painter left the item to VIEW_ITEM::ViewDraw()
+    GAL_DISPLAY_LIST commands;
+};
+
+
+void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags,
+                           const std::vector<RECORDED_LAYER>* aRecorded )
 {
     if( aUpdateFlags & INITIAL_ADD )
     {
@@ -1261,7 +1275,23 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         if( IsCached( layer ) )
         {
             if( aUpdateFlags & ( GEOMETRY | LAYERS | REPAINT ) )
-                updateItemGeometry( aItem, layer );
+            {
+                const RECORDED_LAYER* recorded = nullptr;
+
+                if( aRecorded )
+                {
+                    auto it = std::find_if( aRecorded->begin(), aRecorded->end(),
+                                            [layer]( const RECORDED_LAYER& aEntry )
+                                            {
+                                                return aEntry.layer == layer;
+                                            } );
+
+                    if( it != aRecorded->end() )
+                        recorded = &*it;
+                }
+
+                updateItemGeometry( aItem, layer, recorded );
+            }
             else if( aUpdateFlags & COLOR )
                 updateItemColor( aItem, layer );
         }
@@ -1307,7 +1337,7 @@ void VIEW::updateItemColor( VIEW_ITEM* aItem, int aLayer )
 }
 
 
-void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
+void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer, const RECORDED_LAYER* aRecorded )
 {
     VIEW_ITEM_DATA* viewData = aItem->viewPrivData();
 
@@ -1337,8 +1367,17 @@ void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
     group = m_gal->BeginGroup();
     viewData->setGroup( aLayer, group );
 
-    if( !m_painter->Draw( aItem, aLayer ) )
+    if( aRecorded )
+    {
+        aRecorded->commands.Replay( *m_gal );
+
+        if( !aRecorded->drawn )
+            aItem->ViewDraw( aLayer, this ); // Alternative drawing method
+    }
+    else if( !m_painter->Draw( aItem, aLayer ) )
+    {
         aItem->ViewDraw( aLayer, this ); // Alternative drawing method
+    }
 
     m_gal->EndGroup();
 }
@@ -1465,6 +1504,116 @@ void VIEW::RecacheAllItems()
 }
 
 
+std::vector<std::vector<VIEW::RECORDED_LAYER>>
+VIEW::recordItems( const std::vector<VIEW_ITEM*>& aItems )
+{
+    // Below this count, the thread pool overhead is not worth it
+    const size_t minItemCount = 256;
+
+    // Items handed to a worker at once.  Small enough to balance the load when some items
+    // (e.g. zones) are much longer to paint than the other ones.
+    const size_t chunkSize = 32;
+
+    std::vector<std::vector<RECORDED_LAYER>> recorded;
+
+    if( !ADVANCED_CFG::GetCfg().m_ParallelViewRecache || !m_painter
+            || aItems.size() < minItemCount )
+        return recorded;
+
+    auto needsGeometry =
+            []( VIEW_ITEM* aItem )
+            {
+                int flags = aItem->viewPrivData()->m_requiredUpdate;
+
+                return ( flags & ( INITIAL_ADD | GEOMETRY | LAYERS | REPAINT ) ) != 0;
+            };
+
+    if( (size_t) std::count_if( aItems.begin(), aItems.end(), needsGeometry ) < minItemCount )
+        return recorded;
+
+    thread_pool& tp = GetKiCadThreadPool();
+    size_t       threadCount = std::min<size_t>( tp.get_thread_count(),
+                                                  aItems.size() / chunkSize );
+
+    if( threadCount < 2 )
+        return recorded;
+
+    // The recorders and painters are created here, the GAL constructor is not thread safe
+    GAL_DISPLAY_OPTIONS                         options;
+    std::vector<std::unique_ptr<RECORDING_GAL>> recorders;
+    std::vector<std::unique_ptr<PAINTER>>       painters;
+
+    for( size_t ii = 0; ii < threadCount; ++ii )
+    {
+        recorders.push_back( std::make_unique<RECORDING_GAL>( options, *m_gal ) );
+        painters.push_back( m_painter->Clone( recorders.back().get() ) );
+
+        if( !painters.back() )
+            return recorded;
+    }
+
+    PROF_TIMER timer;
+
+    recorded.resize( aItems.size() );
+
+    std::atomic<size_t>            nextChunk( 0 );
+    std::vector<std::future<void>> tasks;
+
+    auto recordChunks =
+            [&]( RECORDING_GAL* aRecorder, PAINTER* aPainter )
+            {
+                for( size_t first = nextChunk.fetch_add( chunkSize ); first < aItems.size();
+                     first = nextChunk.fetch_add( chunkSize ) )
+                {
+                    size_t last = std::min( first + chunkSize, aItems.size() );
+
+                    for( size_t ii = first; ii < last; ++ii )
+                    {
+                        VIEW_ITEM* item = aItems[ii];
+
+                        if( !needsGeometry( item ) )
+                            continue;
+
+                        for( int layer : item->ViewGetLayers() )
+                        {
+                            auto it = m_layers.find( layer );
+
+                            if( it == m_layers.end() || it->second.target != TARGET_CACHED )
+                                continue;
+
+                            aRecorder->BeginRecording( it->second.renderingOrder );
+
+                            RECORDED_LAYER& entry = recorded[ii].emplace_back();
+                            entry.layer = layer;
+                            entry.drawn = aPainter->Draw( item, layer );
+                            entry.commands = aRecorder->EndRecording();
+                        }
+                    }
+                }
+            };
+
+    for( size_t ii = 0; ii < threadCount; ++ii )
+    {
+        RECORDING_GAL* recorder = recorders[ii].get();
+        PAINTER*       painter = painters[ii].get();
+
+        tasks.push_back( tp.submit_task( [&recordChunks, recorder, painter]()
+                                         {
+                                             recordChunks( recorder, painter );
+                                         } ) );
+    }
+
+    for( const std::future<void>& task : tasks )
+        task.wait();
+
+    KI_TRACE( traceGalProfile,
+              wxS( "View recache: %zu items recorded on %zu threads in %0.3f ms\n" ),
+              aItems.size(), threadCount, timer.msecs() );
+
+    return recorded;
+}
+
+
 void VIEW::UpdateItems()
 {
     if( !m_gal->IsVisible() || !m_gal->IsInitialized() )
@@ -1541,15 +1690,26 @@ void VIEW::UpdateItems()
 
     if( anyUpdated )
     {
-        GAL_UPDATE_CONTEXT ctx( m_gal );
+        std::vector<VIEW_ITEM*> updatedItems;
 
         for( VIEW_ITEM* item : *m_allItems.get() )
         {
             if( item && item->viewPrivData() && item->viewPrivData()->m_requiredUpdate != NONE )
-            {
-                invalidateItem( item, item->viewPrivData()->m_requiredUpdate );
-                item->viewPrivData()->m_requiredUpdate = NONE;
-            }
+                updatedItems.push_back( item );
+        }
+
+        // The painting is done before the GAL is locked: it does not need the GAL context
+        std::vector<std::vector<RECORDED_LAYER>> recorded = recordItems( updatedItems );
+
+        GAL_UPDATE_CONTEXT ctx( m_gal );
+
+        for( size_t ii = 0; ii < updatedItems.size(); ++ii )
+        {
+            VIEW_ITEM* item = updatedItems[ii];
+
+            invalidateItem( item, item->viewPrivData()->m_requiredUpdate,
+                            recorded.empty() ? nullptr : &recorded[ii] );
+            item->viewPrivData()->m_requiredUpdate = NONE;
         }
     }
 
@@ -479,6 +479,8 @@ void mpFXY::Plot( wxDC& dc, mpWindow& w )
 
     dc.SetClippingRegion( startPx, minYpx, endPx - startPx + 1, maxYpx - minYpx + 1 );
 
+    BeginPlot( w, startPx, endPx );
+
     if( !m_continuous )
     {
         bool first = true;
@@ -693,6 +695,8 @@ void mpFXY::Plot( wxDC& dc, mpWindow& w )
         dc.DrawText( m_name, tx, ty );
     }
 
+    EndPlot();
+
     dc.DestroyClippingRegion();
 }
 
@@ -2626,6 +2630,8 @@ void mpFXYVector::Rewind()
 {
     m_index = 0;
     m_sweepWindow = std::numeric_limits<size_t>::max();
+    m_plotPyramid = nullptr;
+    m_hasPendingPoint = false;
 }
 
 
@@ -2633,15 +2639,106 @@ void mpFXYVector::SetSweepWindow( int aSweepIdx )
 {
     m_index = aSweepIdx * m_sweepSize;
     m_sweepWindow = ( aSweepIdx + 1 ) * m_sweepSize;
+    m_plotPyramid = nullptr;
+    m_hasPendingPoint = false;
+
+    if( !m_plotWindow || aSweepIdx < 0 || aSweepIdx >= (int) m_pyramids.size() )
+        return;
+
+    const SWEEP_PYRAMID& pyramid = m_pyramids[aSweepIdx];
+
+    if( !pyramid.m_monotonic || pyramid.m_start >= pyramid.m_end )
+        return;
+
+    // Only enumerate the visible points, plus one on each side so the lines to the points
+    // outside the view can still be interpolated
+    auto first = std::partition_point( m_xs.begin() + pyramid.m_start,
+                                       m_xs.begin() + pyramid.m_end,
+                                       [&]( double x )
+                                       {
+                                           return xToPx( x ) < m_plotStartPx - 1;
+                                       } );
+
+    auto last = std::partition_point( first, m_xs.begin() + pyramid.m_end,
+                                      [&]( double x )
+                                      {
+                                          return xToPx( x ) <= m_plotEndPx;
+                                      } );
+
+    size_t firstIdx = first - m_xs.begin();
+    size_t lastIdx = last - m_xs.begin();
+
+    m_index = firstIdx > pyramid.m_start ? firstIdx - 1 : pyramid.m_start;
+    m_sweepWindow = std::min( pyramid.m_end, lastIdx + 1 );
+
+    if( !pyramid.m_levels.empty() )
+        m_plotPyramid = &pyramid;
 }
 
 
 bool mpFXYVector::GetNextXY( double& x, double& y )
 {
+    if( m_hasPendingPoint )
+    {
+        x = m_xs[m_pendingIdx];
+        y = m_ys[m_pendingIdx];
+        m_hasPendingPoint = false;
+        return true;
+    }
+
     if( m_index >= m_xs.size() || m_index >= m_sweepWindow )
     {
         return false;
     }
+    else if( m_plotPyramid )
+    {
+        // Use the largest bucket starting at the current point which doesn't span more than
+        // one pixel column.  Buckets are aligned, so this walks the pyramid down and up again
+        // at most once per column.
+        size_t offset = m_index - m_plotPyramid->m_start;
+        size_t bucketSize = 1;
+        int    level = -1;
+        wxCoord startPx = xToPx( m_xs[m_index] );
+
+        for( int ii = 0; ii < (int) m_plotPyramid->m_levels.size(); ++ii )
+        {
+            size_t size = bucketSize * DECIMATION_FANOUT;
+
+            if( offset % size != 0 || m_index + size > m_sweepWindow
+                    || xToPx( m_xs[m_index + size - 1] ) - startPx > 1 )
+            {
+                break;
+            }
+
+            bucketSize = size;
+            level = ii;
+        }
+
+        if( level < 0 )
+        {
+            x = m_xs[m_index];
+            y = m_ys[m_index++];
+            return true;
+        }
+
+        const DECIMATED_BUCKET& bucket = m_plotPyramid->m_levels[level][offset / bucketSize];
+
+        // Return the extrema in the order they occur in the data
+        size_t firstIdx = std::min( bucket.m_minIdx, bucket.m_maxIdx );
+        size_t secondIdx = std::max( bucket.m_minIdx, bucket.m_maxIdx );
+
+        x = m_xs[firstIdx];
+        y = m_ys[firstIdx];
+
+        if( secondIdx != firstIdx )
+        {
+            m_pendingIdx = secondIdx;
+            m_hasPendingPoint = true;
+        }
+
+        m_index += bucketSize;
+        return true;
+    }
     else
     {
         x = m_xs[m_index];
@@ -2651,10 +2748,114 @@ bool mpFXYVector::GetNextXY( double& x, double& y )
 }
 
 
+void mpFXYVector::BeginPlot( mpWindow& w, wxCoord aStartPx, wxCoord aEndPx )
+{
+    if( !m_scaleX )
+        return;
+
+    if( m_pyramids.empty() )
+        buildPyramids();
+
+    m_plotWindow = &w;
+    m_plotStartPx = aStartPx;
+    m_plotEndPx = aEndPx;
+}
+
+
+void mpFXYVector::EndPlot()
+{
+    m_plotWindow = nullptr;
+    m_plotPyramid = nullptr;
+    m_hasPendingPoint = false;
+}
+
+
+wxCoord mpFXYVector::xToPx( double x ) const
+{
+    return m_plotWindow->x2p( m_scaleX->TransformToPlot( x ) );
+}
+
+
+void mpFXYVector::buildPyramids()
+{
+    m_pyramids.clear();
+
+    for( int sweep = 0; sweep < m_sweepCount; ++sweep )
+    {
+        SWEEP_PYRAMID& pyramid = m_pyramids.emplace_back();
+
+        pyramid.m_start = std::min( m_xs.size(), sweep * m_sweepSize );
+        pyramid.m_end = std::min( m_xs.size(), ( sweep + 1 ) * m_sweepSize );
+        pyramid.m_monotonic = true;
+
+        for( size_t ii = pyramid.m_start + 1; ii < pyramid.m_end; ++ii )
+        {
+            // Also catches NaNs
+            if( !( m_xs[ii] >= m_xs[ii - 1] ) )
+            {
+                pyramid.m_monotonic = false;
+                break;
+            }
+        }
+
+        if( !pyramid.m_monotonic || pyramid.m_end - pyramid.m_start < MIN_DECIMATED_POINTS )
+            continue;
+
+        // First level from the points
+        std::vector<DECIMATED_BUCKET>& base = pyramid.m_levels.emplace_back();
+        base.reserve( ( pyramid.m_end - pyramid.m_start ) / DECIMATION_FANOUT );
+
+        for( size_t ii = pyramid.m_start; ii + DECIMATION_FANOUT <= pyramid.m_end;
+             ii += DECIMATION_FANOUT )
+        {
+            DECIMATED_BUCKET bucket{ ii, ii };
+
+            for( size_t jj = ii + 1; jj < ii + DECIMATION_FANOUT; ++jj )
+            {
+                if( m_ys[jj] < m_ys[bucket.m_minIdx] )
+                    bucket.m_minIdx = jj;
+
+                if( m_ys[jj] > m_ys[bucket.m_maxIdx] )
+                    bucket.m_maxIdx = jj;
+            }
+
+            base.push_back( bucket );
+        }
+
+        // Next levels by merging the buckets of the previous one
+        while( pyramid.m_levels.back().size() >= DECIMATION_FANOUT )
+        {
+            const std::vector<DECIMATED_BUCKET>& prev = pyramid.m_levels.back();
+            std::vector<DECIMATED_BUCKET>        next;
+            next.reserve( prev.size() / DECIMATION_FANOUT );
+
+            for( size_t ii = 0; ii + DECIMATION_FANOUT <= prev.size(); ii += DECIMATION_FANOUT )
+            {
+                DECIMATED_BUCKET bucket = prev[ii];
+
+                for( size_t jj = ii + 1; jj < ii + DECIMATION_FANOUT; ++jj )
+                {
+                    if( m_ys[prev[jj].m_minIdx] < m_ys[bucket.m_minIdx] )
+                        bucket.m_minIdx = prev[jj].m_minIdx;
+
+                    if( m_ys[prev[jj].m_maxIdx] > m_ys[bucket.m_maxIdx] )
+                        bucket.m_maxIdx = prev[jj].m_maxIdx;
+                }
+
+                next.push_back( bucket );
+            }
+
+            pyramid.m_levels.push_back( std::move( next ) );
+        }
+    }
+}
+
+
 void mpFXYVector::Clear()
 {
     m_xs.clear();
     m_ys.clear();
+    m_pyramids.clear();
 }
 
 
@@ -2668,6 +2869,9 @@ void mpFXYVector::SetData( const std::vector<double>& xs, const std::vector<doub
     m_xs    = xs;
     m_ys    = ys;
 
+    // The min/max pyramids are rebuilt on the next plot
+    m_pyramids.clear();
+
     // Update internal variables for the bounding box.
     if( xs.size() > 0 )
     {
@@ -38,6 +38,7 @@
 #include <sch_marker.h>
 #include <sch_pin.h>
 #include <sch_rule_area.h>
+#include <sch_screen.h>
 #include <sch_sheet.h>
 #include <sch_sheet_path.h>
 #include <sch_sheet_pin.h>
@@ -659,6 +660,8 @@ void CONNECTION_GRAPH::Merge( CONNECTION_GRAPH& aGraph )
     m_last_net_code = std::max( m_last_net_code, aGraph.m_last_net_code );
     m_last_subgraph_code = std::max( m_last_subgraph_code, aGraph.m_last_subgraph_code );
 
+    // Any code that was not reused by aGraph belongs to a net that no longer exists
+    m_retired_net_code_map.clear();
 }
 
 
@@ -726,6 +729,7 @@ void CONNECTION_GRAPH::Reset()
     m_bus_alias_cache.clear();
     m_net_name_to_code_map.clear();
     m_bus_name_to_code_map.clear();
+    m_retired_net_code_map.clear();
     m_net_code_to_subgraphs_map.clear();
     m_net_name_to_subgraphs_map.clear();
     m_item_to_subgraph_map.clear();
@@ -915,6 +919,23 @@ std::set<std::pair<SCH_SHEET_PATH, SCH_ITEM*>> CONNECTION_GRAPH::ExtractAffected
         aSubgraph->getAllConnectedItems( retvals, subgraphs );
     };
 
+    auto traverse_net = [&traverse_subgraph]( CONNECTION_SUBGRAPH* aSubgraph )
+    {
+        traverse_subgraph( aSubgraph );
+
+        for( auto& bus_it : aSubgraph->m_bus_neighbors )
+        {
+            for( CONNECTION_SUBGRAPH* bus_sg : bus_it.second )
+                traverse_subgraph( bus_sg );
+        }
+
+        for( auto& bus_it : aSubgraph->m_bus_parents )
+        {
+            for( CONNECTION_SUBGRAPH* bus_sg : bus_it.second )
+                traverse_subgraph( bus_sg );
+        }
+    };
+
     auto extract_element = [&]( SCH_ITEM* aItem )
     {
         CONNECTION_SUBGRAPH* item_sg = GetSubgraphForItem( aItem );
@@ -948,25 +969,144 @@ std::set<std::pair<SCH_SHEET_PATH, SCH_ITEM*>> CONNECTION_GRAPH::ExtractAffected
                     sg_to_scan.size() );
 
         for( CONNECTION_SUBGRAPH* sg : sg_to_scan )
+            traverse_net( sg );
+
+        std::erase( m_items, aItem );
+    };
+
+    // Labels, sheet pins and power pins join nets by name rather than by position, so an edit
+    // can attach them to nets they were not part of (a renamed label, a new global label...).
+    // The subgraphs currently holding the item's new name, or one of its bus members, have to
+    // be re-resolved along with it.  Everything not reachable this way keeps its connectivity.
+    auto extract_by_name = [&]( SCH_ITEM* aItem )
+    {
+        std::vector<SCH_SHEET_PATH> sheets;
+        EDA_ITEM*                   parent = aItem->GetParent();
+
+        while( parent && parent->Type() != SCH_SCREEN_T )
+            parent = parent->GetParent();
+
+        if( parent )
+            sheets = static_cast<SCH_SCREEN*>( parent )->GetClientSheetPaths();
+
+        if( sheets.empty() )
+            sheets.push_back( m_schematic->CurrentSheet() );
+
+        auto extract_name =
+                [&]( const wxString& aName, const SCH_SHEET_PATH& aSheet )
+                {
+                    SCH_CONNECTION conn( aItem, aSheet );
+                    conn.SetGraph( this );
+                    conn.ConfigureFromLabel( aName );
+
+                    std::vector<std::shared_ptr<SCH_CONNECTION>> members = conn.AllMembers();
+                    std::vector<const SCH_CONNECTION*>           conns = { &conn };
+
+                    for( const std::shared_ptr<SCH_CONNECTION>& member : members )
+                        conns.push_back( member.get() );
+
+                    for( const SCH_CONNECTION* c : conns )
+                    {
+                        for( const wxString& name : { c->Name(), c->Name( true ) } )
+                        {
+                            for( CONNECTION_SUBGRAPH* sg : GetAllSubgraphs( name ) )
+                                traverse_net( sg );
+
+                            auto global_it = m_global_label_cache.find( name );
+
+                            if( global_it != m_global_label_cache.end() )
+                            {
+                                for( const CONNECTION_SUBGRAPH* sg : global_it->second )
+                                    traverse_net( const_cast<CONNECTION_SUBGRAPH*>( sg ) );
+                            }
+
+                            auto local_it = m_local_label_cache.find( { aSheet, name } );
+
+                            if( local_it != m_local_label_cache.end() )
+                            {
+                                for( const CONNECTION_SUBGRAPH* sg : local_it->second )
+                                    traverse_net( const_cast<CONNECTION_SUBGRAPH*>( sg ) );
+                            }
+                        }
+                    }
+                };
+
+        for( const SCH_SHEET_PATH& sheet : sheets )
         {
-            traverse_subgraph( sg );
+            switch( aItem->Type() )
+            {
+            case SCH_LABEL_T:
+            case SCH_GLOBAL_LABEL_T:
+            {
+                SCH_LABEL_BASE* label = static_cast<SCH_LABEL_BASE*>( aItem );
+                extract_name( EscapeString( label->GetShownText( &sheet, false ), CTX_NETNAME ),
+                              sheet );
+                break;
+            }
 
-            for( auto& bus_it : sg->m_bus_neighbors )
+            case SCH_HIER_LABEL_T:
             {
-                for( CONNECTION_SUBGRAPH* bus_sg : bus_it.second )
-                    traverse_subgraph( bus_sg );
+                SCH_HIERLABEL* label = static_cast<SCH_HIERLABEL*>( aItem );
+                wxString       name = EscapeString( label->GetShownText( &sheet, false ),
+                                                    CTX_NETNAME );
+
+                extract_name( name, sheet );
+
+                // The sheet pin this label now matches in the parent sheet
+                if( sheet.size() > 1 )
+                {
+                    for( SCH_SHEET_PIN* pin : sheet.Last()->GetPins() )
+                    {
+                        wxString pinName = EscapeString( pin->GetShownText( &sheet, false ),
+                                                         CTX_NETNAME );
+
+                        if( pinName != name )
+                            continue;
+
+                        if( CONNECTION_SUBGRAPH* sg = GetSubgraphForItem( pin ) )
+                            traverse_net( sg );
+                    }
+                }
+
+                break;
             }
 
-            for( auto& bus_it : sg->m_bus_parents )
+            case SCH_SHEET_PIN_T:
             {
-                for( CONNECTION_SUBGRAPH* bus_sg : bus_it.second )
-                    traverse_subgraph( bus_sg );
+                // Sheet pins resolve their text in the sheet they belong to, which is also
+                // where the hierarchical labels they now match live
+                SCH_SHEET_PIN* pin = static_cast<SCH_SHEET_PIN*>( aItem );
+                SCH_SHEET_PATH childPath = sheet;
+
+                if( childPath.Last() != pin->GetParent() )
+                    childPath.push_back( pin->GetParent() );
+
+                wxString name = EscapeString( pin->GetShownText( &childPath, false ),
+                                              CTX_NETNAME );
+
+                extract_name( name, sheet );
+                extract_name( name, childPath );
+                break;
             }
-        }
 
-        std::erase( m_items, aItem );
+            case SCH_PIN_T:
+            {
+                SCH_PIN* pin = static_cast<SCH_PIN*>( aItem );
+
+                if( pin->IsPower() )
+                    extract_name( pin->GetDefaultNetName( sheet ), sheet );
+
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
     };
 
+    m_retired_net_code_map.clear();
+
     for( SCH_ITEM* item : aItems )
     {
         if( item->Type() == SCH_SHEET_T )
@@ -974,18 +1114,25 @@ std::set<std::pair<SCH_SHEET_PATH, SCH_ITEM*>> CONNECTION_GRAPH::ExtractAffected
             SCH_SHEET* sheet = static_cast<SCH_SHEET*>( item );
 
             for( SCH_SHEET_PIN* pin : sheet->GetPins() )
+            {
                 extract_element( pin );
+                extract_by_name( pin );
+            }
         }
         else if ( item->Type() == SCH_SYMBOL_T )
         {
             SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( item );
 
             for( SCH_PIN* pin : symbol->GetPins( &m_schematic->CurrentSheet() ) )
+            {
                 extract_element( pin );
+                extract_by_name( pin );
+            }
         }
         else
         {
             extract_element( item );
+            extract_by_name( item );
         }
     }
 
@@ -1019,15 +1166,8 @@ void CONNECTION_GRAPH::RemoveItem( SCH_ITEM* aItem )
 void CONNECTION_GRAPH::removeSubgraphs( std::set<CONNECTION_SUBGRAPH*>& aSubgraphs )
 {
     wxLogTrace( ConnTrace, wxT( "Removing %zu subgraphs" ), aSubgraphs.size() );
-    std::sort( m_driver_subgraphs.begin(), m_driver_subgraphs.end() );
-    std::sort( m_subgraphs.begin(), m_subgraphs.end() );
     std::set<int> codes_to_remove;
 
-    for( auto& el : m_sheet_to_subgraphs_map )
-    {
-        std::sort( el.second.begin(), el.second.end() );
-    }
-
     for( CONNECTION_SUBGRAPH* sg : aSubgraphs )
     {
         for( auto& it : sg->m_bus_neighbors )
@@ -1067,96 +1207,63 @@ void CONNECTION_GRAPH::removeSubgraphs( std::set<CONNECTION_SUBGRAPH*>& aSubgrap
                     parent->m_bus_neighbors.erase( it.first );
             }
         }
+    }
 
-        {
-            auto it = std::lower_bound( m_driver_subgraphs.begin(), m_driver_subgraphs.end(), sg );
-
-            while( it != m_driver_subgraphs.end() && *it == sg )
-                it = m_driver_subgraphs.erase( it );
-        }
-
-        {
-            auto it = std::lower_bound( m_subgraphs.begin(), m_subgraphs.end(), sg );
-
-            while( it != m_subgraphs.end() && *it == sg )
-                it = m_subgraphs.erase( it );
-        }
-
-        for( auto& el : m_sheet_to_subgraphs_map )
-        {
-            auto it = std::lower_bound( el.second.begin(), el.second.end(), sg );
-
-            while( it != el.second.end() && *it == sg )
-                it = el.second.erase( it );
-        }
-
-        auto remove_sg = [sg]( auto it ) -> bool
-                         {
-                             for( const CONNECTION_SUBGRAPH* test_sg : it->second )
-                             {
-                                 if( sg == test_sg )
-                                     return true;
-                             }
+    // Each structure is walked once for the whole set rather than once per removed subgraph;
+    // a local edit on a large design can remove thousands of subgraphs.
+    auto is_removed = [&aSubgraphs]( const CONNECTION_SUBGRAPH* aSubgraph ) -> bool
+                      {
+                          CONNECTION_SUBGRAPH* sg = const_cast<CONNECTION_SUBGRAPH*>( aSubgraph );
+                          return aSubgraphs.contains( sg );
+                      };
 
-                             return false;
-                         };
+    auto has_removed = [&is_removed]( const auto& aEntry ) -> bool
+                       {
+                           return std::any_of( aEntry.second.begin(), aEntry.second.end(),
+                                               is_removed );
+                       };
 
-        for( auto it = m_global_label_cache.begin(); it != m_global_label_cache.end(); )
-        {
-            if( remove_sg( it ) )
-                it = m_global_label_cache.erase( it );
-            else
-                ++it;
-        }
+    std::erase_if( m_driver_subgraphs, is_removed );
+    std::erase_if( m_subgraphs, is_removed );
 
-        for( auto it = m_local_label_cache.begin(); it != m_local_label_cache.end(); )
-        {
-            if( remove_sg( it ) )
-                it = m_local_label_cache.erase( it );
-            else
-                ++it;
-        }
+    for( auto& [sheet, subgraphs] : m_sheet_to_subgraphs_map )
+        std::erase_if( subgraphs, is_removed );
 
-        for( auto it = m_net_code_to_subgraphs_map.begin();
-             it != m_net_code_to_subgraphs_map.end(); )
-        {
-            if( remove_sg( it ) )
-            {
-                codes_to_remove.insert( it->first.Netcode );
-                it = m_net_code_to_subgraphs_map.erase( it );
-            }
-            else
-            {
-                ++it;
-            }
-        }
+    std::erase_if( m_global_label_cache, has_removed );
+    std::erase_if( m_local_label_cache, has_removed );
 
-        for( auto it = m_net_name_to_subgraphs_map.begin();
-             it != m_net_name_to_subgraphs_map.end(); )
+    for( auto it = m_net_code_to_subgraphs_map.begin(); it != m_net_code_to_subgraphs_map.end(); )
+    {
+        if( has_removed( *it ) )
         {
-            if( remove_sg( it ) )
-                it = m_net_name_to_subgraphs_map.erase( it );
-            else
-                ++it;
+            codes_to_remove.insert( it->first.Netcode );
+            it = m_net_code_to_subgraphs_map.erase( it );
         }
-
-        for( auto it = m_item_to_subgraph_map.begin(); it != m_item_to_subgraph_map.end(); )
+        else
         {
-            if( it->second == sg )
-                it = m_item_to_subgraph_map.erase( it );
-            else
-                ++it;
+            ++it;
         }
+    }
 
+    std::erase_if( m_net_name_to_subgraphs_map, has_removed );
 
-    }
+    std::erase_if( m_item_to_subgraph_map,
+                   [&is_removed]( const auto& aEntry )
+                   {
+                       return is_removed( aEntry.second );
+                   } );
 
     for( auto it = m_net_name_to_code_map.begin(); it != m_net_name_to_code_map.end(); )
     {
         if( codes_to_remove.contains( it->second ) )
+        {
+            m_retired_net_code_map.insert_or_assign( it->first, it->second );
             it = m_net_name_to_code_map.erase( it );
+        }
         else
+        {
             ++it;
+        }
     }
 
     for( auto it = m_bus_name_to_code_map.begin(); it != m_bus_name_to_code_map.end(); )
@@ -2616,7 +2723,18 @@ int CONNECTION_GRAPH::getOrCreateNetCode( const wxString& aNetName )
 
     if( it == m_net_name_to_code_map.end() )
     {
-        code = m_last_net_code++;
+        auto retired = m_retired_net_code_map.find( aNetName );
+
+        if( retired != m_retired_net_code_map.end() )
+        {
+            code = retired->second;
+            m_retired_net_code_map.erase( retired );
+        }
+        else
+        {
+            code = m_last_net_code++;
+        }
+
         m_net_name_to_code_map[ aNetName ] = code;
     }
     else
@@ -391,6 +391,7 @@ public:
         m_last_net_code = aOther->m_last_net_code;
         m_last_bus_code = aOther->m_last_bus_code;
         m_last_subgraph_code = aOther->m_last_subgraph_code;
+        m_retired_net_code_map = aOther->m_retired_net_code_map;
     }
 
     /**
@@ -620,6 +621,8 @@ private:
     int assignNewNetCode( SCH_CONNECTION& aConnection );
 
     /**
+     * Reuse the code a net had before it was extracted by ExtractAffectedItems() if there is
+     * one, so that nets keep their code across incremental updates.
      *
      * @param aNetName string with the netname for coding
      * @return existing netcode (if it exists) or newly created one
@@ -820,6 +823,9 @@ private:
 
     std::unordered_map<wxString, int> m_bus_name_to_code_map;
 
+    /// Net codes of the nets removed by the last ExtractAffectedItems(), by net name.
+    std::unordered_map<wxString, int> m_retired_net_code_map;
+
     std::unordered_map<wxString, std::vector<const CONNECTION_SUBGRAPH*>> m_global_label_cache;
 
     std::map< std::pair<SCH_SHEET_PATH, wxString>,
@@ -273,7 +273,7 @@ void DIALOG_CHANGE_SYMBOLS::updateFieldsList()
     // Load non-mandatory fields from all matching symbols and their library symbols
     std::set<wxString> fieldNames;
 
-    for( SCH_SHEET_PATH& instance : frame->Schematic().Hierarchy() )
+    for( const SCH_SHEET_PATH& instance : frame->Schematic().Hierarchy() )
     {
         SCH_SCREEN* screen = instance.LastScreen();
 
@@ -450,7 +450,7 @@ void DIALOG_CHANGE_SYMBOLS::onOkButtonClicked( wxCommandEvent& aEvent )
 }
 
 
-bool DIALOG_CHANGE_SYMBOLS::isMatch( SCH_SYMBOL* aSymbol, SCH_SHEET_PATH* aInstance )
+bool DIALOG_CHANGE_SYMBOLS::isMatch( SCH_SYMBOL* aSymbol, const SCH_SHEET_PATH* aInstance )
 {
     SCH_EDIT_FRAME* frame = dynamic_cast<SCH_EDIT_FRAME*>( GetParent() );
 
@@ -511,7 +511,7 @@ int DIALOG_CHANGE_SYMBOLS::processMatchingSymbols( SCH_COMMIT* aCommit )
 
     std::map<SCH_SYMBOL*, SYMBOL_CHANGE_INFO> symbols;
 
-    for( SCH_SHEET_PATH& instance : frame->Schematic().Hierarchy() )
+    for( const SCH_SHEET_PATH& instance : frame->Schematic().Hierarchy() )
     {
         SCH_SCREEN* screen = instance.LastScreen();
 
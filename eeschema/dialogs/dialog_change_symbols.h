@@ -94,7 +94,7 @@ protected:
 
     void updateFieldsList();
 
-    bool isMatch( SCH_SYMBOL* aSymbol, SCH_SHEET_PATH* aInstance );
+    bool isMatch( SCH_SYMBOL* aSymbol, const SCH_SHEET_PATH* aInstance );
     int processMatchingSymbols( SCH_COMMIT* aCommit );
     int processSymbols( SCH_COMMIT* aCommit, const std::map<SCH_SYMBOL*, SYMBOL_CHANGE_INFO>& aSymbols );
     wxString getSymbolReferences( SCH_SYMBOL& aSymbol, const LIB_ID& aNewId,
@@ -24,6 +24,8 @@
  */
 
 #include <algorithm>
+#include <functional>
+#include <future>
 #include <numeric>
 
 #include "connection_graph.h"
@@ -57,6 +59,8 @@
 #include <sim/sim_lib_mgr.h>
 #include <progress_reporter.h>
 #include <kiway.h>
+#include <scoped_set_reset.h>
+#include <thread_pool.h>
 
 
 /* ERC tests :
@@ -138,6 +142,24 @@ const std::set<ELECTRICAL_PINTYPE> DrivenPinTypes =
 extern void CheckDuplicatePins( LIB_SYMBOL* aSymbol, std::vector<wxString>& aMessages,
                                 UNITS_PROVIDER* aUnitsProvider );
 
+/// Markers created by a test, in creation order, with the screen they belong to
+using ERC_MARKER_LIST = std::vector<std::pair<SCH_SCREEN*, SCH_MARKER*>>;
+
+/**
+ * While RunTests() executes tests concurrently, the markers of the test running on this thread
+ * go here instead of into the screens, which the other tests are reading.
+ */
+static thread_local ERC_MARKER_LIST* s_pendingMarkers = nullptr;
+
+
+static void addMarker( SCH_SCREEN* aScreen, SCH_MARKER* aMarker )
+{
+    if( s_pendingMarkers )
+        s_pendingMarkers->emplace_back( aScreen, aMarker );
+    else
+        aScreen->Append( aMarker );
+}
+
 int ERC_TESTER::TestDuplicateSheetNames( bool aCreateMarker )
 {
     int err_count = 0;
@@ -168,7 +190,7 @@ int ERC_TESTER::TestDuplicateSheetNames( bool aCreateMarker )
                         ercItem->SetItems( sheet, test_item );
 
                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), sheet->GetPosition() );
-                        screen->Append( marker );
+                        addMarker( screen, marker );
                     }
 
                     err_count++;
@@ -213,7 +235,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                     ercItem->SetErrorMessage( ercText );
 
                     SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pos );
-                    screen->Append( marker );
+                    addMarker( screen, marker );
 
                     return true;
                 }
@@ -232,7 +254,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                     ercItem->SetErrorMessage( ercText );
 
                     SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pos );
-                    screen->Append( marker );
+                    addMarker( screen, marker );
 
                     return true;
                 }
@@ -270,7 +292,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                         ercItem->SetSheetSpecificPath( sheet );
 
                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), field.GetPosition() );
-                        screen->Append( marker );
+                        addMarker( screen, marker );
                     }
 
                     testAssertion( &field, sheet, screen, field.GetText(), field.GetPosition() );
@@ -300,7 +322,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                                         VECTOR2I pos = bbox.Centre() + symbol->GetPosition();
 
                                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pos );
-                                        screen->Append( marker );
+                                        addMarker( screen, marker );
                                     }
 
                                     testAssertion( symbol, sheet, screen, textItem->GetText(),
@@ -321,7 +343,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                                         VECTOR2I pos = bbox.Centre() + symbol->GetPosition();
 
                                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pos );
-                                        screen->Append( marker );
+                                        addMarker( screen, marker );
                                     }
 
                                     testAssertion( symbol, sheet, screen, textboxItem->GetText(),
@@ -342,7 +364,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                         ercItem->SetSheetSpecificPath( sheet );
 
                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), field.GetPosition() );
-                        screen->Append( marker );
+                        addMarker( screen, marker );
                     }
 
                     testAssertion( &field, sheet, screen, field.GetText(), field.GetPosition() );
@@ -361,7 +383,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                         ercItem->SetSheetSpecificPath( sheet );
 
                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), field.GetPosition() );
-                        screen->Append( marker );
+                        addMarker( screen, marker );
                     }
 
                     testAssertion( &field, sheet, screen, field.GetText(), field.GetPosition() );
@@ -379,7 +401,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                         ercItem->SetSheetSpecificPath( sheet );
 
                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pin->GetPosition() );
-                        screen->Append( marker );
+                        addMarker( screen, marker );
                     }
                 }
             }
@@ -392,7 +414,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                     ercItem->SetSheetSpecificPath( sheet );
 
                     SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), text->GetPosition() );
-                    screen->Append( marker );
+                    addMarker( screen, marker );
                 }
 
                 testAssertion( text, sheet, screen, text->GetText(), text->GetPosition() );
@@ -406,7 +428,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                     ercItem->SetSheetSpecificPath( sheet );
 
                     SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), textBox->GetPosition() );
-                    screen->Append( marker );
+                    addMarker( screen, marker );
                 }
 
                 testAssertion( textBox, sheet, screen, textBox->GetText(), textBox->GetPosition() );
@@ -428,7 +450,7 @@ void ERC_TESTER::TestTextVars( DS_PROXY_VIEW_ITEM* aDrawingSheet )
                     ercItem->SetSheetSpecificPath( sheet );
 
                     SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), text->GetPosition() );
-                    screen->Append( marker );
+                    addMarker( screen, marker );
                 }
             }
         }
@@ -467,7 +489,7 @@ int ERC_TESTER::TestConflictingBusAliases()
                     ercItem->SetErrorMessage( msg );
 
                     SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), VECTOR2I() );
-                    test->GetParent()->Append( marker );
+                    addMarker( test->GetParent(), marker );
 
                     ++err_count;
                 }
@@ -531,7 +553,7 @@ int ERC_TESTER::TestMultiunitFootprints()
                 ercItem->SetItems( unit, secondUnit );
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), secondUnit->GetPosition() );
-                secondRef.GetSheetPath().LastScreen()->Append( marker );
+                addMarker( secondRef.GetSheetPath().LastScreen(), marker );
 
                 ++errors;
             }
@@ -594,7 +616,7 @@ int ERC_TESTER::TestMissingUnits()
                     ercItem->SetItemsSheetPaths( base_ref.GetSheetPath() );
 
                     SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), unit->GetPosition() );
-                    base_ref.GetSheetPath().LastScreen()->Append( marker );
+                    addMarker( base_ref.GetSheetPath().LastScreen(), marker );
 
                     ++errors;
                 };
@@ -694,7 +716,7 @@ int ERC_TESTER::TestMissingNetclasses()
                                                             netclass ) );
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), item->GetPosition() );
-                sheet.LastScreen()->Append( marker );
+                addMarker( sheet.LastScreen(), marker );
             };
 
     for( const SCH_SHEET_PATH& sheet : m_sheetList )
@@ -776,7 +798,7 @@ int ERC_TESTER::TestLabelMultipleWires()
                 ercItem->SetSheetSpecificPath( sheet );
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pair.first );
-                sheet.LastScreen()->Append( marker );
+                addMarker( sheet.LastScreen(), marker );
             }
         }
     }
@@ -855,7 +877,7 @@ int ERC_TESTER::TestFourWayJunction()
                 ercItem->SetSheetSpecificPath( sheet );
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pair.first );
-                sheet.LastScreen()->Append( marker );
+                addMarker( sheet.LastScreen(), marker );
             }
         }
     }
@@ -924,7 +946,7 @@ int ERC_TESTER::TestNoConnectPins()
                 ercItem->SetSheetSpecificPath( sheet );
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pair.first );
-                sheet.LastScreen()->Append( marker );
+                addMarker( sheet.LastScreen(), marker );
             }
         }
     }
@@ -974,6 +996,15 @@ int ERC_TESTER::TestPinToPin()
                        return ret < 0;
                    } );
 
+        // Pin conflicts are only looked for when pin-to-pin warnings are enabled
+        std::map<ELECTRICAL_PINTYPE, std::vector<size_t>> pins_by_type;
+
+        if( m_settings.IsTestEnabled( ERCE_PIN_TO_PIN_WARNING ) )
+        {
+            for( size_t ii = 0; ii < pins.size(); ++ii )
+                pins_by_type[pins[ii].Pin()->GetType()].push_back( ii );
+        }
+
         ERC_SCH_PIN_CONTEXT needsDriver;
         ELECTRICAL_PINTYPE  needsDriverType = ELECTRICAL_PINTYPE::PT_UNSPECIFIED;
         bool                hasDriver = false;
@@ -992,12 +1023,8 @@ int ERC_TESTER::TestPinToPin()
             }
         }
 
-        std::vector<std::tuple<iterator_t, iterator_t, PIN_ERROR>> pin_mismatches;
-        std::map<iterator_t, int>                                  pin_mismatch_counts;
-
-        for( auto refIt = pins.begin(); refIt != pins.end(); ++refIt )
+        for( ERC_SCH_PIN_CONTEXT& refPin : pins )
         {
-            ERC_SCH_PIN_CONTEXT& refPin = *refIt;
             ELECTRICAL_PINTYPE refType = refPin.Pin()->GetType();
 
             if( DrivenPinTypes.contains( refType ) )
@@ -1019,55 +1046,83 @@ int ERC_TESTER::TestPinToPin()
                 hasDriver |= ( DrivingPowerPinTypes.count( refType ) != 0 );
             else
                 hasDriver |= ( DrivingPinTypes.count( refType ) != 0 );
+        }
 
-            for( auto testIt = refIt + 1; testIt != pins.end(); ++testIt )
-            {
-                ERC_SCH_PIN_CONTEXT& testPin = *testIt;
+        // Pins conflicting with each pin, by increasing index.  Only pairs of pin types that the
+        // pin map flags are looked at, so the large OK groups of big nets (passives, power
+        // inputs...) cost nothing.  The conflicting pair is evaluated in sorted pin order, as
+        // the matrix isn't necessarily symmetric.
+        std::vector<std::vector<std::pair<size_t, PIN_ERROR>>> pin_mismatches( pins.size() );
+        std::map<iterator_t, int>                              pin_mismatch_counts;
+        size_t                                                 mismatch_count = 0;
 
-                // Multiple pins in the same symbol that share a type,
-                // name and position are considered
-                // "stacked" and shouldn't trigger ERC errors
-                if( refPin.Pin()->IsStacked( testPin.Pin() ) && refPin.Sheet() == testPin.Sheet() )
+        for( auto typeA = pins_by_type.begin(); typeA != pins_by_type.end(); ++typeA )
+        {
+            for( auto typeB = typeA; typeB != pins_by_type.end(); ++typeB )
+            {
+                if( m_settings.GetPinMapValue( typeA->first, typeB->first ) == PIN_ERROR::OK
+                    && m_settings.GetPinMapValue( typeB->first, typeA->first ) == PIN_ERROR::OK )
+                {
                     continue;
+                }
 
-                ELECTRICAL_PINTYPE testType = testPin.Pin()->GetType();
+                const std::vector<size_t>& pinsA = typeA->second;
+                const std::vector<size_t>& pinsB = typeB->second;
 
-                if( ispowerNet )
-                    hasDriver |= DrivingPowerPinTypes.contains( testType );
-                else
-                    hasDriver |= DrivingPinTypes.contains( testType );
+                for( size_t ii = 0; ii < pinsA.size(); ++ii )
+                {
+                    for( size_t jj = ( typeA == typeB ) ? ii + 1 : 0; jj < pinsB.size(); ++jj )
+                    {
+                        size_t ref = std::min( pinsA[ii], pinsB[jj] );
+                        size_t test = std::max( pinsA[ii], pinsB[jj] );
 
-                PIN_ERROR erc = m_settings.GetPinMapValue( refType, testType );
+                        ERC_SCH_PIN_CONTEXT& refPin = pins[ref];
+                        ERC_SCH_PIN_CONTEXT& testPin = pins[test];
 
-                if( erc != PIN_ERROR::OK && m_settings.IsTestEnabled( ERCE_PIN_TO_PIN_WARNING ) )
-                {
-                    pin_mismatches.emplace_back(
-                            std::tuple<iterator_t, iterator_t, PIN_ERROR>{ refIt, testIt, erc } );
+                        // Multiple pins in the same symbol that share a type,
+                        // name and position are considered
+                        // "stacked" and shouldn't trigger ERC errors
+                        if( refPin.Pin()->IsStacked( testPin.Pin() )
+                                && refPin.Sheet() == testPin.Sheet() )
+                        {
+                            continue;
+                        }
 
-                    if( m_settings.GetERCSortingMetric() == ERC_PIN_SORTING_METRIC::SM_HEURISTICS )
-                    {
-                        pin_mismatch_counts[refIt] =
-                                m_settings.GetPinTypeWeight( ( *refIt ).Pin()->GetType() );
+                        PIN_ERROR erc = m_settings.GetPinMapValue( refPin.Pin()->GetType(),
+                                                                   testPin.Pin()->GetType() );
 
-                        pin_mismatch_counts[testIt] =
-                                m_settings.GetPinTypeWeight( ( *testIt ).Pin()->GetType() );
-                    }
-                    else
-                    {
-                        if( !pin_mismatch_counts.contains( testIt ) )
-                            pin_mismatch_counts.emplace( testIt, 1 );
-                        else
-                            pin_mismatch_counts[testIt]++;
+                        if( erc == PIN_ERROR::OK )
+                            continue;
+
+                        pin_mismatches[ref].emplace_back( test, erc );
+                        pin_mismatches[test].emplace_back( ref, erc );
+                        mismatch_count++;
+
+                        iterator_t refIt = pins.begin() + ref;
+                        iterator_t testIt = pins.begin() + test;
 
-                        if( !pin_mismatch_counts.contains( refIt ) )
-                            pin_mismatch_counts.emplace( refIt, 1 );
+                        if( m_settings.GetERCSortingMetric()
+                                == ERC_PIN_SORTING_METRIC::SM_HEURISTICS )
+                        {
+                            pin_mismatch_counts[refIt] =
+                                    m_settings.GetPinTypeWeight( ( *refIt ).Pin()->GetType() );
+
+                            pin_mismatch_counts[testIt] =
+                                    m_settings.GetPinTypeWeight( ( *testIt ).Pin()->GetType() );
+                        }
                         else
+                        {
+                            pin_mismatch_counts[testIt]++;
                             pin_mismatch_counts[refIt]++;
+                        }
                     }
                 }
             }
         }
 
+        for( std::vector<std::pair<size_t, PIN_ERROR>>& conflicts : pin_mismatches )
+            std::sort( conflicts.begin(), conflicts.end() );
+
         std::multimap<size_t, iterator_t, std::greater<size_t>> pins_dsc;
 
         std::transform( pin_mismatch_counts.begin(), pin_mismatch_counts.end(),
@@ -1077,13 +1132,17 @@ int ERC_TESTER::TestPinToPin()
                             return std::pair<size_t, iterator_t>( p.second, p.first );
                         } );
 
+        // Each conflict is reported once, on the first of its two pins in pins_dsc order
+        std::vector<bool> reported( pins.size(), false );
+
         for( const auto& [amount, pinItBind] : pins_dsc )
         {
             auto& pinIt = pinItBind;
 
-            if( pin_mismatches.empty() )
+            if( mismatch_count == 0 )
                 break;
 
+            size_t   pinIdx = pinIt - pins.begin();
             SCH_PIN* pin = ( *pinIt ).Pin();
             VECTOR2I position = pin->GetPosition();
 
@@ -1091,41 +1150,37 @@ int ERC_TESTER::TestPinToPin()
             double     smallest_distance = std::numeric_limits<double>::infinity();
             PIN_ERROR  erc;
 
-            std::erase_if(
-                    pin_mismatches,
-                    [&]( const auto& tuple )
-                    {
-                        iterator_t other;
+            reported[pinIdx] = true;
 
-                        if( pinIt == std::get<0>( tuple ) )
-                            other = std::get<1>( tuple );
-                        else if( pinIt == std::get<1>( tuple ) )
-                            other = std::get<0>( tuple );
-                        else
-                            return false;
+            for( const auto& [otherIdx, otherErc] : pin_mismatches[pinIdx] )
+            {
+                if( reported[otherIdx] )
+                    continue;
 
-                        if( ( *pinIt ).Sheet().Cmp( ( *other ).Sheet() ) != 0 )
-                        {
-                            if( std::isinf( smallest_distance ) )
-                            {
-                                nearest_pin = other;
-                                erc = std::get<2>( tuple );
-                            }
-                        }
-                        else
-                        {
-                            double distance = position.Distance( ( *other ).Pin()->GetPosition() );
+                iterator_t other = pins.begin() + otherIdx;
 
-                            if( std::isinf( smallest_distance ) || distance < smallest_distance )
-                            {
-                                smallest_distance = distance;
-                                nearest_pin = other;
-                                erc = std::get<2>( tuple );
-                            }
-                        }
+                mismatch_count--;
 
-                        return true;
-                    } );
+                if( ( *pinIt ).Sheet().Cmp( ( *other ).Sheet() ) != 0 )
+                {
+                    if( std::isinf( smallest_distance ) )
+                    {
+                        nearest_pin = other;
+                        erc = otherErc;
+                    }
+                }
+                else
+                {
+                    double distance = position.Distance( ( *other ).Pin()->GetPosition() );
+
+                    if( std::isinf( smallest_distance ) || distance < smallest_distance )
+                    {
+                        smallest_distance = distance;
+                        nearest_pin = other;
+                        erc = otherErc;
+                    }
+                }
+            }
 
             if( nearest_pin != pins.end() )
             {
@@ -1144,7 +1199,7 @@ int ERC_TESTER::TestPinToPin()
                                           ElectricalPinTypeGetText( other_pin->GetType() ) ) );
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pin->GetPosition() );
-                pinToScreenMap[pin]->Append( marker );
+                addMarker( pinToScreenMap[pin], marker );
                 errors++;
             }
         }
@@ -1163,7 +1218,7 @@ int ERC_TESTER::TestPinToPin()
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ),
                                                      needsDriver.Pin()->GetPosition() );
-                pinToScreenMap[needsDriver.Pin()]->Append( marker );
+                addMarker( pinToScreenMap[needsDriver.Pin()], marker );
                 errors++;
             }
         }
@@ -1216,7 +1271,7 @@ int ERC_TESTER::TestMultUnitPinConflicts()
                         ercItem->SetItemsSheetPaths( sheet, sheet );
 
                         SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), pin->GetPosition() );
-                        sheet.LastScreen()->Append( marker );
+                        addMarker( sheet.LastScreen(), marker );
                         errors += 1;
                     }
                 }
@@ -1284,7 +1339,7 @@ int ERC_TESTER::TestGroundPins()
 
                     SCH_MARKER* marker =
                             new SCH_MARKER( std::move( ercItem ), pin->GetPosition() );
-                    screen->Append( marker );
+                    addMarker( screen, marker );
                     errors++;
                 }
             }
@@ -1322,7 +1377,7 @@ int ERC_TESTER::TestStackedPinNotation()
 
                     SCH_MARKER* marker =
                             new SCH_MARKER( std::move( ercItem ), pin->GetPosition() );
-                    screen->Append( marker );
+                    addMarker( screen, marker );
                     warnings++;
                 }
             }
@@ -1377,7 +1432,7 @@ int ERC_TESTER::TestSameLocalGlobalLabel()
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ),
                                                      globalItem.first->GetPosition() );
-                globalItem.second.LastScreen()->Append( marker );
+                addMarker( globalItem.second.LastScreen(), marker );
 
                 errCount++;
             }
@@ -1391,11 +1446,26 @@ int ERC_TESTER::TestSameLocalGlobalLabel()
 int ERC_TESTER::TestSimilarLabels()
 {
     int errors = 0;
-    std::unordered_map<wxString, std::vector<std::tuple<wxString, SCH_ITEM*, SCH_SHEET_PATH>>> generalMap;
+
+    using LABEL_ENTRY = std::tuple<wxString, SCH_ITEM*, SCH_SHEET_PATH>;
+
+    /// The items sharing one exact text; local labels are split by sheet as they are only
+    /// similar to local labels of the same sheet.
+    struct TEXT_GROUP
+    {
+        std::vector<size_t>                                     m_items;
+        std::unordered_map<SCH_SHEET_PATH, std::vector<size_t>> m_localLabels;
+    };
+
+    // Items are bucketed by case-folded text and then by exact text, so that identical labels
+    // (the many labels of a power net or a bus) are never compared with each other.  Indices
+    // refer to allItems and give the order in which the original pairwise scan found them.
+    std::vector<LABEL_ENTRY>                                     allItems;
+    std::unordered_map<wxString, std::map<wxString, TEXT_GROUP>> generalMap;
 
     auto logError =
             [&]( const wxString& normalized, SCH_ITEM* item, const SCH_SHEET_PATH& sheet,
-                 const std::tuple<wxString, SCH_ITEM*, SCH_SHEET_PATH>& other )
+                 const LABEL_ENTRY& other )
             {
                 auto& [otherText, otherItem, otherSheet] = other;
                 ERCE_T typeOfWarning = ERCE_SIMILAR_LABELS;
@@ -1422,7 +1492,54 @@ int ERC_TESTER::TestSimilarLabels()
                 ercItem->SetItemsSheetPaths( sheet, otherSheet );
 
                 SCH_MARKER* marker = new SCH_MARKER( std::move( ercItem ), item->GetPosition() );
-                sheet.LastScreen()->Append( marker );
+                addMarker( sheet.LastScreen(), marker );
+            };
+
+    auto checkItem =
+            [&]( const wxString& aText, SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet )
+            {
+                wxString                        normalized = aText.Lower();
+                std::map<wxString, TEXT_GROUP>& similar = generalMap[normalized];
+                std::vector<size_t>             others;
+
+                for( auto& [otherText, group] : similar )
+                {
+                    if( otherText == aText )
+                        continue;
+
+                    others.insert( others.end(), group.m_items.begin(), group.m_items.end() );
+
+                    // Similar local labels on different sheets are fine
+                    if( aItem->Type() == SCH_LABEL_T )
+                    {
+                        auto it = group.m_localLabels.find( aSheet );
+
+                        if( it != group.m_localLabels.end() )
+                            others.insert( others.end(), it->second.begin(), it->second.end() );
+                    }
+                    else
+                    {
+                        for( const auto& [sheet, labels] : group.m_localLabels )
+                            others.insert( others.end(), labels.begin(), labels.end() );
+                    }
+                }
+
+                std::sort( others.begin(), others.end() );
+
+                for( size_t other : others )
+                {
+                    logError( normalized, aItem, aSheet, allItems[other] );
+                    errors += 1;
+                }
+
+                TEXT_GROUP& group = similar[aText];
+
+                if( aItem->Type() == SCH_LABEL_T )
+                    group.m_localLabels[aSheet].push_back( allItems.size() );
+                else
+                    group.m_items.push_back( allItems.size() );
+
+                allItems.emplace_back( aText, aItem, aSheet );
             };
 
     for( const std::pair<NET_NAME_CODE_CACHE_KEY, std::vector<CONNECTION_SUBGRAPH*>> net : m_nets )
@@ -1440,29 +1557,8 @@ int ERC_TESTER::TestSimilarLabels()
                 case SCH_GLOBAL_LABEL_T:
                 {
                     SCH_LABEL_BASE* label = static_cast<SCH_LABEL_BASE*>( item );
-                    wxString        unnormalized = label->GetShownText( &sheet, false );
-                    wxString        normalized = unnormalized.Lower();
-
-                    generalMap[normalized].emplace_back( std::make_tuple( unnormalized, label, sheet ) );
-
-                    for( const auto& otherTuple : generalMap.at( normalized ) )
-                    {
-                        const auto& [otherText, otherItem, otherSheet] = otherTuple;
-
-                        if( unnormalized != otherText )
-                        {
-                            // Similar local labels on different sheets are fine
-                            if( item->Type() == SCH_LABEL_T && otherItem->Type() == SCH_LABEL_T
-                                    && sheet != otherSheet )
-                            {
-                                continue;
-                            }
-
-                            logError( normalized, label, sheet, otherTuple );
-                            errors += 1;
-                        }
-                    }
 
+                    checkItem( label->GetShownText( &sheet, false ), label, sheet );
                     break;
                 }
                 case SCH_PIN_T:
@@ -1473,22 +1569,8 @@ int ERC_TESTER::TestSimilarLabels()
                         continue;
 
                     SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( pin->GetParentSymbol() );
-                    wxString    unnormalized = symbol->GetValue( true, &sheet, false );
-                    wxString    normalized = unnormalized.Lower();
-
-                    generalMap[normalized].emplace_back( std::make_tuple( unnormalized, pin, sheet ) );
-
-                    for( const auto& otherTuple : generalMap.at( normalized ) )
-                    {
-                        const auto& [otherText, otherItem, otherSheet] = otherTuple;
-
-                        if( unnormalized != otherText )
-                        {
-                            logError( normalized, pin, sheet, otherTuple );
-                            errors += 1;
-                        }
-                    }
 
+                    checkItem( symbol->GetValue( true, &sheet, false ), pin, sheet );
                     break;
                 }
 
@@ -1511,8 +1593,11 @@ int ERC_TESTER::TestLibSymbolIssues()
     wxString          msg;
     int               err_count = 0;
 
-    for( SCH_SCREEN* screen = m_screens.GetFirst(); screen; screen = m_screens.GetNext() )
+    // Not GetFirst()/GetNext(): other tests may be walking m_screens concurrently
+    for( unsigned ii = 0; ii < m_screens.GetCount(); ++ii )
     {
+        SCH_SCREEN* screen = m_screens.GetScreen( ii );
+
         std::vector<SCH_MARKER*> markers;
 
         for( SCH_ITEM* item : screen->Items().OfType( SCH_SYMBOL_T ) )
@@ -1629,7 +1714,7 @@ int ERC_TESTER::TestLibSymbolIssues()
 
         for( SCH_MARKER* marker : markers )
         {
-            screen->Append( marker );
+            addMarker( screen, marker );
             err_count += 1;
         }
     }
@@ -1709,7 +1794,7 @@ int ERC_TESTER::TestFootprintLinkIssues( KIFACE* aCvPcb, PROJECT* aProject )
 
         for( SCH_MARKER* marker : markers )
         {
-            sheet.LastScreen()->Append( marker );
+            addMarker( sheet.LastScreen(), marker );
             err_count += 1;
         }
     }
@@ -1780,7 +1865,7 @@ int ERC_TESTER::TestFootprintFilters()
 
         for( SCH_MARKER* marker : markers )
         {
-            sheet.LastScreen()->Append( marker );
+            addMarker( sheet.LastScreen(), marker );
             err_count += 1;
         }
     }
@@ -1794,8 +1879,10 @@ int ERC_TESTER::TestOffGridEndpoints()
     const int gridSize = m_schematic->Settings().m_ConnectionGridSize;
     int       err_count = 0;
 
-    for( SCH_SCREEN* screen = m_screens.GetFirst(); screen; screen = m_screens.GetNext() )
+    for( unsigned ii = 0; ii < m_screens.GetCount(); ++ii )
     {
+        SCH_SCREEN* screen = m_screens.GetScreen( ii );
+
         std::vector<SCH_MARKER*> markers;
 
         for( SCH_ITEM* item : screen->Items() )
@@ -1862,7 +1949,7 @@ int ERC_TESTER::TestOffGridEndpoints()
 
         for( SCH_MARKER* marker : markers )
         {
-            screen->Append( marker );
+            addMarker( screen, marker );
             err_count += 1;
         }
     }
@@ -1915,7 +2002,7 @@ int ERC_TESTER::TestSimModelIssues()
 
         for( SCH_MARKER* marker : markers )
         {
-            sheet.LastScreen()->Append( marker );
+            addMarker( sheet.LastScreen(), marker );
             err_count += 1;
         }
     }
@@ -1962,45 +2049,64 @@ void ERC_TESTER::RunTests( DS_PROXY_VIEW_ITEM* aDrawingSheet, SCH_EDIT_FRAME* aE
 
     m_schematic->ConnectionGraph()->RunERC();
 
-    if( aProgressReporter )
-        aProgressReporter->AdvancePhase( _( "Checking units..." ) );
+    // The remaining tests only read the schematic and the connection graph, so they run
+    // concurrently.  Each one collects its markers, which are added to the screens once all
+    // the tests are done, in the order below so that the results don't depend on scheduling.
+    struct ERC_TEST_TASK
+    {
+        wxString              m_phase;       ///< Progress phase to show, if any
+        std::function<void()> m_test;        ///< Test to run, if any
+        bool                  m_mainThread;  ///< Uses resources that aren't thread-safe
+        ERC_MARKER_LIST       m_markers;
+        std::future<void>     m_future;
+    };
+
+    std::vector<ERC_TEST_TASK> tasks;
+
+    auto addPhase =
+            [&]( const wxString& aPhase )
+            {
+                tasks.push_back( { aPhase, nullptr, false } );
+            };
+
+    auto addTest =
+            [&]( const wxString& aPhase, std::function<void()> aTest, bool aMainThread = false )
+            {
+                tasks.push_back( { aPhase, std::move( aTest ), aMainThread } );
+            };
+
+    addPhase( _( "Checking units..." ) );
 
     // Test is all units of each multiunit symbol have the same footprint assigned.
     if( m_settings.IsTestEnabled( ERCE_DIFFERENT_UNIT_FP ) )
-    {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking footprints..." ) );
-
-        TestMultiunitFootprints();
-    }
+        addTest( _( "Checking footprints..." ), [this]() { TestMultiunitFootprints(); } );
 
     if( m_settings.IsTestEnabled( ERCE_MISSING_UNIT )
         || m_settings.IsTestEnabled( ERCE_MISSING_INPUT_PIN )
         || m_settings.IsTestEnabled( ERCE_MISSING_POWER_INPUT_PIN )
         || m_settings.IsTestEnabled( ERCE_MISSING_BIDI_PIN ) )
     {
-        TestMissingUnits();
+        addTest( wxEmptyString, [this]() { TestMissingUnits(); } );
     }
 
-    if( aProgressReporter )
-        aProgressReporter->AdvancePhase( _( "Checking pins..." ) );
+    addPhase( _( "Checking pins..." ) );
 
     if( m_settings.IsTestEnabled( ERCE_DIFFERENT_UNIT_NET ) )
-        TestMultUnitPinConflicts();
+        addTest( wxEmptyString, [this]() { TestMultUnitPinConflicts(); } );
 
     // Test pins on each net against the pin connection table
     if( m_settings.IsTestEnabled( ERCE_PIN_TO_PIN_ERROR )
         || m_settings.IsTestEnabled( ERCE_POWERPIN_NOT_DRIVEN )
         || m_settings.IsTestEnabled( ERCE_PIN_NOT_DRIVEN ) )
     {
-        TestPinToPin();
+        addTest( wxEmptyString, [this]() { TestPinToPin(); } );
     }
 
     if( m_settings.IsTestEnabled( ERCE_GROUND_PIN_NOT_GROUND ) )
-        TestGroundPins();
+        addTest( wxEmptyString, [this]() { TestGroundPins(); } );
 
     if( m_settings.IsTestEnabled( ERCE_STACKED_PIN_SYNTAX ) )
-        TestStackedPinNotation();
+        addTest( wxEmptyString, [this]() { TestStackedPinNotation(); } );
 
     // Test similar labels (i;e. labels which are identical when
     // using case insensitive comparisons)
@@ -2008,99 +2114,139 @@ void ERC_TESTER::RunTests( DS_PROXY_VIEW_ITEM* aDrawingSheet, SCH_EDIT_FRAME* aE
         || m_settings.IsTestEnabled( ERCE_SIMILAR_POWER )
         || m_settings.IsTestEnabled( ERCE_SIMILAR_LABEL_AND_POWER ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking similar labels..." ) );
-
-        TestSimilarLabels();
+        addTest( _( "Checking similar labels..." ), [this]() { TestSimilarLabels(); } );
     }
 
     if( m_settings.IsTestEnabled( ERCE_SAME_LOCAL_GLOBAL_LABEL ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking local and global labels..." ) );
-
-        TestSameLocalGlobalLabel();
+        addTest( _( "Checking local and global labels..." ),
+                 [this]() { TestSameLocalGlobalLabel(); } );
     }
 
     if( m_settings.IsTestEnabled( ERCE_UNRESOLVED_VARIABLE ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking for unresolved variables..." ) );
-
-        TestTextVars( aDrawingSheet );
+        addTest( _( "Checking for unresolved variables..." ),
+                 [this, aDrawingSheet]() { TestTextVars( aDrawingSheet ); } );
     }
 
+    // Model creation may load simulation libraries
     if( m_settings.IsTestEnabled( ERCE_SIMULATION_MODEL ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking SPICE models..." ) );
-
-        TestSimModelIssues();
+        addTest( _( "Checking SPICE models..." ), [this]() { TestSimModelIssues(); },
+                 true );
     }
 
     if( m_settings.IsTestEnabled( ERCE_NOCONNECT_CONNECTED ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking no connect pins for connections..." ) );
-
-        TestNoConnectPins();
+        addTest( _( "Checking no connect pins for connections..." ),
+                 [this]() { TestNoConnectPins(); } );
     }
 
+    // Library symbols are loaded through the symbol library table
     if( m_settings.IsTestEnabled( ERCE_LIB_SYMBOL_ISSUES )
         || m_settings.IsTestEnabled( ERCE_LIB_SYMBOL_MISMATCH ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking for library symbol issues..." ) );
-
-        TestLibSymbolIssues();
+        addTest( _( "Checking for library symbol issues..." ), [this]() { TestLibSymbolIssues(); },
+                 true );
     }
 
     if( m_settings.IsTestEnabled( ERCE_FOOTPRINT_LINK_ISSUES ) && aCvPcb )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking for footprint link issues..." ) );
-
-        TestFootprintLinkIssues( aCvPcb, aProject );
+        addTest( _( "Checking for footprint link issues..." ),
+                 [this, aCvPcb, aProject]() { TestFootprintLinkIssues( aCvPcb, aProject ); },
+                 true );
     }
 
     if( m_settings.IsTestEnabled( ERCE_FOOTPRINT_FILTERS ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking footprint assignments against footprint filters..." ) );
-
-        TestFootprintFilters();
+        addTest( _( "Checking footprint assignments against footprint filters..." ),
+                 [this]() { TestFootprintFilters(); } );
     }
 
     if( m_settings.IsTestEnabled( ERCE_ENDPOINT_OFF_GRID ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking for off grid pins and wires..." ) );
-
-        TestOffGridEndpoints();
+        addTest( _( "Checking for off grid pins and wires..." ),
+                 [this]() { TestOffGridEndpoints(); } );
     }
 
     if( m_settings.IsTestEnabled( ERCE_FOUR_WAY_JUNCTION ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking for four way junctions..." ) );
-
-        TestFourWayJunction();
+        addTest( _( "Checking for four way junctions..." ),
+                 [this]() { TestFourWayJunction(); } );
     }
 
     if( m_settings.IsTestEnabled( ERCE_LABEL_MULTIPLE_WIRES ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking for labels on more than one wire..." ) );
-
-        TestLabelMultipleWires();
+        addTest( _( "Checking for labels on more than one wire..." ),
+                 [this]() { TestLabelMultipleWires(); } );
     }
 
     if( m_settings.IsTestEnabled( ERCE_UNDEFINED_NETCLASS ) )
     {
-        if( aProgressReporter )
-            aProgressReporter->AdvancePhase( _( "Checking for undefined netclasses..." ) );
+        addTest( _( "Checking for undefined netclasses..." ),
+                 [this]() { TestMissingNetclasses(); } );
+    }
+
+    auto runTask =
+            []( ERC_TEST_TASK& aTask )
+            {
+                SCOPED_SET_RESET<ERC_MARKER_LIST*> sink( s_pendingMarkers, &aTask.m_markers );
+                aTask.m_test();
+            };
+
+    thread_pool& tp = GetKiCadThreadPool();
+
+    for( ERC_TEST_TASK& task : tasks )
+    {
+        if( task.m_test && !task.m_mainThread )
+            task.m_future = tp.submit_task( [&runTask, &task]() { runTask( task ); } );
+    }
 
-        TestMissingNetclasses();
+    try
+    {
+        for( ERC_TEST_TASK& task : tasks )
+        {
+            if( aProgressReporter && !task.m_phase.IsEmpty() )
+                aProgressReporter->AdvancePhase( task.m_phase );
+
+            if( !task.m_test )
+                continue;
+
+            if( task.m_mainThread )
+            {
+                runTask( task );
+                continue;
+            }
+
+            while( task.m_future.wait_for( std::chrono::milliseconds( 100 ) )
+                    != std::future_status::ready )
+            {
+                if( aProgressReporter )
+                    aProgressReporter->KeepRefreshing();
+            }
+
+            task.m_future.get();
+        }
+    }
+    catch( ... )
+    {
+        // The queued tests reference the tasks on this stack: let them finish before unwinding
+        for( ERC_TEST_TASK& task : tasks )
+        {
+            if( task.m_future.valid() )
+                task.m_future.wait();
+
+            for( const auto& [screen, marker] : task.m_markers )
+                delete marker;
+        }
+
+        throw;
+    }
+
+    for( ERC_TEST_TASK& task : tasks )
+    {
+        for( const auto& [screen, marker] : task.m_markers )
+            screen->Append( marker );
     }
 
     m_schematic->ResolveERCExclusionsPostUpdate();
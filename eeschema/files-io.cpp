@@ -909,7 +909,9 @@ bool PrepareSaveAsFiles( SCHEMATIC& aSchematic, SCH_SCREENS& aScreens,
         }
     }
 
-    for( SCH_SHEET_PATH& sheet : aSchematic.Hierarchy() )
+    SCH_SHEET_LIST sheets = aSchematic.Hierarchy();
+
+    for( SCH_SHEET_PATH& sheet : sheets )
     {
         if( !sheet.Last()->IsRootSheet() )
             sheet.MakeFilePathRelativeToParentSheet();
@@ -1180,7 +1182,7 @@ bool SCH_EDIT_FRAME::SaveProject( bool aSaveAs )
     std::vector<FILE_INFO_PAIR>& sheets = Prj().GetProjectFile().GetSheets();
     sheets.clear();
 
-    for( SCH_SHEET_PATH& sheetPath : Schematic().Hierarchy() )
+    for( const SCH_SHEET_PATH& sheetPath : Schematic().Hierarchy() )
     {
         SCH_SHEET* sheet = sheetPath.Last();
 
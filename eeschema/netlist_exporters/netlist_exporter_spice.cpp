@@ -28,6 +28,7 @@
 #include <sim/spice_circuit_model.h>
 #include <sim/sim_library_spice.h>
 #include <sim/sim_model_raw_spice.h>
+#include <sim/sim_sweep.h>
 #include <common.h>
 #include <confirm.h>
 #include <pgm_base.h>
@@ -363,6 +364,7 @@ void NETLIST_EXPORTER_SPICE::ReadDirectives( unsigned aNetlistOptions )
                         || isDirective( line, wxS( ".SAVE" ) )
                         || isDirective( line, wxS( ".SENS" ) )
                         || isDirective( line, wxS( ".SP" ) )
+                        || isDirective( line, wxS( ".STEP" ) )
                         || isDirective( line, wxS( ".SUBCKT" ) )
                         || isDirective( line, wxS( ".TEMP" ) )
                         || isDirective( line, wxS( ".TF" ) )
@@ -681,8 +683,29 @@ void NETLIST_EXPORTER_SPICE::WriteDirectives( const wxString& aSimCommand, unsig
                         || isSimCommand( candidate, wxS( ".TF" ) ) );
         }
 
-        if( !simCommand || ( aSimOptions & OPTION_SIM_COMMAND ) )
+        if( simCommand && !( aSimOptions & OPTION_SIM_COMMAND ) )
+            continue;
+
+        // .step is not understood by ngspice; it is handled by the simulator frame, which
+        // runs a netlist for each step (see SIM_SWEEP)
+        if( directive.Lower().Contains( wxS( ".step" ) ) )
+        {
+            wxStringTokenizer tokenizer( directive, wxT( "\r\n" ), wxTOKEN_STRTOK );
+
+            while( tokenizer.HasMoreTokens() )
+            {
+                wxString line = tokenizer.GetNextToken();
+
+                if( SIM_SWEEP::IsStepDirective( line ) )
+                    line.Prepend( wxS( "* " ) );
+
+                aFormatter.Print( 0, "%s\n", UTF8( line ).c_str() );
+            }
+        }
+        else
+        {
             aFormatter.Print( 0, "%s\n", UTF8( directive ).c_str() );
+        }
     }
 }
 
@@ -213,7 +213,7 @@ bool SCH_COLLECTOR::IsCorner() const
 
 
 void CollectOtherUnits( const wxString& aRef, int aUnit, const LIB_ID& aLibId,
-                        SCH_SHEET_PATH& aSheet, std::vector<SCH_SYMBOL*>* otherUnits )
+                        const SCH_SHEET_PATH& aSheet, std::vector<SCH_SYMBOL*>* otherUnits )
 {
     SCH_REFERENCE_LIST symbols;
     aSheet.GetSymbols( symbols );
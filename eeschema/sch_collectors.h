@@ -109,4 +109,4 @@ public:
 
 
 void CollectOtherUnits( const wxString& thisRef, int thisUnit, const LIB_ID& aLibId,
-                        SCH_SHEET_PATH& aSheet, std::vector<SCH_SYMBOL*>* otherUnits );
+                        const SCH_SHEET_PATH& aSheet, std::vector<SCH_SYMBOL*>* otherUnits );
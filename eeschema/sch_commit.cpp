@@ -364,6 +364,9 @@ void SCH_COMMIT::pushSchEdit( const wxString& aMessage, int aCommitFlags )
                     refreshHierarchy = true;
             }
 
+            // Pins, fields or sheet pins may have been added or removed
+            screen->ItemsChanged();
+
             if( frame )
                 frame->UpdateItem( schItem, false, true );
 
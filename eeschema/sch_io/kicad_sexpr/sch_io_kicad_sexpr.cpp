@@ -60,6 +60,7 @@
 #include <sch_textbox.h>
 #include <string_utils.h>
 #include <symbol_lib_table.h>  // for PropPowerSymsOnly definition.
+#include <thread_pool.h>
 #include <trace_helpers.h>
 
 using namespace TSCHEMATIC_T;
@@ -91,6 +92,8 @@ void SCH_IO_KICAD_SEXPR::init( SCHEMATIC* aSchematic,
     m_schematic = aSchematic;
     m_cache     = nullptr;
     m_out       = nullptr;
+
+    m_prefetchedFiles.clear();
 }
 
 
@@ -169,6 +172,7 @@ SCH_SHEET* SCH_IO_KICAD_SEXPR::LoadSchematicFile( const wxString& aFileName, SCH
     wxASSERT( m_currentPath.size() == 1 );  // only the project path should remain
 
     m_currentPath.pop(); // Clear the path stack for next call to Load
+    m_prefetchedFiles.clear();
 
     return sheet;
 }
@@ -258,6 +262,8 @@ void SCH_IO_KICAD_SEXPR::loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath,
                 m_error += ioe.What();
             }
 
+            prefetchSubsheets( aSheet->GetScreen() );
+
             if( fileName.FileExists() )
             {
                 aSheet->GetScreen()->SetFileReadOnly( !fileName.IsFileWritable() );
@@ -292,11 +298,66 @@ void SCH_IO_KICAD_SEXPR::loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath,
 }
 
 
+void SCH_IO_KICAD_SEXPR::prefetchSubsheets( SCH_SCREEN* aScreen )
+{
+    thread_pool& tp = GetKiCadThreadPool();
+
+    for( SCH_ITEM* aItem : aScreen->Items().OfType( SCH_SHEET_T ) )
+    {
+        SCH_SHEET* sheet = static_cast<SCH_SHEET*>( aItem );
+
+        if( sheet->GetScreen() )
+            continue;
+
+        // Must match the file name resolution done by loadHierarchy() for this sheet.
+        wxFileName fileName = sheet->GetFileName();
+
+        if( !fileName.IsAbsolute() )
+            fileName.MakeAbsolute( m_currentPath.top() );
+
+        wxString fullPath = fileName.GetFullPath();
+
+        if( m_prefetchedFiles.contains( fullPath ) )
+            continue;
+
+        m_prefetchedFiles[fullPath] = tp.submit_task(
+                [fullPath]() -> std::optional<std::string>
+                {
+                    try
+                    {
+                        FILE_LINE_READER reader( fullPath );
+                        std::string      content;
+
+                        while( reader.ReadLine() )
+                            content.append( reader.Line(), reader.Length() );
+
+                        return content;
+                    }
+                    catch( const IO_ERROR& )
+                    {
+                        // loadFile() will read the file itself and report the error.
+                        return std::nullopt;
+                    }
+                } );
+    }
+}
+
+
 void SCH_IO_KICAD_SEXPR::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
 {
-    FILE_LINE_READER reader( aFileName );
+    std::optional<std::string> prefetched;
+    auto                       it = m_prefetchedFiles.find( aFileName );
+
+    if( it != m_prefetchedFiles.end() && it->second.valid() )
+        prefetched = it->second.get();
+
+    std::unique_ptr<LINE_READER> reader;
+    size_t                       lineCount = 0;
 
-    size_t lineCount = 0;
+    if( prefetched )
+        reader = std::make_unique<STRING_LINE_READER>( *prefetched, aFileName );
+    else
+        reader = std::make_unique<FILE_LINE_READER>( aFileName );
 
     if( m_progressReporter )
     {
@@ -305,13 +366,22 @@ void SCH_IO_KICAD_SEXPR::loadFile( const wxString& aFileName, SCH_SHEET* aSheet
         if( !m_progressReporter->KeepRefreshing() )
             THROW_IO_ERROR( _( "Open canceled by user." ) );
 
-        while( reader.ReadLine() )
-            lineCount++;
+        if( prefetched )
+        {
+            lineCount = std::count( prefetched->begin(), prefetched->end(), '\n' );
+        }
+        else
+        {
+            FILE_LINE_READER* fileReader = static_cast<FILE_LINE_READER*>( reader.get() );
+
+            while( fileReader->ReadLine() )
+                lineCount++;
 
-        reader.Rewind();
+            fileReader->Rewind();
+        }
     }
 
-    SCH_IO_KICAD_SEXPR_PARSER parser( &reader, m_progressReporter, lineCount, m_rootSheet,
+    SCH_IO_KICAD_SEXPR_PARSER parser( reader.get(), m_progressReporter, lineCount, m_rootSheet,
                                       m_appending );
 
     parser.ParseSchematic( aSheet );
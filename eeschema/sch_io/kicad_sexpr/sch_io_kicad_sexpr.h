@@ -23,7 +23,10 @@
 #ifndef SCH_IO_KICAD_SEXPR_H_
 #define SCH_IO_KICAD_SEXPR_H_
 
+#include <future>
+#include <map>
 #include <memory>
+#include <optional>
 #include <sch_io/sch_io.h>
 #include <sch_io/sch_io_mgr.h>
 #include <sch_file_versions.h>
@@ -144,6 +147,12 @@ private:
     void loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath, SCH_SHEET* aSheet );
     void loadFile( const wxString& aFileName, SCH_SHEET* aSheet );
 
+    /**
+     * Start reading the files of the not yet loaded sub-sheets of \a aScreen in the background,
+     * so that they are in memory by the time the hierarchy recursion gets to them.
+     */
+    void prefetchSubsheets( SCH_SCREEN* aScreen );
+
     void saveSymbol( SCH_SYMBOL* aSymbol, const SCHEMATIC& aSchematic,
                      const SCH_SHEET_LIST& aSheetList, bool aForClipboard,
                      const SCH_SHEET_PATH* aRelativePath = nullptr );
@@ -180,6 +189,10 @@ protected:
     OUTPUTFORMATTER*        m_out;              ///< The formatter for saving SCH_SCREEN objects.
     SCH_IO_KICAD_SEXPR_LIB_CACHE* m_cache;
 
+    /// Contents of the sub-sheet files read ahead of parsing, keyed by absolute file name.
+    /// Consumed entries are kept (as invalid futures) so that shared sheets are read only once.
+    std::map<wxString, std::future<std::optional<std::string>>> m_prefetchedFiles;
+
     /// initialize PLUGIN like a constructor would.
     void init( SCHEMATIC* aSchematic, const std::map<std::string, UTF8>* aProperties = nullptr );
 
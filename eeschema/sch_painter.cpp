@@ -2393,7 +2393,7 @@ void SCH_PAINTER::draw( const SCH_TEXT* aText, int aLayer, bool aDimmed )
         }
         else
         {
-            std::vector<std::unique_ptr<KIFONT::GLYPH>>* cache = nullptr;
+            std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>> cache;
 
             if( !aText->IsHypertext() && font->IsOutline() )
                 cache = aText->GetRenderCache( font, shownText, text_offset );
@@ -2490,7 +2490,7 @@ void SCH_PAINTER::draw( const SCH_TEXTBOX* aTextBox, int aLayer, bool aDimmed )
                     attrs.m_Underlined = true;
                 }
 
-                std::vector<std::unique_ptr<KIFONT::GLYPH>>* cache = nullptr;
+                std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>> cache;
 
                 if( !aTextBox->IsHypertext() && font->IsOutline() )
                     cache = aTextBox->GetRenderCache( font, shownText );
@@ -34,6 +34,7 @@
 #include <wx/regex.h>
 #include <algorithm>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <string_utils.h>
@@ -392,6 +393,165 @@ void SCH_REFERENCE_LIST::AnnotateByOptions( ANNOTATE_ORDER_T
 }
 
 
+/**
+ * The reference numbers in use in a reference list, by case insensitive reference prefix, in the
+ * form expected by REFDES_TRACKER::GetNextRefDesForUnits().
+ *
+ * This holds the same data FindFirstUnusedReference() collects by scanning the whole list, but
+ * is updated reference by reference as Annotate() assigns numbers.  References still to be
+ * annotated are left out, and the references sharing a number are kept in list order.
+ */
+class SCH_REFERENCE_LIST::USED_REF_NUMBERS
+{
+public:
+    USED_REF_NUMBERS( const std::vector<SCH_REFERENCE>& aList ) :
+            m_list( aList ),
+            m_indexed( aList.size() )
+    {
+        for( unsigned ii = 0; ii < aList.size(); ii++ )
+            Update( ii );
+    }
+
+    /**
+     * Re-read the reference at \a aIndex in the list after its number, unit or annotation
+     * status changed.
+     */
+    void Update( unsigned aIndex )
+    {
+        INDEXED& indexed = m_indexed[aIndex];
+
+        if( indexed.m_group )
+        {
+            remove( *indexed.m_group, indexed.m_number, aIndex );
+            indexed.m_group = nullptr;
+        }
+
+        const SCH_REFERENCE& ref = m_list[aIndex];
+
+        if( ref.m_isNew )
+            return;
+
+        indexed.m_group = &m_groups[ref.m_ref.Lower()];
+        indexed.m_number = ref.m_numRef;
+        insert( *indexed.m_group, ref.m_numRef, aIndex );
+    }
+
+    /**
+     * @return the references in use with the prefix of \a aRef, by reference number.
+     */
+    const std::map<int, std::vector<SCH_REFERENCE>>& Numbers( const SCH_REFERENCE& aRef ) const
+    {
+        static const std::map<int, std::vector<SCH_REFERENCE>> empty;
+
+        auto it = m_groups.find( aRef.m_ref.Lower() );
+
+        return it == m_groups.end() ? empty : it->second.m_numbers;
+    }
+
+    /**
+     * @return the smallest number not in use with the prefix of \a aRef which is not less
+     *         than \a aMinValue.
+     */
+    int FirstFree( const SCH_REFERENCE& aRef, int aMinValue ) const
+    {
+        auto it = m_groups.find( aRef.m_ref.Lower() );
+
+        if( it == m_groups.end() )
+            return aMinValue;
+
+        const std::map<int, int>& runs = it->second.m_runs;
+        auto                      next = runs.upper_bound( aMinValue );
+
+        if( next != runs.begin() && std::prev( next )->second >= aMinValue )
+            return std::prev( next )->second + 1;
+
+        return aMinValue;
+    }
+
+private:
+    struct GROUP
+    {
+        std::map<int, std::vector<SCH_REFERENCE>> m_numbers;
+        std::map<int, std::vector<unsigned>>      m_positions;  ///< List indices of m_numbers
+        std::map<int, int>                        m_runs;       ///< Consecutive numbers in use,
+                                                                ///< first -> last
+    };
+
+    struct INDEXED
+    {
+        GROUP* m_group = nullptr;
+        int    m_number = 0;
+    };
+
+    void insert( GROUP& aGroup, int aNumber, unsigned aIndex )
+    {
+        std::vector<unsigned>&      positions = aGroup.m_positions[aNumber];
+        std::vector<SCH_REFERENCE>& refs = aGroup.m_numbers[aNumber];
+        auto                        it = std::lower_bound( positions.begin(), positions.end(),
+                                                           aIndex );
+
+        refs.insert( refs.begin() + ( it - positions.begin() ), m_list[aIndex] );
+        positions.insert( it, aIndex );
+
+        if( refs.size() > 1 )
+            return;
+
+        // Merge aNumber with the runs ending just before and starting just after it
+        int  first = aNumber;
+        int  last = aNumber;
+        auto next = aGroup.m_runs.upper_bound( aNumber );
+
+        if( next != aGroup.m_runs.end() && next->first == aNumber + 1 )
+        {
+            last = next->second;
+            next = aGroup.m_runs.erase( next );
+        }
+
+        if( next != aGroup.m_runs.begin() && std::prev( next )->second == aNumber - 1 )
+        {
+            first = std::prev( next )->first;
+            aGroup.m_runs.erase( std::prev( next ) );
+        }
+
+        aGroup.m_runs[first] = last;
+    }
+
+    void remove( GROUP& aGroup, int aNumber, unsigned aIndex )
+    {
+        std::vector<unsigned>&      positions = aGroup.m_positions[aNumber];
+        std::vector<SCH_REFERENCE>& refs = aGroup.m_numbers[aNumber];
+        auto                        it = std::lower_bound( positions.begin(), positions.end(),
+                                                           aIndex );
+
+        refs.erase( refs.begin() + ( it - positions.begin() ) );
+        positions.erase( it );
+
+        if( !refs.empty() )
+            return;
+
+        aGroup.m_numbers.erase( aNumber );
+        aGroup.m_positions.erase( aNumber );
+
+        // Split the run holding aNumber
+        auto run = std::prev( aGroup.m_runs.upper_bound( aNumber ) );
+        int  first = run->first;
+        int  last = run->second;
+
+        aGroup.m_runs.erase( run );
+
+        if( first < aNumber )
+            aGroup.m_runs[first] = aNumber - 1;
+
+        if( aNumber < last )
+            aGroup.m_runs[aNumber + 1] = last;
+    }
+
+    const std::vector<SCH_REFERENCE>&   m_list;
+    std::vector<INDEXED>                m_indexed;
+    std::unordered_map<wxString, GROUP> m_groups;
+};
+
+
 void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int aStartNumber,
                                    const SCH_MULTI_UNIT_REFERENCE_MAP& aLockedUnitMap,
                                    const SCH_REFERENCE_LIST& aAdditionalRefs,
@@ -434,6 +594,48 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
         AddItem( additionalRef ); //add to this container
     }
 
+    // Index the list once instead of rescanning it for each symbol: the numbers in use by
+    // prefix, the list positions of each symbol, and the locked list of each symbol instance.
+    USED_REF_NUMBERS usedNumbers( m_flatList );
+
+    std::unordered_map<const SCH_SYMBOL*, std::vector<unsigned>> symbolPositions;
+
+    for( unsigned ii = 0; ii < m_flatList.size(); ii++ )
+        symbolPositions[m_flatList[ii].GetSymbol()].push_back( ii );
+
+    std::unordered_map<const SCH_SYMBOL*,
+                       std::vector<std::pair<KIID_PATH, const SCH_REFERENCE_LIST*>>> lockedLists;
+
+    for( const SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
+    {
+        for( const SCH_REFERENCE& lockedRef : pair.second )
+        {
+            lockedLists[lockedRef.GetSymbol()].emplace_back( lockedRef.GetSheetPath().Path(),
+                                                             &pair.second );
+        }
+    }
+
+    auto findFirstUnusedReference =
+            [&]( const SCH_REFERENCE& aRef, int aMinValue, const std::vector<int>& aUnits )
+            {
+                if( !m_indexedAnnotation )
+                    return FindFirstUnusedReference( aRef, aMinValue, aUnits );
+
+                // Numbers in use can only be shared when units are required, so skip them
+                // rather than having the tracker reject them one at a time.
+                if( std::none_of( aUnits.begin(), aUnits.end(),
+                                  []( int aUnit )
+                                  {
+                                      return aUnit >= 0;
+                                  } ) )
+                {
+                    aMinValue = usedNumbers.FirstFree( aRef, aMinValue );
+                }
+
+                return m_refDesTracker->GetNextRefDesForUnits( aRef, usedNumbers.Numbers( aRef ),
+                                                               aUnits, aMinValue );
+            };
+
     int LastReferenceNumber = 0;
 
     /* calculate index of the first symbol with the same reference prefix
@@ -463,23 +665,35 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
         // Check whether this symbol is in aLockedUnitMap.
         const SCH_REFERENCE_LIST* lockedList = nullptr;
 
-        for( const SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
+        if( !m_indexedAnnotation )
         {
-            unsigned n_refs = pair.second.GetCount();
-
-            for( unsigned thisRefI = 0; thisRefI < n_refs; ++thisRefI )
+            for( const SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
             {
-                const SCH_REFERENCE &thisRef = pair.second[thisRefI];
+                for( const SCH_REFERENCE& lockedRef : pair.second )
+                {
+                    if( lockedRef.IsSameInstance( ref_unit ) )
+                    {
+                        lockedList = &pair.second;
+                        break;
+                    }
+                }
+
+                if( lockedList != nullptr )
+                    break;
+            }
+        }
+        else if( auto it = lockedLists.find( ref_unit.GetSymbol() ); it != lockedLists.end() )
+        {
+            KIID_PATH path = ref_unit.GetSheetPath().Path();
 
-                if( thisRef.IsSameInstance( ref_unit ) )
+            for( const auto& [lockedPath, list] : it->second )
+            {
+                if( lockedPath == path )
                 {
-                    lockedList = &pair.second;
+                    lockedList = list;
                     break;
                 }
             }
-
-            if( lockedList != nullptr )
-                break;
         }
 
         if(  ( m_flatList[first].CompareRef( ref_unit ) != 0 )
@@ -506,13 +720,14 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
         {
             if( ref_unit.m_isNew )
             {
-                LastReferenceNumber = FindFirstUnusedReference( ref_unit, minRefId, {} );
+                LastReferenceNumber = findFirstUnusedReference( ref_unit, minRefId, {} );
                 ref_unit.m_numRef = LastReferenceNumber;
                 ref_unit.m_numRefStr = ref_unit.formatRefStr( LastReferenceNumber );
             }
 
             ref_unit.m_flag  = 1;
             ref_unit.m_isNew = false;
+            usedNumbers.Update( ii );
             continue;
         }
 
@@ -525,7 +740,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
 
             if( ref_unit.m_isNew )
             {
-                LastReferenceNumber = FindFirstUnusedReference( ref_unit, minRefId, units );
+                LastReferenceNumber = findFirstUnusedReference( ref_unit, minRefId, units );
                 ref_unit.m_numRef = LastReferenceNumber;
                 ref_unit.m_numRefStr = ref_unit.formatRefStr( LastReferenceNumber );
                 ref_unit.m_isNew = false;
@@ -552,29 +767,52 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     continue;
 
                 // Find the matching symbol
-                for( unsigned jj = ii + 1; jj < m_flatList.size(); jj++ )
+                auto propagate =
+                        [&]( unsigned jj ) -> bool
+                        {
+                            if( jj <= ii || !lockedRef.IsSameInstance( m_flatList[jj] ) )
+                                return false;
+
+                            wxString ref_candidate = buildFullReference( ref_unit,
+                                                                         lockedRef.m_unit );
+
+                            // propagate the new reference and unit selection to the "old"
+                            // symbol, if this new full reference is not already used (can
+                            // happens when initial multiunits symbols have duplicate references)
+                            if( inUseRefs.find( ref_candidate ) != inUseRefs.end() )
+                                return false;
+
+                            m_flatList[jj].m_numRef = ref_unit.m_numRef;
+                            m_flatList[jj].m_numRefStr = ref_unit.m_numRefStr;
+                            m_flatList[jj].m_isNew = false;
+                            m_flatList[jj].m_flag = 1;
+                            usedNumbers.Update( jj );
+
+                            // lock this new full reference
+                            inUseRefs.insert( ref_candidate );
+                            return true;
+                        };
+
+                if( !m_indexedAnnotation )
                 {
-                    if( !lockedRef.IsSameInstance( m_flatList[jj] ) )
-                        continue;
-
-                    wxString ref_candidate = buildFullReference( ref_unit, lockedRef.m_unit );
-
-                    // propagate the new reference and unit selection to the "old" symbol,
-                    // if this new full reference is not already used (can happens when initial
-                    // multiunits symbols have duplicate references)
-                    if( inUseRefs.find( ref_candidate ) == inUseRefs.end() )
+                    for( unsigned jj = ii + 1; jj < m_flatList.size(); jj++ )
                     {
-                        m_flatList[jj].m_numRef = ref_unit.m_numRef;
-                        m_flatList[jj].m_numRefStr = ref_unit.m_numRefStr;
-                        m_flatList[jj].m_isNew = false;
-                        m_flatList[jj].m_flag = 1;
-
-                        // lock this new full reference
-                        inUseRefs.insert( ref_candidate );
-                        break;
+                        if( propagate( jj ) )
+                            break;
+                    }
+                }
+                else if( auto positions = symbolPositions.find( lockedRef.GetSymbol() );
+                         positions != symbolPositions.end() )
+                {
+                    for( unsigned jj : positions->second )
+                    {
+                        if( propagate( jj ) )
+                            break;
                     }
                 }
             }
+
+            usedNumbers.Update( ii );
         }
         else if( ref_unit.m_isNew )
         {
@@ -582,11 +820,12 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
             // know what group this might belong to, so just find the first unused reference for
             // this specific unit. The other units will be annotated in the following passes.
             std::vector<int> units = { ref_unit.GetUnit() };
-            LastReferenceNumber = FindFirstUnusedReference( ref_unit, minRefId, units );
+            LastReferenceNumber = findFirstUnusedReference( ref_unit, minRefId, units );
             ref_unit.m_numRef = LastReferenceNumber;
             ref_unit.m_numRefStr = ref_unit.formatRefStr( LastReferenceNumber );
             ref_unit.m_isNew = false;
             ref_unit.m_flag = 1;
+            usedNumbers.Update( ii );
         }
     }
 
@@ -603,6 +603,13 @@ public:
         m_refDesTracker = aTracker;
     }
 
+    /**
+     * Annotate() indexes the reference numbers in use instead of scanning the whole list for
+     * every symbol.  Without the index the result is the same, only much slower on large
+     * designs; this is meant to check the index.
+     */
+    void SetIndexedAnnotation( bool aIndexed ) { m_indexedAnnotation = aIndexed; }
+
     friend class BACK_ANNOTATION;
 
     typedef std::vector<SCH_REFERENCE>::iterator       iterator;
@@ -636,9 +643,14 @@ private:
     // Used for sorting static sortByTimeStamp function
     friend class BACK_ANNOTATE;
 
+    /// Index of the reference numbers in use, kept up to date by Annotate().
+    class USED_REF_NUMBERS;
+
     std::vector<SCH_REFERENCE> m_flatList;
 
     std::shared_ptr<REFDES_TRACKER> m_refDesTracker; ///< A list of previously used reference designators.
+
+    bool m_indexedAnnotation = true;                 ///< See SetIndexedAnnotation()
 };
 
 #endif    // _SCH_REFERENCE_LIST_H_
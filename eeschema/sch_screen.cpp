@@ -61,6 +61,7 @@
 #include <locale_io.h>
 
 #include <algorithm>
+#include <atomic>
 #include <math/vector3.h>
 #include <memory>
 
@@ -77,6 +78,10 @@
 static const wxChar DanglingProfileMask[] = wxT( "DANGLING_PROFILE" );
 
 
+/// Source of the item generations of the screens, unique across screens.
+static std::atomic<uint64_t> s_itemsGeneration( 0 );
+
+
 SCH_SCREEN::SCH_SCREEN( EDA_ITEM* aParent ) :
     BASE_SCREEN( aParent, SCH_SCREEN_T ),
     m_fileFormatVersionAtLoad( 0 ),
@@ -92,6 +97,8 @@ SCH_SCREEN::SCH_SCREEN( EDA_ITEM* aParent ) :
     // Suitable for schematic only. For symbol_editor and viewlib, must be set to true
     m_Center = false;
 
+    ItemsChanged();
+
     InitDataPoints( m_paper.GetSizeIU( schIUScale.IU_PER_MILS ) );
 }
 
@@ -265,6 +272,7 @@ void SCH_SCREEN::Append( SCH_ITEM* aItem, bool aUpdateLibSymbol )
         }
 
         m_rtree.insert( aItem );
+        ItemsChanged();
         --m_modification_sync;
     }
 }
@@ -293,6 +301,7 @@ void SCH_SCREEN::Clear( bool aFree )
     else
     {
         m_rtree.clear();
+        ItemsChanged();
     }
 
     // Clear the project settings
@@ -315,6 +324,7 @@ void SCH_SCREEN::FreeDrawList()
             } );
 
     m_rtree.clear();
+    ItemsChanged();
 
     for( SCH_ITEM* item : delete_list )
         delete item;
@@ -332,6 +342,9 @@ bool SCH_SCREEN::Remove( SCH_ITEM* aItem, bool aUpdateLibSymbol )
 {
     bool retv = m_rtree.remove( aItem );
 
+    if( retv )
+        ItemsChanged();
+
     // Check if the library symbol for the removed schematic symbol is still required.
     if( retv && aItem->Type() == SCH_SYMBOL_T && aUpdateLibSymbol )
     {
@@ -397,6 +410,18 @@ bool SCH_SCREEN::CheckIfOnDrawList( const SCH_ITEM* aItem ) const
 }
 
 
+void SCH_SCREEN::ItemsChanged()
+{
+    m_itemsGeneration = ++s_itemsGeneration;
+}
+
+
+uint64_t SCH_SCREEN::GetLastItemsGeneration()
+{
+    return s_itemsGeneration;
+}
+
+
 SCH_ITEM* SCH_SCREEN::GetItem( const VECTOR2I& aPosition, int aAccuracy, KICAD_T aType ) const
 {
     BOX2I bbox;
@@ -835,6 +860,9 @@ void SCH_SCREEN::UpdateLocalLibSymbolLinks()
 
         m_rtree.insert( symbol );
     }
+
+    // The pins of the symbols have been rebuilt
+    ItemsChanged();
 }
 
 
@@ -1080,7 +1108,7 @@ size_t SCH_SCREEN::CountConnectedItems( const VECTOR2I& aPos, bool aTestJunction
 }
 
 
-void SCH_SCREEN::ClearAnnotation( SCH_SHEET_PATH* aSheetPath, bool aResetPrefix )
+void SCH_SCREEN::ClearAnnotation( const SCH_SHEET_PATH* aSheetPath, bool aResetPrefix )
 {
 
     for( SCH_ITEM* item : Items().OfType( SCH_SYMBOL_T ) )
@@ -1867,7 +1895,7 @@ void SCH_SCREENS::ClearAnnotationOfNewSheetPaths( SCH_SHEET_LIST& aInitialSheetP
 
     // Search for new sheet paths, not existing in aInitialSheetPathList
     // and existing in sheetpathList
-    for( SCH_SHEET_PATH& sheetpath : sch->Hierarchy() )
+    for( const SCH_SHEET_PATH& sheetpath : sch->Hierarchy() )
     {
         bool path_exists = false;
 
@@ -1930,6 +1958,12 @@ int SCH_SCREENS::ReplaceDuplicateTimeStamps()
         }
     }
 
+    if( count )
+    {
+        for( SCH_SCREEN* screen : m_screens )
+            screen->ItemsChanged();
+    }
+
     return count;
 }
 
@@ -2106,7 +2140,7 @@ void SCH_SCREENS::BuildClientSheetPathList()
     for( SCH_SCREEN* curr_screen = GetFirst(); curr_screen; curr_screen = GetNext() )
         curr_screen->GetClientSheetPaths().clear();
 
-    for( SCH_SHEET_PATH& sheetpath : sch->Hierarchy() )
+    for( const SCH_SHEET_PATH& sheetpath : sch->Hierarchy() )
     {
         SCH_SCREEN* used_screen = sheetpath.LastScreen();
 
@@ -288,6 +288,26 @@ public:
 
     bool CheckIfOnDrawList( const SCH_ITEM* aItem ) const;
 
+    /**
+     * Flag the items of the screen as changed, so that the KIID index of the schematic is
+     * refreshed.  Call it when children were added to or removed from an item of the screen,
+     * or when a KIID was changed in place.  Append(), Remove() and Clear() do it already.
+     */
+    void ItemsChanged();
+
+    /**
+     * @return a number that changes every time the items of the screen change.  It is unique
+     *         across screens, so it also tells apart a screen created at the address of a
+     *         deleted one.
+     */
+    uint64_t GetItemsGeneration() const { return m_itemsGeneration; }
+
+    /**
+     * @return the latest item generation given to any screen.  It changes whenever the items of
+     *         a screen change or a screen is created.
+     */
+    static uint64_t GetLastItemsGeneration();
+
     /**
      * Test all of the connectable objects in the schematic for unused connection points.
      *
@@ -394,7 +414,7 @@ public:
      * @param[in] aResetPrefix The annotation prefix ('R', 'U', etc.) should be reset to the
      *                         symbol library prefix.
      */
-    void ClearAnnotation( SCH_SHEET_PATH* aSheetPath, bool aResetPrefix );
+    void ClearAnnotation( const SCH_SHEET_PATH* aSheetPath, bool aResetPrefix );
 
     /**
      * For screens shared by many sheetpaths (complex hierarchies):
@@ -701,6 +721,8 @@ private:
     VECTOR2I    m_aux_origin;               // Origin used for drill & place files by Pcbnew.
     EE_RTREE    m_rtree;
 
+    uint64_t    m_itemsGeneration;          // See GetItemsGeneration().
+
     int         m_modification_sync;        // Inequality with SYMBOL_LIBS::GetModificationHash()
                                             // will trigger ResolveAll().
 
@@ -990,32 +990,31 @@ void SCH_SHEET_LIST::ClearModifyStatus()
 }
 
 
-SCH_ITEM* SCH_SHEET_LIST::ResolveItem( const KIID& aID, SCH_SHEET_PATH* aPathOut, bool aAllowNullptrReturn ) const
+/**
+ * @return the schematic owning the screens of \a aSheets, or nullptr if they are not attached
+ *         to one yet.
+ */
+static const SCHEMATIC* schematicOf( const SCH_SHEET_LIST& aSheets )
 {
-    for( const SCH_SHEET_PATH& sheet : *this )
+    for( const SCH_SHEET_PATH& sheet : aSheets )
     {
-        SCH_ITEM* item = sheet.ResolveItem( aID );
-
-        if( item )
-        {
-            if( aPathOut )
-                *aPathOut = sheet;
+        SCH_SCREEN* screen = sheet.LastScreen();
 
-            return item;
-        }
+        if( screen && screen->GetParent() && screen->GetParent()->Type() == SCHEMATIC_T )
+            return static_cast<const SCHEMATIC*>( screen->GetParent() );
     }
 
-    // Not found; weak reference has been deleted.
-    if( aAllowNullptrReturn )
-        return nullptr;
-    else
-        return DELETED_SHEET_ITEM::GetInstance();
+    return nullptr;
 }
 
 
-SCH_ITEM* SCH_SHEET_PATH::ResolveItem( const KIID& aID ) const
+/**
+ * Search the items of \a aScreen and their children for \a aID, for screens which are not
+ * attached to a schematic and so have no KIID index.
+ */
+static SCH_ITEM* searchScreen( SCH_SCREEN* aScreen, const KIID& aID )
 {
-    for( SCH_ITEM* aItem : LastScreen()->Items() )
+    for( SCH_ITEM* aItem : aScreen->Items() )
     {
         if( aItem->m_Uuid == aID )
             return aItem;
@@ -1038,7 +1037,56 @@ SCH_ITEM* SCH_SHEET_PATH::ResolveItem( const KIID& aID ) const
 }
 
 
-void SCH_SHEET_LIST::FillItemMap( std::map<KIID, EDA_ITEM*>& aMap )
+SCH_ITEM* SCH_SHEET_LIST::ResolveItem( const KIID& aID, SCH_SHEET_PATH* aPathOut, bool aAllowNullptrReturn ) const
+{
+    SCH_ITEM* item = nullptr;
+
+    if( const SCHEMATIC* schematic = schematicOf( *this ) )
+    {
+        item = schematic->FindItemByKIID( aID, *this, aPathOut );
+    }
+    else
+    {
+        for( const SCH_SHEET_PATH& sheet : *this )
+        {
+            if( sheet.LastScreen() )
+                item = searchScreen( sheet.LastScreen(), aID );
+
+            if( item )
+            {
+                if( aPathOut )
+                    *aPathOut = sheet;
+
+                break;
+            }
+        }
+    }
+
+    if( item )
+        return item;
+
+    // Not found; weak reference has been deleted.
+    if( aAllowNullptrReturn )
+        return nullptr;
+    else
+        return DELETED_SHEET_ITEM::GetInstance();
+}
+
+
+SCH_ITEM* SCH_SHEET_PATH::ResolveItem( const KIID& aID ) const
+{
+    SCH_SHEET_LIST sheets;
+
+    sheets.push_back( *this );
+
+    if( const SCHEMATIC* schematic = schematicOf( sheets ) )
+        return schematic->FindItemByKIID( aID, sheets );
+
+    return searchScreen( LastScreen(), aID );
+}
+
+
+void SCH_SHEET_LIST::FillItemMap( std::map<KIID, EDA_ITEM*>& aMap ) const
 {
     for( const SCH_SHEET_PATH& sheet : *this )
     {
@@ -1059,7 +1107,7 @@ void SCH_SHEET_LIST::FillItemMap( std::map<KIID, EDA_ITEM*>& aMap )
 }
 
 
-void SCH_SHEET_LIST::AnnotatePowerSymbols()
+void SCH_SHEET_LIST::AnnotatePowerSymbols() const
 {
     // List of reference for power symbols
     SCH_REFERENCE_LIST references;
@@ -1069,7 +1117,7 @@ void SCH_SHEET_LIST::AnnotatePowerSymbols()
     SCH_MULTI_UNIT_REFERENCE_MAP lockedSymbols;
 
     // Build the list of power symbols:
-    for( SCH_SHEET_PATH& sheet : *this )
+    for( const SCH_SHEET_PATH& sheet : *this )
     {
         for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_SYMBOL_T ) )
         {
@@ -496,7 +496,7 @@ public:
     /**
      * Fill an item cache for temporary use when many items need to be fetched.
      */
-    void FillItemMap( std::map<KIID, EDA_ITEM*>& aMap );
+    void FillItemMap( std::map<KIID, EDA_ITEM*>& aMap ) const;
 
     /**
      * Silently annotate the not yet annotated power symbols of the entire hierarchy of the
@@ -506,7 +506,7 @@ public:
      * the user about not annotated or duplicate for these symbols, if only these symbols
      * need annotation ( a very frequent case ).
      */
-    void AnnotatePowerSymbols();
+    void AnnotatePowerSymbols() const;
 
     /**
      * Add a #SCH_REFERENCE object to \a aReferences for each symbol in the list of sheets.
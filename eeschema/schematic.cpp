@@ -51,12 +51,23 @@
 
 #include <wx/log.h>
 
+/**
+ * Flag to enable the reports of the differences between incremental and full connectivity
+ * updates.
+ *
+ * @ingroup trace_env_vars
+ */
+static const wxChar ConnVerifyTrace[] = wxT( "CONN_VERIFY" );
+
 bool SCHEMATIC::m_IsSchematicExists = false;
 
 SCHEMATIC::SCHEMATIC( PROJECT* aPrj ) :
           EDA_ITEM( nullptr, SCHEMATIC_T ),
           m_project( nullptr ),
           m_rootSheet( nullptr ),
+          m_hierarchy( std::make_shared<const SCH_SHEET_LIST>() ),
+          m_hierarchyGeneration( 0 ),
+          m_indexCheckedGeneration( 0 ),
           m_schematicHolder( nullptr )
 {
     m_currentSheet    = new SCH_SHEET_PATH();
@@ -100,7 +111,7 @@ SCHEMATIC::SCHEMATIC( PROJECT* aPrj ) :
                 int      unit = symbol->GetUnit();
                 LIB_ID   libId = symbol->GetLibId();
 
-                for( SCH_SHEET_PATH& sheet : Hierarchy() )
+                for( const SCH_SHEET_PATH& sheet : Hierarchy() )
                 {
                     std::vector<SCH_SYMBOL*> otherUnits;
 
@@ -149,6 +160,12 @@ void SCHEMATIC::Reset()
 
     m_connectionGraph->Reset();
     m_currentSheet->clear();
+
+    std::lock_guard<std::mutex> lock( m_itemIndexMutex );
+
+    m_itemIndex.clear();
+    m_indexedScreens.clear();
+    m_indexCheckedGeneration = 0;
 }
 
 
@@ -229,7 +246,7 @@ void SCHEMATIC::SetRoot( SCH_SHEET* aRootSheet )
     m_currentSheet->clear();
     m_currentSheet->push_back( m_rootSheet );
 
-    m_hierarchy = BuildSheetListSortedByPageNumbers();
+    RefreshHierarchy();
     m_connectionGraph->Reset();
 }
 
@@ -240,17 +257,190 @@ SCH_SCREEN* SCHEMATIC::RootScreen() const
 }
 
 
-SCH_SHEET_LIST SCHEMATIC::Hierarchy() const
+const SCH_SHEET_LIST& SCHEMATIC::Hierarchy() const
 {
-    wxCHECK( !m_hierarchy.empty(), m_hierarchy );
+    wxCHECK( !m_hierarchy->empty(), *m_hierarchy );
 
-    return m_hierarchy;
+    return *m_hierarchy;
 }
 
 
 void SCHEMATIC::RefreshHierarchy()
 {
-    m_hierarchy = BuildSheetListSortedByPageNumbers();
+    // Never modify the current list in place: callers may still hold a snapshot of it
+    m_hierarchy = std::make_shared<const SCH_SHEET_LIST>( BuildSheetListSortedByPageNumbers() );
+    m_hierarchyGeneration++;
+
+    // Drop the screens which left the hierarchy.  The others keep their entries, and are
+    // indexed again at the next lookup only if their items changed.
+    std::unordered_set<SCH_SCREEN*> screens;
+
+    for( const SCH_SHEET_PATH& sheet : *m_hierarchy )
+        screens.insert( sheet.LastScreen() );
+
+    std::lock_guard<std::mutex> lock( m_itemIndexMutex );
+    std::vector<SCH_SCREEN*>    removed;
+
+    for( const auto& [screen, entry] : m_indexedScreens )
+    {
+        if( !screens.count( screen ) )
+            removed.push_back( screen );
+    }
+
+    for( SCH_SCREEN* screen : removed )
+        unindexScreen( screen );
+
+    // Screens may also have joined the hierarchy
+    m_indexCheckedGeneration = 0;
+}
+
+
+void SCHEMATIC::unindexScreen( SCH_SCREEN* aScreen ) const
+{
+    auto it = m_indexedScreens.find( aScreen );
+
+    if( it == m_indexedScreens.end() )
+        return;
+
+    // The screen may have been deleted since it was indexed: only compare its address
+    for( const KIID& id : it->second.second )
+    {
+        auto [first, last] = m_itemIndex.equal_range( id );
+
+        while( first != last )
+        {
+            if( first->second.second == aScreen )
+                first = m_itemIndex.erase( first );
+            else
+                ++first;
+        }
+    }
+
+    m_indexedScreens.erase( it );
+}
+
+
+void SCHEMATIC::indexScreen( SCH_SCREEN* aScreen ) const
+{
+    unindexScreen( aScreen );
+
+    auto& [generation, ids] = m_indexedScreens[aScreen];
+
+    generation = aScreen->GetItemsGeneration();
+
+    auto addId =
+            [&]( const KIID& aId, SCH_ITEM* aItem )
+            {
+                m_itemIndex.emplace( aId, std::make_pair( aItem, aScreen ) );
+                ids.push_back( aId );
+            };
+
+    for( SCH_ITEM* item : aScreen->Items() )
+    {
+        addId( item->m_Uuid, item );
+
+        // The members of a group are items of the screen themselves
+        if( item->Type() == SCH_GROUP_T )
+            continue;
+
+        item->RunOnChildren(
+                [&]( SCH_ITEM* aChild )
+                {
+                    addId( aChild->m_Uuid, item );
+                },
+                RECURSE_MODE::NO_RECURSE );
+    }
+}
+
+
+void SCHEMATIC::validateIndex( const SCH_SHEET_LIST& aSheets ) const
+{
+    // Read first: items changed while checking must be checked again next time
+    uint64_t generation = SCH_SCREEN::GetLastItemsGeneration();
+
+    for( const SCH_SHEET_PATH& sheet : aSheets )
+    {
+        SCH_SCREEN* screen = sheet.LastScreen();
+
+        if( !screen )
+            continue;
+
+        auto it = m_indexedScreens.find( screen );
+
+        if( it == m_indexedScreens.end() || it->second.first != screen->GetItemsGeneration() )
+            indexScreen( screen );
+    }
+
+    m_indexCheckedGeneration = generation;
+}
+
+
+SCH_ITEM* SCHEMATIC::FindItemByKIID( const KIID& aID, const SCH_SHEET_LIST& aSheets,
+                                     SCH_SHEET_PATH* aPathOut ) const
+{
+    std::lock_guard<std::mutex> lock( m_itemIndexMutex );
+
+    // No item changed anywhere since the last check, so the indexed screens are up to date
+    bool checked = m_indexCheckedGeneration == SCH_SCREEN::GetLastItemsGeneration();
+
+    if( !checked )
+        validateIndex( aSheets );
+
+    SCH_ITEM* item = findIndexedItem( aID, aSheets, aPathOut );
+
+    // The item may be on a screen of aSheets which was not part of the last check
+    if( !item && checked )
+    {
+        validateIndex( aSheets );
+        item = findIndexedItem( aID, aSheets, aPathOut );
+    }
+
+    return item;
+}
+
+
+SCH_ITEM* SCHEMATIC::findIndexedItem( const KIID& aID, const SCH_SHEET_LIST& aSheets,
+                                      SCH_SHEET_PATH* aPathOut ) const
+{
+    auto [first, last] = m_itemIndex.equal_range( aID );
+
+    if( first == last )
+        return nullptr;
+
+    // Only the screens of aSheets are searched, and the first sheet showing the item wins
+    for( const SCH_SHEET_PATH& sheet : aSheets )
+    {
+        for( auto entry = first; entry != last; ++entry )
+        {
+            if( !sheet.LastScreen() || entry->second.second != sheet.LastScreen() )
+                continue;
+
+            SCH_ITEM* item = entry->second.first;
+            SCH_ITEM* match = item->m_Uuid == aID ? item : nullptr;
+
+            if( !match )
+            {
+                item->RunOnChildren(
+                        [&]( SCH_ITEM* aChild )
+                        {
+                            if( aChild->m_Uuid == aID )
+                                match = aChild;
+                        },
+                        RECURSE_MODE::NO_RECURSE );
+            }
+
+            // No match means that a KIID was changed in place without SCH_SCREEN::ItemsChanged()
+            if( match )
+            {
+                if( aPathOut )
+                    *aPathOut = sheet;
+
+                return match;
+            }
+        }
+    }
+
+    return nullptr;
 }
 
 
@@ -1232,6 +1422,120 @@ void SCHEMATIC::CleanUp( SCH_COMMIT* aCommit, SCH_SCREEN* aScreen )
 }
 
 
+/// Net name and net code of each connectable item, by sheet path
+using CONNECTIVITY_SNAPSHOT = std::map<std::pair<wxString, const SCH_ITEM*>,
+                                       std::pair<wxString, int>>;
+
+
+static CONNECTIVITY_SNAPSHOT snapshotConnectivity( const SCH_SHEET_LIST& aSheets )
+{
+    CONNECTIVITY_SNAPSHOT snapshot;
+
+    for( const SCH_SHEET_PATH& sheet : aSheets )
+    {
+        wxString path = sheet.PathAsString();
+
+        auto add =
+                [&]( const SCH_ITEM* aItem )
+                {
+                    SCH_CONNECTION* conn = aItem->Connection( &sheet );
+
+                    if( !conn || conn->Type() == CONNECTION_TYPE::NONE )
+                        snapshot[{ path, aItem }] = { wxEmptyString, 0 };
+                    else
+                        snapshot[{ path, aItem }] = { conn->Name(),
+                                                      conn->IsNet() ? conn->NetCode() : 0 };
+                };
+
+        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        {
+            if( !item->IsConnectable() )
+                continue;
+
+            if( item->Type() == SCH_SYMBOL_T )
+            {
+                for( SCH_PIN* pin : static_cast<SCH_SYMBOL*>( item )->GetPins( &sheet ) )
+                    add( pin );
+            }
+            else if( item->Type() == SCH_SHEET_T )
+            {
+                for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                    add( pin );
+            }
+            else
+            {
+                add( item );
+            }
+        }
+    }
+
+    return snapshot;
+}
+
+
+/**
+ * Compare the connectivity left by an incremental update with the one from a full update.
+ *
+ * Net codes are renumbered by a full update, so for those only the consistency of the
+ * incremental result is checked: one code per net name and one net name per code.
+ *
+ * @return the number of discrepancies found.
+ */
+static int diffConnectivity( const CONNECTIVITY_SNAPSHOT& aIncremental,
+                             const CONNECTIVITY_SNAPSHOT& aFull )
+{
+    int                     errors = 0;
+    std::map<int, wxString> codeToName;
+    std::map<wxString, int> nameToCode;
+
+    auto report =
+            [&]( const wxString& aPath, const SCH_ITEM* aItem, const wxString& aMsg )
+            {
+                wxLogTrace( ConnVerifyTrace, "%s %s on %s: %s", aItem->GetTypeDesc(),
+                            aItem->m_Uuid.AsString(), aPath, aMsg );
+                errors++;
+            };
+
+    for( const auto& [key, value] : aFull )
+    {
+        auto it = aIncremental.find( key );
+
+        if( it == aIncremental.end() )
+            report( key.first, key.second, wxS( "missing from the incremental update" ) );
+        else if( it->second.first != value.first )
+            report( key.first, key.second,
+                    wxString::Format( wxS( "net '%s', expected '%s'" ), it->second.first,
+                                      value.first ) );
+    }
+
+    for( const auto& [key, value] : aIncremental )
+    {
+        const auto& [name, code] = value;
+
+        if( code <= 0 )
+            continue;
+
+        auto [codeIt, newCode] = codeToName.emplace( code, name );
+        auto [nameIt, newName] = nameToCode.emplace( name, code );
+
+        if( !newCode && codeIt->second != name )
+        {
+            report( key.first, key.second,
+                    wxString::Format( wxS( "net code %d shared by '%s' and '%s'" ), code,
+                                      codeIt->second, name ) );
+        }
+        else if( !newName && nameIt->second != code )
+        {
+            report( key.first, key.second,
+                    wxString::Format( wxS( "net '%s' has codes %d and %d" ), name,
+                                      nameIt->second, code ) );
+        }
+    }
+
+    return errors;
+}
+
+
 void SCHEMATIC::RecalculateConnections( SCH_COMMIT* aCommit, SCH_CLEANUP_FLAGS aCleanupFlags,
                                         TOOL_MANAGER* aToolManager,
                                         PROGRESS_REPORTER* aProgressReporter,
@@ -1241,8 +1545,11 @@ void SCHEMATIC::RecalculateConnections( SCH_COMMIT* aCommit, SCH_CLEANUP_FLAGS a
 {
     SCHEMATIC_SETTINGS& settings = Settings();
     RefreshHierarchy();
-    SCH_SHEET_LIST      list = Hierarchy();
-    SCH_COMMIT          localCommit( aToolManager );
+
+    // Hold a snapshot rather than a copy, so the list outlives any refresh done below
+    std::shared_ptr<const SCH_SHEET_LIST> hierarchy = HierarchySnapshot();
+    const SCH_SHEET_LIST&                 list = *hierarchy;
+    SCH_COMMIT                            localCommit( aToolManager );
 
     if( !aCommit )
         aCommit = &localCommit;
@@ -1495,6 +1802,22 @@ void SCHEMATIC::RecalculateConnections( SCH_COMMIT* aCommit, SCH_CLEANUP_FLAGS a
 
         new_graph.Recalculate( list, false, aChangedItemHandler, aProgressReporter );
         ConnectionGraph()->Merge( new_graph );
+
+        if( ADVANCED_CFG::GetCfg().m_IncrementalConnectivityVerify )
+        {
+            CONNECTIVITY_SNAPSHOT incremental = snapshotConnectivity( list );
+
+            // Redo everything from scratch; the full result is also the one we keep
+            netSettings->ClearAllCaches();
+            ConnectionGraph()->Recalculate( list, true, aChangedItemHandler, aProgressReporter );
+
+            if( int errors = diffConnectivity( incremental, snapshotConnectivity( list ) ) )
+            {
+                wxLogWarning( wxS( "Incremental connectivity update differs from a full update "
+                                   "on %d items (see the CONN_VERIFY trace for details)." ),
+                              errors );
+            }
+        }
     }
 
     if( !localCommit.Empty() )
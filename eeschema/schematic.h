@@ -27,6 +27,9 @@
 #include <schematic_settings.h>
 #include <project.h>
 
+#include <mutex>
+#include <unordered_map>
+
 
 class BUS_ALIAS;
 class CONNECTION_GRAPH;
@@ -126,8 +129,23 @@ public:
 
     /**
      * Return the full schematic flattened hierarchical sheet list.
+     *
+     * The list is shared and immutable; the reference stays valid until the next call to
+     * RefreshHierarchy() or SetRoot().  Copy it, or hold a HierarchySnapshot(), to keep it
+     * across schematic edits.
+     */
+    const SCH_SHEET_LIST& Hierarchy() const;
+
+    /**
+     * @return a shared pointer to the current hierarchy, which outlives later refreshes.
      */
-    SCH_SHEET_LIST Hierarchy() const;
+    std::shared_ptr<const SCH_SHEET_LIST> HierarchySnapshot() const { return m_hierarchy; }
+
+    /**
+     * @return a counter incremented every time the hierarchy is rebuilt, so that caches derived
+     *         from it can tell when they are stale.
+     */
+    uint64_t HierarchyGeneration() const { return m_hierarchyGeneration; }
 
     void RefreshHierarchy();
 
@@ -137,6 +155,21 @@ public:
         return BuildUnorderedSheetList().ResolveItem( aID, aPathOut, aAllowNullptrReturn );
     }
 
+    /**
+     * Find an item of the screens of \a aSheets, or a child of one (pin, field, sheet pin...),
+     * in the KIID index of the schematic.
+     *
+     * The index is refreshed for a screen at the first lookup after its items changed (see
+     * SCH_SCREEN::ItemsChanged()), so it is complete and a miss does not search the items.
+     * The screens are only checked when the items of a screen changed since the last check, or
+     * when the item is not found (\a aSheets may show screens which were not checked yet).
+     *
+     * @param aPathOut receives the first sheet path of \a aSheets showing the item.
+     * @return the item or nullptr if not found.
+     */
+    SCH_ITEM* FindItemByKIID( const KIID& aID, const SCH_SHEET_LIST& aSheets,
+                              SCH_SHEET_PATH* aPathOut = nullptr ) const;
+
     SCH_SHEET& Root() const
     {
         return *m_rootSheet;
@@ -433,6 +466,20 @@ private:
             ( l->*aFunc )( std::forward<Args>( args )... );
     }
 
+    /// Refresh the KIID index entries of \a aScreen.  #m_itemIndexMutex must be held.
+    void indexScreen( SCH_SCREEN* aScreen ) const;
+
+    /// Remove the KIID index entries of \a aScreen.  #m_itemIndexMutex must be held.
+    void unindexScreen( SCH_SCREEN* aScreen ) const;
+
+    /// Refresh the KIID index entries of the stale screens of \a aSheets.  #m_itemIndexMutex
+    /// must be held.
+    void validateIndex( const SCH_SHEET_LIST& aSheets ) const;
+
+    /// Look \a aID up in the KIID index.  #m_itemIndexMutex must be held.
+    SCH_ITEM* findIndexedItem( const KIID& aID, const SCH_SHEET_LIST& aSheets,
+                               SCH_SHEET_PATH* aPathOut ) const;
+
     PROJECT* m_project;
 
     /// The top-level sheet in this schematic hierarchy (or potentially the only one)
@@ -470,7 +517,22 @@ private:
     /**
      * Cache of the entire schematic hierarchy sorted by sheet page number.
      */
-    SCH_SHEET_LIST m_hierarchy;
+    std::shared_ptr<const SCH_SHEET_LIST> m_hierarchy;
+    uint64_t                              m_hierarchyGeneration;
+
+    /**
+     * KIIDs of the items of the screens and of their children, mapped to the top-level item
+     * and its screen.  Duplicated KIIDs on different screens have an entry per screen.
+     */
+    mutable std::unordered_multimap<KIID, std::pair<SCH_ITEM*, SCH_SCREEN*>> m_itemIndex;
+
+    /// Item generation and KIIDs of each screen at the time it was indexed.
+    mutable std::unordered_map<SCH_SCREEN*, std::pair<uint64_t, std::vector<KIID>>>
+                                                                              m_indexedScreens;
+    mutable std::mutex                                                        m_itemIndexMutex;
+
+    /// SCH_SCREEN::GetLastItemsGeneration() when the indexed screens were last checked, or 0.
+    mutable uint64_t m_indexCheckedGeneration;
 
     /**
      * Currently installed listeners.
@@ -0,0 +1,1010 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <sstream>
+
+#include <fmt/format.h>
+#include <fast_float/fast_float.h>
+#include <wx/filename.h>
+#include <wx/process.h>
+#include <wx/stdpaths.h>
+#include <wx/tokenzr.h>
+#include <wx/translation.h>
+#include <wx/utils.h>
+
+#include <thread_pool.h>
+#include "sim_sweep.h"
+#include "spice_value.h"
+
+
+/**
+ * Parse a SPICE number, with an optional unit prefix (e.g. 4.7k).
+ */
+static bool parseSpiceNumber( const wxString& aToken, double* aValue )
+{
+    if( aToken.IsEmpty() )
+        return false;
+
+    wxUniChar first = aToken[0];
+
+    if( !wxIsdigit( first ) && first != '-' && first != '+' && first != '.' )
+        return false;
+
+    *aValue = SPICE_VALUE( aToken ).ToDouble();
+    return true;
+}
+
+
+bool SIM_SWEEP::IsStepDirective( const wxString& aLine )
+{
+    wxString line = aLine;
+    line.Trim( false );
+
+    return line.Lower().StartsWith( wxS( ".step" ) )
+           && ( line.Length() == 5 || wxIsspace( line[5] ) );
+}
+
+
+bool SIM_SWEEP::ParseDirectives( const std::vector<wxString>& aDirectives, wxString* aErrors )
+{
+    bool ok = true;
+
+    for( const wxString& directive : aDirectives )
+    {
+        wxStringTokenizer lines( directive, wxT( "\r\n" ), wxTOKEN_STRTOK );
+
+        while( lines.HasMoreTokens() )
+        {
+            wxString line = lines.GetNextToken();
+            wxString error;
+
+            if( !IsStepDirective( line ) )
+                continue;
+
+            if( !ParseStep( line, &error ) )
+            {
+                ok = false;
+
+                if( aErrors )
+                    *aErrors << line << wxS( ": " ) << error << wxS( "\n" );
+            }
+        }
+    }
+
+    return ok;
+}
+
+
+bool SIM_SWEEP::ParseStep( const wxString& aLine, wxString* aError )
+{
+    wxArrayString tokens = wxStringTokenize( aLine, wxT( " \t" ), wxTOKEN_STRTOK );
+
+    auto fail =
+            [&]( const wxString& aMsg )
+            {
+                if( aError )
+                    *aError = aMsg;
+
+                return false;
+            };
+
+    auto tooManyRuns =
+            [&]()
+            {
+                return fail( wxString::Format( _( "The study would have more than %zu runs." ),
+                                               MAX_RUNS ) );
+            };
+
+    if( tokens.size() < 3 || tokens[0].Lower() != wxS( ".step" ) )
+        return fail( _( "Expected '.step param' or '.step mc'." ) );
+
+    wxString kind = tokens[1].Lower();
+
+    if( kind == wxS( "mc" ) )
+    {
+        long runs = 0;
+        long seed = 1;
+
+        if( !tokens[2].ToLong( &runs ) || runs < 1 )
+            return fail( _( "Invalid number of Monte Carlo runs." ) );
+
+        if( tokens.size() > 3 && ( !tokens[3].ToLong( &seed ) || seed < 1 ) )
+            return fail( _( "Invalid Monte Carlo seed." ) );
+
+        if( runs > (long) MAX_RUNS || countRuns( m_params, (int) runs ) > MAX_RUNS )
+            return tooManyRuns();
+
+        m_mcRuns = (int) runs;
+        m_mcSeed = (int) seed;
+        return true;
+    }
+
+    if( kind != wxS( "param" ) || tokens.size() < 4 )
+        return fail( _( "Expected '.step param' or '.step mc'." ) );
+
+    PARAM param;
+    param.m_Name = tokens[2];
+
+    if( tokens[3].Lower() == wxS( "list" ) )
+    {
+        for( size_t ii = 4; ii < tokens.size(); ++ii )
+        {
+            double value;
+
+            if( !parseSpiceNumber( tokens[ii], &value ) )
+                return fail( wxString::Format( _( "Invalid value '%s'." ), tokens[ii] ) );
+
+            param.m_Values.push_back( value );
+        }
+    }
+    else
+    {
+        double start, stop, increment;
+
+        if( tokens.size() != 6 || !parseSpiceNumber( tokens[3], &start )
+                || !parseSpiceNumber( tokens[4], &stop )
+                || !parseSpiceNumber( tokens[5], &increment ) )
+        {
+            return fail( _( "Expected '.step param <name> <start> <stop> <increment>'." ) );
+        }
+
+        if( increment == 0.0 || ( stop - start ) / increment < 0.0 )
+            return fail( _( "The increment does not lead from start to stop." ) );
+
+        // Tolerate rounding errors on the last step
+        double count = std::floor( ( stop - start ) / increment + 1e-9 ) + 1;
+
+        if( count > MAX_RUNS )
+            return fail( _( "Too many steps." ) );
+
+        for( int ii = 0; ii < (int) count; ++ii )
+            param.m_Values.push_back( start + ii * increment );
+    }
+
+    if( param.m_Values.empty() )
+        return fail( _( "No values to step through." ) );
+
+    // A later directive for the same parameter replaces the earlier one
+    std::vector<PARAM> params = m_params;
+
+    std::erase_if( params,
+                   [&]( const PARAM& aOther )
+                   {
+                       return aOther.m_Name.IsSameAs( param.m_Name, false );
+                   } );
+
+    params.push_back( std::move( param ) );
+
+    if( countRuns( params, m_mcRuns ) > MAX_RUNS )
+        return tooManyRuns();
+
+    m_params = std::move( params );
+    return true;
+}
+
+
+size_t SIM_SWEEP::countRuns( const std::vector<PARAM>& aParams, int aMcRuns )
+{
+    size_t count = 1;
+
+    // Each factor is at most MAX_RUNS, so stopping past it avoids any overflow
+    for( const PARAM& param : aParams )
+    {
+        count *= param.m_Values.size();
+
+        if( count > MAX_RUNS )
+            return count;
+    }
+
+    if( aMcRuns > 0 )
+        count *= aMcRuns;
+
+    return count;
+}
+
+
+std::vector<SIM_SWEEP::RUN> SIM_SWEEP::GetRuns() const
+{
+    std::vector<RUN> runs( 1 );
+
+    for( const PARAM& param : m_params )
+    {
+        std::vector<RUN> expanded;
+
+        expanded.reserve( runs.size() * param.m_Values.size() );
+
+        for( const RUN& run : runs )
+        {
+            for( double value : param.m_Values )
+            {
+                expanded.push_back( run );
+                expanded.back().m_Params.emplace_back( param.m_Name, value );
+            }
+        }
+
+        runs = std::move( expanded );
+    }
+
+    if( m_mcRuns > 0 )
+    {
+        std::vector<RUN> expanded;
+
+        expanded.reserve( runs.size() * m_mcRuns );
+
+        for( const RUN& run : runs )
+        {
+            for( int ii = 0; ii < m_mcRuns; ++ii )
+            {
+                expanded.push_back( run );
+                expanded.back().m_Seed = m_mcSeed + ii;
+            }
+        }
+
+        runs = std::move( expanded );
+    }
+
+    return runs;
+}
+
+
+std::string SIM_SWEEP::MakeRunNetlist( const std::string& aNetlist, const RUN& aRun,
+                                       SIM_TYPE aSimType, const std::string& aRawFile )
+{
+    // Everything before the final .end card is kept as is
+    size_t end = aNetlist.size();
+    size_t pos = aNetlist.size();
+
+    while( pos > 0 )
+    {
+        size_t lineStart = aNetlist.rfind( '\n', pos - 1 );
+        lineStart = ( lineStart == std::string::npos ) ? 0 : lineStart + 1;
+
+        std::string line = aNetlist.substr( lineStart, pos - lineStart );
+        std::transform( line.begin(), line.end(), line.begin(), ::tolower );
+        line.erase( 0, line.find_first_not_of( " \t\r\n" ) );
+        line.erase( line.find_last_not_of( " \t\r\n" ) + 1 );
+
+        if( line == ".end" )
+        {
+            end = lineStart;
+            break;
+        }
+
+        if( lineStart == 0 )
+            break;
+
+        pos = lineStart - 1;
+    }
+
+    std::string netlist = aNetlist.substr( 0, end );
+
+    if( !netlist.empty() && netlist.back() != '\n' )
+        netlist += '\n';
+
+    if( aRun.m_Seed > 0 )
+        netlist += fmt::format( ".options seed={}\n", aRun.m_Seed );
+
+    netlist += ".control\n";
+    netlist += "set filetype=ascii\n";
+
+    for( const auto& [name, value] : aRun.m_Params )
+        netlist += fmt::format( "alterparam {} = {:.15g}\n", name.ToStdString(), value );
+
+    if( !aRun.m_Params.empty() )
+        netlist += "reset\n";
+
+    netlist += "run\n";
+
+    if( aSimType == ST_TRAN )
+        netlist += "linearize\n";
+
+    netlist += fmt::format( "write \"{}\"\n", aRawFile );
+    netlist += "quit\n";
+    netlist += ".endc\n";
+    netlist += ".end\n";
+
+    return netlist;
+}
+
+
+int SIM_SWEEP_VECTORS::Find( const std::string& aNormalizedName ) const
+{
+    auto it = std::find( m_Names.begin(), m_Names.end(), aNormalizedName );
+
+    return it == m_Names.end() ? -1 : (int) ( it - m_Names.begin() );
+}
+
+
+std::string SIM_SWEEP_VECTORS::NormalizeVectorName( const wxString& aName )
+{
+    wxString name = aName.Lower();
+    name.Trim().Trim( false );
+
+    if( name.StartsWith( wxS( "v(" ) ) && name.EndsWith( wxS( ")" ) ) && !name.Contains( ',' ) )
+        name = name.Mid( 2, name.Length() - 3 );
+    else if( name.StartsWith( wxS( "i(" ) ) && name.EndsWith( wxS( ")" ) ) )
+        name = name.Mid( 2, name.Length() - 3 ) + wxS( "#branch" );
+
+    return name.ToStdString();
+}
+
+
+bool SIM_SWEEP_VECTORS::ParseRawFile( const std::string& aContent )
+{
+    size_t varCount = 0;
+    size_t pointCount = 0;
+    bool   complex = false;
+    size_t pos = 0;
+    bool   foundValues = false;
+
+    m_Names.clear();
+    m_Real.clear();
+    m_Imag.clear();
+
+    auto nextLine =
+            [&]( std::string& aLine ) -> bool
+            {
+                if( pos >= aContent.size() )
+                    return false;
+
+                size_t eol = aContent.find( '\n', pos );
+
+                if( eol == std::string::npos )
+                    eol = aContent.size();
+
+                aLine = aContent.substr( pos, eol - pos );
+                pos = eol + 1;
+
+                if( !aLine.empty() && aLine.back() == '\r' )
+                    aLine.pop_back();
+
+                return true;
+            };
+
+    auto startsWith =
+            []( const std::string& aLine, const char* aPrefix )
+            {
+                return aLine.rfind( aPrefix, 0 ) == 0;
+            };
+
+    std::string line;
+
+    while( !foundValues && nextLine( line ) )
+    {
+        if( startsWith( line, "Flags:" ) )
+        {
+            complex = line.find( "complex" ) != std::string::npos;
+        }
+        else if( startsWith( line, "No. Variables:" ) )
+        {
+            varCount = std::strtoul( line.c_str() + 14, nullptr, 10 );
+        }
+        else if( startsWith( line, "No. Points:" ) )
+        {
+            pointCount = std::strtoul( line.c_str() + 11, nullptr, 10 );
+        }
+        else if( startsWith( line, "Variables:" ) )
+        {
+            for( size_t ii = 0; ii < varCount && nextLine( line ); ++ii )
+            {
+                std::istringstream fields( line );
+                std::string        index, name;
+
+                fields >> index >> name;
+                m_Names.push_back( NormalizeVectorName( wxString::FromUTF8( name ) ) );
+            }
+        }
+        else if( startsWith( line, "Values:" ) )
+        {
+            foundValues = true;
+        }
+        else if( startsWith( line, "Binary:" ) )
+        {
+            return false;
+        }
+    }
+
+    if( !foundValues || varCount == 0 || m_Names.size() != varCount )
+        return false;
+
+    m_Real.resize( varCount );
+
+    if( complex )
+        m_Imag.resize( varCount );
+
+    for( size_t ii = 0; ii < varCount; ++ii )
+    {
+        m_Real[ii].reserve( pointCount );
+
+        if( complex )
+            m_Imag[ii].reserve( pointCount );
+    }
+
+    const char* cursor = aContent.data() + std::min( pos, aContent.size() );
+    const char* last = aContent.data() + aContent.size();
+
+    auto nextToken =
+            [&]( const char*& aStart, const char*& aEnd ) -> bool
+            {
+                while( cursor < last && std::isspace( (unsigned char) *cursor ) )
+                    ++cursor;
+
+                aStart = cursor;
+
+                while( cursor < last && !std::isspace( (unsigned char) *cursor ) )
+                    ++cursor;
+
+                aEnd = cursor;
+                return aStart < aEnd;
+            };
+
+    auto parseDouble =
+            []( const char* aStart, const char* aEnd, double& aValue ) -> const char*
+            {
+                fast_float::from_chars_result res = fast_float::from_chars( aStart, aEnd, aValue );
+                return res.ec == std::errc() ? res.ptr : nullptr;
+            };
+
+    for( size_t point = 0; point < pointCount; ++point )
+    {
+        const char* start;
+        const char* end;
+
+        // Point index
+        if( !nextToken( start, end ) )
+            break;
+
+        for( size_t ii = 0; ii < varCount; ++ii )
+        {
+            double re = 0.0;
+            double im = 0.0;
+
+            if( !nextToken( start, end ) )
+                return false;
+
+            const char* ptr = parseDouble( start, end, re );
+
+            if( !ptr )
+                return false;
+
+            if( complex && ( *ptr != ',' || !parseDouble( ptr + 1, end, im ) ) )
+                return false;
+
+            m_Real[ii].push_back( re );
+
+            if( complex )
+                m_Imag[ii].push_back( im );
+        }
+    }
+
+    return GetPointCount() > 0;
+}
+
+
+size_t SIM_SWEEP_RESULTS::GetPointsPerRun() const
+{
+    if( m_vectors.empty() )
+        return 0;
+
+    size_t points = m_vectors[0].GetPointCount();
+
+    for( const SIM_SWEEP_VECTORS& vectors : m_vectors )
+    {
+        if( vectors.GetPointCount() != points )
+            return 0;
+    }
+
+    return points;
+}
+
+
+bool SIM_SWEEP_RESULTS::GetVector( const wxString& aName, PART aPart, std::vector<double>* aX,
+                                   std::vector<double>* aY ) const
+{
+    std::string name = SIM_SWEEP_VECTORS::NormalizeVectorName( aName );
+    size_t      points = GetPointsPerRun();
+
+    if( points == 0 )
+        return false;
+
+    aX->clear();
+    aY->clear();
+    aX->reserve( points * m_vectors.size() );
+    aY->reserve( points * m_vectors.size() );
+
+    for( const SIM_SWEEP_VECTORS& vectors : m_vectors )
+    {
+        int index = vectors.Find( name );
+
+        if( index < 0 )
+            return false;
+
+        // The scale of a complex plot (frequency) is real
+        aX->insert( aX->end(), vectors.m_Real[0].begin(), vectors.m_Real[0].end() );
+
+        const std::vector<double>& re = vectors.m_Real[index];
+
+        if( !vectors.IsComplex() || aPart == REAL )
+        {
+            aY->insert( aY->end(), re.begin(), re.end() );
+            continue;
+        }
+
+        const std::vector<double>& im = vectors.m_Imag[index];
+
+        for( size_t ii = 0; ii < re.size(); ++ii )
+        {
+            if( aPart == GAIN )
+                aY->push_back( std::hypot( re[ii], im[ii] ) );
+            else
+                aY->push_back( std::atan2( im[ii], re[ii] ) );
+        }
+    }
+
+    return true;
+}
+
+
+bool SIM_SWEEP_RESULTS::GetFinalValueStats( const wxString& aName, STATS* aStats ) const
+{
+    std::string         name = SIM_SWEEP_VECTORS::NormalizeVectorName( aName );
+    std::vector<double> values;
+
+    for( const SIM_SWEEP_VECTORS& vectors : m_vectors )
+    {
+        int index = vectors.Find( name );
+
+        if( index < 0 || vectors.GetPointCount() == 0 )
+            return false;
+
+        double value = vectors.m_Real[index].back();
+
+        if( vectors.IsComplex() )
+            value = std::hypot( value, vectors.m_Imag[index].back() );
+
+        values.push_back( value );
+    }
+
+    if( values.empty() )
+        return false;
+
+    double sum = 0.0;
+
+    for( double value : values )
+        sum += value;
+
+    aStats->m_Mean = sum / values.size();
+    aStats->m_Min = *std::min_element( values.begin(), values.end() );
+    aStats->m_Max = *std::max_element( values.begin(), values.end() );
+    aStats->m_StdDev = 0.0;
+
+    if( values.size() > 1 )
+    {
+        double sumSq = 0.0;
+
+        for( double value : values )
+            sumSq += ( value - aStats->m_Mean ) * ( value - aStats->m_Mean );
+
+        aStats->m_StdDev = std::sqrt( sumSq / ( values.size() - 1 ) );
+    }
+
+    return true;
+}
+
+
+/**
+ * A worker process of a sweep.  Deletes itself once the process has terminated.
+ */
+class SIM_SWEEP_PROCESS : public wxProcess
+{
+public:
+    SIM_SWEEP_PROCESS( SIM_SWEEP_RUNNER* aRunner, size_t aRun ) :
+            wxProcess(),
+            m_runner( aRunner ),
+            m_run( aRun ),
+            m_pid( 0 )
+    {}
+
+    void OnTerminate( int aPid, int aStatus ) override
+    {
+        if( m_runner )
+            m_runner->onWorkerFinished( this, m_run, aStatus );
+
+        delete this;
+    }
+
+    /// Detach from the runner, which is not interested in the result anymore.
+    void Orphan() { m_runner = nullptr; }
+
+    void SetPid( long aPid ) { m_pid = aPid; }
+    long GetPid() const { return m_pid; }
+
+private:
+    SIM_SWEEP_RUNNER* m_runner;
+    size_t            m_run;
+    long              m_pid;
+};
+
+
+SIM_SWEEP_RUNNER::SIM_SWEEP_RUNNER() :
+        m_simType( ST_UNKNOWN ),
+        m_next( 0 ),
+        m_finished( 0 ),
+        m_maxWorkers( 1 )
+{
+    m_finishTimer.Bind( wxEVT_TIMER, &SIM_SWEEP_RUNNER::onFinishTimer, this );
+}
+
+
+SIM_SWEEP_RUNNER::~SIM_SWEEP_RUNNER()
+{
+    Stop();
+}
+
+
+wxString SIM_SWEEP_RUNNER::FindNgspice()
+{
+#if defined( __WINDOWS__ )
+    // ngspice.exe is the GUI flavor on Windows
+    const std::vector<wxString> names = { wxS( "ngspice_con.exe" ), wxS( "ngspice.exe" ) };
+#else
+    const std::vector<wxString> names = { wxS( "ngspice" ) };
+#endif
+
+    std::vector<wxString> dirs;
+    wxString              path;
+
+    dirs.push_back( wxFileName( wxStandardPaths::Get().GetExecutablePath() ).GetPath() );
+
+    if( wxGetEnv( wxT( "PATH" ), &path ) )
+    {
+        wxStringTokenizer tokenizer( path, wxPATH_SEP, wxTOKEN_STRTOK );
+
+        while( tokenizer.HasMoreTokens() )
+            dirs.push_back( tokenizer.GetNextToken() );
+    }
+
+    for( const wxString& dir : dirs )
+    {
+        for( const wxString& name : names )
+        {
+            wxFileName candidate( dir, name );
+
+            if( candidate.IsFileExecutable() )
+                return candidate.GetFullPath();
+        }
+    }
+
+    return wxEmptyString;
+}
+
+
+bool SIM_SWEEP_RUNNER::Start( const std::string& aNetlist, SIM_TYPE aSimType,
+                              const SIM_SWEEP& aSweep,
+                              const std::vector<std::string>& aInitCommands,
+                              FINISHED_CALLBACK aOnFinished, PROGRESS_CALLBACK aOnProgress,
+                              wxString* aError )
+{
+    static int s_sweepCount = 0;
+
+    Stop();
+
+    m_ngspice = FindNgspice();
+
+    if( m_ngspice.IsEmpty() )
+    {
+        *aError = _( "The ngspice executable, needed to run sweeps, could not be found." );
+        return false;
+    }
+
+    m_tempDir = wxFileName( wxFileName::GetTempDir(),
+                            wxString::Format( wxS( "kicad-sim-sweep-%lu-%d" ), wxGetProcessId(),
+                                              s_sweepCount++ ) ).GetFullPath();
+
+    if( !wxFileName::Mkdir( m_tempDir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+    {
+        *aError = wxString::Format( _( "Could not create folder '%s'." ), m_tempDir );
+        return false;
+    }
+
+    // The workers run in the temporary folder, where ngspice picks up this init file before
+    // reading the netlist.  Library paths in the netlist are absolute.
+    {
+        wxFileName    initFile( m_tempDir, wxS( ".spiceinit" ) );
+        std::ofstream out( initFile.GetFullPath().fn_str(), std::ios::binary );
+
+        for( const std::string& command : aInitCommands )
+            out << command << "\n";
+    }
+
+    m_simType = aSimType;
+    m_runs = aSweep.GetRuns();
+    m_next = 0;
+    m_finished = 0;
+    m_maxWorkers = std::max<size_t>( 1, GetKiCadThreadPool().get_thread_count() );
+    m_vectors.clear();
+    m_vectors.resize( m_runs.size() );
+    m_parsed.clear();
+    m_parsed.resize( m_runs.size() );
+    m_runErrors.clear();
+    m_onFinished = std::move( aOnFinished );
+    m_onProgress = std::move( aOnProgress );
+
+    // Netlists are written as the runs are launched
+    m_netlist = aNetlist;
+
+    launchNext();
+    return true;
+}
+
+
+wxString SIM_SWEEP_RUNNER::runFile( size_t aRun, const wxString& aExtension ) const
+{
+    return wxFileName( m_tempDir, wxString::Format( wxS( "run%zu" ), aRun ), aExtension )
+            .GetFullPath();
+}
+
+
+void SIM_SWEEP_RUNNER::launchNext()
+{
+    while( m_active.size() < m_maxWorkers && m_next < m_runs.size() )
+    {
+        size_t      run = m_next++;
+        wxString    cirFile = runFile( run, wxS( "cir" ) );
+        wxString    logFile = runFile( run, wxS( "log" ) );
+        std::string netlist = SIM_SWEEP::MakeRunNetlist( m_netlist, m_runs[run], m_simType,
+                                                         runFile( run, wxS( "raw" ) ).ToStdString() );
+
+        {
+            std::ofstream out( cirFile.fn_str(), std::ios::binary );
+            out << netlist;
+
+            if( !out )
+            {
+                failRun( run, wxString::Format( _( "Could not write '%s'." ), cirFile ) );
+                continue;
+            }
+        }
+
+        std::vector<const wchar_t*> args = { m_ngspice.wc_str(), L"-b", L"-o",
+                                             logFile.wc_str(), cirFile.wc_str(), nullptr };
+
+        wxExecuteEnv env;
+        env.cwd = m_tempDir;
+        wxGetEnvMap( &env.env );
+
+        SIM_SWEEP_PROCESS* process = new SIM_SWEEP_PROCESS( this, run );
+        long               pid = wxExecute( const_cast<wchar_t**>( args.data() ), wxEXEC_ASYNC,
+                                            process, &env );
+
+        if( pid <= 0 )
+        {
+            delete process;
+            failRun( run, wxString::Format( _( "Could not start '%s'." ), m_ngspice ) );
+            continue;
+        }
+
+        process->SetPid( pid );
+        m_active[run] = process;
+    }
+
+    // Finish from the event loop, so that the callback never runs from within Start() when
+    // none of the runs could be launched
+    if( m_active.empty() && m_next >= m_runs.size() )
+        m_finishTimer.StartOnce( 1 );
+}
+
+
+/**
+ * @return the last lines of a log file, indented, or an empty string if it cannot be read.
+ */
+static wxString logTail( const wxString& aFileName, size_t aMaxLines = 5 )
+{
+    std::ifstream           in( aFileName.fn_str(), std::ios::binary );
+    std::deque<std::string> lines;
+    std::string             line;
+
+    while( std::getline( in, line ) )
+    {
+        if( !line.empty() && line.back() == '\r' )
+            line.pop_back();
+
+        if( line.find_first_not_of( " \t" ) == std::string::npos )
+            continue;
+
+        lines.push_back( line );
+
+        if( lines.size() > aMaxLines )
+            lines.pop_front();
+    }
+
+    wxString tail;
+
+    for( const std::string& logLine : lines )
+        tail << wxS( "    " ) << wxString::FromUTF8( logLine ) << wxS( "\n" );
+
+    return tail;
+}
+
+
+void SIM_SWEEP_RUNNER::failRun( size_t aRun, const wxString& aError )
+{
+    // The temporary files are removed at the end of the sweep, so the log is quoted
+    m_runErrors[aRun] = aError + wxS( "\n" ) + logTail( runFile( aRun, wxS( "log" ) ) );
+    m_finished++;
+
+    if( m_onProgress )
+        m_onProgress( m_finished, m_runs.size() );
+}
+
+
+void SIM_SWEEP_RUNNER::onWorkerFinished( SIM_SWEEP_PROCESS* aProcess, size_t aRun, int aStatus )
+{
+    m_active.erase( aRun );
+
+    if( aStatus != 0 )
+    {
+        failRun( aRun, wxString::Format( _( "ngspice exited with code %d." ), aStatus ) );
+    }
+    else
+    {
+        wxString rawFile = runFile( aRun, wxS( "raw" ) );
+
+        m_parsed[aRun] = GetKiCadThreadPool().submit_task(
+                [this, aRun, rawFile]() -> bool
+                {
+                    std::ifstream      in( rawFile.fn_str(), std::ios::binary );
+                    std::ostringstream content;
+
+                    content << in.rdbuf();
+
+                    return in && m_vectors[aRun].ParseRawFile( content.str() );
+                } );
+
+        m_finished++;
+
+        if( m_onProgress )
+            m_onProgress( m_finished, m_runs.size() );
+    }
+
+    launchNext();
+}
+
+
+void SIM_SWEEP_RUNNER::onFinishTimer( wxTimerEvent& aEvent )
+{
+    finish();
+}
+
+
+void SIM_SWEEP_RUNNER::finish()
+{
+    // The last raw files may still be parsed; check again later rather than blocking the UI
+    for( std::future<bool>& parsed : m_parsed )
+    {
+        if( parsed.valid()
+                && parsed.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+        {
+            m_finishTimer.StartOnce( 50 );
+            return;
+        }
+    }
+
+    std::vector<SIM_SWEEP::RUN>                runs;
+    std::vector<SIM_SWEEP_VECTORS>             vectors;
+    std::vector<SIM_SWEEP_RESULTS::FAILED_RUN> failedRuns;
+    wxString                                   errors;
+
+    for( size_t run = 0; run < m_runs.size(); ++run )
+    {
+        if( m_parsed[run].valid() && !m_parsed[run].get() )
+        {
+            m_runErrors[run] = _( "No results could be read." ) + wxS( "\n" )
+                               + logTail( runFile( run, wxS( "log" ) ) );
+        }
+
+        auto error = m_runErrors.find( run );
+
+        if( error != m_runErrors.end() )
+        {
+            errors << wxString::Format( _( "Run %zu: %s" ), run + 1, error->second );
+            failedRuns.push_back( { std::move( m_runs[run] ), error->second } );
+        }
+        else
+        {
+            runs.push_back( std::move( m_runs[run] ) );
+            vectors.push_back( std::move( m_vectors[run] ) );
+        }
+    }
+
+    std::shared_ptr<SIM_SWEEP_RESULTS> results;
+
+    if( !runs.empty() )
+    {
+        results = std::make_shared<SIM_SWEEP_RESULTS>( m_simType, std::move( runs ),
+                                                       std::move( vectors ),
+                                                       std::move( failedRuns ) );
+    }
+
+    FINISHED_CALLBACK callback = std::move( m_onFinished );
+
+    cleanup();
+
+    m_runs.clear();
+    m_vectors.clear();
+    m_parsed.clear();
+    m_runErrors.clear();
+    m_next = 0;
+    m_onFinished = nullptr;
+    m_onProgress = nullptr;
+    m_netlist.clear();
+
+    // Nothing may be touched after this, as the callback is free to start another sweep
+    if( callback )
+        callback( results, errors );
+}
+
+
+void SIM_SWEEP_RUNNER::Stop()
+{
+    m_finishTimer.Stop();
+
+    for( const auto& [run, process] : m_active )
+    {
+        process->Orphan();
+        wxProcess::Kill( process->GetPid(), wxSIGKILL, wxKILL_CHILDREN );
+    }
+
+    m_active.clear();
+
+    // Parsing tasks write into m_vectors
+    for( std::future<bool>& parsed : m_parsed )
+    {
+        if( parsed.valid() )
+            parsed.wait();
+    }
+
+    m_parsed.clear();
+    m_runs.clear();
+    m_vectors.clear();
+    m_runErrors.clear();
+    m_next = 0;
+    m_onFinished = nullptr;
+    m_onProgress = nullptr;
+
+    cleanup();
+}
+
+
+void SIM_SWEEP_RUNNER::cleanup()
+{
+    if( !m_tempDir.IsEmpty() && wxFileName::DirExists( m_tempDir ) )
+        wxFileName::Rmdir( m_tempDir, wxPATH_RMDIR_RECURSIVE );
+
+    m_tempDir.clear();
+}
@@ -0,0 +1,327 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SIM_SWEEP_H
+#define SIM_SWEEP_H
+
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wx/string.h>
+#include <wx/timer.h>
+
+#include "sim_types.h"
+
+class SIM_SWEEP_PROCESS;
+
+
+/**
+ * A parameter sweep and/or Monte Carlo study, described by `.step` directives:
+ *
+ *   .step param <name> <start> <stop> <increment>
+ *   .step param <name> list <value> [<value> ...]
+ *   .step mc <runs> [<seed>]
+ *
+ * Swept parameters must be defined with `.param` in the netlist.  Each combination of parameter
+ * values is a separate run; `.step mc` multiplies the runs, giving each one a different seed
+ * for ngspice's random functions (agauss(), aunif(), ...).
+ */
+class SIM_SWEEP
+{
+public:
+    struct PARAM
+    {
+        wxString            m_Name;
+        std::vector<double> m_Values;
+    };
+
+    struct RUN
+    {
+        std::vector<std::pair<wxString, double>> m_Params;
+        int                                      m_Seed = 0;     ///< 0 if not a Monte Carlo run
+    };
+
+    /// Upper bound on the number of runs of a single study.  Larger studies are rejected when
+    /// parsing the directives.
+    static constexpr size_t MAX_RUNS = 10000;
+
+    /**
+     * @return true if aLine is a `.step` directive.
+     */
+    static bool IsStepDirective( const wxString& aLine );
+
+    /**
+     * Parse the `.step` lines of the given (possibly multi-line) directives.
+     *
+     * @param aErrors receives a description of the invalid lines, if any.
+     * @return false if any `.step` line is invalid.
+     */
+    bool ParseDirectives( const std::vector<wxString>& aDirectives, wxString* aErrors = nullptr );
+
+    /**
+     * Parse a single `.step` line.
+     *
+     * A line which would bring the study over #MAX_RUNS runs is rejected and leaves the study
+     * unchanged.
+     */
+    bool ParseStep( const wxString& aLine, wxString* aError = nullptr );
+
+    bool IsEmpty() const { return m_params.empty() && m_mcRuns == 0; }
+
+    const std::vector<PARAM>& GetParams() const { return m_params; }
+
+    int GetMonteCarloRuns() const { return m_mcRuns; }
+
+    /**
+     * @return the number of runs of the study.
+     */
+    size_t GetRunCount() const { return countRuns( m_params, m_mcRuns ); }
+
+    /**
+     * @return the runs of the study.  The first parameter varies slowest and Monte Carlo runs
+     *         fastest.
+     */
+    std::vector<RUN> GetRuns() const;
+
+    /**
+     * @return true if sweeps can be run for the given analysis type.
+     */
+    static bool IsSupported( SIM_TYPE aType )
+    {
+        return aType == ST_TRAN || aType == ST_DC || aType == ST_AC;
+    }
+
+    /**
+     * Build the netlist of a single run from the netlist of the nominal circuit.
+     *
+     * The netlist gets a control section which applies the run's parameters, runs the analysis
+     * and writes all vectors to aRawFile in ngspice's ascii raw format.  Transient results are
+     * linearized so that all the runs share the same time axis.
+     */
+    static std::string MakeRunNetlist( const std::string& aNetlist, const RUN& aRun,
+                                       SIM_TYPE aSimType, const std::string& aRawFile );
+
+private:
+    static size_t countRuns( const std::vector<PARAM>& aParams, int aMcRuns );
+
+private:
+    std::vector<PARAM> m_params;
+    int                m_mcRuns = 0;
+    int                m_mcSeed = 1;
+};
+
+
+/**
+ * Vectors read from an ngspice raw file.  The first one is the scale (time, frequency...).
+ */
+struct SIM_SWEEP_VECTORS
+{
+    std::vector<std::string>         m_Names;    ///< normalized, see NormalizeVectorName()
+    std::vector<std::vector<double>> m_Real;
+    std::vector<std::vector<double>> m_Imag;     ///< empty unless the plot is complex
+
+    bool IsComplex() const { return !m_Imag.empty(); }
+
+    size_t GetPointCount() const { return m_Real.empty() ? 0 : m_Real[0].size(); }
+
+    /**
+     * @return the index of a vector, or -1 if there is no such vector.
+     */
+    int Find( const std::string& aNormalizedName ) const;
+
+    /**
+     * Parse the contents of an ngspice ascii raw file (`set filetype=ascii`, `write`).
+     */
+    bool ParseRawFile( const std::string& aContent );
+
+    /**
+     * Bring vector names to a common form, as ngspice writes node voltages as `v(node)` and
+     * branch currents as `i(device)` in raw files, while the shared library names them `node`
+     * and `device#branch`.
+     */
+    static std::string NormalizeVectorName( const wxString& aName );
+};
+
+
+/**
+ * The combined results of the successful runs of a #SIM_SWEEP.
+ */
+class SIM_SWEEP_RESULTS
+{
+public:
+    /// A run which gave no results, and why.
+    struct FAILED_RUN
+    {
+        SIM_SWEEP::RUN m_Run;
+        wxString       m_Error;
+    };
+
+    SIM_SWEEP_RESULTS( SIM_TYPE aSimType, std::vector<SIM_SWEEP::RUN> aRuns,
+                       std::vector<SIM_SWEEP_VECTORS> aVectors,
+                       std::vector<FAILED_RUN> aFailedRuns = {} ) :
+            m_simType( aSimType ),
+            m_runs( std::move( aRuns ) ),
+            m_vectors( std::move( aVectors ) ),
+            m_failedRuns( std::move( aFailedRuns ) )
+    {}
+
+    SIM_TYPE GetSimType() const { return m_simType; }
+
+    const std::vector<SIM_SWEEP::RUN>& GetRuns() const { return m_runs; }
+
+    size_t GetRunCount() const { return m_runs.size(); }
+
+    const std::vector<FAILED_RUN>& GetFailedRuns() const { return m_failedRuns; }
+
+    /**
+     * @return the number of points in each run, or 0 if the runs do not share the same scale.
+     */
+    size_t GetPointsPerRun() const;
+
+    enum PART { REAL, GAIN, PHASE };
+
+    /**
+     * Return the scale and a vector of all the runs, concatenated in run order so they can be
+     * plotted as sweep sub-traces.
+     *
+     * @param aPart selects the real part, gain or phase of the vector.
+     * @return false if the vector is missing from any run.
+     */
+    bool GetVector( const wxString& aName, PART aPart, std::vector<double>* aX,
+                    std::vector<double>* aY ) const;
+
+    struct STATS
+    {
+        double m_Mean = 0.0;
+        double m_StdDev = 0.0;
+        double m_Min = 0.0;
+        double m_Max = 0.0;
+    };
+
+    /**
+     * Compute statistics of the final value of a vector across the runs (gain for complex
+     * vectors).
+     *
+     * @return false if the vector is missing from any run.
+     */
+    bool GetFinalValueStats( const wxString& aName, STATS* aStats ) const;
+
+private:
+    SIM_TYPE                       m_simType;
+    std::vector<SIM_SWEEP::RUN>    m_runs;
+    std::vector<SIM_SWEEP_VECTORS> m_vectors;
+    std::vector<FAILED_RUN>        m_failedRuns;
+};
+
+
+/**
+ * Run the netlists of a #SIM_SWEEP in parallel with the ngspice console executable.
+ *
+ * The ngspice shared library can only hold one circuit per process, so every run is simulated
+ * by a separate `ngspice -b` worker process.  Up to one worker per thread of the KiCad thread
+ * pool runs at a time and the raw files are parsed on the pool as the workers finish.
+ *
+ * Processes are driven by the wx event loop: the callbacks are called from the main thread,
+ * which never waits for the workers or the parsing.  The temporary files are removed once the
+ * sweep is over, the errors of the failed runs quoting the end of their ngspice log.
+ */
+class SIM_SWEEP_RUNNER
+{
+public:
+    typedef std::function<void( std::shared_ptr<SIM_SWEEP_RESULTS>, const wxString& )>
+            FINISHED_CALLBACK;
+
+    typedef std::function<void( size_t, size_t )> PROGRESS_CALLBACK;
+
+    SIM_SWEEP_RUNNER();
+    ~SIM_SWEEP_RUNNER();
+
+    /**
+     * @return the path of the ngspice executable, or an empty string if it cannot be found.
+     */
+    static wxString FindNgspice();
+
+    /**
+     * Start the runs of a sweep.
+     *
+     * @param aNetlist is the netlist of the nominal circuit, including the analysis command.
+     * @param aInitCommands are ngspice commands to execute before loading the netlist (such as
+     *                      the compatibility mode settings).
+     * @param aOnFinished receives the results of the successful runs (nullptr if none
+     *                    succeeded) and the error messages of the failed runs.  It is called
+     *                    from the event loop, never before Start() returns.
+     * @param aOnProgress receives the number of finished runs and the total.
+     * @return false if the sweep could not be started; aError tells why.
+     */
+    bool Start( const std::string& aNetlist, SIM_TYPE aSimType, const SIM_SWEEP& aSweep,
+                const std::vector<std::string>& aInitCommands, FINISHED_CALLBACK aOnFinished,
+                PROGRESS_CALLBACK aOnProgress, wxString* aError );
+
+    /**
+     * Kill the running workers and drop the queued runs.  The finished callback is not called.
+     */
+    void Stop();
+
+    bool IsRunning() const { return !m_runs.empty(); }
+
+    size_t GetWorkerCount() const { return m_maxWorkers; }
+
+private:
+    friend class SIM_SWEEP_PROCESS;
+
+    void launchNext();
+    void onWorkerFinished( SIM_SWEEP_PROCESS* aProcess, size_t aRun, int aStatus );
+    void onFinishTimer( wxTimerEvent& aEvent );
+
+    /// Record the failure of a run which is over
+    void failRun( size_t aRun, const wxString& aError );
+
+    /// Call the finished callback once all the raw files are parsed
+    void finish();
+    void cleanup();
+
+    wxString runFile( size_t aRun, const wxString& aExtension ) const;
+
+private:
+    wxString                           m_ngspice;
+    wxString                           m_tempDir;
+    std::string                        m_netlist;
+    SIM_TYPE                           m_simType;
+    std::vector<SIM_SWEEP::RUN>        m_runs;
+    size_t                             m_next;
+    size_t                             m_finished;
+    size_t                             m_maxWorkers;
+    std::map<size_t, SIM_SWEEP_PROCESS*> m_active;
+    std::vector<SIM_SWEEP_VECTORS>     m_vectors;
+    std::vector<std::future<bool>>     m_parsed;
+    std::map<size_t, wxString>         m_runErrors;
+    wxTimer                            m_finishTimer;    ///< calls finish() from the event loop
+    FINISHED_CALLBACK                  m_onFinished;
+    PROGRESS_CALLBACK                  m_onProgress;
+};
+
+#endif // SIM_SWEEP_H
@@ -55,11 +55,13 @@
 #include <sim/sim_plot_tab.h>
 #include <sim/spice_simulator.h>
 #include <sim/simulator_reporter.h>
+#include <sim/sim_sweep.h>
 #include <eeschema_settings.h>
 #include <advanced_config.h>
 #include <sim/toolbars_simulator_frame.h>
 #include <settings/settings_manager.h>
 
+#include <chrono>
 #include <memory>
 
 
@@ -473,6 +475,8 @@ void SIMULATOR_FRAME::StartSimulation()
         m_ui->OnSimUpdate();
         m_simulator->Run();
 
+        startSweep( simTab );
+
         // Netlist from schematic may have changed; update signals list, measurements list,
         // etc.
         m_ui->OnPlotSettingsChanged();
@@ -484,6 +488,88 @@ void SIMULATOR_FRAME::StartSimulation()
 }
 
 
+void SIMULATOR_FRAME::startSweep( SIM_TAB* aSimTab )
+{
+    if( m_sweepRunner )
+        m_sweepRunner->Stop();
+
+    SIM_SWEEP sweep;
+    wxString  errors;
+
+    // Running only part of the study would give misleading results
+    if( !sweep.ParseDirectives( m_circuitModel->GetDirectives(), &errors ) )
+    {
+        m_ui->OnSimReport( errors );
+        m_ui->OnSimReport( _( "Sweep not run; showing the nominal simulation only." ) );
+        return;
+    }
+
+    if( sweep.IsEmpty() )
+        return;
+
+    SIM_TYPE simType = aSimTab->GetSimType();
+
+    if( !SIM_SWEEP::IsSupported( simType ) )
+    {
+        m_ui->OnSimReport( _( "Parameter sweeps are only supported for transient, DC and AC "
+                              "analyses; showing the nominal simulation only." ) );
+        return;
+    }
+
+    if( !m_sweepRunner )
+        m_sweepRunner = std::make_unique<SIM_SWEEP_RUNNER>();
+
+    wxString simCommand = aSimTab->GetSimCommand();
+    auto     start = std::chrono::steady_clock::now();
+    wxString error;
+
+    auto onFinished =
+            [this, simCommand, start]( std::shared_ptr<SIM_SWEEP_RESULTS> aResults,
+                                       const wxString& aErrors )
+            {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+                if( !aErrors.IsEmpty() )
+                    m_ui->OnSimReport( aErrors );
+
+                if( aResults )
+                {
+                    m_ui->OnSimReport( wxString::Format( _( "Sweep of %zu runs finished in %.1f s "
+                                                            "using %zu worker processes." ),
+                                                         aResults->GetRunCount(),
+                                                         elapsed.count(),
+                                                         m_sweepRunner->GetWorkerCount() ) );
+
+                    if( !aResults->GetFailedRuns().empty() )
+                    {
+                        m_ui->OnSimReport( wxString::Format( _( "%zu failed runs are not "
+                                                                "shown." ),
+                                                             aResults->GetFailedRuns().size() ) );
+                    }
+                }
+                else
+                {
+                    m_ui->OnSimReport( _( "Sweep failed; showing the nominal simulation only." ) );
+                }
+
+                m_ui->OnSweepFinished( simCommand, aResults );
+            };
+
+    if( !m_sweepRunner->Start( m_simulator->GetNetlist(), simType, sweep,
+                               m_simulator->GetSettingCommands(), onFinished, nullptr,
+                               &error ) )
+    {
+        m_ui->OnSimReport( error );
+        return;
+    }
+
+    m_ui->OnSimReport( wxString::Format( _( "Running %zu sweep steps in up to %zu ngspice "
+                                            "processes..." ),
+                                         sweep.GetRunCount(),
+                                         m_sweepRunner->GetWorkerCount() ) );
+}
+
+
 SIM_TAB* SIMULATOR_FRAME::NewSimTab( const wxString& aSimCommand )
 {
     return m_ui->NewSimTab( aSimCommand );
@@ -653,6 +739,9 @@ void SIMULATOR_FRAME::doCloseWindow()
     if( m_simulator->IsRunning() )
         m_simulator->Stop();
 
+    if( m_sweepRunner )
+        m_sweepRunner->Stop();
+
     // Prevent memory leak on exit by deleting all simulation vectors
     m_simulator->Clean();
 
@@ -854,6 +943,10 @@ void SIMULATOR_FRAME::onUpdateSim( wxCommandEvent& aEvent )
     if( m_simulator->IsRunning() )
         m_simulator->Stop();
 
+    // Sweep results do not reflect the tuned values
+    if( m_sweepRunner )
+        m_sweepRunner->Stop();
+
     std::unique_lock<std::mutex> simulatorLock( m_simulator->GetMutex(), std::try_to_lock );
 
     if( simulatorLock.owns_lock() )
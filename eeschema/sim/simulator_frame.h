@@ -47,6 +47,7 @@ class SIMULATOR_FRAME_UI;
 class SIM_THREAD_REPORTER;
 class ACTION_TOOLBAR;
 class SPICE_SIMULATOR;
+class SIM_SWEEP_RUNNER;
 
 
 /**
@@ -212,6 +213,12 @@ private:
 
     void showNetlistErrors( const WX_STRING_REPORTER& aReporter );
 
+    /**
+     * Start the parameter sweep or Monte Carlo runs described by the `.step` directives of the
+     * schematic, if any, alongside the nominal simulation.
+     */
+    void startSweep( SIM_TAB* aSimTab );
+
     bool canCloseWindow( wxCloseEvent& aEvent ) override;
     void doCloseWindow() override;
 
@@ -230,6 +237,7 @@ private:
     std::shared_ptr<SPICE_SIMULATOR>     m_simulator;
     SIM_THREAD_REPORTER*                 m_reporter;
     std::shared_ptr<SPICE_CIRCUIT_MODEL> m_circuitModel;
+    std::unique_ptr<SIM_SWEEP_RUNNER>    m_sweepRunner;
 
     bool                                 m_simFinished;
     bool                                 m_workbookModified;
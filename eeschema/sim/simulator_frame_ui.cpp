@@ -49,6 +49,7 @@
 #include <sim/simulator_frame_ui.h>
 #include <sim/simulator_frame.h>
 #include <sim/sim_plot_tab.h>
+#include <sim/sim_sweep.h>
 #include <sim/spice_simulator.h>
 #include <dialogs/dialog_text_entry.h>
 #include <dialogs/dialog_sim_format_value.h>
@@ -1908,6 +1909,37 @@ void SIMULATOR_FRAME_UI::updateTrace( const wxString& aVectorName, int aTraceTyp
 
     std::vector<double> data_x;
     std::vector<double> data_y;
+    int                 runCount = 1;
+
+    // Two-source DC sweeps hold a sub-trace for each value of the second source
+    auto dcSweepCount =
+            [&]() -> int
+            {
+                SPICE_DC_PARAMS source1, source2;
+
+                if( simType == ST_DC
+                        && circuitModel()->ParseDCCommand( aPlotTab->GetSimCommand(), &source1,
+                                                           &source2 )
+                        && !source2.m_source.IsEmpty() )
+                {
+                    SPICE_VALUE v = ( source2.m_vend - source2.m_vstart ) / source2.m_vincrement;
+
+                    return KiROUND( v.ToDouble() ) + 1;
+                }
+
+                return 1;
+            };
+
+    if( getSweepTraceData( simVectorName, aTraceType, aPlotTab, &data_x, &data_y, &runCount ) )
+    {
+        int    sweepCount = runCount * dcSweepCount();
+        size_t sweepSize = data_x.size() / sweepCount;
+
+        if( TRACE* trace = aPlotTab->GetOrAddTrace( aVectorName, aTraceType ) )
+            aPlotTab->SetTraceData( trace, data_x, data_y, sweepCount, sweepSize );
+
+        return;
+    }
 
     if( !aDataX || aClearData )
         aDataX = &data_x;
@@ -1960,19 +1992,11 @@ void SIMULATOR_FRAME_UI::updateTrace( const wxString& aVectorName, int aTraceTyp
         wxFAIL_MSG( wxT( "Unhandled plot type" ) );
     }
 
-    SPICE_DC_PARAMS source1, source2;
-    int             sweepCount = 1;
-    size_t          sweepSize = std::numeric_limits<size_t>::max();
-
-    if( simType == ST_DC
-            && circuitModel()->ParseDCCommand( aPlotTab->GetSimCommand(), &source1, &source2 )
-            && !source2.m_source.IsEmpty() )
-    {
-        SPICE_VALUE v = ( source2.m_vend - source2.m_vstart ) / source2.m_vincrement;
+    int    sweepCount = dcSweepCount();
+    size_t sweepSize = std::numeric_limits<size_t>::max();
 
-        sweepCount = KiROUND( v.ToDouble() ) + 1;
+    if( sweepCount > 1 )
         sweepSize = aDataX->size() / sweepCount;
-    }
 
     if( TRACE* trace = aPlotTab->GetOrAddTrace( aVectorName, aTraceType ) )
     {
@@ -1982,6 +2006,28 @@ void SIMULATOR_FRAME_UI::updateTrace( const wxString& aVectorName, int aTraceTyp
 }
 
 
+bool SIMULATOR_FRAME_UI::getSweepTraceData( const wxString& aSimVectorName, int aTraceType,
+                                            SIM_PLOT_TAB* aPlotTab, std::vector<double>* aDataX,
+                                            std::vector<double>* aDataY, int* aRunCount ) const
+{
+    if( !m_sweepResults || aPlotTab->GetSimCommand() != m_sweepSimCommand )
+        return false;
+
+    SIM_SWEEP_RESULTS::PART part = SIM_SWEEP_RESULTS::REAL;
+
+    if( m_sweepResults->GetSimType() == ST_AC )
+        part = ( aTraceType & SPT_AC_PHASE ) ? SIM_SWEEP_RESULTS::PHASE : SIM_SWEEP_RESULTS::GAIN;
+
+    // Signals the worker processes did not write (such as user-defined signals) are shown from
+    // the nominal simulation
+    if( !m_sweepResults->GetVector( aSimVectorName, part, aDataX, aDataY ) )
+        return false;
+
+    *aRunCount = (int) m_sweepResults->GetRunCount();
+    return !aDataX->empty();
+}
+
+
 // TODO make sure where to instantiate and how to style correct
 // Better ask someone..
 template void SIMULATOR_FRAME_UI::signalsGridCursorUpdate<SIGNALS_GRID_COLUMNS, int, int>(
@@ -3092,6 +3138,9 @@ void SIMULATOR_FRAME_UI::OnSimUpdate()
 
     m_simConsole->Clear();
 
+    m_sweepResults.reset();
+    m_sweepSimCommand.clear();
+
     // Do not export netlist, it is already stored in the simulator
     applyTuners();
 
@@ -3325,6 +3374,52 @@ void SIMULATOR_FRAME_UI::OnSimRefresh( bool aFinal )
 }
 
 
+void SIMULATOR_FRAME_UI::OnSweepFinished( const wxString& aSimCommand,
+                                          const std::shared_ptr<SIM_SWEEP_RESULTS>& aResults )
+{
+    m_sweepResults = aResults;
+    m_sweepSimCommand = aSimCommand;
+
+    SIM_PLOT_TAB* plotTab = dynamic_cast<SIM_PLOT_TAB*>( GetCurrentSimTab() );
+
+    if( !aResults || !plotTab || plotTab->GetSimCommand() != aSimCommand )
+        return;
+
+    wxString msg;
+
+    m_simConsole->AppendText( wxString::Format( _( "\n\nFinal values over %zu runs:\n\n" ),
+                                                aResults->GetRunCount() ) );
+
+    for( const auto& [ name, trace ] : plotTab->GetTraces() )
+    {
+        SIM_SWEEP_RESULTS::STATS stats;
+        wxString                 vectorName = trace->GetName();
+
+        if( trace->GetType() & SPT_AC_PHASE )
+            continue;
+
+        if( trace->GetType() & SPT_POWER )
+            vectorName = vectorName.AfterFirst( '(' ).BeforeLast( ')' ) + wxS( ":power" );
+
+        if( !aResults->GetFinalValueStats( vectorName, &stats ) )
+            continue;
+
+        msg.Printf( _( "%s: mean %s, std. dev. %s, min %s, max %s\n" ),
+                    trace->GetName(),
+                    SPICE_VALUE( stats.m_Mean ).ToSpiceString(),
+                    SPICE_VALUE( stats.m_StdDev ).ToSpiceString(),
+                    SPICE_VALUE( stats.m_Min ).ToSpiceString(),
+                    SPICE_VALUE( stats.m_Max ).ToSpiceString() );
+
+        m_simConsole->AppendText( msg );
+    }
+
+    m_simConsole->SetInsertionPointEnd();
+
+    OnSimRefresh( true );
+}
+
+
 void SIMULATOR_FRAME_UI::OnModify()
 {
     m_simulatorFrame->OnModify();
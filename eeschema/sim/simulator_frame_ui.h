@@ -43,6 +43,7 @@ class SPICE_SIMULATOR;
 class SPICE_SETTINGS;
 class EESCHEMA_SETTINGS;
 class SPICE_CIRCUIT_MODEL;
+class SIM_SWEEP_RESULTS;
 
 class SIM_THREAD_REPORTER;
 class TUNER_SLIDER;
@@ -251,6 +252,16 @@ public:
     void OnSimReport( const wxString& aMsg );
     void OnSimRefresh( bool aFinal );
 
+    /**
+     * Show the results of a parameter sweep in place of the nominal simulation, and report
+     * statistics of the plotted signals.
+     *
+     * @param aSimCommand is the command of the sweep; only tabs with this command use the results.
+     * @param aResults may be nullptr if the sweep failed.
+     */
+    void OnSweepFinished( const wxString& aSimCommand,
+                          const std::shared_ptr<SIM_SWEEP_RESULTS>& aResults );
+
     void OnModify();
 
 private:
@@ -271,6 +282,16 @@ private:
     void updateTrace( const wxString& aVectorName, int aTraceType, SIM_PLOT_TAB* aPlotTab,
                       std::vector<double>* aDataX = nullptr, bool aClearData = false );
 
+    /**
+     * Fetch the data of a trace from the sweep results, if there are results for the tab.
+     *
+     * @param aRunCount receives the number of sweep runs the data is made of.
+     * @return false if the trace should be taken from the nominal simulation.
+     */
+    bool getSweepTraceData( const wxString& aSimVectorName, int aTraceType,
+                            SIM_PLOT_TAB* aPlotTab, std::vector<double>* aDataX,
+                            std::vector<double>* aDataY, int* aRunCount ) const;
+
     /**
      * A common toggler for the two main wxSplitterWindow s
      */
@@ -376,6 +397,8 @@ private:
     SCH_EDIT_FRAME*              m_schematicFrame;
 
     std::vector<wxString>        m_signals;
+    std::shared_ptr<SIM_SWEEP_RESULTS> m_sweepResults;
+    wxString                     m_sweepSimCommand;
     std::map<int, wxString>      m_userDefinedSignals;
     std::list<TUNER_SLIDER*>     m_tuners;
 
@@ -3088,7 +3088,7 @@ void SCH_EDIT_TOOL::collectUnits( const SCH_SELECTION& aSelection,
                 int      unit = symbol->GetUnit();
                 LIB_ID   libId = symbol->GetLibId();
 
-                for( SCH_SHEET_PATH& sheet : m_frame->Schematic().Hierarchy() )
+                for( const SCH_SHEET_PATH& sheet : m_frame->Schematic().Hierarchy() )
                 {
                     SCH_SCREEN*              screen = sheet.LastScreen();
                     std::vector<SCH_SYMBOL*> otherUnits;
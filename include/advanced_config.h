@@ -486,6 +486,17 @@ public:
      */
     bool m_IncrementalConnectivity;
 
+    /**
+     * Check every incremental connectivity update against a full recalculation and log the
+     * items whose net differs.  This is slow and only meant for debugging the incremental
+     * netlister.
+     *
+     * Setting name: "IncrementalConnectivityVerify"
+     * Valid values: 0 or 1
+     * Default value: 0
+     */
+    bool m_IncrementalConnectivityVerify;
+
     /**
      * The number of milliseconds to wait in a click before showing a disambiguation menu.
      *
@@ -800,6 +811,17 @@ public:
      */
     int m_PNSProcessClusterTimeout;
 
+    /**
+     * Evaluate independent PNS router candidates (walkaround winding directions, optimizer
+     * merge bypasses) concurrently on the thread pool.  The selected result is the same as
+     * the one picked by the serial evaluation.
+     *
+     * Setting name: "PNSParallelCandidateEvaluation"
+     * Valid values: 0 or 1
+     * Default value: 0
+     */
+    bool m_PNSParallelCandidates;
+
     /**
      * Skip importing component bodies when importing some format files, such as Altium.
      *
@@ -824,6 +846,26 @@ public:
      */
     int m_ScreenDPI;
 
+    /**
+     * Record the drawing commands of items whose cached geometry has to be rebuilt on the
+     * thread pool.  Only the playback into the GAL cache is done on the GUI thread.
+     *
+     * Setting name: "ParallelViewRecache"
+     * Valid values: 0 or 1
+     * Default value: 1
+     */
+    bool m_ParallelViewRecache;
+
+    /**
+     * Memory budget of the caches of laid out text shared by all the fonts, in MiB.  The least
+     * recently used runs and glyphs are dropped beyond it.
+     *
+     * Setting name: "TextCacheSize"
+     * Valid values: 1 to 4096
+     * Default value: 64
+     */
+    int m_TextCacheSize;
+
     wxString m_traceMasks; ///< Trace masks for wxLogTrace, loaded from the config file.
     ///@}
 
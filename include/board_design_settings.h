@@ -792,6 +792,9 @@ public:
     /// Enable inclusion of stackup height in track length measurements and length tuning
     bool       m_UseHeightForLengthCalcs;
 
+    /// Use a uniform-grid spatial index instead of R-trees in the interactive router
+    bool       m_RouterGridIndex;
+
 private:
     VECTOR2I   m_auxOrigin;  ///< origin for plot exports
     VECTOR2I   m_gridOrigin; ///< origin for grid offsets
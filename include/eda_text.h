@@ -26,6 +26,7 @@
 #define EDA_TEXT_H_
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <eda_search_data.h>
@@ -381,7 +382,12 @@ public:
     virtual void ClearRenderCache();
     virtual void ClearBoundingBoxCache();
 
-    std::vector<std::unique_ptr<KIFONT::GLYPH>>*
+    /**
+     * @return the glyphs of the text for the outline font \a aFont, or nullptr for a stroke
+     *         font.  The list is never modified once returned, so it can be drawn while another
+     *         thread rebuilds the cache.
+     */
+    std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>>
     GetRenderCache( const KIFONT::FONT* aFont, const wxString& forResolvedText,
                     const VECTOR2I& aOffset = { 0, 0 } ) const;
 
@@ -460,7 +466,7 @@ private:
     mutable const KIFONT::FONT*                         m_render_cache_font;
     mutable EDA_ANGLE                                   m_render_cache_angle;
     mutable VECTOR2I                                    m_render_cache_offset;
-    mutable std::vector<std::unique_ptr<KIFONT::GLYPH>> m_render_cache;
+    mutable std::shared_ptr<std::vector<std::unique_ptr<KIFONT::GLYPH>>> m_render_cache;
 
     struct BBOX_CACHE_ENTRY
     {
@@ -470,6 +476,9 @@ private:
 
     mutable std::map<int, BBOX_CACHE_ENTRY> m_bbox_cache;
 
+    /// Guards the render and bounding box caches, which are filled from plotting threads
+    mutable std::mutex                      m_cache_mutex;
+
     TEXT_ATTRIBUTES  m_attributes;
     wxString         m_unresolvedFontName;
     VECTOR2I         m_pos;
@@ -34,6 +34,7 @@
 #include <wx/string.h>
 #include <font/glyph.h>
 #include <font/text_attributes.h>
+#include <font/text_cache.h>
 
 namespace KIGFX
 {
@@ -202,6 +203,9 @@ public:
     /**
      * Convert text string to an array of GLYPHs.
      *
+     * The runs are looked up in a cache shared by all the fonts and threads, so drawing,
+     * plotting and measuring the same text only lays it out once.
+     *
      * @param aBBox pointer to a BOX2I that will set to the bounding box, or nullptr
      * @param aGlyphs storage for the returned GLYPHs
      * @param aText text to convert to polygon/polyline
@@ -213,13 +217,41 @@ public:
      * @param aTextStyle text style flags
      * @return text cursor position after this text
      */
-    virtual VECTOR2I GetTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                                      const wxString& aText, const VECTOR2I& aSize,
-                                      const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
-                                      bool aMirror, const VECTOR2I& aOrigin,
-                                      TEXT_STYLE_FLAGS aTextStyle ) const = 0;
+    VECTOR2I GetTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                              const wxString& aText, const VECTOR2I& aSize,
+                              const VECTOR2I& aPosition, const EDA_ANGLE& aAngle, bool aMirror,
+                              const VECTOR2I& aOrigin, TEXT_STYLE_FLAGS aTextStyle ) const;
+
+    /**
+     * Counters of the text layout caches shared by all the fonts.
+     */
+    struct CACHE_STATS
+    {
+        TEXT_CACHE_STATS m_TextRuns;     ///< Glyphs and extents of text runs
+        TEXT_CACHE_STATS m_ShapedRuns;   ///< Glyph indices and advances from HarfBuzz
+        TEXT_CACHE_STATS m_Glyphs;       ///< Outline font glyphs with their triangulation
+    };
+
+    static CACHE_STATS GetCacheStats();
+
+    /**
+     * Empty the text layout caches.  The counters are kept.
+     */
+    static void ClearCaches();
 
 protected:
+    /**
+     * Convert text string to an array of GLYPHs, without looking it up in the cache.
+     *
+     * Called from any thread.  The parameters are those of GetTextAsGlyphs(), except that
+     * \a aBBox has to be set (not merged) when not nullptr.
+     */
+    virtual VECTOR2I layoutText( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                                 const wxString& aText, const VECTOR2I& aSize,
+                                 const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
+                                 bool aMirror, const VECTOR2I& aOrigin,
+                                 TEXT_STYLE_FLAGS aTextStyle ) const = 0;
+
     /**
      * Return number of lines for a given text.
      *
@@ -290,6 +322,9 @@ protected:
     wxString     m_fontName;         ///< Font name
     wxString     m_fontFileName;     ///< Font file name
 
+    /// Identifies the font in the text run cache.  Unlike the address, never reused.
+    uint64_t     m_cacheId;
+
 private:
     static FONT* s_defaultFont;
 
@@ -90,7 +90,7 @@ public:
      * (See GetTriangulationData() above for more info.)
      */
     void CacheTriangulation(
-            std::vector<std::unique_ptr<SHAPE_POLY_SET::TRIANGULATED_POLYGON>>& aHintData );
+            const std::vector<std::unique_ptr<SHAPE_POLY_SET::TRIANGULATED_POLYGON>>& aHintData );
 };
 
 
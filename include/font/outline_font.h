@@ -46,6 +46,8 @@
 
 namespace KIFONT
 {
+struct SHAPED_RUN;
+
 /**
  * Class OUTLINE_FONT implements outline font drawing.
  */
@@ -106,17 +108,20 @@ public:
      */
     double GetInterline( double aGlyphHeight, const METRICS& aFontMetrics ) const override;
 
-    VECTOR2I GetTextAsGlyphs( BOX2I* aBoundingBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                              const wxString& aText, const VECTOR2I& aSize,
-                              const VECTOR2I& aPosition, const EDA_ANGLE& aAngle, bool aMirror,
-                              const VECTOR2I& aOrigin, TEXT_STYLE_FLAGS aTextStyle ) const override;
-
     void GetLinesAsGlyphs( std::vector<std::unique_ptr<GLYPH>>* aGlyphs, const wxString& aText,
                            const VECTOR2I& aPosition, const TEXT_ATTRIBUTES& aAttrs,
                            const METRICS& aFontMetrics ) const;
 
     const FT_Face& GetFace() const { return m_face; }
 
+    /**
+     * Get the counters of the caches of shaped runs and of glyph outlines shared by all the
+     * outline fonts.
+     */
+    static void GetShapingCacheStats( TEXT_CACHE_STATS& aShapedRuns, TEXT_CACHE_STATS& aGlyphs );
+
+    static void ClearShapingCaches();
+
 #if 0
     void RenderToOpenGLCanvas( KIGFX::OPENGL_FREETYPE& aTarget, const wxString& aString,
                                const VECTOR2D& aSize, const wxPoint& aPosition,
@@ -128,18 +133,29 @@ protected:
 
     BOX2I getBoundingBox( const std::vector<std::unique_ptr<GLYPH>>& aGlyphs ) const;
 
+    VECTOR2I layoutText( BOX2I* aBoundingBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                         const wxString& aText, const VECTOR2I& aSize, const VECTOR2I& aPosition,
+                         const EDA_ANGLE& aAngle, bool aMirror, const VECTOR2I& aOrigin,
+                         TEXT_STYLE_FLAGS aTextStyle ) const override;
+
     VECTOR2I getTextAsGlyphs( BOX2I* aBoundingBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
                               const wxString& aText, const VECTOR2I& aSize,
                               const VECTOR2I& aPosition, const EDA_ANGLE& aAngle, bool aMirror,
                               const VECTOR2I& aOrigin, TEXT_STYLE_FLAGS aTextStyle ) const;
 
 private:
-    VECTOR2I getTextAsGlyphsUnlocked( BOX2I* aBoundingBox,
-                                      std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                                      const wxString& aText, const VECTOR2I& aSize,
-                                      const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
-                                      bool aMirror, const VECTOR2I& aOrigin,
-                                      TEXT_STYLE_FLAGS aTextStyle ) const;
+    /**
+     * Shape a run of text with HarfBuzz, or get it from the cache.  Takes the FreeType lock on
+     * a cache miss only.
+     */
+    std::shared_ptr<const SHAPED_RUN> shapeText( const wxString& aText, bool aSuperSub ) const;
+
+    /**
+     * Load the contours of a glyph from FreeType, or a tofu box if it has none.  Takes the
+     * FreeType lock.
+     */
+    void loadGlyph( std::vector<CONTOUR>& aContours, unsigned int aCodepoint, int aAdvance,
+                    bool aSuperSub ) const;
 
 private:
     // FreeType variables
@@ -72,10 +72,11 @@ public:
      */
     double GetInterline( double aGlyphHeight, const METRICS& aFontMetrics ) const override;
 
-    VECTOR2I GetTextAsGlyphs( BOX2I* aBoundingBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
-                              const wxString& aText, const VECTOR2I& aSize,
-                              const VECTOR2I& aPosition, const EDA_ANGLE& aAngle, bool aMirror,
-                              const VECTOR2I& aOrigin, TEXT_STYLE_FLAGS aTextStyle ) const override;
+protected:
+    VECTOR2I layoutText( BOX2I* aBoundingBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
+                         const wxString& aText, const VECTOR2I& aSize, const VECTOR2I& aPosition,
+                         const EDA_ANGLE& aAngle, bool aMirror, const VECTOR2I& aOrigin,
+                         TEXT_STYLE_FLAGS aTextStyle ) const override;
 
 private:
     /**
@@ -0,0 +1,164 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef TEXT_CACHE_H_
+#define TEXT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace KIFONT
+{
+
+/**
+ * Counters of a #TEXT_CACHE.
+ */
+struct TEXT_CACHE_STATS
+{
+    uint64_t m_Hits = 0;
+    uint64_t m_Misses = 0;
+    uint64_t m_Evictions = 0;     ///< Entries dropped to stay within the memory budget
+    size_t   m_Entries = 0;
+    size_t   m_Bytes = 0;         ///< Estimated memory used by the entries
+
+    double HitRate() const
+    {
+        uint64_t lookups = m_Hits + m_Misses;
+
+        return lookups ? (double) m_Hits / lookups : 0.0;
+    }
+};
+
+
+/**
+ * A thread-safe cache of text layout data, dropping the least recently used entries beyond a
+ * memory budget.
+ *
+ * The values are immutable once stored and handed out as shared pointers, so the lock is only
+ * held for the lookup: callers build missing values without it and several threads can read
+ * the same entry.  Two threads missing the same key at the same time both build the value, and
+ * the last one stored wins.
+ */
+template <typename KEY, typename VALUE, typename HASH = std::hash<KEY>>
+class TEXT_CACHE
+{
+public:
+    TEXT_CACHE( size_t aMaxBytes ) :
+            m_maxBytes( aMaxBytes )
+    {
+    }
+
+    /**
+     * @return the value stored for \a aKey, or nullptr.
+     */
+    std::shared_ptr<const VALUE> Get( const KEY& aKey )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        auto it = m_index.find( aKey );
+
+        if( it == m_index.end() )
+        {
+            m_stats.m_Misses++;
+            return nullptr;
+        }
+
+        m_stats.m_Hits++;
+        m_entries.splice( m_entries.begin(), m_entries, it->second );
+
+        return it->second->m_Value;
+    }
+
+    /**
+     * Store a value, replacing the one stored for the same key if any.
+     *
+     * @param aBytes is an estimate of the memory used by the value.
+     */
+    void Put( const KEY& aKey, std::shared_ptr<const VALUE> aValue, size_t aBytes )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        auto it = m_index.find( aKey );
+
+        if( it != m_index.end() )
+        {
+            m_stats.m_Bytes -= it->second->m_Bytes;
+            m_entries.erase( it->second );
+            m_index.erase( it );
+        }
+
+        m_entries.push_front( { aKey, std::move( aValue ), aBytes } );
+        m_index.emplace( aKey, m_entries.begin() );
+        m_stats.m_Bytes += aBytes;
+
+        // Keep at least the new entry, even if it is larger than the budget
+        while( m_stats.m_Bytes > m_maxBytes && m_entries.size() > 1 )
+        {
+            ENTRY& last = m_entries.back();
+
+            m_stats.m_Bytes -= last.m_Bytes;
+            m_stats.m_Evictions++;
+            m_index.erase( last.m_Key );
+            m_entries.pop_back();
+        }
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        m_index.clear();
+        m_entries.clear();
+        m_stats.m_Bytes = 0;
+    }
+
+    TEXT_CACHE_STATS GetStats() const
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        TEXT_CACHE_STATS stats = m_stats;
+        stats.m_Entries = m_entries.size();
+
+        return stats;
+    }
+
+private:
+    struct ENTRY
+    {
+        KEY                          m_Key;
+        std::shared_ptr<const VALUE> m_Value;
+        size_t                       m_Bytes;
+    };
+
+    mutable std::mutex                                                  m_mutex;
+    size_t                                                              m_maxBytes;
+    std::list<ENTRY>                                                    m_entries;
+    std::unordered_map<KEY, typename std::list<ENTRY>::iterator, HASH>  m_index;
+    TEXT_CACHE_STATS                                                    m_stats;
+};
+
+} // namespace KIFONT
+
+#endif // TEXT_CACHE_H_
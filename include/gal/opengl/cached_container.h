@@ -28,8 +28,10 @@
 #define CACHED_CONTAINER_H_
 
 #include <gal/opengl/vertex_container.h>
+#include <cstdint>
 #include <map>
 #include <set>
+#include <utility>
 
 namespace KIGFX
 {
@@ -96,14 +98,45 @@ public:
 
     virtual unsigned int AllItemsSize() const { return 0; }
 
+    /**
+     * Allocation and transfer statistics, to monitor the fragmentation of the container.
+     */
+    struct STATS
+    {
+        unsigned int m_size = 0;              ///< container size, in vertices
+        unsigned int m_used = 0;              ///< vertices used by the stored items
+        unsigned int m_freeChunks = 0;        ///< number of free chunks
+        unsigned int m_largestFreeChunk = 0;  ///< size of the largest free chunk, in vertices
+
+        /// Part of the free space not usable for a single allocation: 1 - largest free chunk /
+        /// free space
+        double       m_fragmentation = 0.0;
+
+        uint64_t     m_uploadedBytes = 0;     ///< bytes sent to the GPU by the last Unmap()
+        uint64_t     m_totalUploadedBytes = 0;
+        unsigned int m_reallocations = 0;     ///< items moved because they grew
+        unsigned int m_resizes = 0;           ///< full defragmentations, with or without resize
+        uint64_t     m_compactedVertices = 0; ///< vertices moved by the incremental compaction
+    };
+
+    /**
+     * Return the current allocation statistics, cumulated since the container creation.
+     */
+    STATS GetStats() const;
+
 protected:
-    ///< Maps size of free memory chunks to their offsets
+    ///< Size and offset of a free memory chunk
     typedef std::pair<unsigned int, unsigned int> CHUNK;
-    typedef std::multimap<unsigned int, unsigned int> FREE_CHUNK_MAP;
+
+    ///< Free memory chunks ordered by size, then offset
+    typedef std::set<CHUNK> FREE_CHUNK_MAP;
 
     /// List of all the stored items
     typedef std::set<VERTEX_ITEM*> ITEMS;
 
+    ///< Maximal number of vertices moved by compact() for a single update
+    static constexpr unsigned int COMPACTION_STEP = 32768;
+
     /**
      * Resize the chunk that stores the current item to the given size. The current item has
      * its offset adjusted after the call, and the new chunk parameters are stored
@@ -134,10 +167,27 @@ protected:
     void defragment( VERTEX* aTarget );
 
     /**
-     * Look for consecutive free memory chunks and merges them, decreasing fragmentation of
-     * memory.
+     * Reset the free chunks and the offsets of the items once the items have been packed at the
+     * beginning of the container by defragmentResize().
+     */
+    void resetFreeChunks();
+
+    /**
+     * Move the items stored at the end of the container to the free chunks before them.
+     *
+     * This is done in small steps before each upload, so a container fragmented by many edits
+     * is packed again over a few updates instead of being resized and reuploaded at once.
+     *
+     * @param aMaxVertices is the maximal number of vertices to move.
+     */
+    void compact( unsigned int aMaxVertices );
+
+    /**
+     * Record the upload of the dirty range of vertices and clear the dirty flag.
+     *
+     * @return the number of the first dirty vertex and the number of dirty vertices.
      */
-    void mergeFreeChunks();
+    std::pair<unsigned int, unsigned int> takeDirtyRange();
 
     /**
      * Return the size of a chunk.
@@ -160,16 +210,38 @@ protected:
     }
 
     /**
-     * Add a chunk marked as a free space.
+     * Add a chunk marked as a free space, merged with the free chunks around it.
      */
     void addFreeChunk( unsigned int aOffset, unsigned int aSize );
 
+    /**
+     * Remove a chunk from the free space.
+     */
+    void removeFreeChunk( unsigned int aOffset, unsigned int aSize );
+
+    /**
+     * Move the data of a stored item to a new offset.
+     */
+    void moveItem( VERTEX_ITEM* aItem, unsigned int aNewOffset );
+
     ///< Store size & offset of free chunks.
     FREE_CHUNK_MAP  m_freeChunks;
 
+    ///< Size of free chunks by offset, to merge neighbor chunks
+    std::map<unsigned int, unsigned int> m_freeChunksByOffset;
+
     ///< Stored VERTEX_ITEMs
     ITEMS m_items;
 
+    ///< Stored VERTEX_ITEMs by offset
+    std::map<unsigned int, VERTEX_ITEM*> m_itemsByOffset;
+
+    ///< Allocation statistics
+    STATS m_stats;
+
+    ///< True while the container is being compacted
+    bool m_compacting;
+
     ///< Currently modified item
     VERTEX_ITEM* m_item;
 
@@ -80,6 +80,9 @@ protected:
 
     ///< Handle to vertices buffer
     GLuint  m_verticesBuffer;
+
+    ///< Number of vertices the vertices buffer was allocated for
+    unsigned int m_bufferSize;
 };
 } // namespace KIGFX
 
@@ -34,6 +34,9 @@
 
 #include <gal/opengl/vertex_common.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace KIGFX
 {
 class VERTEX_ITEM;
@@ -144,6 +147,22 @@ public:
     void SetDirty()
     {
         m_dirty = true;
+        m_dirtyStart = 0;
+        m_dirtyEnd = std::numeric_limits<unsigned int>::max();
+    }
+
+    /**
+     * Set the dirty flag for a range of vertices, so only the modified vertices have to be
+     * reuploaded to the GPU on the next frame.
+     *
+     * @param aOffset is the first modified vertex.
+     * @param aSize is the number of modified vertices.
+     */
+    void SetDirty( unsigned int aOffset, unsigned int aSize )
+    {
+        m_dirty = true;
+        m_dirtyStart = std::min( m_dirtyStart, aOffset );
+        m_dirtyEnd = std::max( m_dirtyEnd, aOffset + aSize );
     }
 
     /**
@@ -152,6 +171,8 @@ public:
     void ClearDirty()
     {
         m_dirty = false;
+        m_dirtyStart = std::numeric_limits<unsigned int>::max();
+        m_dirtyEnd = 0;
     }
 
 protected:
@@ -183,6 +204,10 @@ protected:
     bool            m_failed;
     bool            m_dirty;
 
+    ///< Range of vertices modified since the last upload (end excluded)
+    unsigned int    m_dirtyStart;
+    unsigned int    m_dirtyEnd;
+
     ///< Default initial size of a container (expressed in vertices)
     static constexpr unsigned int DEFAULT_SIZE = 1048576;
 };
@@ -59,6 +59,12 @@ public:
      */
     VERTEX_MANAGER( bool aCached );
 
+    /**
+     * @param aContainer is the container to store the vertices in, the manager takes its
+     *                   ownership.
+     */
+    explicit VERTEX_MANAGER( VERTEX_CONTAINER* aContainer );
+
     /**
      * Map vertex buffer.
      */
@@ -96,6 +96,17 @@ public:
      */
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) = 0;
 
+    /**
+     * Create a painter drawing items like this one, but on another GAL.
+     *
+     * The copy is used to draw items on a worker thread, so it must not share any mutable
+     * state with this painter.
+     *
+     * @param aGal is the GAL the new painter draws on.
+     * @return the new painter, or nullptr if this painter cannot be copied.
+     */
+    virtual std::unique_ptr<PAINTER> Clone( GAL* aGal ) const { return nullptr; }
+
 protected:
     /// Instance of graphic abstraction layer that gives an interface to call
     /// commands used to draw (eg. DrawLine, DrawCircle, etc.)
@@ -0,0 +1,197 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef RECORDING_GAL_H
+#define RECORDING_GAL_H
+
+#include <functional>
+#include <vector>
+
+#include <gal/gal.h>
+#include <gal/graphics_abstraction_layer.h>
+
+namespace KIGFX
+{
+
+/**
+ * A list of drawing commands recorded by a #RECORDING_GAL, to be played back later on
+ * another GAL.
+ */
+class GAL_API GAL_DISPLAY_LIST
+{
+public:
+    /**
+     * Issue the recorded commands, including the attribute changes, on \a aGal.
+     */
+    void Replay( GAL& aGal ) const;
+
+    bool Empty() const { return m_commands.empty(); }
+
+    size_t Size() const { return m_commands.size(); }
+
+private:
+    friend class RECORDING_GAL;
+
+    std::vector<std::function<void( GAL& )>> m_commands;
+};
+
+
+/**
+ * A GAL storing the drawing commands instead of rendering them.
+ *
+ * Painters can draw into it from a worker thread: nothing here touches a rendering context.
+ * The view parameters (zoom, matrices, flipping, depth range) are copied from the target GAL
+ * at construction, so painters see the same values as when drawing on the target.  The
+ * commands keep copies of their arguments, except for bitmaps which are referenced and must
+ * outlive the playback.
+ *
+ * The constructor subscribes to the display options, so recorders have to be created and
+ * destroyed on the GUI thread.
+ */
+class GAL_API RECORDING_GAL : public GAL
+{
+public:
+    RECORDING_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, GAL& aTarget );
+
+    /**
+     * Start a new display list.
+     *
+     * @param aLayerDepth is the depth the commands are drawn at, as set by the view for the
+     *                    layer being drawn.
+     */
+    void BeginRecording( double aLayerDepth );
+
+    /**
+     * @return the commands issued since BeginRecording().
+     */
+    GAL_DISPLAY_LIST EndRecording();
+
+    bool IsCairoEngine() override { return m_isCairoEngine; }
+    bool IsOpenGlEngine() override { return m_isOpenGlEngine; }
+
+    /// @copydoc GAL::DrawLine()
+    void DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
+
+    /// @copydoc GAL::DrawSegment()
+    void DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                      double aWidth ) override;
+
+    /// @copydoc GAL::DrawSegmentChain()
+    void DrawSegmentChain( const std::vector<VECTOR2D>& aPointList, double aWidth ) override;
+    void DrawSegmentChain( const SHAPE_LINE_CHAIN& aLineChain, double aWidth ) override;
+
+    /// @copydoc GAL::DrawPolyline()
+    void DrawPolyline( const std::deque<VECTOR2D>& aPointList ) override;
+    void DrawPolyline( const std::vector<VECTOR2D>& aPointList ) override;
+    void DrawPolyline( const VECTOR2D aPointList[], int aListSize ) override;
+    void DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain ) override;
+
+    /// @copydoc GAL::DrawPolylines()
+    void DrawPolylines( const std::vector<std::vector<VECTOR2D>>& aPointLists ) override;
+
+    /// @copydoc GAL::DrawCircle()
+    void DrawCircle( const VECTOR2D& aCenterPoint, double aRadius ) override;
+
+    /// @copydoc GAL::DrawHoleWall()
+    void DrawHoleWall( const VECTOR2D& aCenterPoint, double aHoleRadius,
+                       double aWallWidth ) override;
+
+    /// @copydoc GAL::DrawArc()
+    void DrawArc( const VECTOR2D& aCenterPoint, double aRadius, const EDA_ANGLE& aStartAngle,
+                  const EDA_ANGLE& aAngle ) override;
+
+    /// @copydoc GAL::DrawArcSegment()
+    void DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadius,
+                         const EDA_ANGLE& aStartAngle, const EDA_ANGLE& aAngle,
+                         double aWidth, double aMaxError ) override;
+
+    /// @copydoc GAL::DrawRectangle()
+    void DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
+
+    /// @copydoc GAL::DrawGlyph()
+    void DrawGlyph( const KIFONT::GLYPH& aGlyph, int aNth, int aTotal ) override;
+
+    /// @copydoc GAL::DrawGlyphs()
+    void DrawGlyphs( const std::vector<std::unique_ptr<KIFONT::GLYPH>>& aGlyphs ) override;
+
+    /// @copydoc GAL::DrawPolygon()
+    void DrawPolygon( const std::deque<VECTOR2D>& aPointList ) override;
+    void DrawPolygon( const VECTOR2D aPointList[], int aListSize ) override;
+    void DrawPolygon( const SHAPE_POLY_SET& aPolySet, bool aStrokeTriangulation = false ) override;
+    void DrawPolygon( const SHAPE_LINE_CHAIN& aPolySet ) override;
+
+    /// @copydoc GAL::DrawCurve()
+    void DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
+                    const VECTOR2D& aControlPointB, const VECTOR2D& aEndPoint,
+                    double aFilterValue = 0.0 ) override;
+
+    /// @copydoc GAL::DrawBitmap()
+    void DrawBitmap( const BITMAP_BASE& aBitmap, double alphaBlend = 1.0 ) override;
+
+    /// @copydoc GAL::BitmapText()
+    void BitmapText( const wxString& aText, const VECTOR2I& aPosition,
+                     const EDA_ANGLE& aAngle ) override;
+
+    /// @copydoc GAL::Transform()
+    void Transform( const MATRIX3x3D& aTransformation ) override;
+
+    /// @copydoc GAL::Rotate()
+    void Rotate( double aAngle ) override;
+
+    /// @copydoc GAL::Translate()
+    void Translate( const VECTOR2D& aTranslation ) override;
+
+    /// @copydoc GAL::Scale()
+    void Scale( const VECTOR2D& aScale ) override;
+
+    /// @copydoc GAL::Save()
+    void Save() override;
+
+    /// @copydoc GAL::Restore()
+    void Restore() override;
+
+private:
+    /**
+     * Append a command to the current display list, preceded by the attribute changes made
+     * since the previous command.
+     */
+    void record( std::function<void( GAL& )>&& aCommand );
+
+    GAL_DISPLAY_LIST m_list;
+
+    bool             m_isCairoEngine;
+    bool             m_isOpenGlEngine;
+
+    /// Attributes as set by the commands recorded so far
+    bool             m_stateValid;
+    bool             m_recordedIsFill;
+    bool             m_recordedIsStroke;
+    COLOR4D          m_recordedFillColor;
+    COLOR4D          m_recordedStrokeColor;
+    float            m_recordedLineWidth;
+    float            m_recordedMinLineWidth;
+    double           m_recordedLayerDepth;
+};
+
+} // namespace KIGFX
+
+#endif // RECORDING_GAL_H
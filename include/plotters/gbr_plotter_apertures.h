@@ -26,6 +26,9 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 
 /* Class to handle a D_CODE when plotting a board using Standard Aperture Templates
  * (complex apertures need aperture macros to be flashed)
@@ -185,7 +188,11 @@ class APER_MACRO_FREEPOLY_LIST
 public:
     APER_MACRO_FREEPOLY_LIST() {}
 
-    void ClearList() { m_AMList.clear(); }
+    void ClearList()
+    {
+        m_AMList.clear();
+        m_lookup.clear();
+    }
 
     int AmCount() const { return (int)m_AMList.size(); }
 
@@ -210,4 +217,8 @@ public:
     void Format( FILE * aOutput, double aIu2GbrMacroUnit );
 
     std::vector<APER_MACRO_FREEPOLY> m_AMList;
+
+private:
+    // Index of m_AMList by polygon hash, see FindAm()
+    std::unordered_multimap<size_t, int> m_lookup;
 };
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "plotter.h"
 #include "gbr_plotter_apertures.h"
 
@@ -175,6 +177,16 @@ public:
 
     void PlotGerberRegion( const SHAPE_LINE_CHAIN& aPoly, GBR_METADATA* aGbrMetadata );
 
+    /**
+     * Plot the outlines of a set of polygons sharing the same attributes as a single Gerber
+     * region, with one contour per outline.
+     *
+     * The attributes and the G36/G37 commands are written only once, which makes much smaller
+     * files than one region per polygon for zones filled with many areas.  Holes are not
+     * plotted: the polygons must be fractured.
+     */
+    void PlotGerberRegion( const SHAPE_POLY_SET& aPolys, GBR_METADATA* aGbrMetadata );
+
     /**
      * Change the plot polarity and begin a new layer.
      *
@@ -364,7 +376,23 @@ protected:
      */
     void writeApertureList();
 
+    /**
+     * Write the moves and draws of a region contour, closing it if needed.  The caller writes
+     * the G36/G37 commands around it.
+     */
+    void writeRegionContour( const SHAPE_LINE_CHAIN& aPoly );
+
+    /// Size of the stdio buffers of the work and final files
+    static constexpr size_t FILE_BUFFER_SIZE = 1024 * 1024;
+
+    std::vector<char> m_workFileBuffer;
+    std::vector<char> m_finalFileBuffer;
+
     std::vector<APERTURE> m_apertures;  // The list of available apertures
+
+    // Index of m_apertures by hash of the aperture parameters, to avoid a linear search of
+    // the list for every flashed pad (boards can have thousands of different apertures)
+    std::unordered_multimap<size_t, int> m_apertureLookup;
     int     m_currentApertureIdx;       // The index of the current aperture in m_apertures
     bool    m_hasApertureRoundRect;     // true is at least one round rect aperture is in use
     bool    m_hasApertureRotOval;       // true is at least one oval rotated aperture is in use
@@ -819,19 +819,35 @@ protected:
     /// used by GAL).
     void clearGroupCache();
 
+    /// Drawing of an item on a cached layer, recorded by recordItems().
+    struct RECORDED_LAYER;
+
     /**
      * Manage dirty flags & redraw queuing when updating an item.
      *
      * @param aItem is the item to be updated.
      * @param aUpdateFlags determines the way an item is refreshed.
+     * @param aRecorded is the drawing of the item recorded by recordItems(), or nullptr to
+     *                  paint the item now.
+     */
+    void invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags,
+                         const std::vector<RECORDED_LAYER>* aRecorded = nullptr );
+
+    /**
+     * Record the drawing of items on the cached layers, using the thread pool.
+     *
+     * @param aItems are the items about to be invalidated.
+     * @return the recorded layers of each item of \a aItems, or an empty list if the items
+     *         have to be painted on the GUI thread.
      */
-    void invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags );
+    std::vector<std::vector<RECORDED_LAYER>> recordItems( const std::vector<VIEW_ITEM*>& aItems );
 
     /// Update colors that are used for an item to be drawn.
     void updateItemColor( VIEW_ITEM* aItem, int aLayer );
 
     /// Update all information needed to draw an item.
-    void updateItemGeometry( VIEW_ITEM* aItem, int aLayer );
+    void updateItemGeometry( VIEW_ITEM* aItem, int aLayer,
+                             const RECORDED_LAYER* aRecorded = nullptr );
 
     /// Update bounding box of an item.
     void updateBbox( VIEW_ITEM* aItem );
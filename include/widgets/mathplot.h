@@ -562,6 +562,13 @@ public:
     virtual size_t GetCount() const = 0;
     virtual int GetSweepCount() const { return 1; }
 
+    /** Called by mpFXY::Plot around the enumeration of a continuous locus, so that implementations
+     *  may skip the points outside [aStartPx, aEndPx] and return fewer points for the ones which
+     *  share a pixel column.  The default implementation enumerates every point.
+     */
+    virtual void BeginPlot( mpWindow& w, wxCoord aStartPx, wxCoord aEndPx ) {}
+    virtual void EndPlot() {}
+
     /** Layer plot handler.
      *  This implementation will plot the locus in the visible area and put a label according to
      *  the alignment specified.
@@ -1421,8 +1428,17 @@ public:
      */
     virtual void SetData( const std::vector<double>& xs, const std::vector<double>& ys );
 
-    void SetSweepCount( int aSweepCount ) { m_sweepCount = aSweepCount; }
-    void SetSweepSize( size_t aSweepSize ) { m_sweepSize = aSweepSize; }
+    void SetSweepCount( int aSweepCount )
+    {
+        m_sweepCount = aSweepCount;
+        m_pyramids.clear();
+    }
+
+    void SetSweepSize( size_t aSweepSize )
+    {
+        m_sweepSize = aSweepSize;
+        m_pyramids.clear();
+    }
 
     /** Clears all the data, leaving the layer empty.
      * @sa SetData
@@ -1459,6 +1475,13 @@ protected:
     size_t GetCount() const override { return m_xs.size(); }
     int GetSweepCount() const override { return m_sweepCount; }
 
+    /** Restrict the enumeration of each sweep to the visible points, and replace runs of points
+     *  falling within a pixel column by their minimum and maximum so that peaks stay visible.
+     *  The cost of a redraw then depends on the plot width rather than on the number of points.
+     */
+    void BeginPlot( mpWindow& w, wxCoord aStartPx, wxCoord aEndPx ) override;
+    void EndPlot() override;
+
 public:
     /** Returns the actual minimum X data (loaded in SetData).
      */
@@ -1476,6 +1499,46 @@ public:
      */
     double GetMaxY() const override { return m_maxY; }
 
+private:
+    /// Number of buckets of a pyramid level merged into a bucket of the next level
+    static constexpr size_t DECIMATION_FANOUT = 4;
+
+    /// Sweeps with fewer points are always enumerated point by point
+    static constexpr size_t MIN_DECIMATED_POINTS = 4096;
+
+    /** A bucket of consecutive points, summarised by the indices of its extrema.
+     */
+    struct DECIMATED_BUCKET
+    {
+        size_t m_minIdx;
+        size_t m_maxIdx;
+    };
+
+    /** Min/max pyramid of a sweep.  Level k holds buckets of DECIMATION_FANOUT^(k+1) points,
+     *  aligned on the first point of the sweep; trailing points which don't fill a bucket are
+     *  only present in the lower levels.
+     */
+    struct SWEEP_PYRAMID
+    {
+        size_t                                     m_start;
+        size_t                                     m_end;
+        bool                                       m_monotonic;    // X never decreases
+        std::vector<std::vector<DECIMATED_BUCKET>> m_levels;
+    };
+
+    void buildPyramids();
+
+    wxCoord xToPx( double x ) const;
+
+    std::vector<SWEEP_PYRAMID> m_pyramids;     // built on first plot, dropped when data changes
+
+    mpWindow*            m_plotWindow = nullptr;
+    wxCoord              m_plotStartPx = 0;
+    wxCoord              m_plotEndPx = 0;
+    const SWEEP_PYRAMID* m_plotPyramid = nullptr;   // sweep being plotted, if decimated
+    bool                 m_hasPendingPoint = false;
+    size_t               m_pendingIdx = 0;
+
 protected:
 
     DECLARE_DYNAMIC_CLASS( mpFXYVector )
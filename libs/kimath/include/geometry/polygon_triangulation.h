@@ -80,7 +80,7 @@ public:
     {};
 
     bool TesselatePolygon( const SHAPE_LINE_CHAIN& aPoly,
-                           SHAPE_POLY_SET::TRIANGULATED_POLYGON* aHintData )
+                           const SHAPE_POLY_SET::TRIANGULATED_POLYGON* aHintData )
     {
         m_bbox = aPoly.BBox();
         m_result.Clear();
@@ -0,0 +1,98 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <vector>
+
+#include <geometry/seg.h>
+
+/**
+ * A set of segments packed as a structure of arrays, for testing one segment against many.
+ *
+ * Queries first compute a lower bound of the distance to each segment from the bounding boxes,
+ * several segments at a time using SSE2 or AVX when available (with a scalar fallback).  Only the
+ * segments that pass this test are checked with the exact #SEG routines, so the results are
+ * identical to calling #SEG::SquaredDistance() or #SEG::Collide() on every segment in order.
+ */
+class SEG_BATCH
+{
+public:
+    SEG_BATCH() {}
+
+    explicit SEG_BATCH( const std::vector<SEG>& aSegs );
+
+    void Reserve( size_t aSize );
+
+    void Add( const SEG& aSeg );
+
+    void Clear();
+
+    size_t Size() const { return m_ax.size(); }
+
+    SEG Segment( size_t aIndex ) const
+    {
+        return SEG( m_ax[aIndex], m_ay[aIndex], m_bx[aIndex], m_by[aIndex] );
+    }
+
+    /**
+     * Compute the smallest #SEG::SquaredDistance() between aSeg and the segments of the batch.
+     *
+     * @param aIndex if not null, receives the index of the closest segment (the first one on
+     *               ties), or -1 if the batch is empty.
+     * @return the squared distance, or VECTOR2I::ECOORD_MAX if the batch is empty.
+     */
+    SEG::ecoord SquaredDistance( const SEG& aSeg, int* aIndex = nullptr ) const;
+
+    /**
+     * Find the segment of the batch closest to aSeg among those colliding with it, with the
+     * same semantics as calling aSeg.Collide( Segment( i ), aClearance, aActual ) on each
+     * segment in order.
+     *
+     * @param aActual if not null, receives the distance to the returned segment.
+     * @param aFirst if true, stop at the first colliding segment instead of the closest one.
+     * @return the index of the colliding segment, or -1 if there is no collision.
+     */
+    int Collide( const SEG& aSeg, int aClearance, int* aActual = nullptr,
+                 bool aFirst = false ) const;
+
+private:
+    /**
+     * Compute the bounding box distance lower bounds between aSeg and segments [aStart,
+     * aStart + aCount) into aLowerBounds.
+     */
+    void lowerBounds( const SEG& aSeg, size_t aStart, size_t aCount, double* aLowerBounds ) const;
+
+private:
+    std::vector<int> m_ax;
+    std::vector<int> m_ay;
+    std::vector<int> m_bx;
+    std::vector<int> m_by;
+    std::vector<int> m_minX;
+    std::vector<int> m_minY;
+    std::vector<int> m_maxX;
+    std::vector<int> m_maxY;
+};
+
+#endif // __SEG_BATCH_H
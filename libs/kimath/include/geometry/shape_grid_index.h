@@ -0,0 +1,458 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SHAPE_GRID_INDEX_H
+#define __SHAPE_GRID_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <geometry/shape_index.h>
+#include <geometry/shape_segment.h>
+#include <math/box2.h>
+
+/**
+ * A spatial hash of shapes: a uniform grid of square cells, of which only the occupied ones are
+ * stored.
+ *
+ * Offers the same Add/Remove/Query interface as #SHAPE_INDEX.  Inserting and removing an item
+ * only touches the cells its bounding box covers, so it is cheaper than an R-tree update when
+ * the index is modified frequently and the items are small compared to the cell size.  Items
+ * covering more than #MAX_CELLS_PER_ITEM cells (zones, board outlines...) are kept in a separate
+ * list that is checked linearly.
+ *
+ * Segments are stored in the cells along their path rather than in all the cells of their
+ * bounding box, so that long diagonal tracks stay in the grid.  Queries may then skip a segment
+ * whose bounding box overlaps the query area when the segment itself is farther away; callers
+ * are expected to test the actual shapes anyway.
+ *
+ * Each item is reported at most once per query, in the first of its cells (by column, then row)
+ * that lies in the query area.
+ */
+template <class T = SHAPE*>
+class SHAPE_GRID_INDEX
+{
+public:
+    /**
+     * @param aLayer is the layer passed to the shape functor to get the items' bounding boxes.
+     * @param aCellSize is the edge length of a grid cell.
+     */
+    SHAPE_GRID_INDEX( int aLayer, int aCellSize ) :
+            m_layer( aLayer ),
+            m_cellSize( std::max( aCellSize, 1 ) ),
+            m_count( 0 )
+    {
+    }
+
+    /**
+     * Add a shape to the index.
+     */
+    void Add( T aShape )
+    {
+        add( makeEntry( aShape ) );
+    }
+
+    /**
+     * Add a shape with alternate bounding box.
+     */
+    void Add( T aShape, const BOX2I& aBbox )
+    {
+        add( ENTRY{ aShape, aBbox } );
+    }
+
+    /**
+     * Remove a shape from the index.  The shape's bounding box must not have changed since it
+     * was added.
+     */
+    void Remove( T aShape )
+    {
+        remove( makeEntry( aShape ) );
+    }
+
+    /**
+     * Remove a shape added with an alternate bounding box.
+     */
+    void Remove( T aShape, const BOX2I& aBbox )
+    {
+        remove( ENTRY{ aShape, aBbox } );
+    }
+
+    /**
+     * Remove all the contents of the index.
+     */
+    void RemoveAll()
+    {
+        m_cells.clear();
+        m_oversized.clear();
+        m_count = 0;
+    }
+
+    /**
+     * Run a callback on every shape whose bounding box overlaps the bounding box of aShape
+     * inflated by aMinDistance.
+     *
+     * @param aShape is the shape to search against.
+     * @param aMinDistance is the distance threshold.
+     * @param aVisitor is invoked on every found object.  Return false to stop the search.
+     * @return the number of objects found.
+     */
+    template <class V>
+    int Query( const SHAPE* aShape, int aMinDistance, V& aVisitor ) const
+    {
+        BOX2I box = aShape->BBox();
+        box.Inflate( aMinDistance );
+
+        return Query( box, aVisitor );
+    }
+
+    /**
+     * Run a callback on every shape whose bounding box overlaps aBox.
+     */
+    template <class V>
+    int Query( const BOX2I& aBox, V& aVisitor ) const
+    {
+        int found = 0;
+
+        for( const ENTRY& entry : m_oversized )
+        {
+            if( overlaps( entry.m_bbox, aBox ) )
+            {
+                if( !aVisitor( entry.m_item ) )
+                    return found;
+
+                found++;
+            }
+        }
+
+        CELL_RANGE range = cellRange( aBox );
+
+        auto visitCell =
+                [&]( int64_t aCx, int64_t aCy, const CELL& aCell ) -> bool
+                {
+                    for( const ENTRY& entry : aCell )
+                    {
+                        if( !overlaps( entry.m_bbox, aBox ) )
+                            continue;
+
+                        // Items spanning several cells are reported only from their first
+                        // cell in the query area.
+                        if( !isFirstCell( entry, range, aCx, aCy ) )
+                            continue;
+
+                        if( !aVisitor( entry.m_item ) )
+                            return false;
+
+                        found++;
+                    }
+
+                    return true;
+                };
+
+        // Large query areas over a sparse grid are cheaper to answer by walking the occupied
+        // cells than by probing every cell of the area.
+        if( range.Count() > (int64_t) m_cells.size() )
+        {
+            for( const auto& [key, cell] : m_cells )
+            {
+                int64_t cx = keyX( key );
+                int64_t cy = keyY( key );
+
+                if( cx < range.m_x0 || cx > range.m_x1 || cy < range.m_y0 || cy > range.m_y1 )
+                    continue;
+
+                if( !visitCell( cx, cy, cell ) )
+                    break;
+            }
+        }
+        else
+        {
+            for( int64_t cx = range.m_x0; cx <= range.m_x1; cx++ )
+            {
+                for( int64_t cy = range.m_y0; cy <= range.m_y1; cy++ )
+                {
+                    auto it = m_cells.find( cellKey( cx, cy ) );
+
+                    if( it != m_cells.end() && !visitCell( cx, cy, it->second ) )
+                        return found;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    /**
+     * @return the number of shapes stored in the index.
+     */
+    size_t Size() const { return m_count; }
+
+    int GetCellSize() const { return m_cellSize; }
+
+    /// Items covering more cells than this are stored outside of the grid.
+    static constexpr int64_t MAX_CELLS_PER_ITEM = 64;
+
+    /// Segments covering more cells than this along their path are stored outside of the grid.
+    static constexpr int64_t MAX_CELLS_PER_SEGMENT = 4096;
+
+private:
+    struct ENTRY
+    {
+        T        m_item;
+        BOX2I    m_bbox;
+        VECTOR2I m_segA;
+        VECTOR2I m_segB;
+        int      m_segRadius = -1;  ///< Half width of a segment entry, -1 for other shapes
+
+        bool IsSegment() const { return m_segRadius >= 0; }
+    };
+
+    typedef std::vector<ENTRY> CELL;
+
+    struct CELL_RANGE
+    {
+        int64_t m_x0, m_y0, m_x1, m_y1;
+
+        int64_t Count() const { return ( m_x1 - m_x0 + 1 ) * ( m_y1 - m_y0 + 1 ); }
+    };
+
+    ENTRY makeEntry( T aShape ) const
+    {
+        const SHAPE* shape = shapeFunctor( aShape, m_layer );
+        ENTRY        entry{ aShape, boundingBox( aShape, m_layer ) };
+
+        if( shape->Type() == SH_SEGMENT )
+        {
+            const SHAPE_SEGMENT* segment = static_cast<const SHAPE_SEGMENT*>( shape );
+
+            entry.m_segA = segment->GetSeg().A;
+            entry.m_segB = segment->GetSeg().B;
+            entry.m_segRadius = ( segment->GetWidth() + 1 ) / 2;
+        }
+
+        return entry;
+    }
+
+    void add( const ENTRY& aEntry )
+    {
+        m_count++;
+
+        if( cellCount( aEntry ) > maxCells( aEntry ) )
+        {
+            m_oversized.push_back( aEntry );
+            return;
+        }
+
+        forEachCell( aEntry,
+                     [&]( int64_t aCx, int64_t aCy )
+                     {
+                         m_cells[cellKey( aCx, aCy )].push_back( aEntry );
+                     } );
+    }
+
+    void remove( const ENTRY& aEntry )
+    {
+        bool found = false;
+
+        if( cellCount( aEntry ) > maxCells( aEntry ) )
+        {
+            found = removeFromCell( m_oversized, aEntry.m_item );
+        }
+        else
+        {
+            forEachCell( aEntry,
+                         [&]( int64_t aCx, int64_t aCy )
+                         {
+                             auto it = m_cells.find( cellKey( aCx, aCy ) );
+
+                             if( it == m_cells.end()
+                                     || !removeFromCell( it->second, aEntry.m_item ) )
+                             {
+                                 return;
+                             }
+
+                             found = true;
+
+                             if( it->second.empty() )
+                                 m_cells.erase( it );
+                         } );
+        }
+
+        if( found )
+            m_count--;
+    }
+
+    static int64_t maxCells( const ENTRY& aEntry )
+    {
+        return aEntry.IsSegment() ? MAX_CELLS_PER_SEGMENT : MAX_CELLS_PER_ITEM;
+    }
+
+    /**
+     * @return the range of rows covered by a segment entry in column aCx, which must be within
+     *         the columns of the entry's bounding box.
+     */
+    std::pair<int64_t, int64_t> segmentRows( const ENTRY& aEntry, int64_t aCx ) const
+    {
+        const VECTOR2I& a = aEntry.m_segA;
+        const VECTOR2I& b = aEntry.m_segB;
+        int64_t         r = aEntry.m_segRadius;
+
+        // A point of the segment's outline in the column is within r of a point of its axis,
+        // whose x is therefore within r of the column.
+        int64_t x0 = std::max<int64_t>( aCx * m_cellSize - r, std::min( a.x, b.x ) );
+        int64_t x1 = std::min<int64_t>( ( aCx + 1 ) * m_cellSize - 1 + r, std::max( a.x, b.x ) );
+        int64_t y0 = std::min( a.y, b.y );
+        int64_t y1 = std::max( a.y, b.y );
+
+        if( a.x != b.x )
+        {
+            double slope = double( b.y - a.y ) / ( b.x - a.x );
+            double ya = a.y + slope * ( x0 - a.x );
+            double yb = a.y + slope * ( x1 - a.x );
+
+            // One unit of margin covers the rounding of the interpolation
+            y0 = std::max( y0, (int64_t) std::floor( std::min( ya, yb ) ) - 1 );
+            y1 = std::min( y1, (int64_t) std::ceil( std::max( ya, yb ) ) + 1 );
+        }
+
+        return { cellCoord( y0 - r ), cellCoord( y1 + r ) };
+    }
+
+    /**
+     * Call aFunc( cx, cy ) on every cell holding the entry.
+     */
+    template <class F>
+    void forEachCell( const ENTRY& aEntry, F&& aFunc ) const
+    {
+        CELL_RANGE range = cellRange( aEntry.m_bbox );
+
+        for( int64_t cx = range.m_x0; cx <= range.m_x1; cx++ )
+        {
+            int64_t cy0 = range.m_y0;
+            int64_t cy1 = range.m_y1;
+
+            if( aEntry.IsSegment() )
+                std::tie( cy0, cy1 ) = segmentRows( aEntry, cx );
+
+            for( int64_t cy = cy0; cy <= cy1; cy++ )
+                aFunc( cx, cy );
+        }
+    }
+
+    int64_t cellCount( const ENTRY& aEntry ) const
+    {
+        CELL_RANGE range = cellRange( aEntry.m_bbox );
+
+        if( !aEntry.IsSegment() )
+            return range.Count();
+
+        int64_t count = 0;
+
+        for( int64_t cx = range.m_x0; cx <= range.m_x1; cx++ )
+        {
+            auto [cy0, cy1] = segmentRows( aEntry, cx );
+            count += cy1 - cy0 + 1;
+        }
+
+        return count;
+    }
+
+    /**
+     * @return true if (aCx, aCy) is the first cell of the entry within the cells of aRange.
+     */
+    bool isFirstCell( const ENTRY& aEntry, const CELL_RANGE& aRange, int64_t aCx,
+                      int64_t aCy ) const
+    {
+        CELL_RANGE range = cellRange( aEntry.m_bbox );
+        int64_t    cx0 = std::max( range.m_x0, aRange.m_x0 );
+
+        if( !aEntry.IsSegment() )
+            return aCx == cx0 && aCy == std::max( range.m_y0, aRange.m_y0 );
+
+        for( int64_t cx = cx0; cx <= aCx; cx++ )
+        {
+            auto [cy0, cy1] = segmentRows( aEntry, cx );
+
+            if( cy1 >= aRange.m_y0 && cy0 <= aRange.m_y1 )
+                return cx == aCx && aCy == std::max( cy0, aRange.m_y0 );
+        }
+
+        return false;
+    }
+
+    static bool overlaps( const BOX2I& aA, const BOX2I& aB )
+    {
+        // Closed intervals, matching the R-tree overlap test
+        return aA.GetX() <= aB.GetRight() && aB.GetX() <= aA.GetRight()
+               && aA.GetY() <= aB.GetBottom() && aB.GetY() <= aA.GetBottom();
+    }
+
+    int64_t cellCoord( int64_t aCoord ) const
+    {
+        // Floor division, so that cells are contiguous across the origin
+        return aCoord >= 0 ? aCoord / m_cellSize : -( ( -aCoord + m_cellSize - 1 ) / m_cellSize );
+    }
+
+    CELL_RANGE cellRange( const BOX2I& aBox ) const
+    {
+        return { cellCoord( aBox.GetX() ), cellCoord( aBox.GetY() ),
+                 cellCoord( aBox.GetRight() ), cellCoord( aBox.GetBottom() ) };
+    }
+
+    static uint64_t cellKey( int64_t aCx, int64_t aCy )
+    {
+        return ( (uint64_t) (uint32_t) aCx << 32 ) | (uint32_t) aCy;
+    }
+
+    static int64_t keyX( uint64_t aKey ) { return (int32_t) ( aKey >> 32 ); }
+    static int64_t keyY( uint64_t aKey ) { return (int32_t) ( aKey & 0xFFFFFFFF ); }
+
+    static bool removeFromCell( CELL& aCell, T aShape )
+    {
+        auto it = std::find_if( aCell.begin(), aCell.end(),
+                                [&]( const ENTRY& aEntry )
+                                {
+                                    return aEntry.m_item == aShape;
+                                } );
+
+        if( it == aCell.end() )
+            return false;
+
+        *it = aCell.back();
+        aCell.pop_back();
+        return true;
+    }
+
+private:
+    int                                  m_layer;
+    int                                  m_cellSize;
+    size_t                               m_count;
+    std::unordered_map<uint64_t, CELL>   m_cells;
+    CELL                                 m_oversized;
+};
+
+#endif /* __SHAPE_GRID_INDEX_H */
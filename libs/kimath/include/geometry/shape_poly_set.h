@@ -1482,7 +1482,7 @@ public:
 
 protected:
     void cacheTriangulation( bool aPartition, bool aSimplify,
-                             std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>* aHintData );
+                             const std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>* aHintData );
 
 private:
     enum DROP_TRIANGULATION_FLAG { SINGLETON };
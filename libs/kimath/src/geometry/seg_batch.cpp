@@ -0,0 +1,255 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <geometry/seg_batch.h>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#define SEG_BATCH_USE_AVX
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define SEG_BATCH_USE_SSE2
+#endif
+
+
+/// Number of segments whose lower bounds are computed in one go
+static constexpr size_t BLOCK_SIZE = 64;
+
+
+/**
+ * @return true if a segment whose bounding box is aLowerBound (squared) away from the query may
+ * be closer than aThreshold (squared) according to the exact SEG routines.
+ *
+ * The exact routines round nearest points to integer coordinates and compute some distances in
+ * double precision, so they can report slightly less than the true distance.  The slack covers
+ * both, for coordinates anywhere in the 32-bit range.
+ */
+static inline bool mayBeWithin( double aLowerBound, double aThreshold )
+{
+    return aLowerBound <= aThreshold + 2.0 * std::sqrt( aThreshold ) + 16384.0;
+}
+
+
+SEG_BATCH::SEG_BATCH( const std::vector<SEG>& aSegs )
+{
+    Reserve( aSegs.size() );
+
+    for( const SEG& seg : aSegs )
+        Add( seg );
+}
+
+
+void SEG_BATCH::Reserve( size_t aSize )
+{
+    for( std::vector<int>* v : { &m_ax, &m_ay, &m_bx, &m_by, &m_minX, &m_minY, &m_maxX, &m_maxY } )
+        v->reserve( aSize );
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg )
+{
+    m_ax.push_back( aSeg.A.x );
+    m_ay.push_back( aSeg.A.y );
+    m_bx.push_back( aSeg.B.x );
+    m_by.push_back( aSeg.B.y );
+    m_minX.push_back( std::min( aSeg.A.x, aSeg.B.x ) );
+    m_minY.push_back( std::min( aSeg.A.y, aSeg.B.y ) );
+    m_maxX.push_back( std::max( aSeg.A.x, aSeg.B.x ) );
+    m_maxY.push_back( std::max( aSeg.A.y, aSeg.B.y ) );
+}
+
+
+void SEG_BATCH::Clear()
+{
+    for( std::vector<int>* v : { &m_ax, &m_ay, &m_bx, &m_by, &m_minX, &m_minY, &m_maxX, &m_maxY } )
+        v->clear();
+}
+
+
+void SEG_BATCH::lowerBounds( const SEG& aSeg, size_t aStart, size_t aCount,
+                             double* aLowerBounds ) const
+{
+    const double qMinX = std::min( aSeg.A.x, aSeg.B.x );
+    const double qMinY = std::min( aSeg.A.y, aSeg.B.y );
+    const double qMaxX = std::max( aSeg.A.x, aSeg.B.x );
+    const double qMaxY = std::max( aSeg.A.y, aSeg.B.y );
+
+    const int* minX = m_minX.data() + aStart;
+    const int* minY = m_minY.data() + aStart;
+    const int* maxX = m_maxX.data() + aStart;
+    const int* maxY = m_maxY.data() + aStart;
+
+    size_t ii = 0;
+
+#if defined( SEG_BATCH_USE_AVX )
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d vMinX = _mm256_set1_pd( qMinX );
+    const __m256d vMinY = _mm256_set1_pd( qMinY );
+    const __m256d vMaxX = _mm256_set1_pd( qMaxX );
+    const __m256d vMaxY = _mm256_set1_pd( qMaxY );
+
+    for( ; ii + 4 <= aCount; ii += 4 )
+    {
+        __m256d sMinX = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( minX + ii ) ) );
+        __m256d sMinY = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( minY + ii ) ) );
+        __m256d sMaxX = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( maxX + ii ) ) );
+        __m256d sMaxY = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( maxY + ii ) ) );
+
+        __m256d dx = _mm256_max_pd( zero, _mm256_max_pd( _mm256_sub_pd( vMinX, sMaxX ),
+                                                         _mm256_sub_pd( sMinX, vMaxX ) ) );
+        __m256d dy = _mm256_max_pd( zero, _mm256_max_pd( _mm256_sub_pd( vMinY, sMaxY ),
+                                                         _mm256_sub_pd( sMinY, vMaxY ) ) );
+
+        _mm256_storeu_pd( aLowerBounds + ii, _mm256_add_pd( _mm256_mul_pd( dx, dx ),
+                                                            _mm256_mul_pd( dy, dy ) ) );
+    }
+#elif defined( SEG_BATCH_USE_SSE2 )
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d vMinX = _mm_set1_pd( qMinX );
+    const __m128d vMinY = _mm_set1_pd( qMinY );
+    const __m128d vMaxX = _mm_set1_pd( qMaxX );
+    const __m128d vMaxY = _mm_set1_pd( qMaxY );
+
+    for( ; ii + 2 <= aCount; ii += 2 )
+    {
+        __m128d sMinX = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( minX + ii ) ) );
+        __m128d sMinY = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( minY + ii ) ) );
+        __m128d sMaxX = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( maxX + ii ) ) );
+        __m128d sMaxY = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( maxY + ii ) ) );
+
+        __m128d dx = _mm_max_pd( zero, _mm_max_pd( _mm_sub_pd( vMinX, sMaxX ),
+                                                   _mm_sub_pd( sMinX, vMaxX ) ) );
+        __m128d dy = _mm_max_pd( zero, _mm_max_pd( _mm_sub_pd( vMinY, sMaxY ),
+                                                   _mm_sub_pd( sMinY, vMaxY ) ) );
+
+        _mm_storeu_pd( aLowerBounds + ii, _mm_add_pd( _mm_mul_pd( dx, dx ),
+                                                      _mm_mul_pd( dy, dy ) ) );
+    }
+#endif
+
+    // Scalar fallback, and the tail of the vectorized loops
+    for( ; ii < aCount; ii++ )
+    {
+        double dx = std::max( 0.0, std::max( qMinX - maxX[ii], minX[ii] - qMaxX ) );
+        double dy = std::max( 0.0, std::max( qMinY - maxY[ii], minY[ii] - qMaxY ) );
+
+        aLowerBounds[ii] = dx * dx + dy * dy;
+    }
+}
+
+
+SEG::ecoord SEG_BATCH::SquaredDistance( const SEG& aSeg, int* aIndex ) const
+{
+    SEG::ecoord best = VECTOR2I::ECOORD_MAX;
+    int         bestIndex = -1;
+    double      lb[BLOCK_SIZE];
+
+    for( size_t start = 0; start < Size() && best > 0; start += BLOCK_SIZE )
+    {
+        size_t count = std::min( BLOCK_SIZE, Size() - start );
+
+        lowerBounds( aSeg, start, count, lb );
+
+        for( size_t ii = 0; ii < count; ii++ )
+        {
+            if( bestIndex >= 0 && !mayBeWithin( lb[ii], (double) best ) )
+                continue;
+
+            SEG::ecoord d = Segment( start + ii ).SquaredDistance( aSeg );
+
+            if( d < best )
+            {
+                best = d;
+                bestIndex = (int) ( start + ii );
+
+                if( best == 0 )
+                    break;
+            }
+        }
+    }
+
+    if( aIndex )
+        *aIndex = bestIndex;
+
+    return best;
+}
+
+
+int SEG_BATCH::Collide( const SEG& aSeg, int aClearance, int* aActual, bool aFirst ) const
+{
+    if( aClearance < 0 )
+        return -1;
+
+    const double clearanceSq = (double) aClearance * aClearance;
+    int          closest = std::numeric_limits<int>::max();
+    int          closestIndex = -1;
+    double       lb[BLOCK_SIZE];
+
+    for( size_t start = 0; start < Size(); start += BLOCK_SIZE )
+    {
+        size_t count = std::min( BLOCK_SIZE, Size() - start );
+
+        lowerBounds( aSeg, start, count, lb );
+
+        for( size_t ii = 0; ii < count; ii++ )
+        {
+            // A farther segment can neither collide nor be closer than the current best
+            double threshold = std::min( clearanceSq, (double) closest * closest );
+
+            if( !mayBeWithin( lb[ii], threshold ) )
+                continue;
+
+            int dist = 0;
+
+            // The distance is needed to find the closest segment even if the caller ignores it
+            if( !aSeg.Collide( Segment( start + ii ), aClearance,
+                               aActual || !aFirst ? &dist : nullptr ) )
+            {
+                continue;
+            }
+
+            if( closestIndex < 0 || dist < closest )
+            {
+                closest = dist;
+                closestIndex = (int) ( start + ii );
+            }
+
+            if( closest == 0 || aFirst )
+            {
+                if( aActual )
+                    *aActual = closest;
+
+                return closestIndex;
+            }
+        }
+    }
+
+    if( aActual && closestIndex >= 0 )
+        *aActual = closest;
+
+    return closestIndex;
+}
@@ -27,6 +27,7 @@
 #include <limits>
 
 #include <geometry/seg.h>                         // for SEG
+#include <geometry/seg_batch.h>
 #include <geometry/shape.h>
 #include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
@@ -287,6 +288,11 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 }
 
 
+/// Below this many segments in the other chain, setting up a #SEG_BATCH costs more than the
+/// segment pairs it would skip.
+static constexpr size_t SEG_BATCH_MIN_SEGMENTS = 8;
+
+
 static inline bool Collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CHAIN_BASE& aB,
                             int aClearance, int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
 {
@@ -338,27 +344,59 @@ static inline bool Collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CH
         std::sort( a_segs.begin(), a_segs.end(), seg_sort );
         std::sort( b_segs.begin(), b_segs.end(), seg_sort );
 
-        for( const SEG& a_seg : a_segs )
+        if( b_segs.size() < SEG_BATCH_MIN_SEGMENTS )
         {
-            for( const SEG& b_seg : b_segs )
+            for( const SEG& a_seg : a_segs )
             {
-                int dist = 0;
-
-                if( a_seg.Collide( b_seg, aClearance, aActual || aLocation ? &dist : nullptr ) )
+                for( const SEG& b_seg : b_segs )
                 {
-                    if( dist < closest_dist )
+                    int dist = 0;
+
+                    if( a_seg.Collide( b_seg, aClearance, aActual || aLocation ? &dist : nullptr ) )
                     {
-                        nearest = a_seg.NearestPoint( b_seg );
-                        closest_dist = dist;
+                        if( dist < closest_dist )
+                        {
+                            nearest = a_seg.NearestPoint( b_seg );
+                            closest_dist = dist;
+                        }
+
+                        // If we're not looking for aActual then any collision will do
+                        if( !aActual || closest_dist == 0 )
+                            break;
                     }
+                }
 
-                    if( closest_dist == 0 )
-                        break;
+                if( closest_dist == 0 )
+                    break;
+            }
+        }
+        else
+        {
+            // Reuse the batch storage, as most queries come from the router's hot paths
+            thread_local SEG_BATCH b_batch;
 
-                    // If we're not looking for aActual then any collision will do
-                    if( !aActual )
-                        break;
+            b_batch.Clear();
+            b_batch.Reserve( b_segs.size() );
+
+            for( const SEG& b_seg : b_segs )
+                b_batch.Add( b_seg );
+
+            for( const SEG& a_seg : a_segs )
+            {
+                int dist = 0;
+
+                // If we're not looking for aActual then any collision will do
+                int b_idx = b_batch.Collide( a_seg, aClearance,
+                                             aActual || aLocation ? &dist : nullptr, !aActual );
+
+                if( b_idx >= 0 && dist < closest_dist )
+                {
+                    nearest = a_seg.NearestPoint( b_batch.Segment( b_idx ) );
+                    closest_dist = dist;
                 }
+
+                if( closest_dist == 0 )
+                    break;
             }
         }
     }
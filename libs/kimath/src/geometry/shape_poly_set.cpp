@@ -2997,8 +2997,9 @@ static SHAPE_POLY_SET partitionPolyIntoRegularCellGrid( const SHAPE_POLY_SET& aP
 }
 
 
-void SHAPE_POLY_SET::cacheTriangulation( bool aPartition, bool aSimplify,
-                                         std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>* aHintData )
+void SHAPE_POLY_SET::cacheTriangulation(
+        bool aPartition, bool aSimplify,
+        const std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>* aHintData )
 {
     std::unique_lock<std::mutex> lock( m_triangulationMutex );
 
@@ -3015,7 +3016,7 @@ void SHAPE_POLY_SET::cacheTriangulation( bool aPartition, bool aSimplify,
     auto triangulate =
             []( SHAPE_POLY_SET& polySet, int forOutline,
                 std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>& dest,
-                std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>* hintData )
+                const std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>* hintData )
             {
                 bool triangulationValid = false;
                 int pass = 0;
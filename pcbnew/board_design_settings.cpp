@@ -205,6 +205,7 @@ BOARD_DESIGN_SETTINGS::BOARD_DESIGN_SETTINGS( JSON_SETTINGS* aParent, const std:
     m_MaxError = ARC_HIGH_DEF;
     m_ZoneKeepExternalFillets = false;
     m_UseHeightForLengthCalcs = true;
+    m_RouterGridIndex = false;
 
     // Global mask margins:
     m_SolderMaskExpansion = pcbIUScale.mmToIU( DEFAULT_SOLDERMASK_EXPANSION );
@@ -256,6 +257,9 @@ BOARD_DESIGN_SETTINGS::BOARD_DESIGN_SETTINGS( JSON_SETTINGS* aParent, const std:
     m_params.emplace_back( new PARAM<bool>( "rules.use_height_for_length_calcs",
             &m_UseHeightForLengthCalcs, true ) );
 
+    m_params.emplace_back( new PARAM<bool>( "rules.router_grid_index",
+            &m_RouterGridIndex, false ) );
+
     m_params.emplace_back( new PARAM_SCALED<int>( "rules.min_clearance",
             &m_MinClearance, pcbIUScale.mmToIU( DEFAULT_MINCLEARANCE ),
             pcbIUScale.mmToIU( 0.00 ), pcbIUScale.mmToIU( 25.0 ), pcbIUScale.MM_PER_IU ) );
@@ -1037,6 +1041,7 @@ void BOARD_DESIGN_SETTINGS::initFromOther( const BOARD_DESIGN_SETTINGS& aOther )
     m_gridOrigin               = aOther.m_gridOrigin;
     m_HasStackup               = aOther.m_HasStackup;
     m_UseHeightForLengthCalcs  = aOther.m_UseHeightForLengthCalcs;
+    m_RouterGridIndex          = aOther.m_RouterGridIndex;
 
     m_trackWidthIndex     = aOther.m_trackWidthIndex;
     m_viaSizeIndex        = aOther.m_viaSizeIndex;
@@ -1140,6 +1145,7 @@ bool BOARD_DESIGN_SETTINGS::operator==( const BOARD_DESIGN_SETTINGS& aOther ) co
     if( m_gridOrigin               != aOther.m_gridOrigin ) return false;
     if( m_HasStackup               != aOther.m_HasStackup ) return false;
     if( m_UseHeightForLengthCalcs  != aOther.m_UseHeightForLengthCalcs ) return false;
+    if( m_RouterGridIndex          != aOther.m_RouterGridIndex ) return false;
     if( m_trackWidthIndex          != aOther.m_trackWidthIndex ) return false;
     if( m_viaSizeIndex             != aOther.m_viaSizeIndex ) return false;
     if( m_diffPairIndex            != aOther.m_diffPairIndex ) return false;
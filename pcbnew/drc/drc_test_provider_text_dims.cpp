@@ -140,7 +140,7 @@ bool DRC_TEST_PROVIDER_TEXT_DIMS::Run()
                     if( !constraint.Value().HasMin() || constraint.Value().Min() <= 0 )
                         return true;
 
-                    auto* glyphs = text->GetRenderCache( font, text->GetShownText( true ) );
+                    auto  glyphs = text->GetRenderCache( font, text->GetShownText( true ) );
                     bool  collapsedStroke = false;
                     bool  collapsedArea = false;
 
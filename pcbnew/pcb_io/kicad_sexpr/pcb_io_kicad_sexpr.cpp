@@ -501,8 +501,8 @@ void PCB_IO_KICAD_SEXPR::formatPolyPts( const SHAPE_LINE_CHAIN& outline,
 void PCB_IO_KICAD_SEXPR::formatRenderCache( const EDA_TEXT* aText ) const
 {
     wxString resolvedText( aText->GetShownText( true ) );
-    std::vector<std::unique_ptr<KIFONT::GLYPH>>* cache = aText->GetRenderCache( aText->GetFont(),
-                                                                                resolvedText );
+    std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>> cache =
+            aText->GetRenderCache( aText->GetFont(), resolvedText );
 
     m_out->Print( "(render_cache %s %s",
                   m_out->Quotew( resolvedText ).c_str(),
@@ -74,6 +74,8 @@
 #include <gr_text.h>
 #include <pgm_base.h>
 
+#include <typeinfo>
+
 using namespace KIGFX;
 
 
@@ -621,6 +623,19 @@ int PCB_PAINTER::getViaDrillSize( const PCB_VIA* aVia ) const
 }
 
 
+std::unique_ptr<PAINTER> PCB_PAINTER::Clone( GAL* aGal ) const
+{
+    // Derived painters (printing, previews) have their own state: leave them on the GUI thread
+    if( typeid( *this ) != typeid( PCB_PAINTER ) )
+        return nullptr;
+
+    std::unique_ptr<PCB_PAINTER> painter = std::make_unique<PCB_PAINTER>( aGal, m_frameType );
+    painter->m_pcbSettings = m_pcbSettings;
+
+    return painter;
+}
+
+
 bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 {
     if( !aItem->IsBOARD_ITEM() )
@@ -2418,7 +2433,7 @@ void PCB_PAINTER::draw( const PCB_TEXT* aText, int aLayer )
             return;
         }
 
-        std::vector<std::unique_ptr<KIFONT::GLYPH>>* cache = nullptr;
+        std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>> cache;
 
         if( font->IsOutline() )
             cache = aText->GetRenderCache( font, resolvedText );
@@ -2565,7 +2580,7 @@ void PCB_PAINTER::draw( const PCB_TEXTBOX* aTextBox, int aLayer )
             return;
         }
 
-        std::vector<std::unique_ptr<KIFONT::GLYPH>>* cache = nullptr;
+        std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>> cache;
 
         if( font->IsOutline() )
             cache = aTextBox->GetRenderCache( font, resolvedText );
@@ -2948,7 +2963,7 @@ void PCB_PAINTER::draw( const PCB_DIMENSION_BASE* aDimension, int aLayer )
     else
         attrs.m_StrokeWidth = getLineThickness( aDimension->GetEffectiveTextPenWidth() );
 
-    std::vector<std::unique_ptr<KIFONT::GLYPH>>* cache = nullptr;
+    std::shared_ptr<const std::vector<std::unique_ptr<KIFONT::GLYPH>>> cache;
 
     if( aDimension->GetFont() && aDimension->GetFont()->IsOutline() )
         cache = aDimension->GetRenderCache( aDimension->GetFont(), resolvedText );
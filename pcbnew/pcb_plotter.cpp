@@ -38,6 +38,9 @@
 #include <pgm_base.h>
 #include <pcbnew_settings.h>
 #include <math/util.h> // for KiROUND
+#include <thread_pool.h>
+
+#include <future>
 
 
 static int scaleToSelection( double scale )
@@ -56,7 +59,8 @@ static int scaleToSelection( double scale )
 PCB_PLOTTER::PCB_PLOTTER( BOARD* aBoard, REPORTER* aReporter, PCB_PLOT_PARAMS& aParams ) :
         m_board( aBoard ),
         m_plotOpts( aParams ),
-        m_reporter( aReporter )
+        m_reporter( aReporter ),
+        m_concurrentPlot( true )
 {
 }
 
@@ -136,6 +140,19 @@ bool PCB_PLOTTER::Plot( const wxString& aOutputPath, const LSEQ& aLayersToPlot,
     PLOTTER* plotter = nullptr;
     int      pageNum = 1;
 
+    // When every layer goes to its own file, each one has its own plotter and the layers can be
+    // plotted concurrently.  The plotters are still started here, in order, as they share the
+    // drawing sheet and the job file.
+    bool concurrent = m_concurrentPlot
+                      && !aOutputPathIsSingle
+                      && !( m_plotOpts.GetFormat() == PLOT_FORMAT::PDF && m_plotOpts.m_PDFSingle )
+                      && finalPageCount > 1;
+
+    std::vector<std::pair<wxString, std::future<bool>>> pending;
+
+    if( concurrent )
+        PrepareBoardForConcurrentPlot( m_board );
+
     for( size_t i = 0; i < layersToPlot.size(); i++ )
     {
         PCB_LAYER_ID layer = layersToPlot[i];
@@ -216,6 +233,36 @@ bool PCB_PLOTTER::Plot( const wxString& aOutputPath, const LSEQ& aLayersToPlot,
                     plotter->SetSubject( msg );
             }
 
+            if( concurrent )
+            {
+                auto plotLayer =
+                        [this, plotter, plotSequence]() -> bool
+                        {
+                            bool ok = true;
+
+                            try
+                            {
+                                PlotBoardLayers( m_board, plotter, plotSequence, m_plotOpts );
+                                PlotInteractiveLayer( m_board, plotter, m_plotOpts );
+                                plotter->EndPlot();
+                            }
+                            catch( ... )
+                            {
+                                ok = false;
+                            }
+
+                            delete plotter->RenderSettings();
+                            delete plotter;
+                            return ok;
+                        };
+
+                pending.emplace_back( fn.GetFullPath(),
+                                      GetKiCadThreadPool().submit_task( plotLayer ) );
+                plotter = nullptr;
+                pageNum++;
+                continue;
+            }
+
             try
             {
                 PlotBoardLayers( m_board, plotter, plotSequence, m_plotOpts );
@@ -288,6 +335,26 @@ bool PCB_PLOTTER::Plot( const wxString& aOutputPath, const LSEQ& aLayersToPlot,
         wxSafeYield(); // displays report message.
     }
 
+    // Report the concurrently plotted files in plot order.  Don't yield until they are all done:
+    // the UI must not run while the board is being read by the plotting threads.
+    for( auto& [fileName, result] : pending )
+    {
+        if( result.get() )
+        {
+            msg.Printf( _( "Plotted to '%s'." ), fileName );
+            m_reporter->Report( msg, RPT_SEVERITY_ACTION );
+        }
+        else
+        {
+            msg.Printf( _( "Failed to plot to '%s'." ), fileName );
+            m_reporter->Report( msg, RPT_SEVERITY_ERROR );
+            success = false;
+        }
+    }
+
+    if( !pending.empty() )
+        wxSafeYield(); // displays report messages.
+
     if( jobfile_writer && m_plotOpts.GetCreateGerberJobFile() )
     {
         // Pick the basename from the board file
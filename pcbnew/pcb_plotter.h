@@ -42,6 +42,12 @@ public:
                 std::optional<wxString> aSheetName = std::nullopt,
                 std::optional<wxString> aSheetPath = std::nullopt );
 
+    /**
+     * Allow the layers of multi-file outputs to be plotted concurrently, which is the default.
+     * When disabled, they are plotted one after the other on the calling thread.
+     */
+    void SetConcurrentPlot( bool aConcurrent ) { m_concurrentPlot = aConcurrent; }
+
     /**
      * All copper layers that are disabled are actually selected
      * This is due to wonkyness in automatically selecting copper layers
@@ -77,6 +83,7 @@ protected:
     BOARD*          m_board;
     PCB_PLOT_PARAMS m_plotOpts;
     REPORTER*       m_reporter;
+    bool            m_concurrentPlot;
 
 private:
     /**
@@ -596,7 +596,7 @@ void PCB_TEXT::TransformTextToPolySet( SHAPE_POLY_SET& aBuffer, int aClearance,
                     textShape.Append( point.x, point.y );
             } );
 
-    if( auto* cache = GetRenderCache( font, shownText ) )
+    if( auto cache = GetRenderCache( font, shownText ) )
         callback_gal.DrawGlyphs( *cache );
     else
         font->Draw( &callback_gal, shownText, GetTextPos(), attrs, GetFontMetrics() );
@@ -664,7 +664,7 @@ void PCB_TEXTBOX::TransformTextToPolySet( SHAPE_POLY_SET& aBuffer, int aClearanc
                     textShape.Append( point.x, point.y );
             } );
 
-    if( auto* cache = GetRenderCache( font, shownText ) )
+    if( auto cache = GetRenderCache( font, shownText ) )
         callback_gal.DrawGlyphs( *cache );
     else
         font->Draw( &callback_gal, shownText, GetDrawPos(), attrs, GetFontMetrics() );
@@ -95,6 +95,7 @@
 #include <dialogs/dialog_gencad_export_options.h>
 #include <paths.h>
 #include <tools/zone_filler_tool.h>
+#include <thread_pool.h>
 
 #include "pcbnew_scripting_helpers.h"
 #include <locale_io.h>
@@ -1316,6 +1317,11 @@ int PCBNEW_JOBS_HANDLER::JobExportGerbers( JOB* aJob )
     // Ensure layers to plot are restricted to enabled layers of the board to plot
     LSET layersToPlot = LSET( { aGerberJob->m_plotLayerSequence } ) & brd->GetEnabledLayers();
 
+    // Each layer has its own file and plotter, so they are plotted concurrently once started
+    std::vector<std::pair<wxString, std::future<bool>>> pending;
+
+    PrepareBoardForConcurrentPlot( brd );
+
     for( PCB_LAYER_ID layer : layersToPlot.UIOrder() )
     {
         LSEQ plotSequence;
@@ -1356,7 +1362,11 @@ int PCBNEW_JOBS_HANDLER::JobExportGerbers( JOB* aJob )
         if( m_progressReporter )
         {
             m_progressReporter->AdvancePhase( wxString::Format( _( "Exporting %s" ), fullname ) );
-            m_progressReporter->KeepRefreshing();
+
+            // Don't yield to the event loop once layers are being plotted: the UI must not run
+            // while the board is being read by the plotting threads.
+            if( pending.empty() )
+                m_progressReporter->KeepRefreshing();
         }
 
         jobfile_writer.AddGbrFile( layer, fullname );
@@ -1377,11 +1387,26 @@ int PCBNEW_JOBS_HANDLER::JobExportGerbers( JOB* aJob )
 
         if( plotter )
         {
-            m_reporter->Report( wxString::Format( _( "Plotted to '%s'.\n" ), fn.GetFullPath() ),
-                                RPT_SEVERITY_ACTION );
-
-            PlotBoardLayers( brd, plotter, plotSequence, plotOpts );
-            plotter->EndPlot();
+            auto plotLayer =
+                    [brd, plotter, plotSequence, plotOpts]() -> bool
+                    {
+                        bool ok = true;
+
+                        try
+                        {
+                            PlotBoardLayers( brd, plotter, plotSequence, plotOpts );
+                            plotter->EndPlot();
+                        }
+                        catch( ... )
+                        {
+                            ok = false;
+                        }
+
+                        delete plotter;
+                        return ok;
+                    };
+
+            pending.emplace_back( fn.GetFullPath(), GetKiCadThreadPool().submit_task( plotLayer ) );
         }
         else
         {
@@ -1389,8 +1414,21 @@ int PCBNEW_JOBS_HANDLER::JobExportGerbers( JOB* aJob )
                                 RPT_SEVERITY_ERROR );
             exitCode = CLI::EXIT_CODES::ERR_INVALID_OUTPUT_CONFLICT;
         }
+    }
 
-        delete plotter;
+    for( auto& [fileName, result] : pending )
+    {
+        if( result.get() )
+        {
+            m_reporter->Report( wxString::Format( _( "Plotted to '%s'.\n" ), fileName ),
+                                RPT_SEVERITY_ACTION );
+        }
+        else
+        {
+            m_reporter->Report( wxString::Format( _( "Failed to plot to '%s'.\n" ), fileName ),
+                                RPT_SEVERITY_ERROR );
+            exitCode = CLI::EXIT_CODES::ERR_UNKNOWN;
+        }
     }
 
     if( aGerberJob->m_createJobsFile )
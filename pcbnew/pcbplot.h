@@ -177,6 +177,12 @@ void setupPlotterNewPDFPage( PLOTTER* aPlotter, BOARD* aBoard, PCB_PLOT_PARAMS*
 void PlotBoardLayers( BOARD* aBoard, PLOTTER* aPlotter, const LSEQ& aLayerSequence,
                       const PCB_PLOT_PARAMS& aPlotOptions );
 
+/**
+ * Fill the caches of board items which are otherwise filled lazily while plotting, so that
+ * PlotBoardLayers() can then be called for several plotters at the same time.
+ */
+void PrepareBoardForConcurrentPlot( BOARD* aBoard );
+
 /**
  * Plot interactive items (hypertext links, properties, etc.).
  */
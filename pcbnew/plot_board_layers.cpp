@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <optional>
+
 #include <wx/log.h>
 #include <eda_item.h>
 #include <layer_ids.h>
@@ -147,6 +149,17 @@ void PlotBoardLayers( BOARD* aBoard, PLOTTER* aPlotter, const LSEQ& aLayers,
 }
 
 
+void PrepareBoardForConcurrentPlot( BOARD* aBoard )
+{
+    for( const FOOTPRINT* fp : aBoard->Footprints() )
+    {
+        fp->GetBoundingBox( true );
+        fp->GetBoundingBox( false );
+        fp->GetBoundingHull();
+    }
+}
+
+
 void PlotInteractiveLayer( BOARD* aBoard, PLOTTER* aPlotter, const PCB_PLOT_PARAMS& aPlotOpt )
 {
     for( const FOOTPRINT* fp : aBoard->Footprints() )
@@ -432,13 +445,24 @@ void PlotStandardLayer( BOARD* aBoard, PLOTTER* aPlotter, const LSET& aLayerMask
                     // Now offset the pad size by margin + width_adj
                     VECTOR2I padPlotsSize = pad->GetSize( aLayer ) + margin * 2 + VECTOR2I( width_adj, width_adj );
 
-                    // Store these parameters that can be modified to plot inflated/deflated pads shape
                     PAD_SHAPE padShape = pad->GetShape( aLayer );
                     VECTOR2I  padSize = pad->GetSize( aLayer );
                     VECTOR2I  padDelta = pad->GetDelta( aLayer ); // has meaning only for trapezoidal pads
-                    // CornerRadius and CornerRadiusRatio can be modified
-                    // the radius is built from the ratio, so saving/restoring the ratio is enough
-                    double    padCornerRadiusRatio = pad->GetRoundRectRadiusRatio( aLayer );
+
+                    // Inflated/deflated shapes are plotted from a copy of the pad: the board is
+                    // shared by the threads plotting the other layers, so it must not be modified.
+                    std::optional<PAD> resized;
+
+                    auto resizedPad =
+                            [&]() -> PAD*
+                            {
+                                if( padPlotsSize == padSize )
+                                    return pad;
+
+                                resized.emplace( *pad );
+                                resized->SetSize( aLayer, padPlotsSize );
+                                return &resized.value();
+                            };
 
                     // Don't draw a 0 sized pad.
                     // Note: a custom pad can have its pad anchor with size = 0
@@ -452,29 +476,31 @@ void PlotStandardLayer( BOARD* aBoard, PLOTTER* aPlotter, const LSET& aLayerMask
                     {
                     case PAD_SHAPE::CIRCLE:
                     case PAD_SHAPE::OVAL:
-                        pad->SetSize( aLayer, padPlotsSize );
-
                         if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
                             ( aPlotOpt.GetDrillMarksType() == DRILL_MARKS::NO_DRILL_SHAPE ) &&
-                            ( pad->GetSize(aLayer ) == pad->GetDrillSize() ) &&
+                            ( padPlotsSize == pad->GetDrillSize() ) &&
                             ( pad->GetAttribute() == PAD_ATTRIB::NPTH ) )
                         {
                             break;
                         }
 
-                        itemplotter.PlotPad( pad, aLayer, color, doSketchPads );
+                        itemplotter.PlotPad( resizedPad(), aLayer, color, doSketchPads );
                         break;
 
                     case PAD_SHAPE::RECTANGLE:
-                        pad->SetSize( aLayer, padPlotsSize );
-
                         if( mask_clearance > 0 )
                         {
-                            pad->SetShape( aLayer, PAD_SHAPE::ROUNDRECT );
-                            pad->SetRoundRectCornerRadius( aLayer, mask_clearance );
+                            resized.emplace( *pad );
+                            resized->SetSize( aLayer, padPlotsSize );
+                            resized->SetShape( aLayer, PAD_SHAPE::ROUNDRECT );
+                            resized->SetRoundRectCornerRadius( aLayer, mask_clearance );
+                            itemplotter.PlotPad( &resized.value(), aLayer, color, doSketchPads );
+                        }
+                        else
+                        {
+                            itemplotter.PlotPad( resizedPad(), aLayer, color, doSketchPads );
                         }
 
-                        itemplotter.PlotPad( pad, aLayer, color, doSketchPads );
                         break;
 
                     case PAD_SHAPE::TRAPEZOID:
@@ -525,12 +551,17 @@ void PlotStandardLayer( BOARD* aBoard, PLOTTER* aPlotter, const LSET& aLayerMask
                     {
                         // rounding is stored as a percent, but we have to update this ratio
                         // to force recalculation of other values after size changing (we do not
-                        // really change the rounding percent value)
-                        double radius_ratio = pad->GetRoundRectRadiusRatio( aLayer );
-                        pad->SetSize( aLayer, padPlotsSize );
-                        pad->SetRoundRectRadiusRatio( aLayer, radius_ratio );
+                        // really change the rounding percent value).  The board's own pad is not
+                        // resized and is plotted as is: other threads may be reading it.
+                        PAD* plotPad = resizedPad();
 
-                        itemplotter.PlotPad( pad, aLayer, color, doSketchPads );
+                        if( plotPad != pad )
+                        {
+                            plotPad->SetRoundRectRadiusRatio( aLayer,
+                                                              pad->GetRoundRectRadiusRatio( aLayer ) );
+                        }
+
+                        itemplotter.PlotPad( plotPad, aLayer, color, doSketchPads );
                         break;
                     }
 
@@ -538,8 +569,7 @@ void PlotStandardLayer( BOARD* aBoard, PLOTTER* aPlotter, const LSET& aLayerMask
                         if( mask_clearance == 0 )
                         {
                             // the size can be slightly inflated by width_adj (PS/PDF only)
-                            pad->SetSize( aLayer, padPlotsSize );
-                            itemplotter.PlotPad( pad, aLayer, color, doSketchPads );
+                            itemplotter.PlotPad( resizedPad(), aLayer, color, doSketchPads );
                         }
                         else
                         {
@@ -608,12 +638,6 @@ void PlotStandardLayer( BOARD* aBoard, PLOTTER* aPlotter, const LSET& aLayerMask
                         break;
                     }
                     }
-
-                    // Restore the pad parameters modified by the plot code
-                    pad->SetSize( aLayer, padSize );
-                    pad->SetDelta( aLayer, padDelta );
-                    pad->SetShape( aLayer, padShape );
-                    pad->SetRoundRectRadiusRatio( aLayer, padCornerRadiusRatio );
                 };
 
             for( PCB_LAYER_ID layer : aLayerMask.SeqStackupForPlotting() )
@@ -882,16 +882,20 @@ void BRDITEMS_PLOTTER::PlotZone( const ZONE* aZone, PCB_LAYER_ID aLayer,
      * In non filled mode the outline is plotted, but not the filling items
      */
 
+    // All the filled areas share the same attributes, so for Gerber plotters they are plotted
+    // as a single region (to manage attributes) with one contour per area
+    if( m_plotter->GetPlotterType() == PLOT_FORMAT::GERBER )
+    {
+        static_cast<GERBER_PLOTTER*>( m_plotter )->PlotGerberRegion( aPolysList, &gbr_metadata );
+        m_plotter->EndBlock( nullptr );    // Clear object attributes
+        return;
+    }
+
     for( int idx = 0; idx < aPolysList.OutlineCount(); ++idx )
     {
         const SHAPE_LINE_CHAIN& outline = aPolysList.Outline( idx );
 
-        // Plot the current filled area (as region for Gerber plotter to manage attributes)
-        if( m_plotter->GetPlotterType() == PLOT_FORMAT::GERBER )
-        {
-            static_cast<GERBER_PLOTTER*>( m_plotter )->PlotGerberRegion( outline, &gbr_metadata );
-        }
-        else if( m_plotter->GetPlotterType() == PLOT_FORMAT::DXF )
+        if( m_plotter->GetPlotterType() == PLOT_FORMAT::DXF )
         {
             if( GetDXFPlotMode() == FILLED )
                 m_plotter->PlotPoly( outline, FILL_T::FILLED_SHAPE, 0, getMetadata() );
@@ -30,14 +30,29 @@ void INDEX::Add( ITEM* aItem )
     const PNS_LAYER_RANGE& range = aItem->Layers();
     assert( range.Start() != -1 && range.End() != -1 );
 
-    if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
+    if( m_gridCellSize > 0 )
     {
-        for( int i = 0; i <= range.End(); ++i )
-            m_subIndices.emplace_back( std::make_unique<ITEM_SHAPE_INDEX>( i ) );
+        while( m_gridSubIndices.size() <= static_cast<size_t>( range.End() ) )
+        {
+            int layer = m_gridSubIndices.size();
+            m_gridSubIndices.emplace_back( std::make_unique<ITEM_GRID_INDEX>( layer,
+                                                                              m_gridCellSize ) );
+        }
+
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_gridSubIndices[i]->Add( aItem );
+    }
+    else
+    {
+        if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
+        {
+            for( int i = 0; i <= range.End(); ++i )
+                m_subIndices.emplace_back( std::make_unique<ITEM_SHAPE_INDEX>( i ) );
+        }
+
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_subIndices[i]->Add( aItem );
     }
-
-    for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i]->Add( aItem );
 
     m_allItems.insert( aItem );
     NET_HANDLE net = aItem->Net();
@@ -52,11 +67,22 @@ void INDEX::Remove( ITEM* aItem )
     const PNS_LAYER_RANGE& range = aItem->Layers();
     assert( range.Start() != -1 && range.End() != -1 );
 
-    if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
-        return;
+    if( m_gridCellSize > 0 )
+    {
+        if( m_gridSubIndices.size() <= static_cast<size_t>( range.End() ) )
+            return;
+
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_gridSubIndices[i]->Remove( aItem );
+    }
+    else
+    {
+        if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
+            return;
 
-    for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i]->Remove( aItem );
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_subIndices[i]->Remove( aItem );
+    }
 
     m_allItems.erase( aItem );
     NET_HANDLE net = aItem->Net();
@@ -28,6 +28,7 @@
 #include <unordered_set>
 
 #include <layer_ids.h>
+#include <geometry/shape_grid_index.h>
 #include <geometry/shape_index.h>
 
 #include "pns_item.h"
@@ -42,15 +43,31 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * Alternatively, the per-layer subindices can be uniform grids (spatial hashes).  These are
+ * cheaper to update than R-trees, which pays off for the dense, evenly sized geometry of e.g.
+ * BGA breakouts, where shoving adds and removes many items on each mouse move.
  **/
 class INDEX
 {
 public:
     typedef std::list<ITEM*>            NET_ITEMS_LIST;
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
+    typedef SHAPE_GRID_INDEX<ITEM*>     ITEM_GRID_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
-    INDEX(){};
+    /**
+     * @param aGridCellSize if greater than zero, use uniform grids with the given cell size
+     *                      instead of R-trees for the per-layer subindices.
+     */
+    INDEX( int aGridCellSize = 0 ) :
+            m_gridCellSize( aGridCellSize )
+    {}
+
+    /**
+     * Returns the cell size of the grid subindices, or 0 if R-trees are used.
+     */
+    int GridCellSize() const { return m_gridCellSize; }
 
     /**
      * Adds item to the spatial index.
@@ -124,6 +141,8 @@ private:
 
 private:
     std::deque<std::unique_ptr<ITEM_SHAPE_INDEX>> m_subIndices;
+    std::deque<std::unique_ptr<ITEM_GRID_INDEX>>  m_gridSubIndices;
+    int                                  m_gridCellSize;
     std::map<NET_HANDLE, NET_ITEMS_LIST> m_netMap;
     ITEM_SET                             m_allItems;
 };
@@ -132,10 +151,19 @@ private:
 template<class Visitor>
 int INDEX::querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const
 {
+    LAYER_CONTEXT_SETTER layerContext( aVisitor, aIndex );
+
+    if( m_gridCellSize > 0 )
+    {
+        if( aIndex >= m_gridSubIndices.size() )
+            return 0;
+
+        return m_gridSubIndices[aIndex]->Query( aShape, aMinDistance, aVisitor );
+    }
+
     if( aIndex >= m_subIndices.size() )
         return 0;
 
-    LAYER_CONTEXT_SETTER layerContext( aVisitor, aIndex );
     return m_subIndices[aIndex]->Query( aShape, aMinDistance, aVisitor);
 }
 
@@ -159,7 +187,9 @@ int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) con
 {
     int total = 0;
 
-    for( std::size_t i = 0; i < m_subIndices.size(); ++i )
+    std::size_t count = m_gridCellSize > 0 ? m_gridSubIndices.size() : m_subIndices.size();
+
+    for( std::size_t i = 0; i < count; ++i )
         total += querySingle( i, aShape, aMinDistance, aVisitor );
 
     return total;
@@ -57,7 +57,12 @@
 
 #include <wx/log.h>
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 #include <advanced_config.h>
 #include <pcbnew_settings.h>
@@ -106,6 +111,78 @@ namespace std
 }
 
 
+/**
+ * A clearance cache split in shards with their own lock, so the threads evaluating router
+ * candidates concurrently rarely wait for each other and lookups don't exclude each other.
+ */
+class CLEARANCE_CACHE
+{
+public:
+    bool Find( const CLEARANCE_CACHE_KEY& aKey, int* aValue ) const
+    {
+        const SHARD&                        shard = m_shards[ shardIndex( aKey ) ];
+        std::shared_lock<std::shared_mutex> lock( shard.m_Mutex );
+
+        auto it = shard.m_Map.find( aKey );
+
+        if( it == shard.m_Map.end() )
+            return false;
+
+        *aValue = it->second;
+        return true;
+    }
+
+    void Store( const CLEARANCE_CACHE_KEY& aKey, int aValue )
+    {
+        SHARD&                              shard = m_shards[ shardIndex( aKey ) ];
+        std::unique_lock<std::shared_mutex> lock( shard.m_Mutex );
+
+        shard.m_Map[ aKey ] = aValue;
+    }
+
+    /// Remove the entries whose key matches \a aPredicate.
+    template <typename PREDICATE>
+    void EraseIf( PREDICATE aPredicate )
+    {
+        for( SHARD& shard : m_shards )
+        {
+            std::unique_lock<std::shared_mutex> lock( shard.m_Mutex );
+            std::erase_if( shard.m_Map,
+                           [&]( const auto& aEntry )
+                           {
+                               return aPredicate( aEntry.first );
+                           } );
+        }
+    }
+
+    void Clear()
+    {
+        for( SHARD& shard : m_shards )
+        {
+            std::unique_lock<std::shared_mutex> lock( shard.m_Mutex );
+            shard.m_Map.clear();
+        }
+    }
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct SHARD
+    {
+        mutable std::shared_mutex                    m_Mutex;
+        std::unordered_map<CLEARANCE_CACHE_KEY, int> m_Map;
+    };
+
+    static size_t shardIndex( const CLEARANCE_CACHE_KEY& aKey )
+    {
+        size_t hash = std::hash<CLEARANCE_CACHE_KEY>()( aKey );
+        return ( hash ^ ( hash >> 32 ) ) % SHARD_COUNT;
+    }
+
+    std::array<SHARD, SHARD_COUNT> m_shards;
+};
+
+
 class PNS_PCBNEW_RULE_RESOLVER : public PNS::RULE_RESOLVER
 {
 public:
@@ -147,37 +224,60 @@ public:
     void ClearTemporaryCaches() override;
 
 private:
+    /// Board items standing for the router items which have none, to evaluate the DRC rules.
+    struct DUMMY_ITEMS
+    {
+        DUMMY_ITEMS( BOARD* aBoard );
+
+        PCB_TRACK m_Tracks[2];
+        PCB_ARC   m_Arcs[2];
+        PCB_VIA   m_Vias[2];
+    };
+
+    /// @return the dummy items of the calling thread.
+    DUMMY_ITEMS& dummyItems();
+
     BOARD_ITEM* getBoardItem( const PNS::ITEM* aItem, PCB_LAYER_ID aBoardLayer, int aIdx = 0 );
 
 private:
     PNS::ROUTER_IFACE* m_routerIface;
     BOARD*             m_board;
-    PCB_TRACK          m_dummyTracks[2];
-    PCB_ARC            m_dummyArcs[2];
-    PCB_VIA            m_dummyVias[2];
     int                m_clearanceEpsilon;
 
-    std::unordered_map<CLEARANCE_CACHE_KEY, int> m_clearanceCache;
-    std::unordered_map<CLEARANCE_CACHE_KEY, int> m_tempClearanceCache;
+    CLEARANCE_CACHE    m_clearanceCache;
+    CLEARANCE_CACHE    m_tempClearanceCache;
+
+    /// The router may evaluate candidates on several threads, each one gets its own dummy items
+    uint64_t           m_id;
+    std::mutex         m_dummyItemsMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<DUMMY_ITEMS>> m_dummyItems;
 };
 
 
-PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard,
-                                                    PNS::ROUTER_IFACE* aRouterIface ) :
-    m_routerIface( aRouterIface ),
-    m_board( aBoard ),
-    m_dummyTracks{ { aBoard }, { aBoard } },
-    m_dummyArcs{ { aBoard }, { aBoard } },
-    m_dummyVias{ { aBoard }, { aBoard } }
+PNS_PCBNEW_RULE_RESOLVER::DUMMY_ITEMS::DUMMY_ITEMS( BOARD* aBoard ) :
+    m_Tracks{ { aBoard }, { aBoard } },
+    m_Arcs{ { aBoard }, { aBoard } },
+    m_Vias{ { aBoard }, { aBoard } }
 {
-    for( PCB_TRACK& track : m_dummyTracks )
+    for( PCB_TRACK& track : m_Tracks )
         track.SetFlags( ROUTER_TRANSIENT );
 
-    for( PCB_ARC& arc : m_dummyArcs )
+    for( PCB_ARC& arc : m_Arcs )
         arc.SetFlags( ROUTER_TRANSIENT );
 
-    for ( PCB_VIA& via : m_dummyVias )
+    for ( PCB_VIA& via : m_Vias )
         via.SetFlags( ROUTER_TRANSIENT );
+}
+
+
+PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard,
+                                                    PNS::ROUTER_IFACE* aRouterIface ) :
+    m_routerIface( aRouterIface ),
+    m_board( aBoard )
+{
+    static std::atomic<uint64_t> s_nextId( 1 );
+
+    m_id = s_nextId++;
 
     if( aBoard )
         m_clearanceEpsilon = aBoard->GetDesignSettings().GetDRCEpsilon();
@@ -191,6 +291,29 @@ PNS_PCBNEW_RULE_RESOLVER::~PNS_PCBNEW_RULE_RESOLVER()
 }
 
 
+PNS_PCBNEW_RULE_RESOLVER::DUMMY_ITEMS& PNS_PCBNEW_RULE_RESOLVER::dummyItems()
+{
+    // Resolvers are told apart by id rather than address, which a new one could reuse
+    thread_local uint64_t     t_resolverId = 0;
+    thread_local DUMMY_ITEMS* t_items = nullptr;
+
+    if( t_resolverId != m_id )
+    {
+        std::lock_guard<std::mutex> lock( m_dummyItemsMutex );
+
+        std::unique_ptr<DUMMY_ITEMS>& items = m_dummyItems[ std::this_thread::get_id() ];
+
+        if( !items )
+            items = std::make_unique<DUMMY_ITEMS>( m_board );
+
+        t_resolverId = m_id;
+        t_items = items.get();
+    }
+
+    return *t_items;
+}
+
+
 bool PNS_PCBNEW_RULE_RESOLVER::IsInNetTie( const PNS::ITEM* aA )
 {
     BOARD_ITEM* item = aA->BoardItem();
@@ -349,29 +472,31 @@ bool PNS_PCBNEW_RULE_RESOLVER::IsNonPlatedSlot( const PNS::ITEM* aItem )
 
 BOARD_ITEM* PNS_PCBNEW_RULE_RESOLVER::getBoardItem( const PNS::ITEM* aItem, PCB_LAYER_ID aBoardLayer, int aIdx )
 {
+    DUMMY_ITEMS& dummies = dummyItems();
+
     switch( aItem->Kind() )
     {
     case PNS::ITEM::ARC_T:
-        m_dummyArcs[aIdx].SetLayer( aBoardLayer );
-        m_dummyArcs[aIdx].SetNet( static_cast<NETINFO_ITEM*>( aItem->Net() ) );
-        m_dummyArcs[aIdx].SetStart( aItem->Anchor( 0 ) );
-        m_dummyArcs[aIdx].SetEnd( aItem->Anchor( 1 ) );
-        return &m_dummyArcs[aIdx];
+        dummies.m_Arcs[aIdx].SetLayer( aBoardLayer );
+        dummies.m_Arcs[aIdx].SetNet( static_cast<NETINFO_ITEM*>( aItem->Net() ) );
+        dummies.m_Arcs[aIdx].SetStart( aItem->Anchor( 0 ) );
+        dummies.m_Arcs[aIdx].SetEnd( aItem->Anchor( 1 ) );
+        return &dummies.m_Arcs[aIdx];
 
     case PNS::ITEM::VIA_T:
     case PNS::ITEM::HOLE_T:
-        m_dummyVias[aIdx].SetLayer( aBoardLayer );
-        m_dummyVias[aIdx].SetNet( static_cast<NETINFO_ITEM*>( aItem->Net() ) );
-        m_dummyVias[aIdx].SetStart( aItem->Anchor( 0 ) );
-        return &m_dummyVias[aIdx];
+        dummies.m_Vias[aIdx].SetLayer( aBoardLayer );
+        dummies.m_Vias[aIdx].SetNet( static_cast<NETINFO_ITEM*>( aItem->Net() ) );
+        dummies.m_Vias[aIdx].SetStart( aItem->Anchor( 0 ) );
+        return &dummies.m_Vias[aIdx];
 
     case PNS::ITEM::SEGMENT_T:
     case PNS::ITEM::LINE_T:
-        m_dummyTracks[aIdx].SetLayer( aBoardLayer );
-        m_dummyTracks[aIdx].SetNet( static_cast<NETINFO_ITEM*>( aItem->Net() ) );
-        m_dummyTracks[aIdx].SetStart( aItem->Anchor( 0 ) );
-        m_dummyTracks[aIdx].SetEnd( aItem->Anchor( 1 ) );
-        return &m_dummyTracks[aIdx];
+        dummies.m_Tracks[aIdx].SetLayer( aBoardLayer );
+        dummies.m_Tracks[aIdx].SetNet( static_cast<NETINFO_ITEM*>( aItem->Net() ) );
+        dummies.m_Tracks[aIdx].SetStart( aItem->Anchor( 0 ) );
+        dummies.m_Tracks[aIdx].SetEnd( aItem->Anchor( 1 ) );
+        return &dummies.m_Tracks[aIdx];
 
     default:
         return nullptr;
@@ -461,41 +586,31 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearCacheForItems( std::vector<const PNS::ITEM*>& aItems )
 {
-    int n_pruned = 0;
     std::set<const PNS::ITEM*> remainingItems( aItems.begin(), aItems.end() );
 
 /* We need to carefully check both A and B item pointers in the cache against dirty/invalidated
    items in the set, as the clearance relation is commutative ( CL[a,b] == CL[b,a] ). The code
    below is a bit ugly, but works in O(n*log(m)) and is run once or twice during ROUTER::Move() call
    - so I hope it still gets better performance than no cache at all */
-    for( auto it = m_clearanceCache.begin(); it != m_clearanceCache.end(); )
-    {
-        bool dirty = remainingItems.find( it->first.A ) != remainingItems.end();
-        dirty |= remainingItems.find( it->first.B) != remainingItems.end();
-
-        if( dirty )
-        {
-            it = m_clearanceCache.erase( it );
-            n_pruned++;
-        } else
-            it++;
-    }
-#if 0
-    printf("ClearCache : n_pruned %d\n", n_pruned );
-#endif
+    m_clearanceCache.EraseIf(
+            [&]( const CLEARANCE_CACHE_KEY& aKey )
+            {
+                return remainingItems.find( aKey.A ) != remainingItems.end()
+                       || remainingItems.find( aKey.B ) != remainingItems.end();
+            } );
 }
 
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearCaches()
 {
-    m_clearanceCache.clear();
-    m_tempClearanceCache.clear();
+    m_clearanceCache.Clear();
+    m_tempClearanceCache.Clear();
 }
 
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearTemporaryCaches()
 {
-    m_tempClearanceCache.clear();
+    m_tempClearanceCache.Clear();
 }
 
 
@@ -503,21 +618,17 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
                                          bool aUseClearanceEpsilon )
 {
     CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
+    int                 rv = 0;
 
     // Search cache (used for actual board items)
-    auto it = m_clearanceCache.find( key );
-
-    if( it != m_clearanceCache.end() )
-        return it->second;
+    if( m_clearanceCache.Find( key, &rv ) )
+        return rv;
 
     // Search cache (used for temporary items within an algorithm)
-    it = m_tempClearanceCache.find( key );
-
-    if( it != m_tempClearanceCache.end() )
-        return it->second;
+    if( m_tempClearanceCache.Find( key, &rv ) )
+        return rv;
 
     PNS::CONSTRAINT constraint;
-    int             rv = 0;
     PNS_LAYER_RANGE     layers;
 
     if( !aB )
@@ -595,9 +706,9 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
     if( aA && aB )
     {
         if ( aA->Owner() && aB->Owner() )
-            m_clearanceCache[ key ] = rv;
+            m_clearanceCache.Store( key, rv );
         else
-            m_tempClearanceCache[ key ] = rv;
+            m_tempClearanceCache.Store( key, rv );
     }
 
     return rv;
@@ -1700,6 +1811,14 @@ void PNS_KICAD_IFACE_BASE::SyncWorld( PNS::NODE *aWorld )
 
     m_world = aWorld;
 
+    if( m_board->GetDesignSettings().m_RouterGridIndex )
+    {
+        // A collision query covers the item plus a clearance halo on each side, so cells a few
+        // clearances wide keep typical queries down to a handful of cells.
+        int cellSize = std::max( 4 * worstClearance, pcbIUScale.mmToIU( 0.5 ) );
+        aWorld->SetIndexGridCellSize( cellSize );
+    }
+
     for( BOARD_ITEM* gitem : m_board->Drawings() )
     {
         if ( gitem->Type() == PCB_SHAPE_T || gitem->Type() == PCB_TEXTBOX_T )
@@ -20,8 +20,10 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <vector>
 #include <cassert>
+#include <mutex>
 #include <utility>
 
 #include <math/vector2d.h>
@@ -59,7 +61,9 @@ NODE::NODE()
     m_parent = nullptr;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = nullptr;
-    m_index = new INDEX;
+    m_index = std::make_shared<INDEX>();
+    m_joints = std::make_shared<JOINT_MAP>();
+    m_override = std::make_shared<std::unordered_set<ITEM*>>();
 
 #ifdef DEBUG
     allocNodes.insert( this );
@@ -85,7 +89,7 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
+    m_joints.reset();
 
     std::vector<const ITEM*> toDelete;
 
@@ -122,7 +126,110 @@ NODE::~NODE()
     releaseGarbage();
     unlinkParent();
 
-    delete m_index;
+    m_index.reset();
+}
+
+
+namespace
+{
+
+/**
+ * The #NODE::STATS counters of one thread.  Only the owning thread writes them, the atomics
+ * just make reading them from the benchmark well defined.
+ */
+struct alignas( 64 ) THREAD_STATS
+{
+    std::atomic<uint64_t> m_branches = 0;
+    std::atomic<uint64_t> m_collisionQueries = 0;
+};
+
+
+struct STATS_REGISTRY
+{
+    std::mutex                 m_mutex;
+    std::vector<THREAD_STATS*> m_threads;
+    NODE::STATS                m_exited;     ///< Counts of the threads that have exited
+};
+
+
+STATS_REGISTRY& statsRegistry()
+{
+    static STATS_REGISTRY registry;
+    return registry;
+}
+
+
+/// Registers the counters of a thread for as long as the thread runs.
+struct THREAD_STATS_HANDLE
+{
+    THREAD_STATS_HANDLE()
+    {
+        STATS_REGISTRY&             registry = statsRegistry();
+        std::lock_guard<std::mutex> lock( registry.m_mutex );
+
+        registry.m_threads.push_back( &m_stats );
+    }
+
+    ~THREAD_STATS_HANDLE()
+    {
+        STATS_REGISTRY&             registry = statsRegistry();
+        std::lock_guard<std::mutex> lock( registry.m_mutex );
+
+        registry.m_exited.m_branches += m_stats.m_branches.load( std::memory_order_relaxed );
+        registry.m_exited.m_collisionQueries +=
+                m_stats.m_collisionQueries.load( std::memory_order_relaxed );
+
+        std::erase( registry.m_threads, &m_stats );
+    }
+
+    THREAD_STATS m_stats;
+};
+
+
+THREAD_STATS& threadStats()
+{
+    thread_local THREAD_STATS_HANDLE handle;
+    return handle.m_stats;
+}
+
+
+void increment( std::atomic<uint64_t>& aCounter )
+{
+    // Single writer, so a plain load and store is enough and avoids a locked instruction
+    aCounter.store( aCounter.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+}
+
+} // namespace
+
+
+NODE::STATS NODE::GetStats()
+{
+    STATS_REGISTRY&             registry = statsRegistry();
+    std::lock_guard<std::mutex> lock( registry.m_mutex );
+    STATS                       stats = registry.m_exited;
+
+    for( const THREAD_STATS* counters : registry.m_threads )
+    {
+        stats.m_branches += counters->m_branches.load( std::memory_order_relaxed );
+        stats.m_collisionQueries += counters->m_collisionQueries.load( std::memory_order_relaxed );
+    }
+
+    return stats;
+}
+
+
+void NODE::ResetStats()
+{
+    STATS_REGISTRY&             registry = statsRegistry();
+    std::lock_guard<std::mutex> lock( registry.m_mutex );
+
+    registry.m_exited = STATS();
+
+    for( THREAD_STATS* counters : registry.m_threads )
+    {
+        counters->m_branches.store( 0, std::memory_order_relaxed );
+        counters->m_collisionQueries.store( 0, std::memory_order_relaxed );
+    }
 }
 
 
@@ -145,6 +252,7 @@ NODE* NODE::Branch()
     NODE* child = new NODE;
 
     m_children.insert( child );
+    increment( threadStats().m_branches );
 
     child->m_depth = m_depth + 1;
     child->m_parent = this;
@@ -152,30 +260,73 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
     child->m_maxClearance = m_maxClearance;
 
-    // Immediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
+    // Immediate offspring of the root branch needs not copy anything. For the rest, share
+    // the joints, overridden item maps and pointers to stored items with the parent.  They
+    // are copied lazily by whichever of the two nodes is modified first.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
-
+        child->m_index = m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
+    else if( m_index->GridCellSize() > 0 )
+    {
+        child->m_index = std::make_shared<INDEX>( m_index->GridCellSize() );
+    }
 
 #if 0
     wxLogTrace( wxT( "PNS" ), wxT( "%d items, %d joints, %d overrides" ),
                 child->m_index->Size(),
-                (int) child->m_joints.size(),
-                (int) child->m_override.size() );
+                (int) child->m_joints->size(),
+                (int) child->m_override->size() );
 #endif
 
     return child;
 }
 
 
+void NODE::SetIndexGridCellSize( int aCellSize )
+{
+    wxCHECK( isRoot() && m_index->Size() == 0, /* void */ );
+
+    m_index = std::make_shared<INDEX>( aCellSize );
+}
+
+
+INDEX& NODE::writableIndex()
+{
+    if( m_index.use_count() > 1 )
+    {
+        std::shared_ptr<INDEX> index = std::make_shared<INDEX>( m_index->GridCellSize() );
+
+        for( ITEM* item : *m_index )
+            index->Add( item );
+
+        m_index = std::move( index );
+    }
+
+    return *m_index;
+}
+
+
+NODE::JOINT_MAP& NODE::writableJoints()
+{
+    if( m_joints.use_count() > 1 )
+        m_joints = std::make_shared<JOINT_MAP>( *m_joints );
+
+    return *m_joints;
+}
+
+
+std::unordered_set<ITEM*>& NODE::writableOverrides()
+{
+    if( m_override.use_count() > 1 )
+        m_override = std::make_shared<std::unordered_set<ITEM*>>( *m_override );
+
+    return *m_override;
+}
+
+
 void NODE::unlinkParent()
 {
     if( isRoot() )
@@ -261,6 +412,8 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles,
     if( aItem->IsVirtual() )
         return 0;
 
+    increment( threadStats().m_collisionQueries );
+
     DEFAULT_OBSTACLE_VISITOR visitor( &ctx, aItem );
 
 #ifdef DEBUG
@@ -528,7 +681,7 @@ void NODE::addSolid( SOLID* aSolid )
         linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
 
     aSolid->SetOwner( this );
-    m_index->Add( aSolid );
+    writableIndex().Add( aSolid );
 }
 
 
@@ -553,7 +706,7 @@ void NODE::addVia( VIA* aVia )
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
     aVia->SetOwner( this );
 
-    m_index->Add( aVia );
+    writableIndex().Add( aVia );
 }
 
 
@@ -563,7 +716,7 @@ void NODE::addHole( HOLE* aHole )
     //linkJoint( aHole->Pos(), aHole->Layers(), aHole->Net(), aHole );
 
     aHole->SetOwner( this );
-    m_index->Add( aHole );
+    writableIndex().Add( aHole );
 }
 
 
@@ -658,7 +811,7 @@ void NODE::addSegment( SEGMENT* aSeg )
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
-    m_index->Add( aSeg );
+    writableIndex().Add( aSeg );
 }
 
 
@@ -687,7 +840,7 @@ void NODE::addArc( ARC* aArc )
     linkJoint( aArc->Anchor( 0 ), aArc->Layers(), aArc->Net(), aArc );
     linkJoint( aArc->Anchor( 1 ), aArc->Layers(), aArc->Net(), aArc );
 
-    m_index->Add( aArc );
+    writableIndex().Add( aArc );
 }
 
 
@@ -732,21 +885,23 @@ void NODE::doRemove( ITEM* aItem )
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
     {
-        m_override.insert( aItem );
+        std::unordered_set<ITEM*>& overrides = writableOverrides();
+
+        overrides.insert( aItem );
 
         if( aItem->HasHole() )
-            m_override.insert( aItem->Hole() );
+            overrides.insert( aItem->Hole() );
     }
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
     {
-        m_index->Remove( aItem );
+        writableIndex().Remove( aItem );
 
         if( aItem->HasHole() )
         {
-            m_index->Remove( aItem->Hole() );
+            writableIndex().Remove( aItem->Hole() );
             holeRemoved = true;
         }
     }
@@ -762,7 +917,7 @@ void NODE::doRemove( ITEM* aItem )
         {
             if( ! holeRemoved )
             {
-                m_index->Remove( hole ); // hole is not directly owned by NODE but by the parent SOLID/VIA.
+                writableIndex().Remove( hole ); // hole is not directly owned by NODE but by the parent SOLID/VIA.
             }
 
             hole->SetOwner( aItem );
@@ -801,14 +956,16 @@ void NODE::rebuildJoint( const JOINT* aJoint, const ITEM* aItem )
     tag.net = net;
     tag.pos = aJoint->Pos();
 
-    bool split;
+    // aJoint may live in a joint map shared with the parent, so detach only after reading it.
+    JOINT_MAP& joints = writableJoints();
+    bool       split;
 
     do
     {
         split = false;
-        auto range = m_joints.equal_range( tag );
+        auto range = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -817,7 +974,7 @@ void NODE::rebuildJoint( const JOINT* aJoint, const ITEM* aItem )
         {
             if( aItem->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                joints.erase( f );
                 split = true;
                 break;
             }
@@ -826,11 +983,11 @@ void NODE::rebuildJoint( const JOINT* aJoint, const ITEM* aItem )
 
     bool completelyErased = false;
 
-    if( !isRoot() && m_joints.find( tag ) == m_joints.end() )
+    if( !isRoot() && joints.find( tag ) == joints.end() )
     {
         JOINT jtDummy( tag.pos, PNS_LAYER_RANGE(-1), tag.net );
 
-        m_joints.insert( TagJointPair( tag, jtDummy ) );
+        joints.insert( TagJointPair( tag, jtDummy ) );
         completelyErased = true;
     }
 
@@ -1181,7 +1338,7 @@ void NODE::FixupVirtualVias()
     const SEGMENT* locked_seg = nullptr;
     std::vector<VVIA*> vvias;
 
-    for( auto& jointPair : m_joints )
+    for( auto& jointPair : *m_joints )
     {
         JOINT joint = jointPair.second;
 
@@ -1272,12 +1429,12 @@ const JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, NET_HANDLE aNet
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::const_iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP::const_iterator f = m_joints->find( tag ), end = m_joints->end();
 
     if( f == end && !isRoot() )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = m_root->m_joints->end();
+        f = m_root->m_joints->find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
     }
 
     while( f != end )
@@ -1307,17 +1464,18 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYER_RANGE& aLayers, N
     tag.net = aNet;
 
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP&          joints = writableJoints();
+    JOINT_MAP::iterator f = joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        range = m_root->m_joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+            joints.insert( *f );
     }
 
     // now insert and combine overlapping joints
@@ -1328,9 +1486,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYER_RANGE& aLayers, N
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1338,14 +1496,14 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYER_RANGE& aLayers, N
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                joints.erase( f );
                 merged = true;
                 break;
             }
         }
     } while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1471,13 +1629,13 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( isRoot() )
         return;
 
-    if( m_override.size() )
-        aRemoved.reserve( m_override.size() );
+    if( m_override->size() )
+        aRemoved.reserve( m_override->size() );
 
     if( m_index->Size() )
         aAdded.reserve( m_index->Size() );
 
-    for( ITEM* item : m_override )
+    for( ITEM* item : *m_override )
         aRemoved.push_back( item );
 
     for( ITEM* item : *m_index )
@@ -1526,7 +1684,7 @@ void NODE::Commit( NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( ITEM* item : aNode->m_override )
+    for( ITEM* item : *aNode->m_override )
         Remove( item );
 
     for( ITEM* item : *aNode->m_index )
@@ -1683,7 +1841,7 @@ int NODE::QueryJoints( const BOX2I& aBox, std::vector<JOINT*>& aJoints, PNS_LAYE
 
     aJoints.clear();
 
-    for( JOINT_MAP::value_type& j : m_joints )
+    for( JOINT_MAP::value_type& j : *m_joints )
     {
         if( !j.second.Layers().Overlaps( aLayerMask ) )
             continue;
@@ -1698,7 +1856,7 @@ int NODE::QueryJoints( const BOX2I& aBox, std::vector<JOINT*>& aJoints, PNS_LAYE
     if( isRoot() )
         return n;
 
-    for( JOINT_MAP::value_type& j : m_root->m_joints )
+    for( JOINT_MAP::value_type& j : *m_root->m_joints )
     {
         if( !Overrides( &j.second ) && j.second.Layers().Overlaps( aLayerMask ) )
         {
@@ -25,6 +25,7 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <set>
 #include <core/minoptmax.h>
 
@@ -243,9 +244,26 @@ public:
     typedef std::vector<ITEM*>    ITEM_VECTOR;
     typedef std::set<OBSTACLE>    OBSTACLES;
 
+    /**
+     * Counters of the node operations that dominate routing cost, summed over all threads.
+     * Used by the router benchmarks to report the work done per event.
+     */
+    struct STATS
+    {
+        uint64_t m_branches = 0;
+        uint64_t m_collisionQueries = 0;
+    };
+
     NODE();
     ~NODE();
 
+    /**
+     * Each thread counts in its own block, so the hot paths never write to a shared cache line.
+     * Reading or resetting the counters while other threads route gives approximate values.
+     */
+    static STATS GetStats();
+    static void ResetStats();
+
     ///< Return the expected clearance between items a and b.
     int GetClearance( const ITEM* aA, const ITEM* aB, bool aUseClearanceEpsilon = true ) const;
 
@@ -261,6 +279,15 @@ public:
         m_maxClearance = aClearance;
     }
 
+    /**
+     * Select the spatial index used for collision queries.  Must be called on an empty root
+     * node; branches inherit the choice.
+     *
+     * @param aCellSize if greater than zero, index items in uniform grids with this cell size
+     *                  instead of R-trees.
+     */
+    void SetIndexGridCellSize( int aCellSize );
+
     ///< Assign a clearance resolution function object.
     void SetRuleResolver( RULE_RESOLVER* aFunc )
     {
@@ -275,7 +302,7 @@ public:
     ///< Return the number of joints.
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints->size();
     }
 
     ///< Return the number of nodes in the inheritance chain (wrs to the root node).
@@ -396,6 +423,10 @@ public:
      * Create a lightweight copy (called branch) of self that tracks the changes (added/removed
      * items) wrs to the root.
      *
+     * The branch shares the index, joint map and override set of its parent and only copies
+     * them when it is modified for the first time, so branching is O(1) and branches that are
+     * only queried never allocate.
+     *
      * @note If there are any branches in use, their parents must **not** be deleted.
      *
      * @return the new branch.
@@ -491,7 +522,7 @@ public:
     ///< Check if this branch contains an updated version of the m_item from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override->find( aItem ) != m_override->end();
     }
 
     void FixupVirtualVias();
@@ -503,7 +534,7 @@ public:
 
     const std::unordered_set<ITEM*>& GetOverrides() const
     {
-        return m_override;
+        return *m_override;
     }
 
     VIA* FindViaByHandle ( const VIA_HANDLE& handle ) const;
@@ -567,19 +598,28 @@ private:
     typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
 
-    JOINT_MAP       m_joints;           ///< hash table with the joints, linking the items. Joints
-                                        ///< are hashed by their position, layer set and net.
+    /**
+     * Accessors for the copy-on-write state of the node.  A branch initially shares these with
+     * its parent; the first modification detaches a private copy.
+     */
+    INDEX&                     writableIndex();
+    JOINT_MAP&                 writableJoints();
+    std::unordered_set<ITEM*>& writableOverrides();
+
+    std::shared_ptr<JOINT_MAP> m_joints; ///< hash table with the joints, linking the items. Joints
+                                         ///< are hashed by their position, layer set and net.
+                                         ///< Shared with the parent until first modified.
 
     NODE*           m_parent;           ///< node this node was branched from
     NODE*           m_root;             ///< root node of the whole hierarchy
     std::set<NODE*> m_children;         ///< list of nodes branched from this one
 
-    std::unordered_set<ITEM*> m_override;   ///< hash of root's items that have been changed
-                                            ///< in this node
+    std::shared_ptr<std::unordered_set<ITEM*>> m_override; ///< hash of root's items that have
+                                                           ///< been changed in this node
 
     int             m_maxClearance;     ///< worst case item-item clearance
     RULE_RESOLVER*  m_ruleResolver;     ///< Design rules resolver
-    INDEX*          m_index;            ///< Geometric/Net index of the items
+    std::shared_ptr<INDEX> m_index;     ///< Geometric/Net index of the items (copy-on-write)
     int             m_depth;            ///< depth of the node (number of parent nodes in the
                                         ///< inheritance chain)
 
@@ -25,6 +25,9 @@
 
 #include <cmath>
 
+#include <advanced_config.h>
+#include <thread_pool.h>
+
 #include "pns_arc.h"
 #include "pns_line.h"
 #include "pns_diff_pair.h"
@@ -113,7 +116,8 @@ OPTIMIZER::OPTIMIZER( NODE* aWorld ) :
     m_world( aWorld ),
     m_collisionKindMask( ITEM::ANY_T ),
     m_effortLevel( MERGE_SEGMENTS ),
-    m_restrictAreaIsStrict( false )
+    m_restrictAreaIsStrict( false ),
+    m_parallelCandidates( ADVANCED_CFG::GetCfg().m_PNSParallelCandidates )
 {
 }
 
@@ -708,19 +712,64 @@ bool OPTIMIZER::mergeStep( LINE* aLine, SHAPE_LINE_CHAIN& aCurrentPath, int step
     DIRECTION_45 orig_start( aLine->CSegment( 0 ), is90mode );
     DIRECTION_45 orig_end( aLine->CSegment( -1 ), is90mode );
 
+    auto isArcSpan =
+            [&]( int aIdx )
+            {
+                // Do not attempt to merge false segments that are part of an arc
+                return aCurrentPath.IsArcSegment( aIdx )
+                       || aCurrentPath.IsArcSegment( static_cast<std::size_t>( aIdx ) + step );
+            };
+
+    // The collision checks of the bypass candidates are independent of each other, so in
+    // parallel mode they are evaluated a batch of spans at a time on the thread pool.  The
+    // candidates are still accepted in order, so the first improving bypass wins just like
+    // in the serial evaluation.  The last spans are checked serially once too few are left
+    // to be worth a batch.
+    bool              parallel = m_parallelCandidates;
+    int               batchStart = 0;
+    int               batchEnd = 0;
+    std::vector<char> batchCollisions;
 
     for( int n = 0; n < n_segs - step; n++ )
     {
-        // Do not attempt to merge false segments that are part of an arc
-        if( aCurrentPath.IsArcSegment( n )
-            || aCurrentPath.IsArcSegment( static_cast<std::size_t>( n ) + step ) )
-        {
+        if( isArcSpan( n ) )
             continue;
-        }
 
         const SEG s1    = aCurrentPath.CSegment( n );
         const SEG s2    = aCurrentPath.CSegment( n + step );
 
+        if( parallel && n >= batchEnd && n_segs - step - n < MinParallelCandidates )
+            parallel = false;
+
+        if( parallel && n >= batchEnd )
+        {
+            thread_pool& tp = GetKiCadThreadPool();
+            int          batchSize = std::max( MinParallelCandidates,
+                                               (int) tp.get_thread_count() );
+
+            batchStart = n;
+            batchEnd = std::min( n + batchSize, n_segs - step );
+            batchCollisions.assign( 2 * ( batchEnd - batchStart ), 0 );
+
+            auto results = tp.submit_loop( 0, (int) batchCollisions.size(),
+                    [&]( const int ii )
+                    {
+                        int cand = batchStart + ii / 2;
+
+                        if( isArcSpan( cand ) )
+                            return;
+
+                        const SEG        c1 = aCurrentPath.CSegment( cand );
+                        const SEG        c2 = aCurrentPath.CSegment( cand + step );
+                        SHAPE_LINE_CHAIN bypass = DIRECTION_45().BuildInitialTrace( c1.A, c2.B,
+                                                                                    ii % 2,
+                                                                                    cornerMode );
+
+                        batchCollisions[ii] = checkColliding( aLine, bypass );
+                    } );
+            results.wait();
+        }
+
         SHAPE_LINE_CHAIN path[2];
         SHAPE_LINE_CHAIN* picked = nullptr;
         int cost[2];
@@ -731,8 +780,10 @@ bool OPTIMIZER::mergeStep( LINE* aLine, SHAPE_LINE_CHAIN& aCurrentPath, int step
             cost[i] = INT_MAX;
 
             bool ok = false;
+            bool colliding = parallel ? batchCollisions[2 * ( n - batchStart ) + i]
+                                      : checkColliding( aLine, bypass );
 
-            if( !checkColliding( aLine, bypass ) )
+            if( !colliding )
             {
                 ok = checkConstraints ( n, n + step + 1, aLine, aCurrentPath, bypass );
             }
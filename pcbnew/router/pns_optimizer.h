@@ -154,6 +154,17 @@ public:
         m_effortLevel |= OPTIMIZER::RESTRICT_AREA;
     }
 
+    /**
+     * Check the collisions of the merge candidates on the thread pool.  The result is the same
+     * as with the serial evaluation.  Defaults to the PNSParallelCandidateEvaluation advanced
+     * setting.
+     */
+    void SetParallelCandidates( bool aParallel ) { m_parallelCandidates = aParallel; }
+
+    /// When fewer spans than this are left to merge, their candidates are checked serially as
+    /// the thread pool round trip costs more than the collision checks.
+    static constexpr int MinParallelCandidates = 8;
+
 private:
     static const int MaxCachedItems = 256;
 
@@ -210,6 +221,7 @@ private:
     std::pair<int, int> m_restrictedVertexRange;
     BOX2I               m_restrictArea;
     bool                m_restrictAreaIsStrict;
+    bool                m_parallelCandidates;
 };
 
 
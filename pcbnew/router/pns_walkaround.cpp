@@ -24,6 +24,7 @@
 #include <optional>
 
 #include <geometry/shape_line_chain.h>
+#include <thread_pool.h>
 
 #include "pns_walkaround.h"
 #include "pns_optimizer.h"
@@ -198,27 +199,69 @@ bool WALKAROUND::singleStep()
         return true;
     };
 
-    if ( m_enabledPolicies[WP_CW] )
+    // Walking around the pending clusters in each direction only reads the world and writes
+    // to a separate line, so the candidates can be evaluated concurrently.  Debug output is
+    // not thread-safe, so the candidates are processed serially while it is enabled.
+    struct CANDIDATE
     {
-        bool stat = processCluster( pendingClusters[ WP_CW ], m_currentResult.lines[ WP_CW ], true );
-        if( !stat )
-            m_currentResult.status[ WP_CW ] = ST_STUCK;
+        TOPOLOGY::CLUSTER* m_cluster;
+        LINE*              m_line;
+        bool               m_cw;
+        bool               m_result;
+    };
+
+    LINE                   path_cw, path_ccw;
+    std::vector<CANDIDATE> candidates;
+
+    if( m_enabledPolicies[WP_CW] )
+        candidates.push_back( { &pendingClusters[WP_CW], &m_currentResult.lines[WP_CW], true, false } );
+
+    if( m_enabledPolicies[WP_CCW] )
+        candidates.push_back( { &pendingClusters[WP_CCW], &m_currentResult.lines[WP_CCW], false, false } );
+
+    if( m_enabledPolicies[WP_SHORTEST] )
+    {
+        path_cw = m_currentResult.lines[WP_SHORTEST];
+        path_ccw = m_currentResult.lines[WP_SHORTEST];
+
+        candidates.push_back( { &pendingClusters[WP_SHORTEST], &path_cw, true, false } );
+        candidates.push_back( { &pendingClusters[WP_SHORTEST], &path_ccw, false, false } );
     }
 
-    if ( m_enabledPolicies[WP_CCW] )
+    bool parallel = ADVANCED_CFG::GetCfg().m_PNSParallelCandidates && candidates.size() > 1
+                    && !( Dbg() && Dbg()->IsDebugEnabled() );
+
+    if( parallel )
+    {
+        thread_pool& tp = GetKiCadThreadPool();
+
+        auto results = tp.submit_loop( 0, candidates.size(),
+                                       [&]( const int ii )
+                                       {
+                                           CANDIDATE& c = candidates[ii];
+                                           c.m_result = processCluster( *c.m_cluster, *c.m_line,
+                                                                        c.m_cw );
+                                       } );
+        results.wait();
+    }
+    else
     {
-        bool stat = processCluster( pendingClusters[ WP_CCW ], m_currentResult.lines[ WP_CCW ], false );
-        if( !stat )
-            m_currentResult.status[ WP_CCW ] = ST_STUCK;
+        for( CANDIDATE& c : candidates )
+            c.m_result = processCluster( *c.m_cluster, *c.m_line, c.m_cw );
     }
 
+    size_t candidateIdx = 0;
+
+    if( m_enabledPolicies[WP_CW] && !candidates[candidateIdx++].m_result )
+        m_currentResult.status[ WP_CW ] = ST_STUCK;
+
+    if( m_enabledPolicies[WP_CCW] && !candidates[candidateIdx++].m_result )
+        m_currentResult.status[ WP_CCW ] = ST_STUCK;
+
     if( m_enabledPolicies[WP_SHORTEST] )
     {
-        LINE& line = m_currentResult.lines[WP_SHORTEST];
-        LINE  path_cw( line ), path_ccw( line );
-
-        auto st_cw = processCluster( pendingClusters[WP_SHORTEST], path_cw, true );
-        auto st_ccw = processCluster( pendingClusters[WP_SHORTEST], path_ccw, false );
+        bool st_cw = candidates[candidateIdx].m_result;
+        bool st_ccw = candidates[candidateIdx + 1].m_result;
 
         bool cw_coll = st_cw ? m_world->CheckColliding( &path_cw ).has_value() : false;
         bool ccw_coll = st_ccw ? m_world->CheckColliding( &path_ccw ).has_value() : false;
@@ -0,0 +1,266 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <gal/opengl/cached_container_ram.h>
+#include <gal/opengl/vertex_item.h>
+#include <gal/opengl/vertex_manager.h>
+
+#include <memory>
+#include <vector>
+
+
+// All these tests are of a class in KIGFX
+using namespace KIGFX;
+
+
+/**
+ * A vertex manager using a RAM cached container.  No OpenGL context is needed as long as the
+ * vertices are not drawn: the container keeps the data in memory and skips the GPU transfer
+ * when there is no vertex buffer.
+ */
+struct CACHED_CONTAINER_FIXTURE
+{
+    CACHED_CONTAINER_FIXTURE( unsigned int aSize ) :
+            m_container( new CACHED_CONTAINER_RAM( aSize ) ),
+            m_manager( m_container )
+    {
+    }
+
+    /**
+     * Add an item whose vertices store the item index and the vertex index as coordinates.
+     */
+    VERTEX_ITEM* AddItem( unsigned int aSize )
+    {
+        float index = m_items.size();
+
+        m_items.push_back( std::make_unique<VERTEX_ITEM>( m_manager ) );
+
+        for( unsigned int ii = 0; ii < aSize; ++ii )
+            m_manager.Vertex( index, ii, 0.0f );
+
+        m_manager.FinishItem();
+
+        return m_items.back().get();
+    }
+
+    /**
+     * Check that the vertices of an item still hold the coordinates written by AddItem().
+     */
+    bool CheckItem( unsigned int aIndex, unsigned int aSize ) const
+    {
+        const VERTEX_ITEM* item = m_items[aIndex].get();
+
+        if( item->GetSize() != aSize )
+            return false;
+
+        const VERTEX* vertices = item->GetVertices();
+
+        for( unsigned int ii = 0; ii < aSize; ++ii )
+        {
+            if( vertices[ii].x != aIndex || vertices[ii].y != ii )
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Run an update cycle as OPENGL_GAL does
+    void Update()
+    {
+        m_manager.Map();
+        m_manager.Unmap();
+    }
+
+    CACHED_CONTAINER*                         m_container;
+    VERTEX_MANAGER                            m_manager;
+    std::vector<std::unique_ptr<VERTEX_ITEM>> m_items;
+};
+
+
+BOOST_AUTO_TEST_SUITE( CachedContainer )
+
+
+/**
+ * Deleted items give their space back as a single chunk merged with its free neighbors
+ */
+BOOST_AUTO_TEST_CASE( FreeChunksMerged )
+{
+    CACHED_CONTAINER_FIXTURE fixture( 1024 );
+
+    for( int ii = 0; ii < 8; ++ii )
+        fixture.AddItem( 16 );
+
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_used, 128 );
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_freeChunks, 1 );
+
+    // Holes between the items, the last one is merged with the free space at the end
+    for( int ii : { 1, 3, 5, 7 } )
+        fixture.m_items[ii].reset();
+
+    CACHED_CONTAINER::STATS stats = fixture.m_container->GetStats();
+
+    BOOST_CHECK_EQUAL( stats.m_freeChunks, 4 );
+    BOOST_CHECK_EQUAL( stats.m_largestFreeChunk, 1024 - 112 );
+    BOOST_CHECK_GT( stats.m_fragmentation, 0.0 );
+
+    for( int ii : { 0, 2, 4, 6 } )
+        BOOST_CHECK( fixture.CheckItem( ii, 16 ) );
+
+    // A new item fits in a hole
+    VERTEX_ITEM* item = fixture.AddItem( 16 );
+
+    BOOST_CHECK_LT( item->GetOffset(), 112 );
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_freeChunks, 3 );
+
+    fixture.m_items.clear();
+
+    stats = fixture.m_container->GetStats();
+
+    BOOST_CHECK_EQUAL( stats.m_used, 0 );
+    BOOST_CHECK_EQUAL( stats.m_freeChunks, 1 );
+    BOOST_CHECK_EQUAL( stats.m_largestFreeChunk, 1024 );
+    BOOST_CHECK_EQUAL( stats.m_fragmentation, 0.0 );
+}
+
+
+/**
+ * Items growing in place are not moved, other ones are copied to a larger chunk
+ */
+BOOST_AUTO_TEST_CASE( ItemReallocation )
+{
+    CACHED_CONTAINER_FIXTURE fixture( 1024 );
+
+    VERTEX_ITEM* first = fixture.AddItem( 10 );
+    VERTEX_ITEM* last = fixture.AddItem( 10 );
+
+    // The last item is followed by free space
+    unsigned int offset = last->GetOffset();
+
+    fixture.m_manager.SetItem( *last );
+    fixture.m_manager.Vertex( 1.0f, 10.0f, 0.0f );
+    fixture.m_manager.FinishItem();
+
+    BOOST_CHECK_EQUAL( last->GetOffset(), offset );
+    BOOST_CHECK( fixture.CheckItem( 1, 11 ) );
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_reallocations, 0 );
+
+    // The first item is followed by the last one
+    fixture.m_manager.SetItem( *first );
+    fixture.m_manager.Vertex( 0.0f, 10.0f, 0.0f );
+    fixture.m_manager.FinishItem();
+
+    BOOST_CHECK_NE( first->GetOffset(), 0 );
+    BOOST_CHECK( fixture.CheckItem( 0, 11 ) );
+    BOOST_CHECK( fixture.CheckItem( 1, 11 ) );
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_reallocations, 1 );
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_used, 22 );
+}
+
+
+/**
+ * A fragmented container is packed over a few updates, without being resized
+ */
+BOOST_AUTO_TEST_CASE( IncrementalCompaction )
+{
+    const unsigned int itemSize = 512;
+    const unsigned int itemCount = 256;
+
+    CACHED_CONTAINER_FIXTURE fixture( 2 * itemSize * itemCount );
+
+    for( unsigned int ii = 0; ii < itemCount; ++ii )
+        fixture.AddItem( itemSize );
+
+    fixture.Update();
+
+    // Delete every other item, half of the used range is lost
+    for( unsigned int ii = 0; ii < itemCount; ii += 2 )
+        fixture.m_items[ii].reset();
+
+    CACHED_CONTAINER::STATS stats = fixture.m_container->GetStats();
+
+    // The holes and the free space at the end
+    BOOST_CHECK_EQUAL( stats.m_freeChunks, itemCount / 2 + 1 );
+    BOOST_CHECK_EQUAL( stats.m_compactedVertices, 0 );
+
+    // Each update moves a limited number of vertices
+    fixture.Update();
+
+    stats = fixture.m_container->GetStats();
+
+    BOOST_CHECK_GT( stats.m_compactedVertices, 0 );
+    BOOST_CHECK_LE( stats.m_compactedVertices, itemSize * itemCount / 4 );
+
+    for( int ii = 0; ii < 8; ++ii )
+        fixture.Update();
+
+    stats = fixture.m_container->GetStats();
+
+    BOOST_CHECK_EQUAL( stats.m_resizes, 0 );
+    BOOST_CHECK_EQUAL( stats.m_size, 2 * itemSize * itemCount );
+    BOOST_CHECK_EQUAL( stats.m_freeChunks, 1 );
+    BOOST_CHECK_EQUAL( stats.m_fragmentation, 0.0 );
+
+    for( unsigned int ii = 1; ii < itemCount; ii += 2 )
+    {
+        BOOST_CHECK_LT( fixture.m_items[ii]->GetOffset(), itemSize * itemCount / 2 );
+        BOOST_CHECK( fixture.CheckItem( ii, itemSize ) );
+    }
+}
+
+
+/**
+ * Only the modified vertices are transferred on update
+ */
+BOOST_AUTO_TEST_CASE( PartialUpload )
+{
+    CACHED_CONTAINER_FIXTURE fixture( 4096 );
+
+    for( int ii = 0; ii < 32; ++ii )
+        fixture.AddItem( 64 );
+
+    // The first update transfers all the stored vertices
+    fixture.Update();
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_uploadedBytes, 32 * 64 * VERTEX_SIZE );
+
+    fixture.Update();
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_uploadedBytes, 0 );
+
+    fixture.m_manager.Map();
+    fixture.m_manager.ChangeItemColor( *fixture.m_items[10], COLOR4D( 1.0, 0.0, 0.0, 1.0 ) );
+    fixture.m_manager.Unmap();
+
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_uploadedBytes, 64 * VERTEX_SIZE );
+
+    // A range covering both items
+    fixture.m_manager.Map();
+    fixture.m_manager.ChangeItemDepth( *fixture.m_items[3], 1.0f );
+    fixture.m_manager.ChangeItemDepth( *fixture.m_items[5], 1.0f );
+    fixture.m_manager.Unmap();
+
+    BOOST_CHECK_EQUAL( fixture.m_container->GetStats().m_uploadedBytes, 3 * 64 * VERTEX_SIZE );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
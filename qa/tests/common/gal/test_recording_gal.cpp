@@ -0,0 +1,175 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <gal/recording_gal.h>
+
+#include <vector>
+
+
+// All these tests are of a class in KIGFX
+using namespace KIGFX;
+
+
+/**
+ * A GAL logging the primitives it is asked to draw, with the attributes they are drawn with.
+ */
+class LOGGING_GAL : public GAL
+{
+public:
+    struct ENTRY
+    {
+        VECTOR2D m_start;
+        VECTOR2D m_end;
+        COLOR4D  m_color;
+        float    m_lineWidth;
+        double   m_depth;
+    };
+
+    LOGGING_GAL( GAL_DISPLAY_OPTIONS& aOptions ) :
+            GAL( aOptions )
+    {
+    }
+
+    void DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override
+    {
+        m_entries.push_back( { aStartPoint, aEndPoint, m_strokeColor, m_lineWidth,
+                               m_layerDepth } );
+    }
+
+    void DrawPolyline( const std::vector<VECTOR2D>& aPointList ) override
+    {
+        m_entries.push_back( { aPointList.front(), aPointList.back(), m_strokeColor, m_lineWidth,
+                               m_layerDepth } );
+    }
+
+    std::vector<ENTRY> m_entries;
+};
+
+
+struct RECORDING_GAL_FIXTURE
+{
+    RECORDING_GAL_FIXTURE() :
+            m_target( m_options )
+    {
+    }
+
+    GAL_DISPLAY_OPTIONS m_options;
+    LOGGING_GAL         m_target;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( RecordingGal, RECORDING_GAL_FIXTURE )
+
+
+/**
+ * The painters see the view parameters of the target GAL
+ */
+BOOST_AUTO_TEST_CASE( ViewParameters )
+{
+    m_target.SetZoomFactor( 2.5 );
+    m_target.SetFlip( true, false );
+    m_target.SetDepthRange( VECTOR2D( -100, 100 ) );
+    m_target.ComputeWorldScreenMatrix();
+
+    RECORDING_GAL recorder( m_options, m_target );
+
+    BOOST_CHECK_EQUAL( recorder.GetZoomFactor(), 2.5 );
+    BOOST_CHECK( recorder.IsFlippedX() );
+    BOOST_CHECK( !recorder.IsFlippedY() );
+    BOOST_CHECK_EQUAL( recorder.GetMinDepth(), -100.0 );
+    BOOST_CHECK_EQUAL( recorder.GetWorldScale(), m_target.GetWorldScale() );
+    BOOST_CHECK_EQUAL( recorder.IsOpenGlEngine(), m_target.IsOpenGlEngine() );
+}
+
+
+/**
+ * The attributes are recorded when they change, and the playback draws with them
+ */
+BOOST_AUTO_TEST_CASE( Attributes )
+{
+    RECORDING_GAL recorder( m_options, m_target );
+
+    recorder.BeginRecording( 10.0 );
+    recorder.SetStrokeColor( COLOR4D( 1.0, 0.0, 0.0, 1.0 ) );
+    recorder.SetLineWidth( 2.0f );
+    recorder.DrawLine( VECTOR2D( 0, 0 ), VECTOR2D( 10, 0 ) );
+    recorder.DrawLine( VECTOR2D( 0, 0 ), VECTOR2D( 0, 10 ) );
+    recorder.SetLineWidth( 3.0f );
+    recorder.AdvanceDepth();
+    recorder.DrawLine( VECTOR2D( 0, 0 ), VECTOR2D( 10, 10 ) );
+
+    GAL_DISPLAY_LIST list = recorder.EndRecording();
+
+    // All the attributes before the first line, then the width and the depth before the last
+    BOOST_CHECK_EQUAL( list.Size(), 7 + 2 + 2 + 1 );
+
+    // The state of the target must not leak into the playback
+    m_target.SetStrokeColor( COLOR4D( 0.0, 0.0, 1.0, 1.0 ) );
+    m_target.SetLineWidth( 10.0f );
+
+    list.Replay( m_target );
+
+    BOOST_REQUIRE_EQUAL( m_target.m_entries.size(), 3 );
+
+    for( const LOGGING_GAL::ENTRY& entry : m_target.m_entries )
+        BOOST_CHECK_EQUAL( entry.m_color, COLOR4D( 1.0, 0.0, 0.0, 1.0 ) );
+
+    BOOST_CHECK_EQUAL( m_target.m_entries[0].m_lineWidth, 2.0f );
+    BOOST_CHECK_EQUAL( m_target.m_entries[0].m_depth, 10.0 );
+    BOOST_CHECK_EQUAL( m_target.m_entries[1].m_end, VECTOR2D( 0, 10 ) );
+    BOOST_CHECK_EQUAL( m_target.m_entries[2].m_lineWidth, 3.0f );
+    BOOST_CHECK_CLOSE( m_target.m_entries[2].m_depth, 9.9, 1e-6 );
+
+    // A new list does not depend on the previous one
+    recorder.BeginRecording( 20.0 );
+    recorder.DrawLine( VECTOR2D( 0, 0 ), VECTOR2D( 5, 5 ) );
+
+    BOOST_CHECK_EQUAL( recorder.EndRecording().Size(), 7 + 1 );
+}
+
+
+/**
+ * The commands keep their own copy of the drawn data
+ */
+BOOST_AUTO_TEST_CASE( ArgumentsCopied )
+{
+    RECORDING_GAL recorder( m_options, m_target );
+
+    std::vector<VECTOR2D> points = { VECTOR2D( 1, 2 ), VECTOR2D( 3, 4 ) };
+
+    recorder.BeginRecording( 0.0 );
+    recorder.DrawPolyline( points );
+
+    GAL_DISPLAY_LIST list = recorder.EndRecording();
+
+    points.clear();
+    list.Replay( m_target );
+
+    BOOST_REQUIRE_EQUAL( m_target.m_entries.size(), 1 );
+    BOOST_CHECK_EQUAL( m_target.m_entries[0].m_start, VECTOR2D( 1, 2 ) );
+    BOOST_CHECK_EQUAL( m_target.m_entries[0].m_end, VECTOR2D( 3, 4 ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,174 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <qa_utils/geometry/geometry.h>
+
+#include <font/stroke_font.h>
+#include <font/text_cache.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+using namespace KIFONT;
+
+
+BOOST_AUTO_TEST_SUITE( TextCache )
+
+
+/**
+ * The least recently used entries are dropped beyond the memory budget
+ */
+BOOST_AUTO_TEST_CASE( Eviction )
+{
+    TEXT_CACHE<std::string, int> cache( 100 );
+
+    BOOST_CHECK( !cache.Get( "a" ) );
+
+    cache.Put( "a", std::make_shared<int>( 1 ), 40 );
+    cache.Put( "b", std::make_shared<int>( 2 ), 40 );
+
+    // "a" becomes the most recently used, so "b" is dropped for "c"
+    BOOST_CHECK_EQUAL( *cache.Get( "a" ), 1 );
+
+    cache.Put( "c", std::make_shared<int>( 3 ), 40 );
+
+    BOOST_CHECK( !cache.Get( "b" ) );
+    BOOST_CHECK_EQUAL( *cache.Get( "c" ), 3 );
+
+    TEXT_CACHE_STATS stats = cache.GetStats();
+
+    BOOST_CHECK_EQUAL( stats.m_Hits, 2 );
+    BOOST_CHECK_EQUAL( stats.m_Misses, 2 );
+    BOOST_CHECK_EQUAL( stats.m_Evictions, 1 );
+    BOOST_CHECK_EQUAL( stats.m_Entries, 2 );
+    BOOST_CHECK_EQUAL( stats.m_Bytes, 80 );
+    BOOST_CHECK_EQUAL( stats.HitRate(), 0.5 );
+
+    // Replacing an entry does not count it twice
+    cache.Put( "c", std::make_shared<int>( 4 ), 10 );
+
+    BOOST_CHECK_EQUAL( *cache.Get( "c" ), 4 );
+    BOOST_CHECK_EQUAL( cache.GetStats().m_Bytes, 50 );
+
+    cache.Clear();
+
+    BOOST_CHECK_EQUAL( cache.GetStats().m_Entries, 0 );
+    BOOST_CHECK_EQUAL( cache.GetStats().m_Bytes, 0 );
+}
+
+
+/**
+ * Text runs found in the cache are the same as the ones laid out
+ */
+BOOST_AUTO_TEST_CASE( TextRuns )
+{
+    std::unique_ptr<STROKE_FONT> font( STROKE_FONT::LoadFont( wxEmptyString ) );
+
+    const wxString text = wxS( "R1\t10k 0402" );
+    const VECTOR2I size( 1000, 1200 );
+    const VECTOR2I position( 500, -300 );
+
+    FONT::ClearCaches();
+    FONT::CACHE_STATS before = FONT::GetCacheStats();
+
+    std::vector<std::unique_ptr<GLYPH>> glyphs1;
+    std::vector<std::unique_ptr<GLYPH>> glyphs2;
+    BOX2I                               bbox1;
+    BOX2I                               bbox2;
+    BOX2I                               bbox3;
+
+    VECTOR2I cursor1 = font->GetTextAsGlyphs( &bbox1, &glyphs1, text, size, position,
+                                              ANGLE_90, true, VECTOR2I( 0, 0 ), 0 );
+    VECTOR2I cursor2 = font->GetTextAsGlyphs( &bbox2, &glyphs2, text, size, position,
+                                              ANGLE_90, true, VECTOR2I( 0, 0 ), 0 );
+    VECTOR2I cursor3 = font->GetTextAsGlyphs( &bbox3, nullptr, text, size, position,
+                                              ANGLE_90, true, VECTOR2I( 0, 0 ), 0 );
+
+    FONT::CACHE_STATS after = FONT::GetCacheStats();
+
+    BOOST_CHECK_EQUAL( after.m_TextRuns.m_Misses - before.m_TextRuns.m_Misses, 1 );
+    BOOST_CHECK_EQUAL( after.m_TextRuns.m_Hits - before.m_TextRuns.m_Hits, 2 );
+    BOOST_CHECK_EQUAL( after.m_TextRuns.m_Entries, 1 );
+
+    BOOST_CHECK_EQUAL( cursor1, cursor2 );
+    BOOST_CHECK_EQUAL( cursor1, cursor3 );
+    BOOST_CHECK_EQUAL( bbox1, bbox2 );
+    BOOST_CHECK_EQUAL( bbox1, bbox3 );
+
+    BOOST_REQUIRE_EQUAL( glyphs1.size(), glyphs2.size() );
+
+    // The callers get their own copies of the glyphs
+    BOOST_CHECK_NE( glyphs1.front().get(), glyphs2.front().get() );
+
+    for( size_t ii = 0; ii < glyphs1.size(); ++ii )
+    {
+        using STROKES = std::vector<std::vector<VECTOR2D>>;
+
+        const STROKES& strokes1 = static_cast<const STROKE_GLYPH&>( *glyphs1[ii] );
+        const STROKES& strokes2 = static_cast<const STROKE_GLYPH&>( *glyphs2[ii] );
+
+        BOOST_CHECK( strokes1 == strokes2 );
+    }
+
+    // Another position is another run
+    BOX2I    bbox4;
+    VECTOR2I cursor4 = font->GetTextAsGlyphs( &bbox4, nullptr, text, size, VECTOR2I( 0, 0 ),
+                                              ANGLE_0, false, VECTOR2I( 0, 0 ), 0 );
+
+    BOOST_CHECK_EQUAL( FONT::GetCacheStats().m_TextRuns.m_Entries, 2 );
+    BOOST_CHECK_NE( cursor4, cursor1 );
+}
+
+
+/**
+ * Fonts do not share their runs, even when one is created where another one was deleted
+ */
+BOOST_AUTO_TEST_CASE( FontsNotShared )
+{
+    const wxString text = wxS( "U12" );
+    const VECTOR2I size( 1000, 1000 );
+
+    FONT::ClearCaches();
+
+    std::unique_ptr<STROKE_FONT> font( STROKE_FONT::LoadFont( wxEmptyString ) );
+
+    font->GetTextAsGlyphs( nullptr, nullptr, text, size, VECTOR2I( 0, 0 ), ANGLE_0, false,
+                           VECTOR2I( 0, 0 ), 0 );
+
+    font.reset( STROKE_FONT::LoadFont( wxEmptyString ) );
+
+    FONT::CACHE_STATS before = FONT::GetCacheStats();
+
+    font->GetTextAsGlyphs( nullptr, nullptr, text, size, VECTOR2I( 0, 0 ), ANGLE_0, false,
+                           VECTOR2I( 0, 0 ), 0 );
+
+    FONT::CACHE_STATS after = FONT::GetCacheStats();
+
+    BOOST_CHECK_EQUAL( after.m_TextRuns.m_Misses - before.m_TextRuns.m_Misses, 1 );
+    BOOST_CHECK_EQUAL( after.m_TextRuns.m_Entries, 2 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
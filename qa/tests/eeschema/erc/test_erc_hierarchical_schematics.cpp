@@ -84,3 +84,50 @@ BOOST_FIXTURE_TEST_CASE( ERCHierarchicalSchematics, ERC_REGRESSION_TEST_FIXTURE
                                          << reportWriter.GetTextReport() );
     }
 }
+
+
+/**
+ * RunTests() runs the tests concurrently; the markers it leaves must not depend on scheduling.
+ */
+BOOST_FIXTURE_TEST_CASE( ERCRunTestsDeterministic, ERC_REGRESSION_TEST_FIXTURE )
+{
+    LOCALE_IO dummy;
+
+    KI_TEST::LoadSchematic( m_settingsManager, "issue10926_1", m_schematic );
+
+    ERC_SETTINGS& settings = m_schematic->ErcSettings();
+
+    settings.m_ERCSeverities[ERCE_LIB_SYMBOL_ISSUES] = RPT_SEVERITY_IGNORE;
+    settings.m_ERCSeverities[ERCE_LIB_SYMBOL_MISMATCH] = RPT_SEVERITY_IGNORE;
+
+    auto runERC =
+            [&]()
+            {
+                SCH_SCREENS screens( m_schematic->Root() );
+                screens.DeleteAllMarkers( MARKER_BASE::MARKER_ERC, true );
+
+                ERC_TESTER tester( m_schematic.get() );
+                tester.RunTests( nullptr, nullptr, nullptr, &m_schematic->Project(), nullptr );
+
+                SHEETLIST_ERC_ITEMS_PROVIDER errors( m_schematic.get() );
+                errors.SetSeverities( RPT_SEVERITY_ERROR | RPT_SEVERITY_WARNING );
+
+                std::vector<std::pair<int, KIID>> result;
+
+                for( int ii = 0; ii < errors.GetCount(); ++ii )
+                {
+                    std::shared_ptr<RC_ITEM> item = errors.GetItem( ii );
+                    result.emplace_back( item->GetErrorCode(), item->GetMainItemID() );
+                }
+
+                return result;
+            };
+
+    std::vector<std::pair<int, KIID>> first = runERC();
+
+    // At least the not-connected errors found by the individual tests above
+    BOOST_CHECK_GE( first.size(), 3 );
+
+    for( int run = 0; run < 5; ++run )
+        BOOST_CHECK( runERC() == first );
+}
@@ -161,4 +161,61 @@ BOOST_FIXTURE_TEST_CASE( RemoveAddItems, CONNECTIVITY_TEST_FIXTURE )
             }
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Re-resolving a net without changing it must leave its name and net code untouched.
+ */
+BOOST_FIXTURE_TEST_CASE( NetCodesSurviveIncrementalUpdate, CONNECTIVITY_TEST_FIXTURE )
+{
+    LOCALE_IO dummy;
+
+    KI_TEST::LoadSchematic( m_settingsManager, "issue7203", m_schematic );
+
+    SCH_SHEET_LIST sheets = m_schematic->BuildSheetListSortedByPageNumbers();
+
+    for( const SCH_SHEET_PATH& path : sheets )
+    {
+        std::vector<SCH_ITEM*> items;
+
+        for( SCH_ITEM* item : path.LastScreen()->Items() )
+        {
+            if( item->IsConnectable() && item->Type() != SCH_SYMBOL_T
+                    && item->Type() != SCH_SHEET_T )
+            {
+                items.push_back( item );
+            }
+        }
+
+        for( SCH_ITEM* item : items )
+        {
+            SCH_CONNECTION* connection = item->Connection( &path );
+
+            if( !connection || !connection->IsNet() )
+                continue;
+
+            wxString netname = connection->Name();
+            int      netcode = connection->NetCode();
+
+            std::set<std::pair<SCH_SHEET_PATH, SCH_ITEM*>> all_items =
+                    m_schematic->ConnectionGraph()->ExtractAffectedItems( { item } );
+            all_items.insert( { path, item } );
+
+            CONNECTION_GRAPH new_graph( m_schematic.get() );
+
+            new_graph.SetLastCodes( m_schematic->ConnectionGraph() );
+
+            for( auto& [itemPath, affected] : all_items )
+                affected->SetConnectivityDirty();
+
+            new_graph.Recalculate( sheets, false );
+            m_schematic->ConnectionGraph()->Merge( new_graph );
+
+            connection = item->Connection( &path );
+
+            BOOST_REQUIRE( connection );
+            BOOST_CHECK_EQUAL( connection->Name(), netname );
+            BOOST_CHECK_EQUAL( connection->NetCode(), netcode );
+        }
+    }
+}
@@ -23,6 +23,8 @@
 
 #include <sch_reference_list.h>
 #include <sch_sheet_path.h> // SCH_MULTI_UNIT_REFERENCE_MAP
+#include <refdes_tracker.h>
+#include <core/profile.h>
 
 
 struct REANNOTATED_REFERENCE
@@ -297,4 +299,66 @@ BOOST_AUTO_TEST_CASE( ReannotateDuplicates )
 }
 
 
+/**
+ * Annotating a whole design with the index of the numbers in use must give the same references
+ * as the plain scans of the list, for every order and algorithm.
+ */
+BOOST_AUTO_TEST_CASE( IndexedAnnotationMatchesScan )
+{
+    auto annotate =
+            [&]( ANNOTATE_ORDER_T aOrder, ANNOTATE_ALGO_T aAlgo, bool aIndexed, double& aTime )
+            {
+                SCH_SHEET_LIST sheets = m_schematic->BuildSheetListSortedByPageNumbers();
+                SCH_REFERENCE_LIST           refs;
+                SCH_MULTI_UNIT_REFERENCE_MAP lockedRefs;
+
+                sheets.GetMultiUnitSymbols( lockedRefs );
+                sheets.GetSymbols( refs );
+
+                refs.SetIndexedAnnotation( aIndexed );
+                refs.SetRefDesTracker( std::make_shared<REFDES_TRACKER>() );
+                refs.RemoveAnnotation();
+                refs.SplitReferences();
+
+                PROF_TIMER timer;
+                refs.AnnotateByOptions( aOrder, aAlgo, 0, lockedRefs, SCH_REFERENCE_LIST(), false );
+                aTime = timer.msecs();
+
+                std::map<wxString, wxString> result;
+
+                for( size_t ii = 0; ii < refs.GetCount(); ++ii )
+                    result[refs[ii].GetFullPath()] = refs[ii].GetFullRef();
+
+                return result;
+            };
+
+    for( const std::string& schematic : { "complex_hierarchy/complex_hierarchy", "video/video" } )
+    {
+        LoadSchematic( schematic );
+
+        for( ANNOTATE_ORDER_T order : { SORT_BY_X_POSITION, SORT_BY_Y_POSITION, UNSORTED } )
+        {
+            for( ANNOTATE_ALGO_T algo : { INCREMENTAL_BY_REF, SHEET_NUMBER_X_100,
+                                          SHEET_NUMBER_X_1000 } )
+            {
+                BOOST_TEST_INFO_SCOPE( schematic << " order " << order << " algo " << algo );
+
+                double scanTime = 0.0;
+                double indexedTime = 0.0;
+
+                std::map<wxString, wxString> scanned = annotate( order, algo, false, scanTime );
+                std::map<wxString, wxString> indexed = annotate( order, algo, true, indexedTime );
+
+                BOOST_CHECK( !indexed.empty() );
+                BOOST_CHECK( scanned == indexed );
+
+                BOOST_TEST_MESSAGE( schematic << " order " << order << " algo " << algo
+                                    << ": scan " << scanTime << " ms, indexed " << indexedTime
+                                    << " ms" );
+            }
+        }
+    }
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,7 @@
 #include "eeschema_test_utils.h"
 
 #include <schematic.h>
+#include <sch_symbol.h>
 #include <wildcards_and_files_ext.h>
 
 // Code under test
@@ -120,4 +121,69 @@ BOOST_AUTO_TEST_CASE( TestSharedByMultipleProjects )
 }
 
 
+/**
+ * Test the KIID index behind SCHEMATIC::ResolveItem().
+ */
+BOOST_AUTO_TEST_CASE( TestResolveItem )
+{
+    LoadSchematic( "schematic_object_tests/not_shared_by_multiple_projects/"
+                   "not_shared_by_multiple_projects" );
+
+    SCH_SCREEN*    screen = m_schematic->RootScreen();
+    SCH_SHEET_PATH rootPath = m_schematic->Hierarchy().at( 0 );
+    SCH_SYMBOL*    symbol = nullptr;
+
+    // Every item and child is indexed after loading
+    for( SCH_ITEM* item : screen->Items() )
+    {
+        BOOST_CHECK_EQUAL( m_schematic->ResolveItem( item->m_Uuid, nullptr, true ), item );
+
+        item->RunOnChildren(
+                [&]( SCH_ITEM* aChild )
+                {
+                    BOOST_CHECK_EQUAL( m_schematic->ResolveItem( aChild->m_Uuid, nullptr, true ),
+                                       aChild );
+                },
+                RECURSE_MODE::NO_RECURSE );
+
+        if( !symbol && item->Type() == SCH_SYMBOL_T )
+            symbol = static_cast<SCH_SYMBOL*>( item );
+    }
+
+    BOOST_REQUIRE( symbol );
+
+    KIID id = symbol->m_Uuid;
+
+    BOOST_CHECK( m_schematic->ResolveItem( KIID(), nullptr, true ) == nullptr );
+
+    screen->Remove( symbol );
+    BOOST_CHECK( m_schematic->ResolveItem( id, nullptr, true ) == nullptr );
+    BOOST_CHECK( rootPath.ResolveItem( id ) == nullptr );
+
+    screen->Append( symbol );
+    BOOST_CHECK_EQUAL( m_schematic->ResolveItem( id, nullptr, true ), symbol );
+    BOOST_CHECK_EQUAL( rootPath.ResolveItem( id ), symbol );
+
+    // Children added to an item are indexed once the screen is flagged as changed
+    SCH_FIELD* field = symbol->AddField( SCH_FIELD( symbol, FIELD_T::USER, wxS( "Test" ) ) );
+
+    screen->ItemsChanged();
+    BOOST_CHECK_EQUAL( m_schematic->ResolveItem( field->m_Uuid, nullptr, true ), field );
+
+    // So are KIIDs changed in place
+    const_cast<KIID&>( symbol->m_Uuid ) = KIID();
+    screen->ItemsChanged();
+    BOOST_CHECK( m_schematic->ResolveItem( id, nullptr, true ) == nullptr );
+
+    SCH_SHEET_PATH path;
+    BOOST_CHECK_EQUAL( m_schematic->ResolveItem( symbol->m_Uuid, &path, true ), symbol );
+    BOOST_CHECK( path.LastScreen() == screen );
+
+    // Screens staying in the hierarchy keep their entries
+    m_schematic->RefreshHierarchy();
+    BOOST_CHECK_EQUAL( m_schematic->ResolveItem( symbol->m_Uuid, nullptr, true ), symbol );
+    BOOST_CHECK_EQUAL( rootPath.ResolveItem( field->m_Uuid ), field );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
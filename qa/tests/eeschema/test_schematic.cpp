@@ -78,4 +78,34 @@ BOOST_AUTO_TEST_CASE( TestSchematicIsComplexHierarchy )
 }
 
 
+BOOST_AUTO_TEST_CASE( TestSchematicHierarchySnapshot )
+{
+    LoadSchematic( "netlists/complex_hierarchy/complex_hierarchy" );
+
+    const SCH_SHEET_LIST& hierarchy = m_schematic->Hierarchy();
+    uint64_t              generation = m_schematic->HierarchyGeneration();
+
+    // Repeated calls hand out the same list instead of a copy
+    BOOST_CHECK_EQUAL( &hierarchy, &m_schematic->Hierarchy() );
+
+    std::shared_ptr<const SCH_SHEET_LIST> snapshot = m_schematic->HierarchySnapshot();
+    SCH_SHEET_LIST                        expected = *snapshot;
+
+    m_schematic->RefreshHierarchy();
+
+    BOOST_CHECK_GT( m_schematic->HierarchyGeneration(), generation );
+    BOOST_CHECK_NE( snapshot.get(), &m_schematic->Hierarchy() );
+
+    // The old snapshot is untouched by the refresh
+    BOOST_REQUIRE_EQUAL( snapshot->size(), expected.size() );
+    BOOST_REQUIRE_EQUAL( m_schematic->Hierarchy().size(), expected.size() );
+
+    for( size_t ii = 0; ii < expected.size(); ii++ )
+    {
+        BOOST_CHECK( snapshot->at( ii ) == expected[ii] );
+        BOOST_CHECK( m_schematic->Hierarchy()[ii] == expected[ii] );
+    }
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,236 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Check the output of the Gerber plotter optimizations by reading it back with the Gerber
+ * file reader of GerbView.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <gbr_metadata.h>
+#include <gerber_draw_item.h>
+#include <gerber_file_image.h>
+#include <geometry/shape_poly_set.h>
+#include <plotters/plotter_gerber.h>
+
+
+// Board internal units per decimil (1 IU = 1 nm)
+static const double IU_PER_DECIMIL = 2540.0;
+
+
+/**
+ * A zone-like fill: a grid of squares and triangles (islands of a thermal relief pattern).
+ */
+static SHAPE_POLY_SET makeFill()
+{
+    SHAPE_POLY_SET fill;
+
+    for( int row = 0; row < 10; ++row )
+    {
+        for( int col = 0; col < 10; ++col )
+        {
+            int x = col * 2000000;
+            int y = row * 2000000;
+
+            fill.NewOutline();
+            fill.Append( x, y );
+            fill.Append( x + 1000000, y );
+
+            if( ( row + col ) % 2 )
+                fill.Append( x + 1000000, y + 1000000 );
+
+            fill.Append( x, y + 1000000 );
+        }
+    }
+
+    return fill;
+}
+
+
+static wxString plotFill( const SHAPE_POLY_SET& aFill, bool aMerged )
+{
+    wxString fileName = wxFileName::CreateTempFileName( wxS( "kicad-qa-gbr" ) );
+
+    GERBER_PLOTTER plotter;
+    plotter.SetViewport( VECTOR2I( 0, 0 ), IU_PER_DECIMIL, 1.0, false );
+    plotter.SetGerberCoordinatesFormat( 6 );
+
+    BOOST_REQUIRE( plotter.OpenFile( fileName ) );
+    BOOST_REQUIRE( plotter.StartPlot( wxS( "1" ) ) );
+
+    GBR_METADATA metadata;
+    metadata.SetNetName( wxS( "GND" ) );
+    metadata.SetApertureAttrib( GBR_APERTURE_METADATA::GBR_APERTURE_ATTRIB_CONDUCTOR );
+    metadata.SetNetAttribType( GBR_NETLIST_METADATA::GBR_NETINFO_NET );
+
+    if( aMerged )
+    {
+        plotter.PlotGerberRegion( aFill, &metadata );
+    }
+    else
+    {
+        for( int ii = 0; ii < aFill.OutlineCount(); ++ii )
+            plotter.PlotGerberRegion( aFill.COutline( ii ), &metadata );
+    }
+
+    plotter.EndPlot();
+
+    return fileName;
+}
+
+
+/**
+ * Read a Gerber file and return the union of its regions.
+ */
+static SHAPE_POLY_SET readRegions( const wxString& aFileName, size_t* aRegionCount )
+{
+    GERBER_FILE_IMAGE image( 0 );
+    SHAPE_POLY_SET    regions;
+
+    BOOST_REQUIRE( image.LoadGerberFile( aFileName ) );
+
+    *aRegionCount = 0;
+
+    for( GERBER_DRAW_ITEM* item : image.GetItems() )
+    {
+        if( item->m_ShapeType != GBR_POLYGON )
+            continue;
+
+        regions.Append( item->m_ShapeAsPolygon );
+        ( *aRegionCount )++;
+    }
+
+    regions.Simplify();
+    return regions;
+}
+
+
+static wxString readFile( const wxString& aFileName )
+{
+    wxFFile  file( aFileName, wxS( "rb" ) );
+    wxString content;
+
+    BOOST_REQUIRE( file.IsOpened() && file.ReadAll( &content ) );
+    return content;
+}
+
+
+static int countOf( const wxString& aContent, const wxString& aCommand )
+{
+    int    count = 0;
+    size_t pos = aContent.find( aCommand );
+
+    while( pos != wxString::npos )
+    {
+        count++;
+        pos = aContent.find( aCommand, pos + aCommand.length() );
+    }
+
+    return count;
+}
+
+
+BOOST_AUTO_TEST_SUITE( GerberPlotterRegions )
+
+
+BOOST_AUTO_TEST_CASE( MergedRegionMatchesSeparateRegions )
+{
+    SHAPE_POLY_SET fill = makeFill();
+    wxString       mergedFile = plotFill( fill, true );
+    wxString       separateFile = plotFill( fill, false );
+
+    size_t         mergedCount = 0;
+    size_t         separateCount = 0;
+    SHAPE_POLY_SET merged = readRegions( mergedFile, &mergedCount );
+    SHAPE_POLY_SET separate = readRegions( separateFile, &separateCount );
+
+    // Each contour of the merged region is still read as a separate polygon
+    BOOST_CHECK_EQUAL( mergedCount, (size_t) fill.OutlineCount() );
+    BOOST_CHECK_EQUAL( separateCount, (size_t) fill.OutlineCount() );
+
+    BOOST_REQUIRE( merged.Area() > 0.0 );
+    BOOST_CHECK_CLOSE( merged.Area(), separate.Area(), 1e-9 );
+
+    // Same coverage
+    SHAPE_POLY_SET diff = merged;
+    diff.BooleanXor( separate );
+    BOOST_CHECK_SMALL( diff.Area(), 1.0 );
+
+    wxString mergedContent = readFile( mergedFile );
+    wxString separateContent = readFile( separateFile );
+
+    BOOST_CHECK_EQUAL( countOf( mergedContent, wxS( "G36*" ) ), 1 );
+    BOOST_CHECK_EQUAL( countOf( separateContent, wxS( "G36*" ) ), fill.OutlineCount() );
+    BOOST_CHECK( mergedContent.Length() < separateContent.Length() );
+
+    wxRemoveFile( mergedFile );
+    wxRemoveFile( separateFile );
+}
+
+
+BOOST_AUTO_TEST_CASE( FreePolygonApertureReuse )
+{
+    GERBER_PLOTTER plotter;
+    plotter.SetViewport( VECTOR2I( 0, 0 ), IU_PER_DECIMIL, 1.0, false );
+
+    std::vector<VECTOR2I> shape = { { -15, -500 }, { 500, -500 }, { 500, 500 }, { -15, 500 } };
+
+    // Within the 2 IU tolerance, first corner in the neighbouring lookup cell
+    std::vector<VECTOR2I> similar = { { -17, -501 }, { 501, -500 }, { 500, 499 }, { -16, 500 } };
+
+    std::vector<VECTOR2I> other = { { 0, 0 }, { 700, 0 }, { 700, 700 }, { 0, 700 } };
+
+    int first = plotter.GetOrCreateAperture( shape, ANGLE_0, APERTURE::AM_FREE_POLYGON, 0, "" );
+
+    BOOST_CHECK_EQUAL( plotter.GetOrCreateAperture( similar, ANGLE_0, APERTURE::AM_FREE_POLYGON,
+                                                    0, "" ),
+                       first );
+
+    int rotated = plotter.GetOrCreateAperture( shape, ANGLE_90, APERTURE::AM_FREE_POLYGON, 0, "" );
+    int different = plotter.GetOrCreateAperture( other, ANGLE_0, APERTURE::AM_FREE_POLYGON, 0, "" );
+
+    BOOST_CHECK_NE( rotated, first );
+    BOOST_CHECK_NE( different, first );
+    BOOST_CHECK_NE( different, rotated );
+
+    BOOST_CHECK_EQUAL( plotter.GetOrCreateAperture( other, ANGLE_0, APERTURE::AM_FREE_POLYGON,
+                                                    0, "" ),
+                       different );
+
+    int circle = plotter.GetOrCreateAperture( VECTOR2I( 100, 100 ), 0, ANGLE_0,
+                                              APERTURE::AT_CIRCLE, 0, "" );
+
+    BOOST_CHECK_EQUAL( plotter.GetOrCreateAperture( VECTOR2I( 100, 100 ), 0, ANGLE_0,
+                                                    APERTURE::AT_CIRCLE, 0, "" ),
+                       circle );
+    BOOST_CHECK_NE( plotter.GetOrCreateAperture( VECTOR2I( 100, 100 ), 0, ANGLE_0,
+                                                 APERTURE::AT_CIRCLE, 1, "" ),
+                    circle );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
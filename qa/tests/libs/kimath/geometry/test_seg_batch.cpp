@@ -0,0 +1,137 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <limits>
+#include <random>
+
+#include <geometry/seg_batch.h>
+
+
+BOOST_AUTO_TEST_SUITE( SegBatch )
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    SEG_BATCH batch;
+    int       index = 0;
+
+    BOOST_CHECK_EQUAL( batch.SquaredDistance( SEG( 0, 0, 10, 10 ), &index ),
+                       VECTOR2I::ECOORD_MAX );
+    BOOST_CHECK_EQUAL( index, -1 );
+    BOOST_CHECK_EQUAL( batch.Collide( SEG( 0, 0, 10, 10 ), 100 ), -1 );
+}
+
+
+/**
+ * The batch must give exactly the same answers as the per-segment routines, at small and at
+ * large coordinate scales (where the double precision bounds matter).
+ */
+BOOST_AUTO_TEST_CASE( MatchesSingleSegmentRoutines )
+{
+    std::mt19937 rng( 7 );
+
+    for( int scale : { 1000, 100000, 100000000 } )
+    {
+        std::uniform_int_distribution<int> pos( -scale, scale );
+        std::uniform_int_distribution<int> len( -scale / 20, scale / 20 );
+
+        auto randomSeg =
+                [&]()
+                {
+                    int x = pos( rng );
+                    int y = pos( rng );
+                    return SEG( x, y, x + len( rng ), y + len( rng ) );
+                };
+
+        for( int test = 0; test < 100; test++ )
+        {
+            std::vector<SEG> segs;
+
+            // Not a multiple of the SIMD width, so that the scalar tail gets exercised too
+            for( int i = 0; i < 203; i++ )
+                segs.push_back( randomSeg() );
+
+            SEG_BATCH batch( segs );
+            SEG       query = randomSeg();
+
+            SEG::ecoord expDist = VECTOR2I::ECOORD_MAX;
+            int         expIndex = -1;
+
+            for( size_t i = 0; i < segs.size(); i++ )
+            {
+                SEG::ecoord d = segs[i].SquaredDistance( query );
+
+                if( d < expDist )
+                {
+                    expDist = d;
+                    expIndex = (int) i;
+                }
+            }
+
+            int index = -2;
+            BOOST_CHECK_EQUAL( batch.SquaredDistance( query, &index ), expDist );
+            BOOST_CHECK_EQUAL( index, expIndex );
+
+            int clearance = scale / 10;
+
+            for( bool first : { false, true } )
+            {
+                int closest = std::numeric_limits<int>::max();
+                int closestIndex = -1;
+
+                for( size_t i = 0; i < segs.size(); i++ )
+                {
+                    int dist = 0;
+
+                    if( !query.Collide( segs[i], clearance, &dist ) )
+                        continue;
+
+                    if( closestIndex < 0 || dist < closest )
+                    {
+                        closest = dist;
+                        closestIndex = (int) i;
+                    }
+
+                    if( closest == 0 || first )
+                        break;
+                }
+
+                int actual = -1;
+                BOOST_CHECK_EQUAL( batch.Collide( query, clearance, &actual, first ),
+                                   closestIndex );
+
+                if( closestIndex >= 0 )
+                    BOOST_CHECK_EQUAL( actual, closest );
+
+                // The closest segment does not depend on the caller asking for the distance
+                BOOST_CHECK_EQUAL( batch.Collide( query, clearance, nullptr, first ),
+                                   closestIndex );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
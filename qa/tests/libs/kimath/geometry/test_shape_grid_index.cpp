@@ -0,0 +1,243 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
+
+#include <geometry/shape_grid_index.h>
+#include <geometry/shape_rect.h>
+#include <geometry/shape_segment.h>
+
+
+namespace
+{
+
+struct TEST_ITEM
+{
+    SHAPE_RECT m_rect;
+
+    const SHAPE* Shape( int aLayer ) const { return &m_rect; }
+};
+
+
+struct TEST_SEGMENT
+{
+    SHAPE_SEGMENT m_seg;
+
+    const SHAPE* Shape( int aLayer ) const { return &m_seg; }
+};
+
+
+struct COLLECTOR
+{
+    std::multiset<const TEST_ITEM*> m_found;
+    size_t                          m_limit = std::numeric_limits<size_t>::max();
+
+    bool operator()( const TEST_ITEM* aItem )
+    {
+        m_found.insert( aItem );
+        return m_found.size() < m_limit;
+    }
+};
+
+
+std::set<const TEST_ITEM*> bruteForce( const std::vector<std::unique_ptr<TEST_ITEM>>& aItems,
+                                       const BOX2I& aBox )
+{
+    std::set<const TEST_ITEM*> result;
+
+    for( const std::unique_ptr<TEST_ITEM>& item : aItems )
+    {
+        BOX2I bb = item->m_rect.BBox();
+
+        if( bb.GetX() <= aBox.GetRight() && aBox.GetX() <= bb.GetRight()
+            && bb.GetY() <= aBox.GetBottom() && aBox.GetY() <= bb.GetBottom() )
+        {
+            result.insert( item.get() );
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( ShapeGridIndex )
+
+
+/**
+ * Random small and large items around the origin, queried with random boxes: each overlapping
+ * item must be reported exactly once.
+ */
+BOOST_AUTO_TEST_CASE( MatchesBruteForce )
+{
+    std::mt19937                            rng( 42 );
+    std::uniform_int_distribution<int>      pos( -50000, 50000 );
+    std::uniform_int_distribution<int>      size( 1, 3000 );
+    std::vector<std::unique_ptr<TEST_ITEM>> items;
+
+    SHAPE_GRID_INDEX<const TEST_ITEM*> index( 0, 1000 );
+
+    for( int i = 0; i < 2000; i++ )
+    {
+        // Every 100th item is large enough to end up in the oversized list
+        int w = ( i % 100 ) ? size( rng ) : 40000;
+        int h = ( i % 100 ) ? size( rng ) : 30000;
+
+        items.push_back( std::make_unique<TEST_ITEM>( TEST_ITEM{ SHAPE_RECT( pos( rng ), pos( rng ),
+                                                                             w, h ) } ) );
+        index.Add( items.back().get() );
+    }
+
+    // Remove every third item
+    for( size_t i = 0; i < items.size(); i += 3 )
+        index.Remove( items[i].get() );
+
+    std::vector<std::unique_ptr<TEST_ITEM>> remaining;
+
+    for( size_t i = 0; i < items.size(); i++ )
+    {
+        if( i % 3 )
+            remaining.push_back( std::move( items[i] ) );
+    }
+
+    BOOST_CHECK_EQUAL( index.Size(), remaining.size() );
+
+    for( int q = 0; q < 200; q++ )
+    {
+        // Mix small queries with ones large enough to take the sparse walk path
+        int        extent = ( q % 10 ) ? size( rng ) : 80000;
+        SHAPE_RECT query( pos( rng ), pos( rng ), extent, extent );
+        int        clearance = q % 500;
+        BOX2I      box = query.BBox();
+
+        box.Inflate( clearance );
+
+        COLLECTOR collector;
+        int       count = index.Query( &query, clearance, collector );
+
+        std::set<const TEST_ITEM*> expected = bruteForce( remaining, box );
+        std::set<const TEST_ITEM*> found( collector.m_found.begin(), collector.m_found.end() );
+
+        BOOST_CHECK_EQUAL( count, (int) expected.size() );
+        BOOST_CHECK_EQUAL( collector.m_found.size(), expected.size() );
+        BOOST_CHECK( found == expected );
+    }
+}
+
+
+/**
+ * Long diagonal segments are stored along their path: every segment touching the query area
+ * must be reported exactly once, and only segments whose bounding box overlaps it.
+ */
+BOOST_AUTO_TEST_CASE( LongSegments )
+{
+    std::mt19937                               rng( 7 );
+    std::uniform_int_distribution<int>         pos( -500000, 500000 );
+    std::uniform_int_distribution<int>         width( 100, 1000 );
+    std::vector<std::unique_ptr<TEST_SEGMENT>> segs;
+
+    SHAPE_GRID_INDEX<const TEST_SEGMENT*> index( 0, 1000 );
+
+    for( int i = 0; i < 500; i++ )
+    {
+        SHAPE_SEGMENT seg( VECTOR2I( pos( rng ), pos( rng ) ), VECTOR2I( pos( rng ), pos( rng ) ),
+                           width( rng ) );
+
+        segs.push_back( std::make_unique<TEST_SEGMENT>( TEST_SEGMENT{ seg } ) );
+        index.Add( segs.back().get() );
+    }
+
+    for( int q = 0; q < 200; q++ )
+    {
+        SHAPE_RECT                         query( pos( rng ), pos( rng ), 5000, 5000 );
+        BOX2I                              box = query.BBox();
+        std::multiset<const TEST_SEGMENT*> reported;
+
+        auto visitor =
+                [&]( const TEST_SEGMENT* aSeg )
+                {
+                    reported.insert( aSeg );
+                    return true;
+                };
+
+        int count = index.Query( &query, 0, visitor );
+
+        std::set<const TEST_SEGMENT*> found( reported.begin(), reported.end() );
+
+        BOOST_CHECK_EQUAL( count, (int) reported.size() );
+        BOOST_CHECK_EQUAL( found.size(), reported.size() );
+
+        for( const std::unique_ptr<TEST_SEGMENT>& seg : segs )
+        {
+            BOX2I bb = seg->m_seg.BBox();
+
+            if( seg->m_seg.Collide( &query, 0 ) )
+                BOOST_CHECK( found.count( seg.get() ) );
+
+            if( found.count( seg.get() ) )
+            {
+                BOOST_CHECK( bb.GetX() <= box.GetRight() && box.GetX() <= bb.GetRight()
+                             && bb.GetY() <= box.GetBottom() && box.GetY() <= bb.GetBottom() );
+            }
+        }
+    }
+
+    for( const std::unique_ptr<TEST_SEGMENT>& seg : segs )
+        index.Remove( seg.get() );
+
+    BOOST_CHECK_EQUAL( index.Size(), 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( StopsWhenVisitorReturnsFalse )
+{
+    std::vector<std::unique_ptr<TEST_ITEM>> items;
+    SHAPE_GRID_INDEX<const TEST_ITEM*>      index( 0, 100 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        items.push_back( std::make_unique<TEST_ITEM>( TEST_ITEM{ SHAPE_RECT( i * 150, 0, 100,
+                                                                             100 ) } ) );
+        index.Add( items.back().get() );
+    }
+
+    SHAPE_RECT query( 0, 0, 1500, 100 );
+    COLLECTOR  collector;
+
+    collector.m_limit = 3;
+    index.Query( &query, 0, collector );
+
+    BOOST_CHECK_EQUAL( collector.m_found.size(), 3 );
+
+    index.RemoveAll();
+    BOOST_CHECK_EQUAL( index.Size(), 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,381 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Check the simplified versions of the 3D models used by the OpenGL viewer.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cfloat>
+#include <cstring>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <3d_cache/3d_model_lod.h>
+#include <plugins/3dapi/ifsg_api.h>
+
+
+static SMESH makeMesh( const std::vector<SFVEC3F>& aPositions,
+                       const std::vector<unsigned int>& aIndices, unsigned int aMaterial )
+{
+    SMESH mesh;
+    S3D::Init3DMesh( mesh );
+
+    mesh.m_MaterialIdx = aMaterial;
+    mesh.m_VertexSize = aPositions.size();
+    mesh.m_Positions = new SFVEC3F[aPositions.size()];
+    mesh.m_Normals = new SFVEC3F[aPositions.size()];
+
+    for( size_t ii = 0; ii < aPositions.size(); ++ii )
+    {
+        mesh.m_Positions[ii] = aPositions[ii];
+        mesh.m_Normals[ii] = glm::normalize( aPositions[ii] );
+    }
+
+    mesh.m_FaceIdxSize = aIndices.size();
+    mesh.m_FaceIdx = new unsigned int[aIndices.size()];
+    std::copy( aIndices.begin(), aIndices.end(), mesh.m_FaceIdx );
+
+    return mesh;
+}
+
+
+static S3DMODEL* makeModel( const std::vector<SMESH>& aMeshes )
+{
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = 2;
+    model->m_Materials = new SMATERIAL[2];
+
+    for( unsigned int ii = 0; ii < 2; ++ii )
+    {
+        S3D::Init3DMaterial( model->m_Materials[ii] );
+        model->m_Materials[ii].m_Diffuse = SFVEC3F( 0.2f, 0.4f * ii, 0.8f );
+    }
+
+    model->m_MeshesSize = aMeshes.size();
+    model->m_Meshes = new SMESH[aMeshes.size()];
+    std::copy( aMeshes.begin(), aMeshes.end(), model->m_Meshes );
+
+    return model;
+}
+
+
+/**
+ * A finely tessellated sphere of radius 1, as two hemispheres of different materials.  The
+ * first one has vertex colors, the second one texture coordinates.
+ */
+static S3DMODEL* makeSphere()
+{
+    const int segments = 256;
+    const int rings = 64;      // per hemisphere
+
+    std::vector<SMESH> meshes;
+
+    for( int half = 0; half < 2; ++half )
+    {
+        std::vector<SFVEC3F>      positions;
+        std::vector<unsigned int> indices;
+
+        for( int ring = 0; ring <= rings; ++ring )
+        {
+            float theta = glm::half_pi<float>() * ( half + (float) ring / rings );
+
+            for( int seg = 0; seg <= segments; ++seg )
+            {
+                float phi = glm::two_pi<float>() * seg / segments;
+
+                positions.emplace_back( std::sin( theta ) * std::cos( phi ),
+                                        std::sin( theta ) * std::sin( phi ), std::cos( theta ) );
+            }
+        }
+
+        for( int ring = 0; ring < rings; ++ring )
+        {
+            for( int seg = 0; seg < segments; ++seg )
+            {
+                unsigned int a = ring * ( segments + 1 ) + seg;
+                unsigned int b = a + segments + 1;
+
+                indices.insert( indices.end(), { a, b, a + 1, a + 1, b, b + 1 } );
+            }
+        }
+
+        SMESH mesh = makeMesh( positions, indices, half );
+
+        if( half == 0 )
+        {
+            mesh.m_Color = new SFVEC3F[mesh.m_VertexSize];
+
+            for( unsigned int ii = 0; ii < mesh.m_VertexSize; ++ii )
+                mesh.m_Color[ii] = glm::abs( mesh.m_Positions[ii] );
+        }
+        else
+        {
+            mesh.m_Texcoords = new SFVEC2F[mesh.m_VertexSize];
+
+            for( unsigned int ii = 0; ii < mesh.m_VertexSize; ++ii )
+                mesh.m_Texcoords[ii] = SFVEC2F( mesh.m_Positions[ii] );
+        }
+
+        meshes.push_back( mesh );
+    }
+
+    return makeModel( meshes );
+}
+
+
+static S3DMODEL* makeBox()
+{
+    std::vector<SFVEC3F> positions;
+
+    for( int ii = 0; ii < 8; ++ii )
+        positions.emplace_back( ii & 1 ? 1.0f : -1.0f, ii & 2 ? 1.0f : -1.0f, ii & 4 ? 1.0f : -1.0f );
+
+    std::vector<unsigned int> indices = { 0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6,
+                                          0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7,
+                                          0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 };
+
+    return makeModel( { makeMesh( positions, indices, 0 ) } );
+}
+
+
+static void getBBox( const S3DMODEL& aModel, SFVEC3F& aMin, SFVEC3F& aMax )
+{
+    aMin = SFVEC3F( FLT_MAX );
+    aMax = SFVEC3F( -FLT_MAX );
+
+    for( unsigned int ii = 0; ii < aModel.m_MeshesSize; ++ii )
+    {
+        for( unsigned int jj = 0; jj < aModel.m_Meshes[ii].m_VertexSize; ++jj )
+        {
+            aMin = glm::min( aMin, aModel.m_Meshes[ii].m_Positions[jj] );
+            aMax = glm::max( aMax, aModel.m_Meshes[ii].m_Positions[jj] );
+        }
+    }
+}
+
+
+static bool sameMesh( const SMESH& aA, const SMESH& aB )
+{
+    if( aA.m_MaterialIdx != aB.m_MaterialIdx || aA.m_VertexSize != aB.m_VertexSize
+            || aA.m_FaceIdxSize != aB.m_FaceIdxSize
+            || ( aA.m_Color == nullptr ) != ( aB.m_Color == nullptr )
+            || ( aA.m_Texcoords == nullptr ) != ( aB.m_Texcoords == nullptr ) )
+    {
+        return false;
+    }
+
+    size_t vec3Size = sizeof( SFVEC3F ) * aA.m_VertexSize;
+
+    return !memcmp( aA.m_Positions, aB.m_Positions, vec3Size )
+           && !memcmp( aA.m_Normals, aB.m_Normals, vec3Size )
+           && ( !aA.m_Color || !memcmp( aA.m_Color, aB.m_Color, vec3Size ) )
+           && ( !aA.m_Texcoords
+                || !memcmp( aA.m_Texcoords, aB.m_Texcoords, sizeof( SFVEC2F ) * aA.m_VertexSize ) )
+           && !memcmp( aA.m_FaceIdx, aB.m_FaceIdx, sizeof( unsigned int ) * aA.m_FaceIdxSize );
+}
+
+
+static bool sameModel( const S3DMODEL& aA, const S3DMODEL& aB )
+{
+    if( aA.m_MeshesSize != aB.m_MeshesSize )
+        return false;
+
+    for( unsigned int ii = 0; ii < aA.m_MeshesSize; ++ii )
+    {
+        if( !sameMesh( aA.m_Meshes[ii], aB.m_Meshes[ii] ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+static void destroyLods( std::vector<S3DMODEL*>& aLods )
+{
+    for( S3DMODEL*& lod : aLods )
+        S3D::Destroy3DModel( &lod );
+
+    aLods.clear();
+}
+
+
+BOOST_AUTO_TEST_SUITE( Model3dLod )
+
+
+BOOST_AUTO_TEST_CASE( Simplify )
+{
+    S3DMODEL* sphere = makeSphere();
+    S3DMODEL* lod = S3D::SimplifyModel( *sphere, S3D::LOD_GRID_SIZES[0] );
+
+    BOOST_REQUIRE( lod );
+    BOOST_CHECK_LT( S3D::GetTriangleCount( *lod ), S3D::GetTriangleCount( *sphere ) * 0.6 );
+
+    // The meshes, their materials and their optional attributes are kept
+    BOOST_REQUIRE_EQUAL( lod->m_MeshesSize, 2 );
+    BOOST_REQUIRE_EQUAL( lod->m_MaterialsSize, 2 );
+    BOOST_CHECK( lod->m_Materials != sphere->m_Materials );
+    BOOST_CHECK_EQUAL( lod->m_Materials[1].m_Diffuse.y, sphere->m_Materials[1].m_Diffuse.y );
+    BOOST_CHECK_EQUAL( lod->m_Meshes[1].m_MaterialIdx, 1 );
+    BOOST_CHECK( lod->m_Meshes[0].m_Color && !lod->m_Meshes[0].m_Texcoords );
+    BOOST_CHECK( !lod->m_Meshes[1].m_Color && lod->m_Meshes[1].m_Texcoords );
+
+    for( unsigned int ii = 0; ii < lod->m_MeshesSize; ++ii )
+    {
+        const SMESH& mesh = lod->m_Meshes[ii];
+
+        for( unsigned int jj = 0; jj < mesh.m_FaceIdxSize; ++jj )
+            BOOST_REQUIRE_LT( mesh.m_FaceIdx[jj], mesh.m_VertexSize );
+
+        for( unsigned int jj = 0; jj < mesh.m_VertexSize; ++jj )
+        {
+            BOOST_REQUIRE_CLOSE( glm::length( mesh.m_Normals[jj] ), 1.0f, 1e-3 );
+
+            // On a sphere, the average of close vertices is close to the surface
+            BOOST_REQUIRE_GT( glm::length( mesh.m_Positions[jj] ), 0.9f );
+        }
+    }
+
+    // The shape stays the same within a grid cell
+    const float cellSize = 2.0f / S3D::LOD_GRID_SIZES[0];
+    SFVEC3F     srcMin, srcMax, lodMin, lodMax;
+
+    getBBox( *sphere, srcMin, srcMax );
+    getBBox( *lod, lodMin, lodMax );
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+        BOOST_CHECK_LE( srcMin[axis], lodMin[axis] );
+        BOOST_CHECK_GE( srcMax[axis], lodMax[axis] );
+        BOOST_CHECK_LT( lodMin[axis] - srcMin[axis], cellSize );
+        BOOST_CHECK_LT( srcMax[axis] - lodMax[axis], cellSize );
+    }
+
+    // The same model always gives the same result, so cached levels don't change
+    S3DMODEL* again = S3D::SimplifyModel( *sphere, S3D::LOD_GRID_SIZES[0] );
+
+    BOOST_REQUIRE( again );
+    BOOST_CHECK( sameModel( *lod, *again ) );
+
+    S3D::Destroy3DModel( &again );
+    S3D::Destroy3DModel( &lod );
+    S3D::Destroy3DModel( &sphere );
+}
+
+
+BOOST_AUTO_TEST_CASE( BuildLevels )
+{
+    S3DMODEL*              sphere = makeSphere();
+    std::vector<S3DMODEL*> lods;
+
+    S3D::BuildLods( *sphere, lods );
+
+    BOOST_REQUIRE_EQUAL( lods.size(), S3D::LOD_LEVELS );
+    BOOST_CHECK_LT( S3D::GetTriangleCount( *lods[0] ), S3D::GetTriangleCount( *sphere ) );
+    BOOST_CHECK_LT( S3D::GetTriangleCount( *lods[1] ), S3D::GetTriangleCount( *lods[0] ) );
+
+    destroyLods( lods );
+    S3D::Destroy3DModel( &sphere );
+
+    // A simple model is drawn as it is
+    S3DMODEL* box = makeBox();
+
+    BOOST_CHECK( !S3D::SimplifyModel( *box, S3D::LOD_GRID_SIZES[1] ) );
+
+    S3D::BuildLods( *box, lods );
+    BOOST_CHECK( lods.empty() );
+
+    S3D::Destroy3DModel( &box );
+}
+
+
+BOOST_AUTO_TEST_CASE( SelectLevel )
+{
+    BOOST_CHECK_EQUAL( S3D::SelectLod( 1000.0f, 2 ), 0 );
+    BOOST_CHECK_EQUAL( S3D::SelectLod( S3D::LOD_GRID_SIZES[0] * 2.0f, 2 ), 0 );
+    BOOST_CHECK_EQUAL( S3D::SelectLod( S3D::LOD_GRID_SIZES[0] * 2.0f - 1.0f, 2 ), 1 );
+    BOOST_CHECK_EQUAL( S3D::SelectLod( 1.0f, 2 ), 2 );
+
+    // Only the available levels are used
+    BOOST_CHECK_EQUAL( S3D::SelectLod( 1.0f, 1 ), 1 );
+    BOOST_CHECK_EQUAL( S3D::SelectLod( 1.0f, 0 ), 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( CacheFile )
+{
+    wxString fileName = wxFileName::CreateTempFileName( wxS( "kicad-qa-lod" ) );
+
+    S3DMODEL*              sphere = makeSphere();
+    std::vector<S3DMODEL*> lods;
+    std::vector<S3DMODEL*> loaded;
+
+    S3D::BuildLods( *sphere, lods );
+
+    BOOST_REQUIRE( S3D::WriteLodCache( fileName, *sphere, lods ) );
+    BOOST_REQUIRE( S3D::ReadLodCache( fileName, *sphere, loaded ) );
+
+    BOOST_REQUIRE_EQUAL( loaded.size(), lods.size() );
+
+    for( size_t ii = 0; ii < lods.size(); ++ii )
+    {
+        BOOST_CHECK( sameModel( *lods[ii], *loaded[ii] ) );
+        BOOST_CHECK_EQUAL( loaded[ii]->m_MaterialsSize, sphere->m_MaterialsSize );
+    }
+
+    destroyLods( loaded );
+
+    // The levels of another model are rejected
+    S3DMODEL* box = makeBox();
+
+    BOOST_CHECK( !S3D::ReadLodCache( fileName, *box, loaded ) );
+    BOOST_CHECK( loaded.empty() );
+
+    S3D::Destroy3DModel( &box );
+
+    // A truncated file is rejected
+    {
+        wxFFile           file( fileName, wxT( "rb" ) );
+        std::vector<char> data( file.Length() );
+
+        BOOST_REQUIRE( file.Read( data.data(), data.size() ) == data.size() );
+        file.Close();
+
+        BOOST_REQUIRE( file.Open( fileName, wxT( "wb" ) ) );
+        file.Write( data.data(), data.size() / 2 );
+    }
+
+    BOOST_CHECK( !S3D::ReadLodCache( fileName, *sphere, loaded ) );
+    BOOST_CHECK( loaded.empty() );
+
+    destroyLods( lods );
+    S3D::Destroy3DModel( &sphere );
+    wxRemoveFile( fileName );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
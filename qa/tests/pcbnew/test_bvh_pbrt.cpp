@@ -0,0 +1,177 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Check the traversal of the raytracer's BVH against a brute force test of all the objects.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <limits>
+#include <random>
+
+#include <3d_rendering/raytracing/accelerators/bvh_pbrt.h>
+#include <3d_rendering/raytracing/accelerators/container_3d.h>
+#include <3d_rendering/raytracing/hitinfo.h>
+#include <3d_rendering/raytracing/shapes3D/dummy_block_3d.h>
+#include <3d_rendering/raytracing/shapes3D/triangle_3d.h>
+
+
+/**
+ * A board-like scene: flat blocks (layers, pads) and small boxes and triangles above them
+ * (3D models).
+ */
+static void makeScene( CONTAINER_3D& aContainer, std::mt19937& aRng )
+{
+    std::uniform_real_distribution<float> pos( -50.0f, 50.0f );
+    std::uniform_real_distribution<float> size( 0.1f, 5.0f );
+    std::uniform_real_distribution<float> height( 0.0f, 10.0f );
+
+    for( int ii = 0; ii < 2000; ++ii )
+    {
+        SFVEC3F min( pos( aRng ), pos( aRng ), ii % 2 ? 1.6f : height( aRng ) );
+        SFVEC3F max = min + SFVEC3F( size( aRng ), size( aRng ), ii % 2 ? 0.0f : size( aRng ) );
+
+        aContainer.Add( new DUMMY_BLOCK( BBOX_3D( min, max ) ) );
+    }
+
+    for( int ii = 0; ii < 2000; ++ii )
+    {
+        SFVEC3F v1( pos( aRng ), pos( aRng ), height( aRng ) );
+        SFVEC3F v2 = v1 + SFVEC3F( size( aRng ), 0.0f, size( aRng ) );
+        SFVEC3F v3 = v1 + SFVEC3F( 0.0f, size( aRng ), size( aRng ) );
+
+        aContainer.Add( new TRIANGLE( v1, v2, v3 ) );
+    }
+}
+
+
+static RAY makeRay( std::mt19937& aRng, int aIndex )
+{
+    std::uniform_real_distribution<float> pos( -60.0f, 60.0f );
+    std::uniform_real_distribution<float> dir( -1.0f, 1.0f );
+
+    SFVEC3F origin( pos( aRng ), pos( aRng ), 30.0f );
+    SFVEC3F direction;
+
+    // Some axis aligned rays, as from an orthographic camera
+    if( aIndex % 4 == 0 )
+        direction = SFVEC3F( 0.0f, 0.0f, -1.0f );
+    else if( aIndex % 4 == 1 )
+        direction = SFVEC3F( dir( aRng ), 0.0f, -1.0f );
+    else
+        direction = SFVEC3F( dir( aRng ), dir( aRng ), -1.0f );
+
+    RAY ray;
+    ray.Init( origin, glm::normalize( direction ) );
+    return ray;
+}
+
+
+static HITINFO noHit()
+{
+    HITINFO hitInfo;
+    hitInfo.m_tHit = std::numeric_limits<float>::infinity();
+    hitInfo.m_acc_node_info = 0;
+    hitInfo.pHitObject = nullptr;
+    return hitInfo;
+}
+
+
+BOOST_AUTO_TEST_SUITE( BvhPbrt )
+
+
+BOOST_AUTO_TEST_CASE( TraversalMatchesBruteForce )
+{
+    std::mt19937 rng( 42 );
+    CONTAINER_3D container;
+
+    makeScene( container, rng );
+
+    for( SPLITMETHOD method : { SPLITMETHOD::SAH, SPLITMETHOD::HLBVH, SPLITMETHOD::MIDDLE } )
+    {
+        BVH_PBRT bvh( container, 4, method );
+        int      hits = 0;
+
+        for( int ii = 0; ii < 5000; ++ii )
+        {
+            RAY     ray = makeRay( rng, ii );
+            HITINFO expected = noHit();
+            HITINFO actual = noHit();
+
+            bool expectedHit = container.Intersect( ray, expected );
+
+            BOOST_REQUIRE_EQUAL( bvh.Intersect( ray, actual ), expectedHit );
+
+            if( !expectedHit )
+                continue;
+
+            hits++;
+            BOOST_CHECK_EQUAL( actual.m_tHit, expected.m_tHit );
+
+            // The node of the hit finds it again
+            HITINFO again = noHit();
+
+            BOOST_CHECK( bvh.Intersect( ray, again, actual.m_acc_node_info ) );
+            BOOST_CHECK_EQUAL( again.m_tHit, actual.m_tHit );
+
+            // Shadow rays
+            BOOST_CHECK( bvh.IntersectP( ray, expected.m_tHit * 1.01f ) );
+            BOOST_CHECK_EQUAL( bvh.IntersectP( ray, expected.m_tHit * 0.5f ),
+                               container.IntersectP( ray, expected.m_tHit * 0.5f ) );
+        }
+
+        // Make sure the scene is dense enough to test something
+        BOOST_CHECK_GT( hits, 1000 );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( EmptyAndSingleObject )
+{
+    CONTAINER_3D container;
+    RAY          ray;
+    HITINFO      hitInfo = noHit();
+
+    ray.Init( SFVEC3F( 0.5f, 0.5f, 10.0f ), SFVEC3F( 0.0f, 0.0f, -1.0f ) );
+
+    {
+        BVH_PBRT bvh( container );
+
+        BOOST_CHECK( !bvh.Intersect( ray, hitInfo ) );
+        BOOST_CHECK( !bvh.IntersectP( ray, 100.0f ) );
+    }
+
+    // A single leaf as root
+    container.Add( new DUMMY_BLOCK( BBOX_3D( SFVEC3F( 0.0f ), SFVEC3F( 1.0f ) ) ) );
+
+    BVH_PBRT bvh( container );
+
+    BOOST_CHECK( bvh.Intersect( ray, hitInfo ) );
+    BOOST_CHECK_CLOSE( hitInfo.m_tHit, 9.0f, 1e-4 );
+    BOOST_CHECK( bvh.IntersectP( ray, 100.0f ) );
+    BOOST_CHECK( !bvh.IntersectP( ray, 5.0f ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
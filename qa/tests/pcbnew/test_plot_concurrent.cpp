@@ -0,0 +1,143 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Check that plotting the layers of a multi-file output concurrently gives the same files as
+ * plotting them one after the other.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <pcbnew_utils/board_test_utils.h>
+#include <board.h>
+#include <pcb_plot_params.h>
+#include <pcb_plotter.h>
+#include <reporter.h>
+#include <settings/settings_manager.h>
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include <fstream>
+#include <map>
+
+
+struct CONCURRENT_PLOT_FIXTURE
+{
+    CONCURRENT_PLOT_FIXTURE() :
+            m_settingsManager( true /* headless */ )
+    { }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+/**
+ * Read a plot file, leaving out the lines holding the creation date.
+ */
+static std::string readPlotFile( const wxString& aFileName )
+{
+    std::ifstream in( aFileName.fn_str(), std::ios::binary );
+    std::string   line;
+    std::string   contents;
+
+    while( std::getline( in, line ) )
+    {
+        if( line.find( "CreationDate" ) != std::string::npos
+                || line.rfind( "G04 Created by", 0 ) == 0 )
+        {
+            continue;
+        }
+
+        contents += line;
+        contents += '\n';
+    }
+
+    return contents;
+}
+
+
+/**
+ * Plot the layers to \a aDir and return the files created, by name.
+ */
+static std::map<wxString, std::string> plot( BOARD* aBoard, PCB_PLOT_PARAMS aOpts,
+                                             const LSEQ& aLayers, bool aConcurrent,
+                                             const wxString& aDir )
+{
+    wxFileName::Mkdir( aDir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL );
+
+    PCB_PLOTTER plotter( aBoard, &NULL_REPORTER::GetInstance(), aOpts );
+
+    plotter.SetConcurrentPlot( aConcurrent );
+    BOOST_CHECK( plotter.Plot( aDir, aLayers, {}, false ) );
+
+    std::map<wxString, std::string> files;
+    wxArrayString                   fileNames;
+
+    wxDir::GetAllFiles( aDir, &fileNames );
+
+    for( const wxString& fileName : fileNames )
+        files[wxFileName( fileName ).GetFullName()] = readPlotFile( fileName );
+
+    wxFileName::Rmdir( aDir, wxPATH_RMDIR_RECURSIVE );
+
+    return files;
+}
+
+
+BOOST_FIXTURE_TEST_CASE( ConcurrentPlotMatchesSerial, CONCURRENT_PLOT_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "component_classes", m_board );
+
+    // The mask layers plot the pads inflated, from copies of the board pads
+    LSEQ layers = { F_Cu, B_Cu, F_Mask, B_Mask, F_Paste, F_SilkS, Edge_Cuts };
+
+    wxString tempDir = wxFileName::GetTempDir() + wxFileName::GetPathSeparator()
+                       + wxString::Format( wxS( "kicad-qa-plot-%ld" ), wxGetProcessId() );
+
+    for( PLOT_FORMAT format : { PLOT_FORMAT::GERBER, PLOT_FORMAT::PDF } )
+    {
+        PCB_PLOT_PARAMS opts;
+
+        opts.SetFormat( format );
+        opts.SetCreateGerberJobFile( false );
+        opts.m_PDFSingle = false;
+
+        std::map<wxString, std::string> serial =
+                plot( m_board.get(), opts, layers, false, tempDir + wxS( "-serial" ) );
+        std::map<wxString, std::string> concurrent =
+                plot( m_board.get(), opts, layers, true, tempDir + wxS( "-concurrent" ) );
+
+        BOOST_CHECK_EQUAL( serial.size(), layers.size() );
+        BOOST_REQUIRE_EQUAL( serial.size(), concurrent.size() );
+
+        for( const auto& [fileName, contents] : serial )
+        {
+            BOOST_TEST_CONTEXT( fileName )
+            {
+                BOOST_REQUIRE( concurrent.count( fileName ) );
+                BOOST_CHECK( !contents.empty() );
+                BOOST_CHECK( contents == concurrent.at( fileName ) );
+            }
+        }
+    }
+}
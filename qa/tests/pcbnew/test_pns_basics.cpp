@@ -30,6 +30,9 @@
 #include <router/pns_node.h>
 #include <router/pns_router.h>
 #include <router/pns_item.h>
+#include <router/pns_line.h>
+#include <router/pns_optimizer.h>
+#include <router/pns_routing_settings.h>
 #include <router/pns_via.h>
 #include <router/pns_kicad_iface.h>
 
@@ -414,3 +417,111 @@ BOOST_FIXTURE_TEST_CASE( PNSHoleCollisions, PNS_TEST_FIXTURE )
     }
 }
 
+
+
+BOOST_FIXTURE_TEST_CASE( PNSBranchCopyOnWrite, PNS_TEST_FIXTURE )
+{
+    std::unique_ptr<PNS::NODE> world( new PNS::NODE );
+
+    world->SetMaxClearance( 10000000 );
+    world->SetRuleResolver( &m_ruleResolver );
+
+    PNS::VIA* v1 = new PNS::VIA( VECTOR2I( 0, 1000000 ), PNS_LAYER_RANGE( F_Cu, B_Cu ), 50000, 10000 );
+    v1->SetNet( (PNS::NET_HANDLE) 1 );
+    world->AddRaw( v1 );
+
+    PNS::NODE* branch = world->Branch();
+
+    auto v2 = std::make_unique<PNS::VIA>( VECTOR2I( 0, 2000000 ), PNS_LAYER_RANGE( F_Cu, B_Cu ),
+                                          50000, 10000 );
+    v2->SetNet( (PNS::NET_HANDLE) 2 );
+    PNS::VIA* v2ptr = v2.get();
+    branch->Add( std::move( v2 ) );
+
+    // A branch of a non-root node shares its parent's state until it is modified
+    PNS::NODE* subBranch = branch->Branch();
+
+    BOOST_CHECK_EQUAL( subBranch->Depth(), 2 );
+    BOOST_CHECK_EQUAL( subBranch->JointCount(), branch->JointCount() );
+    BOOST_CHECK( subBranch->FindJoint( v2ptr->Pos(), F_Cu, v2ptr->Net() ) );
+    BOOST_CHECK( subBranch->FindJoint( v1->Pos(), F_Cu, v1->Net() ) );
+
+    subBranch->Remove( v2ptr );
+    subBranch->Remove( v1 );
+
+    BOOST_CHECK( !subBranch->FindJoint( v2ptr->Pos(), F_Cu, v2ptr->Net() ) );
+    BOOST_CHECK( subBranch->Overrides( v1 ) );
+
+    // ... and the modifications must not leak back into the parent branch
+    BOOST_CHECK( branch->FindJoint( v2ptr->Pos(), F_Cu, v2ptr->Net() ) );
+    BOOST_CHECK( !branch->Overrides( v1 ) );
+
+    PNS::NODE::OBSTACLES obstacles;
+    m_ruleResolver.m_defaultClearance = 1000000;
+
+    PNS::VIA probe( VECTOR2I( 0, 1500000 ), PNS_LAYER_RANGE( F_Cu, B_Cu ), 50000, 10000 );
+    probe.SetNet( (PNS::NET_HANDLE) 3 );
+
+    BOOST_CHECK_EQUAL( branch->QueryColliding( &probe, obstacles ) > 0, true );
+
+    obstacles.clear();
+    BOOST_CHECK_EQUAL( subBranch->QueryColliding( &probe, obstacles ), 0 );
+
+    world->KillChildren();
+}
+
+
+BOOST_FIXTURE_TEST_CASE( PNSParallelMergeMatchesSerial, PNS_TEST_FIXTURE )
+{
+    PNS::ROUTING_SETTINGS settings( nullptr, "" );
+    m_router->LoadSettings( &settings );
+
+    std::unique_ptr<PNS::NODE> world( new PNS::NODE );
+
+    world->SetMaxClearance( 10000000 );
+    world->SetRuleResolver( &m_ruleResolver );
+    m_ruleResolver.m_defaultClearance = 100000;
+
+    // A staircase long enough for several parallel batches, with vias next to some steps so
+    // that part of the shortcuts collide
+    SHAPE_LINE_CHAIN chain;
+
+    for( int ii = 0; ii <= 60; ++ii )
+        chain.Append( VECTOR2I( ( ( ii + 1 ) / 2 ) * 1000000, ( ii / 2 ) * 1000000 ) );
+
+    for( int ii = 3; ii < 30; ii += 4 )
+    {
+        PNS::VIA* via = new PNS::VIA( VECTOR2I( ii * 1000000 + 300000, ii * 1000000 + 700000 ),
+                                      PNS_LAYER_RANGE( F_Cu, B_Cu ), 300000, 150000 );
+        via->SetNet( (PNS::NET_HANDLE) 2 );
+        world->AddRaw( via );
+    }
+
+    PNS::LINE line;
+    line.SetShape( chain );
+    line.SetWidth( 200000 );
+    line.SetLayer( F_Cu );
+    line.SetNet( (PNS::NET_HANDLE) 1 );
+
+    std::vector<SHAPE_LINE_CHAIN> results;
+
+    for( bool parallel : { false, true } )
+    {
+        PNS::OPTIMIZER optimizer( world.get() );
+        PNS::LINE      result;
+
+        optimizer.SetEffortLevel( PNS::OPTIMIZER::MERGE_SEGMENTS );
+        optimizer.SetParallelCandidates( parallel );
+        optimizer.Optimize( &line, &result );
+
+        results.push_back( result.CLine() );
+    }
+
+    BOOST_CHECK_LT( results[0].SegmentCount(), chain.SegmentCount() );
+    BOOST_REQUIRE_EQUAL( results[0].PointCount(), results[1].PointCount() );
+
+    for( int ii = 0; ii < results[0].PointCount(); ++ii )
+        BOOST_CHECK_EQUAL( results[0].CPoint( ii ), results[1].CPoint( ii ) );
+
+    m_router->LoadSettings( nullptr );
+}
@@ -0,0 +1,190 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <fmt/format.h>
+
+#include <sim/sim_sweep.h>
+
+
+BOOST_AUTO_TEST_SUITE( SimSweep )
+
+
+BOOST_AUTO_TEST_CASE( ParseSteps )
+{
+    SIM_SWEEP sweep;
+    wxString  errors;
+
+    BOOST_CHECK( sweep.ParseDirectives( { wxS( ".param rval=1k\n.step param rval 1k 3k 1k" ),
+                                          wxS( ".STEP param cval list 1n 10n" ),
+                                          wxS( ".step mc 3 7" ) },
+                                        &errors ) );
+    BOOST_CHECK( errors.IsEmpty() );
+
+    BOOST_REQUIRE_EQUAL( sweep.GetParams().size(), 2 );
+    BOOST_CHECK_EQUAL( sweep.GetParams()[0].m_Values.size(), 3 );
+    BOOST_CHECK_CLOSE( sweep.GetParams()[0].m_Values[2], 3000.0, 1e-9 );
+    BOOST_CHECK_CLOSE( sweep.GetParams()[1].m_Values[0], 1e-9, 1e-9 );
+    BOOST_CHECK_EQUAL( sweep.GetMonteCarloRuns(), 3 );
+
+    std::vector<SIM_SWEEP::RUN> runs = sweep.GetRuns();
+
+    // 3 resistances x 2 capacitances x 3 Monte Carlo runs, Monte Carlo varying fastest
+    BOOST_REQUIRE_EQUAL( runs.size(), 18 );
+    BOOST_CHECK_EQUAL( runs[0].m_Seed, 7 );
+    BOOST_CHECK_EQUAL( runs[1].m_Seed, 8 );
+    BOOST_CHECK_CLOSE( runs[3].m_Params[1].second, 10e-9, 1e-9 );
+    BOOST_CHECK_CLOSE( runs[6].m_Params[0].second, 2000.0, 1e-9 );
+
+    BOOST_CHECK( !sweep.ParseStep( wxS( ".step param rval 1k 3k -1k" ) ) );
+    BOOST_CHECK( !sweep.ParseStep( wxS( ".step param rval list abc" ) ) );
+    BOOST_CHECK( !sweep.ParseStep( wxS( ".step mc 0" ) ) );
+    BOOST_CHECK( !SIM_SWEEP::IsStepDirective( wxS( ".stepper" ) ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( RunLimit )
+{
+    SIM_SWEEP sweep;
+    wxString  error;
+
+    BOOST_CHECK( sweep.ParseStep( wxS( ".step param rval 1 100 1" ) ) );
+    BOOST_CHECK( sweep.ParseStep( wxS( ".step mc 100" ) ) );
+    BOOST_CHECK_EQUAL( sweep.GetRunCount(), 10000 );
+
+    // Studies over the limit are rejected, not truncated, and the study is left unchanged
+    BOOST_CHECK( !sweep.ParseStep( wxS( ".step param cval list 1n 2n" ), &error ) );
+    BOOST_CHECK( !error.IsEmpty() );
+    BOOST_CHECK( !sweep.ParseStep( wxS( ".step mc 101" ) ) );
+    BOOST_CHECK_EQUAL( sweep.GetParams().size(), 1 );
+    BOOST_CHECK_EQUAL( sweep.GetMonteCarloRuns(), 100 );
+    BOOST_CHECK_EQUAL( sweep.GetRuns().size(), 10000 );
+
+    // Replacing a parameter counts its new values only
+    BOOST_CHECK( sweep.ParseStep( wxS( ".step param rval list 1 2" ) ) );
+    BOOST_CHECK_EQUAL( sweep.GetRunCount(), 200 );
+}
+
+
+BOOST_AUTO_TEST_CASE( RunNetlist )
+{
+    SIM_SWEEP::RUN run;
+    run.m_Params.emplace_back( wxS( "rval" ), 2000.0 );
+    run.m_Seed = 3;
+
+    std::string netlist = SIM_SWEEP::MakeRunNetlist( "KiCad schematic\n.param rval=1k\n"
+                                                     "R1 in out {rval}\n.tran 1u 1m\n.end\n",
+                                                     run, ST_TRAN, "/tmp/run0.raw" );
+
+    BOOST_CHECK( netlist.find( ".options seed=3\n" ) != std::string::npos );
+    BOOST_CHECK( netlist.find( "alterparam rval = 2000\nreset\nrun\nlinearize\n" )
+                 != std::string::npos );
+    BOOST_CHECK( netlist.find( "write \"/tmp/run0.raw\"" ) != std::string::npos );
+
+    // The original .end is replaced by one after the control section
+    BOOST_CHECK_EQUAL( netlist.find( ".end\n" ), netlist.size() - 5 );
+    BOOST_CHECK( netlist.find( ".tran 1u 1m\n.options" ) != std::string::npos );
+}
+
+
+BOOST_AUTO_TEST_CASE( RawFileAndStats )
+{
+    auto rawFile =
+            []( double aScale )
+            {
+                return fmt::format( "Title: test\n"
+                                    "Date: today\n"
+                                    "Plotname: Transient Analysis\n"
+                                    "Flags: real\n"
+                                    "No. Variables: 3\n"
+                                    "No. Points: 2\n"
+                                    "Variables:\n"
+                                    "\t0\ttime\ttime\n"
+                                    "\t1\tv(out)\tvoltage\n"
+                                    "\t2\ti(v1)\tcurrent\n"
+                                    "Values:\n"
+                                    " 0\t0.000000e+00\n\t0.0\n\t1e-3\n"
+                                    " 1\t1.000000e-03\n\t{}\n\t-2e-3\n",
+                                    aScale );
+            };
+
+    std::vector<SIM_SWEEP_VECTORS> vectors( 3 );
+
+    for( int ii = 0; ii < 3; ++ii )
+        BOOST_REQUIRE( vectors[ii].ParseRawFile( rawFile( ii + 1.0 ) ) );
+
+    BOOST_CHECK_EQUAL( vectors[0].GetPointCount(), 2 );
+    BOOST_CHECK( !vectors[0].IsComplex() );
+    BOOST_CHECK_EQUAL( vectors[0].Find( SIM_SWEEP_VECTORS::NormalizeVectorName( wxS( "V(OUT)" ) ) ),
+                       1 );
+    BOOST_CHECK_EQUAL( vectors[0].Find( SIM_SWEEP_VECTORS::NormalizeVectorName( wxS( "v1#branch" ) ) ),
+                       2 );
+
+    SIM_SWEEP_RESULTS results( ST_TRAN, std::vector<SIM_SWEEP::RUN>( 3 ), std::move( vectors ) );
+
+    std::vector<double> x, y;
+
+    BOOST_REQUIRE( results.GetVector( wxS( "out" ), SIM_SWEEP_RESULTS::REAL, &x, &y ) );
+    BOOST_CHECK_EQUAL( results.GetPointsPerRun(), 2 );
+    BOOST_REQUIRE_EQUAL( y.size(), 6 );
+    BOOST_CHECK_EQUAL( x[2], 0.0 );
+    BOOST_CHECK_EQUAL( y[5], 3.0 );
+
+    SIM_SWEEP_RESULTS::STATS stats;
+
+    BOOST_REQUIRE( results.GetFinalValueStats( wxS( "V(out)" ), &stats ) );
+    BOOST_CHECK_CLOSE( stats.m_Mean, 2.0, 1e-9 );
+    BOOST_CHECK_CLOSE( stats.m_StdDev, 1.0, 1e-9 );
+    BOOST_CHECK_EQUAL( stats.m_Min, 1.0 );
+    BOOST_CHECK_EQUAL( stats.m_Max, 3.0 );
+
+    BOOST_CHECK( !results.GetVector( wxS( "V(missing)" ), SIM_SWEEP_RESULTS::REAL, &x, &y ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( ComplexRawFile )
+{
+    SIM_SWEEP_VECTORS vectors;
+
+    BOOST_REQUIRE( vectors.ParseRawFile( "Plotname: AC Analysis\n"
+                                         "Flags: complex\n"
+                                         "No. Variables: 2\n"
+                                         "No. Points: 1\n"
+                                         "Variables:\n"
+                                         "\t0\tfrequency\tfrequency grid=3\n"
+                                         "\t1\tv(out)\tvoltage\n"
+                                         "Values:\n"
+                                         " 0\t1.000000e+03,0.000000e+00\n"
+                                         "\t3.0,4.0\n" ) );
+
+    SIM_SWEEP_RESULTS   results( ST_AC, std::vector<SIM_SWEEP::RUN>( 1 ), { vectors } );
+    std::vector<double> x, y;
+
+    BOOST_REQUIRE( results.GetVector( wxS( "V(out)" ), SIM_SWEEP_RESULTS::GAIN, &x, &y ) );
+    BOOST_CHECK_EQUAL( x[0], 1000.0 );
+    BOOST_CHECK_CLOSE( y[0], 5.0, 1e-9 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
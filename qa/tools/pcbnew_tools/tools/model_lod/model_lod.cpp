@@ -0,0 +1,250 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Measure the simplification of 3D models for the OpenGL viewer: time to build the levels of
+ * detail, time to read them back from the cache file and the number of triangles drawn for a
+ * board full of models seen from different distances.
+ *
+ * Usage: model_lod [model files...]
+ * Without files, a finely tessellated cylinder is used.
+ */
+
+#include <qa_utils/utility_registry.h>
+
+#include <3d_cache/3d_model_lod.h>
+#include <3d_cache/3d_plugin_manager.h>
+#include <3d_cache/sg/scenegraph.h>
+#include <plugins/3dapi/ifsg_api.h>
+#include <core/profile.h>
+
+#include <wx/filename.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+enum MODEL_LOD_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+/**
+ * A cylinder standing for a dense component model (e.g. a tessellated electrolytic capacitor).
+ */
+static S3DMODEL* makeCylinder()
+{
+    const int segments = 512;
+    const int rows = 128;
+
+    std::vector<SFVEC3F>      positions;
+    std::vector<SFVEC3F>      normals;
+    std::vector<unsigned int> indices;
+
+    for( int row = 0; row <= rows; ++row )
+    {
+        for( int seg = 0; seg <= segments; ++seg )
+        {
+            float phi = glm::two_pi<float>() * seg / segments;
+
+            positions.emplace_back( std::cos( phi ), std::sin( phi ), 4.0f * row / rows );
+            normals.emplace_back( std::cos( phi ), std::sin( phi ), 0.0f );
+        }
+    }
+
+    for( int row = 0; row < rows; ++row )
+    {
+        for( int seg = 0; seg < segments; ++seg )
+        {
+            unsigned int a = row * ( segments + 1 ) + seg;
+            unsigned int b = a + segments + 1;
+
+            indices.insert( indices.end(), { a, a + 1, b, a + 1, b + 1, b } );
+        }
+    }
+
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = 1;
+    model->m_Materials = new SMATERIAL[1];
+    S3D::Init3DMaterial( model->m_Materials[0] );
+
+    model->m_MeshesSize = 1;
+    model->m_Meshes = new SMESH[1];
+
+    SMESH& mesh = model->m_Meshes[0];
+    S3D::Init3DMesh( mesh );
+
+    mesh.m_VertexSize = positions.size();
+    mesh.m_Positions = new SFVEC3F[positions.size()];
+    mesh.m_Normals = new SFVEC3F[positions.size()];
+    std::copy( positions.begin(), positions.end(), mesh.m_Positions );
+    std::copy( normals.begin(), normals.end(), mesh.m_Normals );
+
+    mesh.m_FaceIdxSize = indices.size();
+    mesh.m_FaceIdx = new unsigned int[indices.size()];
+    std::copy( indices.begin(), indices.end(), mesh.m_FaceIdx );
+
+    return model;
+}
+
+
+/**
+ * Count the triangles drawn for a grid of instances of a model, 5 mm wide and spread on a
+ * 100 mm square board, seen from above by a perspective camera.
+ */
+static void simulateFrames( const S3DMODEL& aModel, const std::vector<S3DMODEL*>& aLods )
+{
+    const int   gridCount = 40;
+    const float boardSize = 100.0f;
+    const float modelSize = 5.0f;
+    const float screenHeight = 1080.0f;
+    const float focal = 1.0f / std::tan( glm::radians( 45.0f ) / 2.0f );
+
+    std::vector<unsigned int> triangles = { S3D::GetTriangleCount( aModel ) };
+
+    for( const S3DMODEL* lod : aLods )
+        triangles.push_back( S3D::GetTriangleCount( *lod ) );
+
+    printf( "  %10s %16s %16s %10s %12s\n", "distance", "full triangles", "LOD triangles",
+            "ratio", "select (us)" );
+
+    for( float distance : { 50.0f, 100.0f, 200.0f, 400.0f, 800.0f, 1600.0f } )
+    {
+        uint64_t   fullCount = 0;
+        uint64_t   lodCount = 0;
+        PROF_TIMER timer;
+
+        for( int ix = 0; ix < gridCount; ++ix )
+        {
+            for( int iy = 0; iy < gridCount; ++iy )
+            {
+                float x = ( (float) ix / ( gridCount - 1 ) - 0.5f ) * boardSize;
+                float y = ( (float) iy / ( gridCount - 1 ) - 0.5f ) * boardSize;
+                float depth = std::sqrt( x * x + y * y + distance * distance );
+                float screenSize = modelSize * focal / depth * screenHeight * 0.5f;
+
+                fullCount += triangles[0];
+                lodCount += triangles[S3D::SelectLod( screenSize, aLods.size() )];
+            }
+        }
+
+        timer.Stop();
+
+        printf( "  %10.0f %16llu %16llu %10.3f %12.1f\n", distance,
+                (unsigned long long) fullCount, (unsigned long long) lodCount,
+                (double) lodCount / fullCount, timer.msecs() * 1000.0 );
+    }
+}
+
+
+static void benchmarkModel( const wxString& aName, const S3DMODEL& aModel )
+{
+    printf( "%s: %u meshes, %u triangles\n", (const char*) aName.ToUTF8(), aModel.m_MeshesSize,
+            S3D::GetTriangleCount( aModel ) );
+
+    std::vector<S3DMODEL*> lods;
+    PROF_TIMER             buildTimer;
+
+    S3D::BuildLods( aModel, lods );
+    buildTimer.Stop();
+
+    printf( "  build: %.2f ms\n", buildTimer.msecs() );
+
+    for( size_t ii = 0; ii < lods.size(); ++ii )
+    {
+        printf( "  level %zu (grid %d): %u triangles\n", ii + 1, S3D::LOD_GRID_SIZES[ii],
+                S3D::GetTriangleCount( *lods[ii] ) );
+    }
+
+    wxString fileName = wxFileName::CreateTempFileName( wxS( "kicad-model-lod" ) );
+
+    if( S3D::WriteLodCache( fileName, aModel, lods ) )
+    {
+        std::vector<S3DMODEL*> loaded;
+        PROF_TIMER             readTimer;
+
+        bool ok = S3D::ReadLodCache( fileName, aModel, loaded );
+        readTimer.Stop();
+
+        printf( "  read from cache file: %.2f ms%s\n", readTimer.msecs(), ok ? "" : " (failed)" );
+
+        for( S3DMODEL*& lod : loaded )
+            S3D::Destroy3DModel( &lod );
+    }
+
+    wxRemoveFile( fileName );
+
+    simulateFrames( aModel, lods );
+
+    for( S3DMODEL*& lod : lods )
+        S3D::Destroy3DModel( &lod );
+}
+
+
+int model_lod_main( int argc, char* argv[] )
+{
+    if( argc < 2 )
+    {
+        S3DMODEL* model = makeCylinder();
+
+        benchmarkModel( wxS( "cylinder" ), *model );
+        S3D::Destroy3DModel( &model );
+
+        return KI_TEST::RET_CODES::OK;
+    }
+
+    S3D_PLUGIN_MANAGER plugins;
+
+    for( int ii = 1; ii < argc; ++ii )
+    {
+        wxString    fileName = wxString::FromUTF8( argv[ii] );
+        std::string pluginInfo;
+        SCENEGRAPH* scene = plugins.Load3DModel( fileName, pluginInfo );
+        S3DMODEL*   model = scene ? S3D::GetModel( scene ) : nullptr;
+
+        if( !model )
+        {
+            fprintf( stderr, "Cannot load model '%s'\n", argv[ii] );
+            delete scene;
+            return MODEL_LOD_RET_CODES::LOAD_FAILED;
+        }
+
+        benchmarkModel( fileName, *model );
+
+        S3D::Destroy3DModel( &model );
+        delete scene;
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "model_lod",
+        "Measure the levels of detail of 3D models",
+        model_lod_main,
+} );
@@ -0,0 +1,362 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright The KiCad Developers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Headless router benchmark.  Replays a corpus of recorded P&S sessions (the same layout as
+ * the pns_regressions test data: a directory with a tests.lst file listing one case per line,
+ * each case containing a "pns" log + board) and reports per-event latency percentiles, the
+ * number of node branches and collision queries, and the memory use as JSON.
+ *
+ * Run it once with "--index rtree" and once with "--index grid" to compare the router's spatial
+ * index implementations on the same corpus.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+#include <wx/textfile.h>
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <json_common.h>
+#include <reporter.h>
+#include <qa_utils/utility_registry.h>
+
+#include "pns_log_file.h"
+#include "pns_log_player.h"
+
+#if defined( _WIN32 )
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "output",
+            _( "JSON report file (default: pns_benchmark.json)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "repeat",
+            _( "number of times each session is replayed (default: 1)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "i",
+            "index",
+            _( "router spatial index: 'rtree' or 'grid' (default: as set in the board)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            "corpus",
+            "corpus",
+            _( "directory containing tests.lst, or a single log file name (no extension)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+/**
+ * @return the peak resident set size of the process in kilobytes, or 0 if unknown.
+ */
+static uint64_t processPeakMemoryKb()
+{
+#if defined( _WIN32 )
+    PROCESS_MEMORY_COUNTERS pmc;
+
+    if( GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) ) )
+        return pmc.PeakWorkingSetSize / 1024;
+
+    return 0;
+#else
+    struct rusage usage;
+
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return 0;
+
+#if defined( __APPLE__ )
+    return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    return usage.ru_maxrss;         // kilobytes elsewhere
+#endif
+#endif
+}
+
+
+/**
+ * Reset the resident set size high water mark, so that the next casePeakMemoryKb() call
+ * returns the peak since this call.  Only Linux can do this; the process peak of
+ * processPeakMemoryKb() is not affected.
+ *
+ * @return true if the high water mark was reset.
+ */
+static bool resetPeakMemory()
+{
+#if defined( __linux__ )
+    std::ofstream clearRefs( "/proc/self/clear_refs" );
+    clearRefs << "5";
+    clearRefs.close();
+
+    return !clearRefs.fail();
+#else
+    return false;
+#endif
+}
+
+
+/**
+ * @return the resident set size high water mark since the last resetPeakMemory() call, in
+ *         kilobytes, or 0 if unknown.
+ */
+static uint64_t casePeakMemoryKb()
+{
+#if defined( __linux__ )
+    std::ifstream status( "/proc/self/status" );
+    std::string   line;
+
+    while( std::getline( status, line ) )
+    {
+        if( line.rfind( "VmHWM:", 0 ) == 0 )
+            return std::strtoull( line.c_str() + 6, nullptr, 10 );
+    }
+#endif
+
+    return 0;
+}
+
+
+static double percentile( const std::vector<double>& aSorted, double aPercentile )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    // nearest-rank method
+    size_t rank = (size_t) std::ceil( aPercentile / 100.0 * aSorted.size() );
+    return aSorted[std::clamp<size_t>( rank, 1, aSorted.size() ) - 1];
+}
+
+
+static nlohmann::json summarize( const std::vector<PNS_LOG_PLAYER::EVENT_STATS>& aStats )
+{
+    std::vector<double> latencies;
+    uint64_t            branches = 0;
+    uint64_t            queries = 0;
+    double              total = 0.0;
+
+    latencies.reserve( aStats.size() );
+
+    for( const PNS_LOG_PLAYER::EVENT_STATS& evt : aStats )
+    {
+        latencies.push_back( evt.m_durationMs );
+        total += evt.m_durationMs;
+        branches += evt.m_branches;
+        queries += evt.m_collisionQueries;
+    }
+
+    std::sort( latencies.begin(), latencies.end() );
+
+    nlohmann::json j;
+
+    j["events"] = aStats.size();
+    j["latency_ms"] = { { "p50", percentile( latencies, 50 ) },
+                        { "p95", percentile( latencies, 95 ) },
+                        { "p99", percentile( latencies, 99 ) },
+                        { "max", latencies.empty() ? 0.0 : latencies.back() },
+                        { "total", total } };
+    j["node_branches"] = branches;
+    j["collision_queries"] = queries;
+
+    return j;
+}
+
+
+static std::vector<std::pair<wxString, wxString>> collectCases( const wxString& aCorpus )
+{
+    std::vector<std::pair<wxString, wxString>> cases;
+
+    if( !wxFileName::DirExists( aCorpus ) )
+    {
+        cases.emplace_back( wxFileName( aCorpus ).GetName(), aCorpus );
+        return cases;
+    }
+
+    wxFileName listFile( aCorpus, wxT( "tests.lst" ) );
+    wxTextFile fp( listFile.GetFullPath() );
+
+    if( !fp.Open() )
+        return cases;
+
+    for( size_t ii = 0; ii < fp.GetLineCount(); ii++ )
+    {
+        wxString line = fp.GetLine( ii ).Trim().Trim( false );
+
+        if( !line.IsEmpty() )
+            cases.emplace_back( line, aCorpus + wxT( "/" ) + line + wxT( "/pns" ) );
+    }
+
+    return cases;
+}
+
+
+int benchmark_main_func( int argc, char* argv[] )
+{
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "P&S router benchmark. Replays recorded routing sessions and "
+                               "reports router performance statistics as JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cl_parser.Found( "help" ) )
+        return KI_TEST::RET_CODES::OK;
+
+    if( cmd_parsed_ok != 0 || cl_parser.GetParamCount() < 1 )
+    {
+        printf( "P&S router benchmark. For command line options, call %s -h.\n\n", argv[0] );
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     repeat = 1;
+    wxString outputPath = wxT( "pns_benchmark.json" );
+    wxString indexType;
+
+    cl_parser.Found( "repeat", &repeat );
+    cl_parser.Found( "output", &outputPath );
+    cl_parser.Found( "index", &indexType );
+
+    if( !indexType.IsEmpty() && indexType != wxT( "rtree" ) && indexType != wxT( "grid" ) )
+    {
+        std::cerr << "Unknown index type " << indexType << std::endl;
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    auto cases = collectCases( cl_parser.GetParam( 0 ) );
+
+    if( cases.empty() )
+    {
+        std::cerr << "No test cases found in " << cl_parser.GetParam( 0 ) << std::endl;
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    nlohmann::json                           report;
+    std::vector<PNS_LOG_PLAYER::EVENT_STATS> allStats;
+    int                                      failed = 0;
+
+    report["cases"] = nlohmann::json::array();
+
+    for( const auto& [name, path] : cases )
+    {
+        bool         peakReset = resetPeakMemory();
+        PNS_LOG_FILE logFile;
+
+        if( !logFile.Load( wxFileName( path ), &NULL_REPORTER::GetInstance() ) )
+        {
+            std::cerr << "Failed to load test case " << path << std::endl;
+            failed++;
+            continue;
+        }
+
+        if( !indexType.IsEmpty() )
+            logFile.GetBoard()->GetDesignSettings().m_RouterGridIndex = indexType == wxT( "grid" );
+
+        std::vector<PNS_LOG_PLAYER::EVENT_STATS> caseStats;
+
+        for( long rep = 0; rep < std::max( 1L, repeat ); rep++ )
+        {
+            PNS_LOG_PLAYER player;
+
+            player.SetDebugOutputEnabled( false );
+            player.ReplayLog( &logFile, 0 );
+
+            const std::vector<PNS_LOG_PLAYER::EVENT_STATS>& stats = player.GetEventStats();
+            caseStats.insert( caseStats.end(), stats.begin(), stats.end() );
+        }
+
+        nlohmann::json caseReport = summarize( caseStats );
+
+        caseReport["name"] = name.ToStdString();
+
+        // Without a way to reset the high water mark the case peak is unknown, the process
+        // peak is only reported in the summary
+        if( peakReset )
+            caseReport["peak_memory_kb"] = casePeakMemoryKb();
+
+        report["cases"].push_back( caseReport );
+
+        allStats.insert( allStats.end(), caseStats.begin(), caseStats.end() );
+    }
+
+    report["summary"] = summarize( allStats );
+    report["summary"]["process_peak_memory_kb"] = processPeakMemoryKb();
+    report["summary"]["failed_cases"] = failed;
+    report["summary"]["repeat"] = repeat;
+
+    if( !indexType.IsEmpty() )
+        report["summary"]["index"] = indexType.ToStdString();
+
+    // The replay itself prints progress to stdout, so the report always goes to a file
+    std::ofstream out( outputPath.ToStdString() );
+    out << report.dump( 2 ) << std::endl;
+
+    if( !out )
+    {
+        std::cerr << "Failed to write report to " << outputPath << std::endl;
+        return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+    }
+
+    return failed ? KI_TEST::RET_CODES::TOOL_SPECIFIC : KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "benchmark",
+        "PNS router benchmark (replays logged routing sessions)",
+        benchmark_main_func,
+} );
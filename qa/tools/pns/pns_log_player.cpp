@@ -26,12 +26,14 @@
 #include "pns_log_player.h"
 
 #include <pcbnew_utils/board_test_utils.h>
+#include <core/profile.h>
 
 #define PNSLOGINFO PNS::DEBUG_DECORATOR::SRC_LOCATION_INFO( __FILE__, __FUNCTION__, __LINE__ )
 
 using namespace PNS;
 
-PNS_LOG_PLAYER::PNS_LOG_PLAYER()
+PNS_LOG_PLAYER::PNS_LOG_PLAYER() :
+        m_debugOutputEnabled( true )
 {
     SetReporter( &NULL_REPORTER::GetInstance() );
 }
@@ -58,6 +60,7 @@ void PNS_LOG_PLAYER::createRouter()
 
     m_debugDecorator = new PNS_TEST_DEBUG_DECORATOR( m_reporter );
     m_debugDecorator->Clear();
+    m_debugDecorator->SetDebugEnabled( m_debugOutputEnabled );
     m_iface->SetDebugDecorator( m_debugDecorator );
 }
 
@@ -103,6 +106,7 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
     int totalEvents = aLog->Events().size();
 
     m_router->SetMode( aLog->GetMode() );
+    m_eventStats.clear();
 
     for( auto evt : aLog->Events() )
     {
@@ -128,6 +132,9 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
 
         eventIdx++;
 
+        PNS::NODE::ResetStats();
+        PROF_TIMER eventTimer;
+
         switch( evt.type )
         {
         case LOGGER::EVT_START_ROUTE:
@@ -225,6 +232,13 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
         default: break;
         }
 
+        eventTimer.Stop();
+
+        PNS::NODE::STATS nodeStats = PNS::NODE::GetStats();
+
+        m_eventStats.push_back( { evt.type, eventTimer.msecs(), nodeStats.m_branches,
+                                  nodeStats.m_collisionQueries } );
+
         PNS::NODE* node = nullptr;
 
 #if 0
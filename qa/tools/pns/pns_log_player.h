@@ -93,6 +93,15 @@ private:
 class PNS_LOG_PLAYER
 {
 public:
+    ///< Cost of replaying a single logged event.
+    struct EVENT_STATS
+    {
+        PNS::LOGGER::EVENT_TYPE m_type;
+        double                  m_durationMs;
+        uint64_t                m_branches;         ///< NODE::Branch() calls
+        uint64_t                m_collisionQueries; ///< NODE::QueryColliding() calls
+    };
+
     PNS_LOG_PLAYER();
     ~PNS_LOG_PLAYER();
 
@@ -106,6 +115,14 @@ public:
 
     void SetTimeLimit( uint64_t microseconds ) { m_timeLimitUs = microseconds; }
 
+    /**
+     * Enable or disable collecting router debug graphics during replay.  Benchmarks disable
+     * it, as the debug output dominates the run time and forces serial candidate evaluation.
+     */
+    void SetDebugOutputEnabled( bool aEnabled ) { m_debugOutputEnabled = aEnabled; }
+
+    const std::vector<EVENT_STATS>& GetEventStats() const { return m_eventStats; }
+
     bool CompareResults( PNS_LOG_FILE* aLog );
     const PNS_LOG_FILE::COMMIT_STATE GetRouterUpdatedItems();
 
@@ -120,6 +137,9 @@ private:
     std::unique_ptr<PNS::ROUTING_SETTINGS>      m_routingSettings;
     uint64_t m_timeLimitUs;
     REPORTER* m_reporter;
+    bool      m_debugOutputEnabled;
+
+    std::vector<EVENT_STATS> m_eventStats;
 };
 
 #endif